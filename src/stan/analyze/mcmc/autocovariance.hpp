@@ -13,47 +13,56 @@ namespace stan {
 namespace analyze {
 
 /**
- * Write autocorrelation estimates for every lag for the specified
- * input sequence into the specified result using the specified FFT
- * engine. Normalizes lag-k autocorrelation estimators by N instead
- * of (N - k), yielding biased but more stable estimators as
- * discussed in Geyer (1992); see
- * https://projecteuclid.org/euclid.ss/1177011137. The return vector
- * will be resized to the same length as the input sequence with
- * lags given by array index.
- *
- * <p>The implementation involves a fast Fourier transform,
- * followed by a normalization, followed by an inverse transform.
- *
- * <p>An FFT engine can be created for reuse for type double with:
+ * Reusable storage for autocorrelation and autocovariance estimates:
+ * the FFT engine, which caches its plans by size, and the padded
+ * signal and frequency buffers.  Reusing one workspace across
+ * sequences avoids reallocating these for every sequence.
  *
- * <pre>
- *     Eigen::FFT<double> fft;
- * </pre>
+ * @tparam T Scalar type.
+ */
+template <typename T>
+struct autocovariance_workspace {
+  Eigen::FFT<T> fft;
+  Eigen::Matrix<T, Eigen::Dynamic, 1> centered_signal;
+  Eigen::Matrix<std::complex<T>, Eigen::Dynamic, 1> freqvec;
+  Eigen::Matrix<std::complex<T>, Eigen::Dynamic, 1> ac_tmp;
+};
+
+namespace internal {
+
+/**
+ * Write autocorrelation estimates for every lag for the specified
+ * input sequence into the specified result, using the specified FFT
+ * engine and buffers.
  *
  * @tparam T Scalar type.
  * @param y Input sequence.
  * @param ac Autocorrelations.
  * @param fft FFT engine instance.
+ * @param centered_signal buffer for the padded, centered sequence
+ * @param freqvec buffer for the transformed sequence
+ * @param ac_tmp buffer for the inverse transform
  */
 template <typename T, typename DerivedA, typename DerivedB>
-void autocorrelation(const Eigen::MatrixBase<DerivedA>& y,
-                     Eigen::MatrixBase<DerivedB>& ac, Eigen::FFT<T>& fft) {
+void autocorrelation(
+    const Eigen::MatrixBase<DerivedA>& y, Eigen::MatrixBase<DerivedB>& ac,
+    Eigen::FFT<T>& fft, Eigen::Matrix<T, Eigen::Dynamic, 1>& centered_signal,
+    Eigen::Matrix<std::complex<T>, Eigen::Dynamic, 1>& freqvec,
+    Eigen::Matrix<std::complex<T>, Eigen::Dynamic, 1>& ac_tmp) {
   size_t N = y.size();
   size_t M = math::internal::fft_next_good_size(N);
   size_t Mt2 = 2 * M;
 
   // centered_signal = y-mean(y) followed by N zeros
-  Eigen::Matrix<T, Eigen::Dynamic, 1> centered_signal(Mt2);
-  centered_signal.setZero();
+  centered_signal.setZero(Mt2);
   centered_signal.head(N) = y.array() - y.mean();
 
-  Eigen::Matrix<std::complex<T>, Eigen::Dynamic, 1> freqvec(Mt2);
+  freqvec.resize(Mt2);
   fft.fwd(freqvec, centered_signal);
   // cwiseAbs2 == norm
   freqvec = freqvec.cwiseAbs2();
 
-  Eigen::Matrix<std::complex<T>, Eigen::Dynamic, 1> ac_tmp(Mt2);
+  ac_tmp.resize(Mt2);
   fft.inv(ac_tmp, freqvec);
 
   // use "biased" estimate as recommended by Geyer (1992)
@@ -61,10 +70,12 @@ void autocorrelation(const Eigen::MatrixBase<DerivedA>& y,
   ac /= ac(0);
 }
 
+}  // namespace internal
+
 /**
- * Write autocovariance estimates for every lag for the specified
+ * Write autocorrelation estimates for every lag for the specified
  * input sequence into the specified result using the specified FFT
- * engine. Normalizes lag-k autocovariance estimators by N instead
+ * engine. Normalizes lag-k autocorrelation estimators by N instead
  * of (N - k), yielding biased but more stable estimators as
  * discussed in Geyer (1992); see
  * https://projecteuclid.org/euclid.ss/1177011137. The return vector
@@ -74,18 +85,43 @@ void autocorrelation(const Eigen::MatrixBase<DerivedA>& y,
  * <p>The implementation involves a fast Fourier transform,
  * followed by a normalization, followed by an inverse transform.
  *
- * <p>This method is just a light wrapper around the three-argument
- * autocovariance function
+ * <p>An FFT engine can be created for reuse for type double with:
+ *
+ * <pre>
+ *     Eigen::FFT<double> fft;
+ * </pre>
+ *
+ * @tparam T Scalar type.
+ * @param y Input sequence.
+ * @param ac Autocorrelations.
+ * @param fft FFT engine instance.
+ */
+template <typename T, typename DerivedA, typename DerivedB>
+void autocorrelation(const Eigen::MatrixBase<DerivedA>& y,
+                     Eigen::MatrixBase<DerivedB>& ac, Eigen::FFT<T>& fft) {
+  Eigen::Matrix<T, Eigen::Dynamic, 1> centered_signal;
+  Eigen::Matrix<std::complex<T>, Eigen::Dynamic, 1> freqvec;
+  Eigen::Matrix<std::complex<T>, Eigen::Dynamic, 1> ac_tmp;
+  internal::autocorrelation(y, ac, fft, centered_signal, freqvec, ac_tmp);
+}
+
+/**
+ * Write autocovariance estimates for every lag for the specified
+ * input sequence into the specified result, reusing the FFT engine
+ * and buffers of the specified workspace.  The estimates are the same
+ * as those of the two-argument <code>autocovariance</code>.
  *
  * @tparam T Scalar type.
  * @param y Input sequence.
  * @param acov Autocovariances.
+ * @param ws Workspace reused across calls.
  */
 template <typename T, typename DerivedA, typename DerivedB>
 void autocovariance(const Eigen::MatrixBase<DerivedA>& y,
-                    Eigen::MatrixBase<DerivedB>& acov) {
-  Eigen::FFT<T> fft;
-  autocorrelation(y, acov, fft);
+                    Eigen::MatrixBase<DerivedB>& acov,
+                    autocovariance_workspace<T>& ws) {
+  internal::autocorrelation(y, acov, ws.fft, ws.centered_signal, ws.freqvec,
+                            ws.ac_tmp);
 
   using boost::accumulators::accumulator_set;
   using boost::accumulators::stats;
@@ -99,6 +135,33 @@ void autocovariance(const Eigen::MatrixBase<DerivedA>& y,
   acov = acov.array() * boost::accumulators::variance(acc);
 }
 
+/**
+ * Write autocovariance estimates for every lag for the specified
+ * input sequence into the specified result using the specified FFT
+ * engine. Normalizes lag-k autocovariance estimators by N instead
+ * of (N - k), yielding biased but more stable estimators as
+ * discussed in Geyer (1992); see
+ * https://projecteuclid.org/euclid.ss/1177011137. The return vector
+ * will be resized to the same length as the input sequence with
+ * lags given by array index.
+ *
+ * <p>The implementation involves a fast Fourier transform,
+ * followed by a normalization, followed by an inverse transform.
+ *
+ * <p>This method is just a light wrapper around the three-argument
+ * autocovariance function
+ *
+ * @tparam T Scalar type.
+ * @param y Input sequence.
+ * @param acov Autocovariances.
+ */
+template <typename T, typename DerivedA, typename DerivedB>
+void autocovariance(const Eigen::MatrixBase<DerivedA>& y,
+                    Eigen::MatrixBase<DerivedB>& acov) {
+  autocovariance_workspace<T> ws;
+  autocovariance(y, acov, ws);
+}
+
 /**
  * Write autocovariance estimates for every lag for the specified
  * input sequence into the specified result using the specified FFT
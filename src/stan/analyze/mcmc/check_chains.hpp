@@ -17,7 +17,7 @@ namespace analyze {
  * @param chains matrix of draws, one column per chain
  * @return bool true if OK, false otherwise
  */
-inline bool is_finite_and_varies(const Eigen::MatrixXd chains) {
+inline bool is_finite_and_varies(const Eigen::MatrixXd& chains) {
   size_t num_chains = chains.cols();
   size_t num_samples = chains.rows();
   Eigen::VectorXd first_draws = Eigen::VectorXd::Zero(num_chains);
@@ -5,6 +5,7 @@
 #include <boost/math/distributions/normal.hpp>
 #include <algorithm>
 #include <cmath>
+#include <utility>
 #include <vector>
 #include <limits>
 
@@ -12,25 +13,31 @@ namespace stan {
 namespace analyze {
 
 /**
- * Computes normalized average ranks for pooled draws. Normal scores computed
- * using inverse normal transformation and a fractional offset. Based on paper
- * https://arxiv.org/abs/1903.08008
+ * Writes normalized average ranks for pooled draws into
+ * <code>ranks</code>, reusing the storage of <code>ranks</code> and
+ * <code>order</code>, which are resized as needed.  Normal scores
+ * computed using inverse normal transformation and a fractional offset.
+ * Based on paper https://arxiv.org/abs/1903.08008
  *
+ * @tparam Derived type of the matrix of draws
  * @param chains matrix of draws, one column per chain
- * @return normal scores for average ranks of draws
+ * @param[out] ranks normal scores for average ranks of draws
+ * @param[in,out] order buffer for the sorted draws and their indexes
  */
-inline Eigen::MatrixXd rank_transform(const Eigen::MatrixXd& chains) {
-  const Eigen::Index rows = chains.rows();
-  const Eigen::Index cols = chains.cols();
-  const Eigen::Index size = rows * cols;
+template <typename Derived>
+inline void rank_transform(
+    const Eigen::MatrixBase<Derived>& chains, Eigen::MatrixXd& ranks,
+    std::vector<std::pair<double, Eigen::Index>>& order) {
+  const Eigen::Index size = chains.size();
 
-  std::vector<std::pair<double, int>> value_with_index(size);
+  order.resize(size);
   for (Eigen::Index i = 0; i < size; ++i) {
-    value_with_index[i] = {chains(i), i};
+    order[i] = {chains(i), i};
   }
 
-  std::sort(value_with_index.begin(), value_with_index.end());
-  Eigen::MatrixXd rank_matrix = Eigen::MatrixXd::Zero(rows, cols);
+  std::sort(order.begin(), order.end());
+  ranks.resize(chains.rows(), chains.cols());
+  boost::math::normal_distribution<double> dist;
   // Assigning average ranks
   for (Eigen::Index i = 0; i < size; ++i) {
     // Handle ties by averaging ranks
@@ -38,20 +45,33 @@ inline Eigen::MatrixXd rank_transform(const Eigen::MatrixXd& chains) {
     double sum_ranks = j;
     Eigen::Index count = 1;
 
-    while (j < size && value_with_index[j].first == value_with_index[i].first) {
+    while (j < size && order[j].first == order[i].first) {
       sum_ranks += j + 1;  // Rank starts from 1
       ++j;
       ++count;
     }
     double avg_rank = sum_ranks / count;
-    boost::math::normal_distribution<double> dist;
-    for (std::size_t k = i; k < j; ++k) {
-      double p = (avg_rank - 0.375) / (size + 0.25);
-      const Eigen::Index index = value_with_index[k].second;
-      rank_matrix(index) = boost::math::quantile(dist, p);
+    double p = (avg_rank - 0.375) / (size + 0.25);
+    double z = boost::math::quantile(dist, p);
+    for (Eigen::Index k = i; k < j; ++k) {
+      ranks(order[k].second) = z;
     }
     i = j - 1;  // Skip over tied elements
   }
+}
+
+/**
+ * Computes normalized average ranks for pooled draws. Normal scores computed
+ * using inverse normal transformation and a fractional offset. Based on paper
+ * https://arxiv.org/abs/1903.08008
+ *
+ * @param chains matrix of draws, one column per chain
+ * @return normal scores for average ranks of draws
+ */
+inline Eigen::MatrixXd rank_transform(const Eigen::MatrixXd& chains) {
+  Eigen::MatrixXd rank_matrix;
+  std::vector<std::pair<double, Eigen::Index>> order;
+  rank_transform(chains, rank_matrix, order);
   return rank_matrix;
 }
 
@@ -2,6 +2,7 @@
 #define STAN_ANALYZE_MCMC_SPLIT_RANK_NORMALIZED_ESS_HPP
 
 #include <stan/math/prim.hpp>
+#include <stan/analyze/mcmc/autocovariance.hpp>
 #include <stan/analyze/mcmc/check_chains.hpp>
 #include <stan/analyze/mcmc/rank_normalization.hpp>
 #include <stan/analyze/mcmc/split_chains.hpp>
@@ -18,30 +19,48 @@
 namespace stan {
 namespace analyze {
 
+/**
+ * Reusable storage for <code>ess</code>: the autocovariance workspace
+ * and the per-chain autocovariances, means and variances.  Reusing one
+ * workspace across parameters avoids reallocating these for every
+ * parameter.
+ */
+struct ess_workspace {
+  autocovariance_workspace<double> autocovariance;
+  Eigen::MatrixXd acov;
+  Eigen::VectorXd chain_mean;
+  Eigen::VectorXd chain_var;
+  Eigen::VectorXd rho_hat_t;
+};
+
 /**
  * Computes the effective sample size (ESS) for the specified
- * parameter across all chains.  The number of draws per chain must be > 3,
- * and the values across all draws must be finite and not constant.
- * The value returned is the minimum of ESS and (sample_sz * log10(sample_sz).
- * Sample autocovariance is computed using Stan math library implmentation.
+ * parameter across all chains, reusing the specified workspace.  The
+ * number of draws per chain must be > 3, and the values across all
+ * draws must be finite and not constant.  The value returned is the
+ * minimum of ESS and (sample_sz * log10(sample_sz).
  * See https://arxiv.org/abs/1903.08008, section 3.2 for discussion.
  *
  * @param chains matrix of draws across all chains
+ * @param ws workspace reused across calls
  * @return effective sample size for the specified parameter
  */
-double ess(const Eigen::MatrixXd& chains) {
+inline double ess(const Eigen::MatrixXd& chains, ess_workspace& ws) {
   const Eigen::Index num_chains = chains.cols();
   const Eigen::Index num_draws = chains.rows();
-  Eigen::MatrixXd acov(num_draws, num_chains);
-  Eigen::VectorXd chain_mean(num_chains);
-  Eigen::VectorXd chain_var(num_chains);
+  Eigen::MatrixXd& acov = ws.acov;
+  Eigen::VectorXd& chain_mean = ws.chain_mean;
+  Eigen::VectorXd& chain_var = ws.chain_var;
+  acov.resize(num_draws, num_chains);
+  chain_mean.resize(num_chains);
+  chain_var.resize(num_chains);
 
   // compute the per-chain autocovariance
-  for (size_t i = 0; i < num_chains; ++i) {
+  for (Eigen::Index i = 0; i < num_chains; ++i) {
     Eigen::Map<const Eigen::VectorXd> chain_col(chains.col(i).data(),
                                                 num_draws);
     Eigen::Map<Eigen::VectorXd> cov_col(acov.col(i).data(), num_draws);
-    stan::math::autocovariance<double>(chain_col, cov_col);
+    autocovariance(chain_col, cov_col, ws.autocovariance);
     chain_mean(i) = chain_col.mean();
     chain_var(i) = cov_col(0) * num_draws / (num_draws - 1);
   }
@@ -54,8 +73,8 @@ double ess(const Eigen::MatrixXd& chains) {
   }
 
   // Geyer's initial positive sequence, eqn (11)
-  Eigen::VectorXd rho_hat_t = Eigen::VectorXd::Zero(num_draws);
-  Eigen::VectorXd acov_t(num_chains);
+  Eigen::VectorXd& rho_hat_t = ws.rho_hat_t;
+  rho_hat_t.setZero(num_draws);
   double rho_hat_even = 1.0;
   rho_hat_t(0) = rho_hat_even;  // lag 0
   double rho_hat_odd = 1 - (w_chain_var - acov.row(1).mean()) / var_plus;
@@ -66,14 +85,8 @@ double ess(const Eigen::MatrixXd& chains) {
   size_t t = 1;
   while (t < num_draws - 4 && (rho_hat_even + rho_hat_odd > 0)
          && !std::isnan(rho_hat_even + rho_hat_odd)) {
-    for (size_t i = 0; i < num_chains; ++i) {
-      acov_t(i) = acov.col(i)(t + 1);
-    }
-    rho_hat_even = 1 - (w_chain_var - acov_t.mean()) / var_plus;
-    for (size_t i = 0; i < num_chains; ++i) {
-      acov_t(i) = acov.col(i)(t + 2);
-    }
-    rho_hat_odd = 1 - (w_chain_var - acov_t.mean()) / var_plus;
+    rho_hat_even = 1 - (w_chain_var - acov.row(t + 1).mean()) / var_plus;
+    rho_hat_odd = 1 - (w_chain_var - acov.row(t + 2).mean()) / var_plus;
     if ((rho_hat_even + rho_hat_odd) >= 0) {
       rho_hat_t(t + 1) = rho_hat_even;
       rho_hat_t(t + 2) = rho_hat_odd;
@@ -100,6 +113,21 @@ double ess(const Eigen::MatrixXd& chains) {
   return (num_samples / tau_hat);
 }
 
+/**
+ * Computes the effective sample size (ESS) for the specified
+ * parameter across all chains.  The number of draws per chain must be > 3,
+ * and the values across all draws must be finite and not constant.
+ * The value returned is the minimum of ESS and (sample_sz * log10(sample_sz).
+ * See https://arxiv.org/abs/1903.08008, section 3.2 for discussion.
+ *
+ * @param chains matrix of draws across all chains
+ * @return effective sample size for the specified parameter
+ */
+inline double ess(const Eigen::MatrixXd& chains) {
+  ess_workspace ws;
+  return ess(chains, ws);
+}
+
 /**
  * Computes the split effective sample size (split ESS) using rank based
  * diagnostic for a set of per-chain draws. Based on paper
@@ -0,0 +1,262 @@
+#ifndef STAN_ANALYZE_MCMC_SUMMARIZE_DRAWS_HPP
+#define STAN_ANALYZE_MCMC_SUMMARIZE_DRAWS_HPP
+
+#include <stan/math/prim.hpp>
+#include <stan/analyze/mcmc/check_chains.hpp>
+#include <stan/analyze/mcmc/rank_normalization.hpp>
+#include <stan/analyze/mcmc/split_rank_normalized_ess.hpp>
+#include <stan/analyze/mcmc/split_rank_normalized_rhat.hpp>
+#include <boost/math/distributions/beta.hpp>
+#include <boost/math/distributions/normal.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace analyze {
+
+/**
+ * Summary statistics of every column of a set of chains, as computed
+ * by <code>summarize_draws</code>.  Each vector has one element per
+ * column.
+ */
+struct draws_summary {
+  Eigen::VectorXd mean;
+  Eigen::VectorXd sd;
+  /**
+   * Monte Carlo standard error of the mean, <code>sd / sqrt(ess)</code>
+   * with the effective sample size of the split draws
+   */
+  Eigen::VectorXd mcse_mean;
+  /**
+   * Monte Carlo standard errors of the 5%, 50% and 95% quantiles,
+   * estimated from the effective sample size of the indicator of draws
+   * at or below the quantile, as by <code>mcse_quantile</code> of the
+   * R package posterior
+   */
+  Eigen::VectorXd mcse_q5;
+  Eigen::VectorXd mcse_q50;
+  Eigen::VectorXd mcse_q95;
+  /**
+   * Quantiles, one row per column and one column per probability
+   */
+  Eigen::MatrixXd quantiles;
+  Eigen::VectorXd ess_bulk;
+  Eigen::VectorXd ess_tail;
+  Eigen::VectorXd rhat_bulk;
+  Eigen::VectorXd rhat_tail;
+};
+
+namespace internal {
+
+/**
+ * Scratch space reused across the columns summarized by one thread:
+ * the workspace of <code>ess</code>, which holds the FFT engine, and
+ * the buffers for split, transformed and sorted draws.
+ */
+struct summary_workspace {
+  ess_workspace ess;
+  Eigen::MatrixXd split;
+  Eigen::MatrixXd transformed;
+  std::vector<std::pair<double, Eigen::Index>> order;
+  std::vector<double> sorted;
+  std::vector<double> sorted_split;
+};
+
+/**
+ * Return the quantile of sorted values with linear interpolation, as
+ * <code>stan::math::quantile</code> computes it.
+ */
+inline double sorted_quantile(const std::vector<double>& sorted, double p) {
+  double index = (sorted.size() - 1) * p;
+  size_t lo = std::floor(index);
+  double h = index - lo;
+  if (lo + 1 >= sorted.size())
+    return sorted[lo];
+  return (1 - h) * sorted[lo] + h * sorted[lo + 1];
+}
+
+/**
+ * Return the Monte Carlo standard error of the quantile for the
+ * specified probability, as <code>mcse_quantile</code> of the R
+ * package posterior computes it.  The effective sample size of the
+ * indicator of split draws at or below the quantile gives a beta
+ * distribution for the probability of the quantile; the standard
+ * error is half the distance between the draws at its 15.9% and 84.1%
+ * quantiles, which correspond to one standard deviation of a normal.
+ *
+ * @param ws workspace with the split draws in <code>ws.split</code>
+ * and all draws sorted in <code>ws.sorted</code>
+ * @param prob probability of the quantile
+ * @return standard error, or NaN if the indicator does not vary
+ */
+inline double mcse_quantile(summary_workspace& ws, double prob) {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  double quantile = sorted_quantile(ws.sorted, prob);
+  ws.transformed = (ws.split.array() <= quantile).cast<double>();
+  if (ws.transformed.minCoeff() == ws.transformed.maxCoeff())
+    return nan;
+  double ess_quantile = ess(ws.transformed, ws.ess);
+  if (!std::isfinite(ess_quantile))
+    return nan;
+
+  boost::math::normal_distribution<double> normal;
+  boost::math::beta_distribution<double> beta(ess_quantile * prob + 1,
+                                              ess_quantile * (1 - prob) + 1);
+  double a_lo = boost::math::quantile(beta, boost::math::cdf(normal, -1));
+  double a_hi = boost::math::quantile(beta, boost::math::cdf(normal, 1));
+  const double size = ws.sorted.size();
+  size_t lo = std::max(std::floor(a_lo * size), 1.0) - 1;
+  size_t hi = std::min(std::ceil(a_hi * size), size) - 1;
+  return (ws.sorted[hi] - ws.sorted[lo]) / 2;
+}
+
+/**
+ * Summarize column <code>j</code> of the chains into row
+ * <code>j</code> of the summary.
+ */
+inline void summarize_column(summary_workspace& ws,
+                             const std::vector<Eigen::MatrixXd>& chains,
+                             const Eigen::VectorXd& probs, Eigen::Index j,
+                             draws_summary& summary) {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const size_t num_chains = chains.size();
+  const Eigen::Index num_draws = chains[0].rows();
+  const Eigen::Index half = num_draws / 2;
+
+  ws.sorted.clear();
+  ws.split.resize(half, 2 * num_chains);
+  for (size_t i = 0; i < num_chains; ++i) {
+    const double* draws = chains[i].col(j).data();
+    ws.sorted.insert(ws.sorted.end(), draws, draws + num_draws);
+    ws.split.col(2 * i) = Eigen::Map<const Eigen::VectorXd>(draws, half);
+    ws.split.col(2 * i + 1)
+        = Eigen::Map<const Eigen::VectorXd>(draws + half, half);
+  }
+
+  Eigen::Map<const Eigen::VectorXd> all(ws.sorted.data(), ws.sorted.size());
+  double mean = all.mean();
+  double sd = std::sqrt((all.array() - mean).square().sum()
+                        / (all.size() - 1.0));
+  summary.mean(j) = mean;
+  summary.sd(j) = sd;
+  std::sort(ws.sorted.begin(), ws.sorted.end());
+  for (Eigen::Index k = 0; k < probs.size(); ++k)
+    summary.quantiles(j, k) = sorted_quantile(ws.sorted, probs(k));
+
+  summary.mcse_mean(j) = nan;
+  summary.mcse_q5(j) = nan;
+  summary.mcse_q50(j) = nan;
+  summary.mcse_q95(j) = nan;
+  summary.ess_bulk(j) = nan;
+  summary.ess_tail(j) = nan;
+  summary.rhat_bulk(j) = nan;
+  summary.rhat_tail(j) = nan;
+  if (!is_finite_and_varies(ws.split))
+    return;
+
+  rank_transform(ws.split, ws.transformed, ws.order);
+  summary.rhat_bulk(j) = rhat(ws.transformed);
+  bool ess_defined = ws.split.rows() >= 4;
+  if (ess_defined)
+    summary.ess_bulk(j) = ess(ws.transformed, ws.ess);
+
+  // the quantiles of the split draws, which may omit the last draw
+  ws.sorted_split.assign(ws.split.data(), ws.split.data() + ws.split.size());
+  std::sort(ws.sorted_split.begin(), ws.sorted_split.end());
+  double median = sorted_quantile(ws.sorted_split, 0.5);
+  rank_transform((ws.split.array() - median).abs().matrix(), ws.transformed,
+                 ws.order);
+  summary.rhat_tail(j) = rhat(ws.transformed);
+
+  if (!ess_defined)
+    return;
+  double q05 = sorted_quantile(ws.sorted_split, 0.05);
+  double q95 = sorted_quantile(ws.sorted_split, 0.95);
+  ws.transformed = (ws.split.array() <= q05).cast<double>();
+  double ess_tail_05 = ess(ws.transformed, ws.ess);
+  ws.transformed = (ws.split.array() >= q95).cast<double>();
+  double ess_tail_95 = ess(ws.transformed, ws.ess);
+  if (std::isnan(ess_tail_05))
+    summary.ess_tail(j) = ess_tail_95;
+  else if (std::isnan(ess_tail_95))
+    summary.ess_tail(j) = ess_tail_05;
+  else
+    summary.ess_tail(j) = std::min(ess_tail_05, ess_tail_95);
+
+  summary.mcse_mean(j) = sd / std::sqrt(ess(ws.split, ws.ess));
+  summary.mcse_q5(j) = mcse_quantile(ws, 0.05);
+  summary.mcse_q50(j) = mcse_quantile(ws, 0.5);
+  summary.mcse_q95(j) = mcse_quantile(ws, 0.95);
+}
+
+}  // namespace internal
+
+/**
+ * Computes the mean, standard deviation, Monte Carlo standard errors of
+ * the mean and of the 5%, 50% and 95% quantiles, quantiles, and the
+ * rank normalized split R-hat and bulk and tail effective sample sizes
+ * of every column of a set of chains.
+ *
+ * The R-hat and effective sample sizes are the values
+ * <code>split_rank_normalized_rhat</code> and
+ * <code>split_rank_normalized_ess</code> compute one column at a time;
+ * they are NaN when the split draws are not finite or do not vary, and
+ * the effective sample sizes and standard errors also when there are
+ * fewer than 8 draws per chain.  The mean, standard deviation and quantiles are over all
+ * draws of all chains, with quantiles interpolated as by
+ * <code>stan::math::quantile</code>.
+ *
+ * Columns are summarized in parallel with TBB; each thread reuses its
+ * own FFT engine and scratch buffers across the columns it is given.
+ *
+ * @param chains draws of each chain, one row per draw and one column
+ *   per parameter; all chains must have the same dimensions
+ * @param probs probabilities of the quantiles to compute
+ * @return summary of every column
+ * @throw std::invalid_argument if there are no chains or the chains
+ *   have different dimensions
+ */
+inline draws_summary summarize_draws(const std::vector<Eigen::MatrixXd>& chains,
+                                     const Eigen::VectorXd& probs) {
+  if (chains.empty())
+    throw std::invalid_argument("summarize_draws: no chains");
+  for (const auto& chain : chains)
+    if (chain.rows() != chains[0].rows() || chain.cols() != chains[0].cols())
+      throw std::invalid_argument(
+          "summarize_draws: chains have different dimensions");
+
+  const Eigen::Index num_params = chains[0].cols();
+  draws_summary summary;
+  summary.mean.resize(num_params);
+  summary.sd.resize(num_params);
+  summary.mcse_mean.resize(num_params);
+  summary.mcse_q5.resize(num_params);
+  summary.mcse_q50.resize(num_params);
+  summary.mcse_q95.resize(num_params);
+  summary.quantiles.resize(num_params, probs.size());
+  summary.ess_bulk.resize(num_params);
+  summary.ess_tail.resize(num_params);
+  summary.rhat_bulk.resize(num_params);
+  summary.rhat_tail.resize(num_params);
+
+  tbb::enumerable_thread_specific<internal::summary_workspace> workspaces;
+  tbb::parallel_for(tbb::blocked_range<Eigen::Index>(0, num_params),
+                    [&](const tbb::blocked_range<Eigen::Index>& r) {
+                      internal::summary_workspace& ws = workspaces.local();
+                      for (Eigen::Index j = r.begin(); j != r.end(); ++j)
+                        internal::summarize_column(ws, chains, probs, j,
+                                                   summary);
+                    });
+  return summary;
+}
+
+}  // namespace analyze
+}  // namespace stan
+
+#endif
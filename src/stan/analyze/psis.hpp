@@ -0,0 +1,307 @@
+#ifndef STAN_ANALYZE_PSIS_HPP
+#define STAN_ANALYZE_PSIS_HPP
+
+#include <stan/math/prim.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace analyze {
+namespace internal {
+
+/**
+ * Compute log joint likelihood parameter estimates from generalized pareto
+ * distribution and the samples the parameters were estimated from. The
+ * estimates are evaluated in parallel.
+ * @tparam EigArray1 An Eigen type inheriting from `ArrayBase` with dynamic
+ * compile time rows and 1 compile time column.
+ * @tparam EigArray2 An Eigen type inheriting from `ArrayBase` with dynamic
+ * compile time rows and 1 compile time column.
+ * @param[in] theta Estimates from generalized pareto distribution estimation
+ * @param[in] x The sample that the parameters were estimated from.
+ * @return Array of the joint log likelihood of parameter estimates from
+ * generalized pareto distribution and the samples the parameters were estimated
+ * from.
+ */
+template <typename EigArray1, typename EigArray2>
+inline Eigen::Array<double, Eigen::Dynamic, 1> profile_loglikelihood(
+    const EigArray1& theta, const EigArray2& x) {
+  const auto& theta_ref = stan::math::to_ref(theta);
+  const auto& x_ref = stan::math::to_ref(x);
+  Eigen::Array<double, Eigen::Dynamic, 1> k(theta_ref.size());
+  tbb::parallel_for(tbb::blocked_range<Eigen::Index>(0, theta_ref.size()),
+                    [&](const tbb::blocked_range<Eigen::Index>& r) {
+                      for (Eigen::Index i = r.begin(); i < r.end(); ++i) {
+                        k.coeffRef(i)
+                            = (-theta_ref.coeff(i) * x_ref.array())
+                                  .log1p()
+                                  .mean();
+                      }
+                    });
+  return (-theta_ref / k).log() - k - 1;
+}
+
+/**
+ * Estimate parameters of the Generalized Pareto distribution
+ *
+ * Given a sample `x`, Estimate the parameters `k` and $sigma$ of
+ * the Generalized Pareto Distribution (GPD), assuming the location parameter is
+ * 0. By default the fit uses a prior for `k`, which will stabilize
+ * estimates for very small sample sizes (and low effective sample sizes in the
+ * case of MCMC samples). The weakly informative prior is a Gaussian prior
+ * centered at 0.5.
+ *
+ * @tparam EigArray An Eigen type inheriting from `ArrayBase` with dynamic
+ * compile time rows and 1 compile time column.
+ * @param[in] x A numeric vector. The sample from which to estimate the
+ * parameters.
+ * @param[in] min_grid_pts The minimum number of grid points used in the fitting
+ *   algorithm.
+ * @return A pair of doubles with the first element `sigma` and the second
+ * element `k`.
+ *
+ * @details Here the parameter `k is the negative of `k` in Zhang & Stephens
+ * (2009).
+ *
+ * references:
+ * Zhang, J., and Stephens, M. A. (2009). A new and efficient estimation method
+ * for the generalized Pareto distribution. *Technometrics* **51**, 316-325.
+ */
+template <typename EigArray>
+inline std::pair<double, double> gpdfit(const EigArray& x,
+                                        const Eigen::Index min_grid_pts = 30) {
+  using array_vec_t = Eigen::Array<double, Eigen::Dynamic, 1>;
+  constexpr auto prior = 3.0;
+  const auto& x_ref = stan::math::to_ref(x);
+  const Eigen::Index N = x_ref.size();
+  // See section 4 of Zhang and Stephens (2009)
+  const Eigen::Index M = min_grid_pts + std::floor(std::sqrt(N));
+  auto linspaced_arr = array_vec_t::LinSpaced(M, 1, static_cast<double>(M));
+  // first quartile of sample
+  const double x_1st_qt = x_ref.coeff(
+      static_cast<Eigen::Index>(std::floor(static_cast<double>(N) / 4.0 + 0.5))
+      - 1l);
+  array_vec_t theta
+      = 1.0 / x_ref.coeff(N - 1)
+        + (1.0 - (M / (linspaced_arr - 0.5)).sqrt()) / (prior * x_1st_qt);
+  // profile log-lik
+  array_vec_t l_theta
+      = static_cast<double>(N) * profile_loglikelihood(theta, x_ref);
+  auto normalized_theta = (l_theta - stan::math::log_sum_exp(l_theta)).exp();
+  const double theta_hat = (theta * normalized_theta).sum();
+  double k = (-theta_hat * x_ref).log1p().mean();
+  const double sigma = -k / theta_hat;
+  constexpr double a = 10;
+  const double n_plus_a = N + a;
+  auto k_weighted = k * N / n_plus_a + a * 0.5 / n_plus_a;
+  return {sigma, k_weighted};
+}
+
+/**
+ * Inverse CDF of generalized pareto distribution
+ * (assuming location parameter is 0)
+ *
+ * @tparam EigArray An Eigen type inheriting from `ArrayBase` with dynamic
+ * compile time rows and 1 compile time column.
+ * @param[in] p Vector of probabilities.
+ * @param[in] k Scalar shape parameter.
+ * @param[in] sigma Scalar scale parameter.
+ * @return Vector of quantiles.
+ */
+template <typename EigArray>
+inline auto qgpd(const EigArray& p, const double k, const double sigma) {
+  return sigma * stan::math::expm1(-k * (-p).log1p()) / k;
+}
+
+/**
+ * PSIS tail smoothing for a single vector
+ *
+ * @tparam EigArray An Eigen type inheriting from `ArrayBase` with dynamic
+ * compile time rows and 1 compile time column.
+ * @param[in] x Array of tail elements already sorted in ascending order.
+ * @param[in] cutoff
+ * @return A pair containing:
+ * `first`: Eigen Array same size as `x` containing the logs of the
+ *   order statistics of the generalized pareto distribution.
+ * `second`: scalar shape parameter estimate.
+ */
+template <typename EigArray>
+inline auto psis_smooth_tail(const EigArray& x, const double cutoff) {
+  const double exp_cutoff = std::exp(cutoff);
+  const auto fit = gpdfit(x.array().exp() - exp_cutoff);
+  const double k = fit.second;
+  if (!std::isinf(k)) {
+    const Eigen::Index x_size = x.size();
+    const double sigma = fit.first;
+    auto p
+        = (Eigen::Array<double, Eigen::Dynamic, 1>::LinSpaced(x_size, 1, x_size)
+           - 0.5)
+          / x_size;
+    return std::make_pair((qgpd(p, k, sigma) + exp_cutoff).log().eval(), k);
+  } else {
+    return std::make_pair(x.eval(), k);
+  }
+}
+
+/**
+ * Get the largest N elements of an array.
+ *
+ * The elements are selected with `std::nth_element` and only the selected
+ * elements are sorted, so this is linear in the size of `arr`. Ties are
+ * ordered by their index and `NaN` is smaller than any other value.
+ * @param arr The normalized log ratios to sort
+ * @param top_size The length of the tail that is needs to be sorted.
+ * @return A pair with the largest N elements in ascending order in `first` and
+ * the original index of the largest N elements in `second`
+ */
+inline std::pair<Eigen::Array<double, Eigen::Dynamic, 1>,
+                 Eigen::Array<Eigen::Index, Eigen::Dynamic, 1>>
+largest_n_elements(const Eigen::Array<double, Eigen::Dynamic, 1>& arr,
+                   Eigen::Index top_size) {
+  const Eigen::Index arr_size = arr.size();
+  top_size = std::min(top_size, arr_size);
+  const auto key = [&arr](Eigen::Index i) {
+    const double x = arr.coeff(i);
+    return std::isnan(x) ? -std::numeric_limits<double>::infinity() : x;
+  };
+  const auto less = [&key](Eigen::Index i, Eigen::Index j) {
+    const double x_i = key(i);
+    const double x_j = key(j);
+    return x_i < x_j || (x_i == x_j && i < j);
+  };
+  std::vector<Eigen::Index> idx(arr_size);
+  std::iota(idx.begin(), idx.end(), 0);
+  const auto top_begin = idx.begin() + (arr_size - top_size);
+  std::nth_element(idx.begin(), top_begin, idx.end(), less);
+  std::sort(top_begin, idx.end(), less);
+  Eigen::Array<double, Eigen::Dynamic, 1> top_n(top_size);
+  Eigen::Array<Eigen::Index, Eigen::Dynamic, 1> top_n_idx(top_size);
+  for (Eigen::Index i = 0; i < top_size; ++i) {
+    top_n_idx.coeffRef(i) = top_begin[i];
+    top_n.coeffRef(i) = arr.coeff(top_begin[i]);
+  }
+  return {std::move(top_n), std::move(top_n_idx)};
+}
+}  // namespace internal
+
+/**
+ * Result of Pareto smoothed importance sampling (PSIS)
+ */
+struct psis_result_t {
+  // Smoothed and truncated log weights, shifted so that the largest log
+  // ratio is 0
+  Eigen::Array<double, Eigen::Dynamic, 1> log_weights;
+  // Shape parameter estimate of the tail, `NaN` if the tail was not smoothed
+  double pareto_k{std::numeric_limits<double>::quiet_NaN()};
+  // Number of smoothed log weights, 0 if the tail was not smoothed
+  Eigen::Index tail_len{0};
+};
+
+/**
+ * Return the default size of the tail smoothed by PSIS, the minimum of 20%
+ * of the draws and 3 times the square root of the number of draws.
+ *
+ * @param num_draws Number of draws
+ * @return The size of the tail
+ */
+inline Eigen::Index psis_tail_length(Eigen::Index num_draws) {
+  return static_cast<Eigen::Index>(
+      std::min(0.2 * num_draws, 3 * std::sqrt(num_draws)));
+}
+
+/**
+ * Run Pareto smoothed importance sampling (PSIS) on the specified log
+ * importance ratios.
+ *
+ * The tail is selected without sorting all the ratios, so this can be used
+ * cheaply by any algorithm with importance ratios for the Pareto k
+ * diagnostic of its approximation, as well as for the weights.
+ *
+ * @tparam EigArray An Eigen type inheriting from `ArrayBase` with dynamic
+ * compile time rows and 1 compile time column.
+ * @tparam Logger A type derived from `stan::callbacks::logger`
+ * @param[in] log_ratios Array of logarithms of importance ratios
+ * @param[in] tail_len Size of the tail. The tail is not smoothed if it is less
+ * than 5.
+ * @param[in,out] logger Stream for writing possible warnings
+ * @return The log weights along with the Pareto k diagnostic
+ */
+template <typename EigArray, typename Logger>
+inline psis_result_t psis(const EigArray& log_ratios, Eigen::Index tail_len,
+                          Logger& logger) {
+  psis_result_t result;
+  // shift log ratios for safer exponentiation
+  const double max_log_ratio = log_ratios.maxCoeff();
+  Eigen::Array<double, Eigen::Dynamic, 1> llr_weights
+      = log_ratios.array() - max_log_ratio;
+  if (tail_len >= 5) {
+    // Get back tail + smallest but not on tail in ascending order
+    std::pair<Eigen::Array<double, Eigen::Dynamic, 1>,
+              Eigen::Array<Eigen::Index, Eigen::Dynamic, 1>>
+        max_n = internal::largest_n_elements(llr_weights, tail_len + 1);
+    auto lw_tail = max_n.first.tail(tail_len);
+    double cutoff = max_n.first(0);
+    if (unlikely(lw_tail.maxCoeff() - lw_tail.minCoeff()
+                 <= std::numeric_limits<double>::min() * 10)) {
+      double eps_diff = lw_tail.maxCoeff() - lw_tail.minCoeff();
+      logger.warn(
+       std::string("In PSIS Weight Calculation: Difference "
+       "between the tails is ") +
+        std::to_string(eps_diff) +
+        " which is too small for estimating the generalized pareto values."
+        " Returning non-pareto smoothed weights.");
+    } else {
+      auto smoothed = internal::psis_smooth_tail(lw_tail, cutoff);
+      auto idx = max_n.second.tail(tail_len);
+      const Eigen::Index idx_size = idx.size();
+      for (Eigen::Index i = 0; i < idx_size; ++i) {
+        llr_weights.coeffRef(idx.coeff(i)) = smoothed.first.coeff(i);
+      }
+      result.pareto_k = smoothed.second;
+      result.tail_len = idx_size;
+      if (smoothed.second > 0.7) {
+        std::stringstream s;
+        s << "Pareto k value (" << std::setprecision(2) << smoothed.second
+          << ") is greater than 0.7. Importance resampling was not able to "
+          << "improve the approximation, which may indicate that the "
+          << "approximation itself is poor.";
+
+        logger.warn(s.str());
+      }
+    }
+  }
+
+  // truncate at max of raw wts (i.e., 0 since max has been subtracted)
+  result.log_weights = (llr_weights < 0.0).select(llr_weights, 0.0);
+  return result;
+}
+
+/**
+ * Run Pareto smoothed importance sampling (PSIS) on the specified log
+ * importance ratios with the default tail size from `psis_tail_length`.
+ *
+ * @tparam EigArray An Eigen type inheriting from `ArrayBase` with dynamic
+ * compile time rows and 1 compile time column.
+ * @tparam Logger A type derived from `stan::callbacks::logger`
+ * @param[in] log_ratios Array of logarithms of importance ratios
+ * @param[in,out] logger Stream for writing possible warnings
+ * @return The log weights along with the Pareto k diagnostic
+ */
+template <typename EigArray, typename Logger>
+inline psis_result_t psis(const EigArray& log_ratios, Logger& logger) {
+  return psis(log_ratios, psis_tail_length(log_ratios.size()), logger);
+}
+
+}  // namespace analyze
+}  // namespace stan
+
+#endif
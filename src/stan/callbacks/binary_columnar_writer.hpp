@@ -0,0 +1,289 @@
+#ifndef STAN_CALLBACKS_BINARY_COLUMNAR_WRITER_HPP
+#define STAN_CALLBACKS_BINARY_COLUMNAR_WRITER_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * Constants of the binary columnar draw format written by
+ * <code>binary_columnar_writer</code> and read by
+ * <code>io::binary_columnar_reader</code>.
+ *
+ * A file starts with a 16 byte header: the 8 byte magic string
+ * <code>"STANCOL"</code> (including its terminating null), the format
+ * version as a <code>uint32</code> and the byte order mark
+ * <code>0x01020304</code> as a <code>uint32</code>.  All integers and
+ * doubles are in the byte order of the machine that wrote the file,
+ * which readers detect from the byte order mark.
+ *
+ * The header is followed by records, each made of a 16 byte record
+ * header (the record type as a <code>uint32</code>, four reserved zero
+ * bytes and the size in bytes of the padded payload as a
+ * <code>uint64</code>) and a payload zero padded to a multiple of 8
+ * bytes, so that every record, and every array of doubles, starts at an
+ * offset that is a multiple of 8.  Readers skip records by their size,
+ * which includes the padding.  The record types are
+ *
+ * - names: the number of names as a <code>uint64</code>, followed by
+ *   each name as its length in bytes as a <code>uint64</code> and its
+ *   characters;
+ * - comment: the length of the message in bytes as a
+ *   <code>uint64</code> and its characters;
+ * - chunk: the number of draws and the number of columns as
+ *   <code>uint64</code>, followed by the values as doubles in
+ *   column-major order, so the draws of each column are contiguous.
+ *
+ * Records appear in the order the writer was called, so comments
+ * written between draws, such as the adaptation results, separate the
+ * chunks of draws before them from those after them.
+ */
+struct binary_columnar_format {
+  static constexpr char magic[8] = {'S', 'T', 'A', 'N', 'C', 'O', 'L', '\0'};
+  static constexpr uint32_t version = 1;
+  static constexpr uint32_t byte_order_mark = 0x01020304;
+  static constexpr uint32_t names_record = 1;
+  static constexpr uint32_t comment_record = 2;
+  static constexpr uint32_t chunk_record = 3;
+  static constexpr size_t header_size = 16;
+  static constexpr size_t record_header_size = 16;
+
+  /**
+   * Return the size rounded up to a multiple of 8 bytes.
+   */
+  static constexpr uint64_t padded_size(uint64_t size) {
+    return (size + 7) & ~static_cast<uint64_t>(7);
+  }
+};
+
+/**
+ * <code>binary_columnar_writer</code> is an implementation of
+ * <code>writer</code> that writes draws in the binary columnar format
+ * described in <code>binary_columnar_format</code> to a stream it
+ * holds a unique pointer to.
+ *
+ * Draws are buffered and written as chunks of up to a fixed number of
+ * draws.  A chunk is also written early when names or a comment are
+ * written or the number of values in a draw changes, so that records
+ * keep the order of the calls.  Values are stored at full precision.
+ *
+ * @tparam Stream A type with a valid
+ * <code>write(const char*, std::streamsize)</code> method, such as an
+ * <code>std::ofstream</code> opened in binary mode
+ * @tparam Deleter A class with a valid <code>operator()</code> method for
+ * deleting the output stream
+ */
+template <typename Stream, typename Deleter = std::default_delete<Stream>>
+class binary_columnar_writer final : public writer {
+ public:
+  /**
+   * Constructs a binary columnar writer with an output stream and
+   * writes the file header.
+   *
+   * @param[in, out] output A unique pointer to the output stream
+   * @param[in] chunk_size maximum number of draws in a chunk; must be
+   * positive. Default is 1024.
+   */
+  explicit binary_columnar_writer(std::unique_ptr<Stream, Deleter>&& output,
+                                  size_t chunk_size = 1024)
+      : output_(std::move(output)),
+        chunk_size_(chunk_size > 0 ? chunk_size : 1),
+        num_columns_(0),
+        num_draws_(0) {
+    if (output_ == nullptr)
+      return;
+    output_->write(binary_columnar_format::magic, 8);
+    write_uint32(binary_columnar_format::version);
+    write_uint32(binary_columnar_format::byte_order_mark);
+  }
+
+  binary_columnar_writer(binary_columnar_writer& other) = delete;
+  binary_columnar_writer(binary_columnar_writer&& other)
+      : output_(std::move(other.output_)),
+        chunk_size_(other.chunk_size_),
+        num_columns_(other.num_columns_),
+        num_draws_(other.num_draws_),
+        buffer_(std::move(other.buffer_)) {
+    other.num_draws_ = 0;
+  }
+
+  /**
+   * Writes any buffered draws.
+   */
+  virtual ~binary_columnar_writer() {
+    try {
+      write_chunk();
+    } catch (...) {
+    }
+  }
+
+  /**
+   * Writes a names record.
+   *
+   * @param[in] names Names in a std::vector
+   */
+  void operator()(const std::vector<std::string>& names) {
+    if (output_ == nullptr)
+      return;
+    write_chunk();
+    uint64_t size = 8;
+    for (const auto& name : names)
+      size += 8 + name.size();
+    write_record_header(binary_columnar_format::names_record, size);
+    write_uint64(names.size());
+    for (const auto& name : names)
+      write_string(name);
+    write_padding(size);
+  }
+
+  /**
+   * Adds a draw to the current chunk, writing the chunk once it is
+   * full.
+   *
+   * @param[in] values Values in a std::vector
+   */
+  void operator()(const std::vector<double>& values) {
+    if (output_ == nullptr || values.empty())
+      return;
+    if (values.size() != num_columns_) {
+      write_chunk();
+      num_columns_ = values.size();
+      buffer_.resize(num_columns_ * chunk_size_);
+    }
+    double* draw = buffer_.data() + num_draws_;
+    for (size_t j = 0; j < num_columns_; ++j)
+      draw[j * chunk_size_] = values[j];
+    if (++num_draws_ == chunk_size_)
+      write_chunk();
+  }
+
+  /**
+   * Writes multiple draws as a single chunk.
+   *
+   * @param[in] values A matrix of values. The input is expected to have
+   * parameters in the rows and samples in the columns.
+   */
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    if (output_ == nullptr || values.size() == 0)
+      return;
+    write_chunk();
+    Eigen::MatrixXd draws = values.transpose();
+    write_chunk_record(draws.rows(), draws.cols());
+    output_->write(reinterpret_cast<const char*>(draws.data()),
+                   draws.size() * sizeof(double));
+  }
+
+  /**
+   * Writes an empty comment record.
+   */
+  void operator()() { (*this)(std::string()); }
+
+  /**
+   * Writes a comment record.
+   *
+   * @param[in] message A string
+   */
+  void operator()(const std::string& message) {
+    if (output_ == nullptr)
+      return;
+    write_chunk();
+    uint64_t size = 8 + message.size();
+    write_record_header(binary_columnar_format::comment_record, size);
+    write_string(message);
+    write_padding(size);
+  }
+
+  /**
+   * Writes any buffered draws as a chunk.
+   */
+  void flush() { write_chunk(); }
+
+  /**
+   * Get the underlying stream
+   */
+  inline auto& get_stream() noexcept { return *output_; }
+
+ private:
+  /**
+   * Output stream
+   */
+  std::unique_ptr<Stream, Deleter> output_;
+
+  /**
+   * Maximum number of draws in a chunk
+   */
+  size_t chunk_size_;
+
+  /**
+   * Number of values in each buffered draw
+   */
+  size_t num_columns_;
+
+  /**
+   * Number of buffered draws
+   */
+  size_t num_draws_;
+
+  /**
+   * Buffered draws, stored column-major with a stride of
+   * <code>chunk_size_</code> between columns
+   */
+  std::vector<double> buffer_;
+
+  void write_uint32(uint32_t x) {
+    output_->write(reinterpret_cast<const char*>(&x), sizeof(x));
+  }
+
+  void write_uint64(uint64_t x) {
+    output_->write(reinterpret_cast<const char*>(&x), sizeof(x));
+  }
+
+  void write_string(const std::string& x) {
+    write_uint64(x.size());
+    output_->write(x.data(), x.size());
+  }
+
+  void write_padding(uint64_t size) {
+    static constexpr char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    output_->write(zeros, binary_columnar_format::padded_size(size) - size);
+  }
+
+  void write_record_header(uint32_t type, uint64_t size) {
+    write_uint32(type);
+    write_uint32(0);
+    write_uint64(binary_columnar_format::padded_size(size));
+  }
+
+  void write_chunk_record(uint64_t num_draws, uint64_t num_columns) {
+    write_record_header(binary_columnar_format::chunk_record,
+                        16 + num_draws * num_columns * sizeof(double));
+    write_uint64(num_draws);
+    write_uint64(num_columns);
+  }
+
+  /**
+   * Writes the buffered draws, if any, as a chunk.
+   */
+  void write_chunk() {
+    if (output_ == nullptr || num_draws_ == 0)
+      return;
+    write_chunk_record(num_draws_, num_columns_);
+    for (size_t j = 0; j < num_columns_; ++j)
+      output_->write(
+          reinterpret_cast<const char*>(buffer_.data() + j * chunk_size_),
+          num_draws_ * sizeof(double));
+    num_draws_ = 0;
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+
+#endif
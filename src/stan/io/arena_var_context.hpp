@@ -0,0 +1,436 @@
+#ifndef STAN_IO_ARENA_VAR_CONTEXT_HPP
+#define STAN_IO_ARENA_VAR_CONTEXT_HPP
+
+#include <stan/io/var_context.hpp>
+#include <stan/io/validate_dims.hpp>
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * An <code>arena_var_context</code> holds named arrays like an
+ * <code>array_var_context</code>, but keeps the values of all floating
+ * point variables in one contiguous array and the values of all integer
+ * variables in another, in the order of the variables, with a hash
+ * index from names to their position in the arrays.
+ *
+ * <p>The arrays can be moved in from the caller, so that constructing
+ * the context does not copy the values.  As the arrays are laid out
+ * exactly as the caller passed them, new values for variables of the
+ * same shapes can be assigned to, or swapped into, an existing context
+ * without allocating, e.g. when fitting the same model to many
+ * simulated data sets.
+ *
+ * <p>The views returned by <code>vals_r_view</code> and
+ * <code>vals_i_view</code> point into the arrays, so they see values
+ * assigned later but are invalidated by <code>swap_r</code> and
+ * <code>swap_i</code>.
+ */
+class arena_var_context : public var_context {
+ public:
+  /**
+   * Construct a context from floating point variables.
+   *
+   * @param names_r names of the variables
+   * @param values_r values of all variables, one after the other, each
+   *   in last-index-major order
+   * @param dims_r dimensions of each variable
+   * @throw std::invalid_argument if there is not one set of dimensions
+   *   per name, if the names are not unique, or if the number of values
+   *   does not match the dimensions
+   */
+  arena_var_context(std::vector<std::string> names_r,
+                    std::vector<double> values_r,
+                    std::vector<std::vector<size_t>> dims_r)
+      : values_r_(std::move(values_r)) {
+    add(names_r, dims_r, false, values_r_.size());
+  }
+
+  /**
+   * Construct a context from integer variables.
+   *
+   * @param names_i names of the variables
+   * @param values_i values of all variables, one after the other, each
+   *   in last-index-major order
+   * @param dims_i dimensions of each variable
+   * @throw std::invalid_argument if there is not one set of dimensions
+   *   per name, if the names are not unique, or if the number of values
+   *   does not match the dimensions
+   */
+  arena_var_context(std::vector<std::string> names_i,
+                    std::vector<int> values_i,
+                    std::vector<std::vector<size_t>> dims_i)
+      : values_i_(std::move(values_i)) {
+    add(names_i, dims_i, true, values_i_.size());
+  }
+
+  /**
+   * Construct a context from floating point and integer variables.
+   *
+   * @param names_r names of the floating point variables
+   * @param values_r values of all floating point variables
+   * @param dims_r dimensions of each floating point variable
+   * @param names_i names of the integer variables
+   * @param values_i values of all integer variables
+   * @param dims_i dimensions of each integer variable
+   * @throw std::invalid_argument if there is not one set of dimensions
+   *   per name, if the names are not unique, or if the number of values
+   *   does not match the dimensions
+   */
+  arena_var_context(std::vector<std::string> names_r,
+                    std::vector<double> values_r,
+                    std::vector<std::vector<size_t>> dims_r,
+                    std::vector<std::string> names_i,
+                    std::vector<int> values_i,
+                    std::vector<std::vector<size_t>> dims_i)
+      : values_r_(std::move(values_r)), values_i_(std::move(values_i)) {
+    add(names_r, dims_r, false, values_r_.size());
+    add(names_i, dims_i, true, values_i_.size());
+  }
+
+  /**
+   * Return <code>true</code> if the context contains a variable of the
+   * specified name, whether its values are integers or doubles.
+   *
+   * @param name Variable name to test.
+   * @return <code>true</code> if the variable exists.
+   */
+  bool contains_r(const std::string& name) const {
+    return find(name) != nullptr;
+  }
+
+  /**
+   * Return <code>true</code> if the context contains an integer
+   * variable of the specified name.
+   *
+   * @param name Variable name to test.
+   * @return <code>true</code> if the variable has integer values.
+   */
+  bool contains_i(const std::string& name) const {
+    const var_entry* var = find(name);
+    return var != nullptr && var->is_int;
+  }
+
+  /**
+   * Return a copy of the values of the variable as doubles, or an
+   * empty vector if there is no such variable.
+   *
+   * @param name Name of variable.
+   * @return Values of variable.
+   */
+  std::vector<double> vals_r(const std::string& name) const {
+    return vals_r_view(name).to_vector();
+  }
+
+  /**
+   * Return the complex values of the variable, whose real and imaginary
+   * parts are stored next to each other, or an empty vector if there is
+   * no such variable.
+   *
+   * @param name Name of variable.
+   * @return Complex values of variable.
+   */
+  std::vector<std::complex<double>> vals_c(const std::string& name) const {
+    var_view_r values = vals_r_view(name);
+    std::vector<std::complex<double>> vec_c(values.size() / 2);
+    for (size_t i = 0; i < vec_c.size(); ++i)
+      vec_c[i] = std::complex<double>{values[2 * i], values[2 * i + 1]};
+    return vec_c;
+  }
+
+  /**
+   * Return the dimensions of the variable, or an empty vector if there
+   * is no such variable.
+   *
+   * @param name Name of variable.
+   * @return Dimensions of variable.
+   */
+  std::vector<size_t> dims_r(const std::string& name) const {
+    const var_entry* var = find(name);
+    if (var == nullptr)
+      return std::vector<size_t>();
+    return var->dims;
+  }
+
+  /**
+   * Return a copy of the values of the integer variable, or an empty
+   * vector if there is no such integer variable.
+   *
+   * @param name Name of variable.
+   * @return Values of variable.
+   */
+  std::vector<int> vals_i(const std::string& name) const {
+    return vals_i_view(name).to_vector();
+  }
+
+  /**
+   * Return the dimensions of the integer variable, or an empty vector if
+   * there is no such integer variable.
+   *
+   * @param name Name of variable.
+   * @return Dimensions of variable.
+   */
+  std::vector<size_t> dims_i(const std::string& name) const {
+    const var_entry* var = find(name);
+    if (var == nullptr || !var->is_int)
+      return std::vector<size_t>();
+    return var->dims;
+  }
+
+  /**
+   * Return a view of the values and dimensions of the variable without
+   * copying.  Integer variables are viewed as integers.
+   *
+   * @param name Name of variable.
+   * @return View of the variable; empty if there is no such variable.
+   */
+  var_view_r vals_r_view(const std::string& name) const {
+    const var_entry* var = find(name);
+    if (var == nullptr)
+      return var_view_r();
+    if (var->is_int)
+      return var_view_r(
+          array_view<int>(values_i_.data() + var->offset, var->size),
+          var->dims);
+    return var_view_r(
+        array_view<double>(values_r_.data() + var->offset, var->size),
+        var->dims);
+  }
+
+  /**
+   * Return a view of the values and dimensions of the integer variable
+   * without copying.
+   *
+   * @param name Name of variable.
+   * @return View of the variable; empty if there is no such integer
+   * variable.
+   */
+  var_view_i vals_i_view(const std::string& name) const {
+    const var_entry* var = find(name);
+    if (var == nullptr || !var->is_int)
+      return var_view_i();
+    return var_view_i(
+        array_view<int>(values_i_.data() + var->offset, var->size),
+        var->dims);
+  }
+
+  bool has_dims(const std::string& name,
+                const array_view<size_t>& dims) const {
+    return view_has_dims(name, dims);
+  }
+
+  /**
+   * Check variable dimensions against variable declaration.
+   *
+   * @param stage stan program processing stage
+   * @param name variable name
+   * @param base_type declared stan variable type
+   * @param dims_declared variable dimensions
+   * @throw std::runtime_error if mismatch between declared
+   *        dimensions and dimensions found in context.
+   */
+  void validate_dims(const std::string& stage, const std::string& name,
+                     const std::string& base_type,
+                     const std::vector<size_t>& dims_declared) const {
+    size_t num_elts = 1;
+    for (auto& d : dims_declared)
+      num_elts *= d;
+    if (num_elts == 0)
+      return;
+    stan::io::validate_dims(*this, stage, name, base_type, dims_declared);
+  }
+
+  /**
+   * Return a list of the names of the floating point variables in the
+   * order they were passed to the constructor.
+   *
+   * @param names Vector to store the list of names in.
+   */
+  void names_r(std::vector<std::string>& names) const {
+    names.clear();
+    for (const var_entry& var : vars_)
+      if (!var.is_int)
+        names.push_back(var.name);
+  }
+
+  /**
+   * Return a list of the names of the integer variables in the order
+   * they were passed to the constructor.
+   *
+   * @param names Vector to store the list of names in.
+   */
+  void names_i(std::vector<std::string>& names) const {
+    names.clear();
+    for (const var_entry& var : vars_)
+      if (var.is_int)
+        names.push_back(var.name);
+  }
+
+  /**
+   * Return the values of all floating point variables, laid out as
+   * passed to the constructor.
+   */
+  const std::vector<double>& values_r() const { return values_r_; }
+
+  /**
+   * Return the values of all integer variables, laid out as passed to
+   * the constructor.
+   */
+  const std::vector<int>& values_i() const { return values_i_; }
+
+  /**
+   * Copy new values for all floating point variables into the context
+   * without allocating.
+   *
+   * @param values values laid out as passed to the constructor
+   * @throw std::invalid_argument if the number of values differs
+   */
+  void assign_r(const std::vector<double>& values) {
+    check_size("assign_r", values.size(), values_r_.size());
+    std::copy(values.begin(), values.end(), values_r_.begin());
+  }
+
+  /**
+   * Copy new values for all integer variables into the context without
+   * allocating.
+   *
+   * @param values values laid out as passed to the constructor
+   * @throw std::invalid_argument if the number of values differs
+   */
+  void assign_i(const std::vector<int>& values) {
+    check_size("assign_i", values.size(), values_i_.size());
+    std::copy(values.begin(), values.end(), values_i_.begin());
+  }
+
+  /**
+   * Copy new values for one floating point variable into the context
+   * without allocating.
+   *
+   * @param name name of the variable
+   * @param values values in last-index-major order
+   * @throw std::invalid_argument if there is no such floating point
+   *   variable or the number of values differs
+   */
+  void assign_r(const std::string& name, const std::vector<double>& values) {
+    const var_entry& var = find_checked("assign_r", name, false);
+    check_size("assign_r", values.size(), var.size);
+    std::copy(values.begin(), values.end(), values_r_.begin() + var.offset);
+  }
+
+  /**
+   * Copy new values for one integer variable into the context without
+   * allocating.
+   *
+   * @param name name of the variable
+   * @param values values in last-index-major order
+   * @throw std::invalid_argument if there is no such integer variable or
+   *   the number of values differs
+   */
+  void assign_i(const std::string& name, const std::vector<int>& values) {
+    const var_entry& var = find_checked("assign_i", name, true);
+    check_size("assign_i", values.size(), var.size);
+    std::copy(values.begin(), values.end(), values_i_.begin() + var.offset);
+  }
+
+  /**
+   * Exchange the values of all floating point variables with the
+   * specified array, which then holds the previous values.  Neither
+   * copies nor allocates, so callers can alternate between buffers.
+   *
+   * @param values values laid out as passed to the constructor
+   * @throw std::invalid_argument if the number of values differs
+   */
+  void swap_r(std::vector<double>& values) {
+    check_size("swap_r", values.size(), values_r_.size());
+    values_r_.swap(values);
+  }
+
+  /**
+   * Exchange the values of all integer variables with the specified
+   * array, which then holds the previous values.  Neither copies nor
+   * allocates, so callers can alternate between buffers.
+   *
+   * @param values values laid out as passed to the constructor
+   * @throw std::invalid_argument if the number of values differs
+   */
+  void swap_i(std::vector<int>& values) {
+    check_size("swap_i", values.size(), values_i_.size());
+    values_i_.swap(values);
+  }
+
+ private:
+  struct var_entry {
+    std::string name;
+    bool is_int;
+    std::vector<size_t> dims;
+    size_t offset;  // into values_r_ or values_i_
+    size_t size;
+  };
+
+  std::vector<double> values_r_;
+  std::vector<int> values_i_;
+  std::vector<var_entry> vars_;
+  std::unordered_map<std::string, size_t> index_;  // into vars_
+
+  const var_entry* find(const std::string& name) const {
+    const auto var = index_.find(name);
+    return var == index_.end() ? nullptr : &vars_[var->second];
+  }
+
+  const var_entry& find_checked(const char* function, const std::string& name,
+                                bool is_int) const {
+    const var_entry* var = find(name);
+    if (var == nullptr || var->is_int != is_int)
+      throw std::invalid_argument(std::string(function) + ": no "
+                                  + (is_int ? "integer" : "floating point")
+                                  + " variable named " + name);
+    return *var;
+  }
+
+  static void check_size(const char* function, size_t size,
+                         size_t expected) {
+    if (size != expected)
+      throw std::invalid_argument(
+          std::string(function) + ": expected " + std::to_string(expected)
+          + " values, found " + std::to_string(size));
+  }
+
+  /**
+   * Index variables whose values are laid out one after the other.
+   */
+  void add(std::vector<std::string>& names,
+           std::vector<std::vector<size_t>>& dims, bool is_int,
+           size_t num_values) {
+    if (names.size() != dims.size())
+      throw std::invalid_argument(
+          "arena_var_context: expected dimensions for "
+          + std::to_string(names.size()) + " variables, found "
+          + std::to_string(dims.size()));
+    vars_.reserve(vars_.size() + names.size());
+    index_.reserve(vars_.size() + names.size());
+    size_t offset = 0;
+    for (size_t i = 0; i < names.size(); ++i) {
+      size_t size = 1;
+      for (size_t d : dims[i])
+        size *= d;
+      if (!index_.emplace(names[i], vars_.size()).second)
+        throw std::invalid_argument("arena_var_context: duplicate variable "
+                                    + names[i]);
+      vars_.push_back(var_entry{std::move(names[i]), is_int,
+                                std::move(dims[i]), offset, size});
+      offset += size;
+    }
+    check_size("arena_var_context", num_values, offset);
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
@@ -376,6 +376,48 @@ class array_var_context : public var_context {
     return empty_vec_ui_;
   }
 
+  /**
+   * Return a view of the double values and dimensions of the variable
+   * with the specified name without copying.  Integer variables are
+   * viewed as integers.
+   *
+   * @param name Name of variable.
+   * @return View of the variable; empty if there is no such variable.
+   */
+  var_view_r vals_r_view(const std::string& name) const {
+    const auto val_r = vars_r_.find(name);
+    if (val_r != vars_r_.end()) {
+      return var_view_r(array_view<double>(val_r->second.first),
+                        val_r->second.second);
+    }
+    const auto val_i = vars_i_.find(name);
+    if (val_i != vars_i_.end()) {
+      return var_view_r(array_view<int>(val_i->second.first),
+                        val_i->second.second);
+    }
+    return var_view_r();
+  }
+
+  /**
+   * Return a view of the integer values and dimensions of the variable
+   * with the specified name without copying.
+   *
+   * @param name Name of variable.
+   * @return View of the variable; empty if there is no such variable.
+   */
+  var_view_i vals_i_view(const std::string& name) const {
+    const auto val_i = vars_i_.find(name);
+    if (val_i != vars_i_.end()) {
+      return var_view_i(val_i->second.first, val_i->second.second);
+    }
+    return var_view_i();
+  }
+
+  bool has_dims(const std::string& name,
+                const array_view<size_t>& dims) const {
+    return view_has_dims(name, dims);
+  }
+
   /**
    * Check variable dimensions against variable declaration.
    * Only used for data read in from file.
@@ -423,7 +465,7 @@ class array_var_context : public var_context {
   virtual void names_i(std::vector<std::string>& names) const {
     names.clear();
     names.reserve(vars_i_.size());
-    for (const auto& vars_i_iter : vars_r_) {
+    for (const auto& vars_i_iter : vars_i_) {
       names.push_back(vars_i_iter.first);
     }
   }
@@ -0,0 +1,312 @@
+#ifndef STAN_IO_BINARY_COLUMNAR_READER_HPP
+#define STAN_IO_BINARY_COLUMNAR_READER_HPP
+
+#include <stan/callbacks/binary_columnar_writer.hpp>
+#include <stan/io/mapped_file.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <stan/math/prim.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * Reads draws written by <code>callbacks::binary_columnar_writer</code>.
+ *
+ * Files are memory mapped and the draws are never copied unless
+ * requested: each chunk of draws is available as an
+ * <code>Eigen::Map</code> into the mapped file, with draws in rows and
+ * columns in the order of the names.  The reader can also gather single
+ * columns or all draws, and convert the file into a
+ * <code>stan_csv</code>, as <code>stan_csv_reader</code> would read the
+ * equivalent csv file, for use with <code>mcmc::chains</code>.
+ *
+ * Maps returned by the reader are valid for the lifetime of the reader.
+ */
+class binary_columnar_reader {
+ public:
+  using chunk_map = Eigen::Map<const Eigen::MatrixXd>;
+
+  /**
+   * Map the file and index its records.
+   *
+   * @param[in] filename name of the file to read
+   * @throw std::invalid_argument if the file cannot be read or is not a
+   * valid binary columnar file
+   */
+  explicit binary_columnar_reader(const std::string& filename)
+      : file_(new mapped_file(filename)),
+        data_(file_->data()),
+        size_(file_->size()) {
+    index_records();
+  }
+
+  /**
+   * Index records held in memory.  The memory is not copied and must
+   * outlive the reader.
+   *
+   * @param[in] data pointer to the start of the file contents, aligned
+   * to 8 bytes
+   * @param[in] size size of the file contents in bytes
+   * @throw std::invalid_argument if the contents are not a valid binary
+   * columnar file
+   */
+  binary_columnar_reader(const char* data, size_t size)
+      : data_(data), size_(size) {
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(double) != 0)
+      throw std::invalid_argument(
+          "Error: binary columnar data must be aligned to 8 bytes");
+    index_records();
+  }
+
+  binary_columnar_reader(const binary_columnar_reader&) = delete;
+  binary_columnar_reader& operator=(const binary_columnar_reader&) = delete;
+
+  /**
+   * Return the column names.
+   */
+  const std::vector<std::string>& names() const { return names_; }
+
+  /**
+   * Return the index of the column with the given name, or -1 if there
+   * is no such column.
+   */
+  int index(const std::string& name) const {
+    auto found = column_index_.find(name);
+    return found == column_index_.end() ? -1 : found->second;
+  }
+
+  /**
+   * Return all comments in the order they were written.
+   */
+  const std::vector<std::string>& comments() const { return comments_; }
+
+  /**
+   * Return the number of chunks of draws.
+   */
+  size_t num_chunks() const { return chunks_.size(); }
+
+  /**
+   * Return the total number of draws.
+   */
+  size_t num_draws() const { return num_draws_; }
+
+  /**
+   * Return the number of columns of the draws.
+   */
+  size_t num_columns() const {
+    return chunks_.empty() ? names_.size() : chunks_[0].num_columns;
+  }
+
+  /**
+   * Return the draws of a chunk, one draw per row, without copying.
+   *
+   * @param[in] n chunk index
+   */
+  chunk_map chunk(size_t n) const {
+    const chunk_record& c = chunks_.at(n);
+    return chunk_map(c.values, c.num_draws, c.num_columns);
+  }
+
+  /**
+   * Return the draws of a column across all chunks.
+   *
+   * @param[in] j column index
+   */
+  Eigen::VectorXd column(int j) const { return column(j, 0, chunks_.size()); }
+
+  /**
+   * Return all draws, one draw per row.
+   */
+  Eigen::MatrixXd draws() const { return draws(0, chunks_.size()); }
+
+  /**
+   * Convert the file into the contents <code>stan_csv_reader</code>
+   * reads from the equivalent csv file: metadata from the comments
+   * before the names, adaptation from the comments following the
+   * warmup draws, the draws after adaptation and the timing.
+   */
+  stan_csv parse() const {
+    stan_csv data;
+    std::stringstream metadata;
+    for (const auto& comment : metadata_comments_)
+      metadata << "#" << comment << '\n';
+    stan_csv_reader::read_metadata(metadata, data.metadata);
+    data.header = names_;
+    for (auto& name : data.header)
+      prettify_stan_csv_name(name);
+
+    std::stringstream adaptation;
+    for (const auto& comment : adaptation_comments_)
+      adaptation << "#" << comment << '\n';
+    stan_csv_reader::read_adaptation(adaptation, data.adaptation);
+
+    for (const auto& comment : comments_)
+      read_timing(comment, data.timing);
+
+    data.samples = draws(sampling_chunk_, chunks_.size());
+    if (data.metadata.method == "variational" && data.samples.rows() > 0)
+      data.samples = data.samples.bottomRows(data.samples.rows() - 1).eval();
+    return data;
+  }
+
+ private:
+  struct chunk_record {
+    const double* values;
+    size_t num_draws;
+    size_t num_columns;
+  };
+
+  std::unique_ptr<mapped_file> file_;
+  const char* data_;
+  size_t size_;
+
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, int> column_index_;
+  std::vector<std::string> comments_;
+  std::vector<std::string> metadata_comments_;
+  std::vector<std::string> adaptation_comments_;
+  std::vector<chunk_record> chunks_;
+  size_t sampling_chunk_ = 0;
+  size_t num_draws_ = 0;
+
+  template <typename T>
+  T read(size_t& pos, size_t end) const {
+    if (pos + sizeof(T) > end)
+      throw std::invalid_argument("Error: truncated binary columnar file");
+    T x;
+    std::memcpy(&x, data_ + pos, sizeof(T));
+    pos += sizeof(T);
+    return x;
+  }
+
+  std::string read_string(size_t& pos, size_t end) const {
+    uint64_t length = read<uint64_t>(pos, end);
+    if (length > end - pos)
+      throw std::invalid_argument("Error: truncated binary columnar file");
+    std::string x(data_ + pos, length);
+    pos += length;
+    return x;
+  }
+
+  /**
+   * Walk the records, recording names, comments and chunks.
+   */
+  void index_records() {
+    using format = callbacks::binary_columnar_format;
+    size_t pos = 0;
+    if (size_ < format::header_size
+        || std::memcmp(data_, format::magic, sizeof(format::magic)) != 0)
+      throw std::invalid_argument("Error: not a binary columnar file");
+    pos += sizeof(format::magic);
+    uint32_t version = read<uint32_t>(pos, size_);
+    uint32_t byte_order_mark = read<uint32_t>(pos, size_);
+    if (byte_order_mark != format::byte_order_mark)
+      throw std::invalid_argument(
+          "Error: binary columnar file was written with a different byte "
+          "order");
+    if (version != format::version)
+      throw std::invalid_argument(
+          "Error: unsupported binary columnar file version");
+
+    bool in_adaptation = false;
+    while (pos < size_) {
+      uint32_t type = read<uint32_t>(pos, size_);
+      read<uint32_t>(pos, size_);
+      uint64_t size = read<uint64_t>(pos, size_);
+      if (size > size_ - pos)
+        throw std::invalid_argument("Error: truncated binary columnar file");
+      size_t end = pos + size;
+      if (type == format::names_record) {
+        uint64_t num_names = read<uint64_t>(pos, end);
+        names_.clear();
+        column_index_.clear();
+        for (uint64_t j = 0; j < num_names; ++j) {
+          names_.push_back(read_string(pos, end));
+          column_index_.emplace(names_.back(), j);
+        }
+      } else if (type == format::comment_record) {
+        comments_.push_back(read_string(pos, end));
+        if (names_.empty()) {
+          metadata_comments_.push_back(comments_.back());
+        } else if (comments_.back().find("Adaptation terminated")
+                   != std::string::npos) {
+          in_adaptation = true;
+          adaptation_comments_.clear();
+          sampling_chunk_ = chunks_.size();
+        }
+        if (in_adaptation)
+          adaptation_comments_.push_back(comments_.back());
+      } else if (type == format::chunk_record) {
+        in_adaptation = false;
+        chunk_record c;
+        c.num_draws = read<uint64_t>(pos, end);
+        c.num_columns = read<uint64_t>(pos, end);
+        size_t max_values = (end - pos) / sizeof(double);
+        if (c.num_columns != 0 && c.num_draws > max_values / c.num_columns)
+          throw std::invalid_argument(
+              "Error: truncated binary columnar file");
+        if (!chunks_.empty() && c.num_columns != chunks_[0].num_columns)
+          throw std::invalid_argument(
+              "Error: chunks of binary columnar file have different numbers "
+              "of columns");
+        c.values = reinterpret_cast<const double*>(data_ + pos);
+        chunks_.push_back(c);
+        num_draws_ += c.num_draws;
+      }
+      pos = end;
+    }
+  }
+
+  Eigen::VectorXd column(int j, size_t begin, size_t end) const {
+    size_t rows = 0;
+    for (size_t n = begin; n < end; ++n)
+      rows += chunks_[n].num_draws;
+    Eigen::VectorXd x(rows);
+    size_t row = 0;
+    for (size_t n = begin; n < end; ++n) {
+      x.segment(row, chunks_[n].num_draws) = chunk(n).col(j);
+      row += chunks_[n].num_draws;
+    }
+    return x;
+  }
+
+  Eigen::MatrixXd draws(size_t begin, size_t end) const {
+    size_t rows = 0;
+    for (size_t n = begin; n < end; ++n)
+      rows += chunks_[n].num_draws;
+    Eigen::MatrixXd x(rows, rows > 0 ? num_columns() : 0);
+    size_t row = 0;
+    for (size_t n = begin; n < end; ++n) {
+      x.middleRows(row, chunks_[n].num_draws) = chunk(n);
+      row += chunks_[n].num_draws;
+    }
+    return x;
+  }
+
+  static void read_timing(const std::string& comment, stan_csv_timing& timing) {
+    bool warmup = comment.find("(Warm-up)") != std::string::npos;
+    if (!warmup && comment.find("(Sampling)") == std::string::npos)
+      return;
+    std::string value = comment.substr(0, comment.find(" seconds"));
+    value = value.substr(value.find_last_of(" :") + 1);
+    double seconds = std::strtod(value.c_str(), nullptr);
+    if (warmup)
+      timing.warmup += seconds;
+    else
+      timing.sampling += seconds;
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+
+#endif
@@ -0,0 +1,467 @@
+#ifndef STAN_IO_BINARY_VAR_CONTEXT_HPP
+#define STAN_IO_BINARY_VAR_CONTEXT_HPP
+
+#include <stan/io/mapped_file.hpp>
+#include <stan/io/validate_dims.hpp>
+#include <stan/io/var_context.hpp>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * Constants of the binary data format written by
+ * <code>write_binary_var_context</code> and read by
+ * <code>binary_var_context</code>.
+ *
+ * A file starts with a 24 byte header: the 8 byte magic string
+ * <code>"STANDAT"</code> (including its terminating null), the format
+ * version and the byte order mark <code>0x01020304</code> as
+ * <code>uint32</code>, and the number of variables as a
+ * <code>uint64</code>.  All integers and values are in the byte order
+ * of the machine that wrote the file, which readers detect from the
+ * byte order mark.
+ *
+ * The header is followed by an index entry for each variable: the
+ * value type and the number of dimensions as <code>uint32</code>, the
+ * number of values and the offset of the values from the start of the
+ * file as <code>uint64</code>, the length of the name in bytes as a
+ * <code>uint64</code>, the characters of the name zero padded to a
+ * multiple of 8 bytes, and the dimensions as <code>uint64</code>.
+ *
+ * The values of each variable follow the index, in last-index-major
+ * order, as 32 bit integers or doubles, each array starting at an offset
+ * that is a multiple of 8.
+ */
+struct binary_var_context_format {
+  static constexpr char magic[8] = {'S', 'T', 'A', 'N', 'D', 'A', 'T', '\0'};
+  static constexpr uint32_t version = 1;
+  static constexpr uint32_t byte_order_mark = 0x01020304;
+  static constexpr uint32_t int_type = 1;
+  static constexpr uint32_t double_type = 2;
+  static constexpr size_t header_size = 24;
+
+  /**
+   * Return the size rounded up to a multiple of 8 bytes.
+   */
+  static constexpr uint64_t padded_size(uint64_t size) {
+    return (size + 7) & ~static_cast<uint64_t>(7);
+  }
+};
+
+/**
+ * Write the variables of a <code>var_context</code>, such as a
+ * <code>json::json_data</code> or a <code>dump</code>, in the binary
+ * format read by <code>binary_var_context</code>.  Integer variables
+ * are written as integers and all others as doubles.
+ *
+ * @param[in] context variables to write
+ * @param[in,out] out stream to write to, opened in binary mode
+ */
+inline void write_binary_var_context(const var_context& context,
+                                     std::ostream& out) {
+  using format = binary_var_context_format;
+  static_assert(sizeof(int) == sizeof(int32_t),
+                "binary data files store integers as 32 bit integers");
+  struct variable {
+    std::string name;
+    var_view_r values_r;
+    var_view_i values_i;
+  };
+
+  // variables listed by both names_i and names_r are written once, as
+  // integers
+  std::vector<variable> vars;
+  std::vector<std::string> names;
+  context.names_i(names);
+  for (const auto& name : names)
+    if (context.contains_i(name))
+      vars.push_back({name, var_view_r(), context.vals_i_view(name)});
+  size_t num_int = vars.size();
+  context.names_r(names);
+  for (const auto& name : names)
+    if (!context.contains_i(name))
+      vars.push_back({name, context.vals_r_view(name), var_view_i()});
+
+  uint64_t offset = format::header_size;
+  for (const auto& var : vars) {
+    size_t num_dims = var.values_r.dims().size() + var.values_i.dims().size();
+    offset += 32 + format::padded_size(var.name.size()) + 8 * num_dims;
+  }
+
+  auto write_uint32 = [&out](uint32_t x) {
+    out.write(reinterpret_cast<const char*>(&x), sizeof(x));
+  };
+  auto write_uint64 = [&out](uint64_t x) {
+    out.write(reinterpret_cast<const char*>(&x), sizeof(x));
+  };
+  auto write_padding = [&out](uint64_t size) {
+    static constexpr char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    out.write(zeros, format::padded_size(size) - size);
+  };
+
+  out.write(format::magic, sizeof(format::magic));
+  write_uint32(format::version);
+  write_uint32(format::byte_order_mark);
+  write_uint64(vars.size());
+  for (size_t n = 0; n < vars.size(); ++n) {
+    bool is_int = n < num_int;
+    const array_view<size_t>& dims
+        = is_int ? vars[n].values_i.dims() : vars[n].values_r.dims();
+    size_t size = is_int ? vars[n].values_i.size() : vars[n].values_r.size();
+    write_uint32(is_int ? format::int_type : format::double_type);
+    write_uint32(dims.size());
+    write_uint64(size);
+    write_uint64(offset);
+    write_uint64(vars[n].name.size());
+    out.write(vars[n].name.data(), vars[n].name.size());
+    write_padding(vars[n].name.size());
+    for (size_t d : dims)
+      write_uint64(d);
+    offset += format::padded_size(size * (is_int ? 4 : 8));
+  }
+
+  for (size_t n = 0; n < vars.size(); ++n) {
+    if (n < num_int) {
+      const var_view_i& values = vars[n].values_i;
+      out.write(reinterpret_cast<const char*>(values.data()),
+                values.size() * sizeof(int32_t));
+      write_padding(values.size() * sizeof(int32_t));
+    } else {
+      const var_view_r& values = vars[n].values_r;
+      if (values.is_int()) {
+        std::vector<double> x = values.to_vector();
+        out.write(reinterpret_cast<const char*>(x.data()),
+                  x.size() * sizeof(double));
+      } else {
+        out.write(reinterpret_cast<const char*>(values.data()),
+                  values.size() * sizeof(double));
+      }
+    }
+  }
+}
+
+/**
+ * A <code>binary_var_context</code> is a <code>var_context</code>
+ * reading variables from the binary format described in
+ * <code>binary_var_context_format</code>, such as files written by
+ * <code>write_binary_var_context</code>.
+ *
+ * <p>Files are memory mapped and only their index is read on
+ * construction, so loading takes time proportional to the number of
+ * variables rather than their size, and processes reading the same
+ * file share its pages.  Values are never copied unless requested by
+ * the accessors returning vectors; the views returned by
+ * <code>vals_r_view</code> and <code>vals_i_view</code> point into the
+ * mapped file and are valid for the lifetime of the context.
+ */
+class binary_var_context : public var_context {
+ public:
+  /**
+   * Map the file and read its index.
+   *
+   * @param[in] filename name of the file to read
+   * @throw std::invalid_argument if the file cannot be read or is not a
+   * valid binary data file
+   */
+  explicit binary_var_context(const std::string& filename)
+      : file_(new mapped_file(filename)),
+        data_(file_->data()),
+        size_(file_->size()) {
+    index();
+  }
+
+  /**
+   * Read the index of a file held in memory.  The memory is not copied
+   * and must outlive the context.
+   *
+   * @param[in] data pointer to the start of the file contents, aligned
+   * to 8 bytes
+   * @param[in] size size of the file contents in bytes
+   * @throw std::invalid_argument if the contents are not a valid binary
+   * data file
+   */
+  binary_var_context(const char* data, size_t size)
+      : data_(data), size_(size) {
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(double) != 0)
+      throw std::invalid_argument(
+          "Error: binary data must be aligned to 8 bytes");
+    index();
+  }
+
+  binary_var_context(const binary_var_context&) = delete;
+  binary_var_context& operator=(const binary_var_context&) = delete;
+
+  /**
+   * Return <code>true</code> if the file contains a variable of the
+   * specified name, whether its values are integers or doubles.
+   *
+   * @param name Variable name to test.
+   * @return <code>true</code> if the variable exists.
+   */
+  bool contains_r(const std::string& name) const {
+    return vars_.find(name) != vars_.end();
+  }
+
+  /**
+   * Return <code>true</code> if the file contains an integer variable
+   * of the specified name.
+   *
+   * @param name Variable name to test.
+   * @return <code>true</code> if the variable has integer values.
+   */
+  bool contains_i(const std::string& name) const {
+    const auto var = vars_.find(name);
+    return var != vars_.end() && var->second.is_int;
+  }
+
+  /**
+   * Return a copy of the values of the variable as doubles, or an
+   * empty vector if there is no such variable.
+   *
+   * @param name Name of variable.
+   * @return Values of variable.
+   */
+  std::vector<double> vals_r(const std::string& name) const {
+    return vals_r_view(name).to_vector();
+  }
+
+  /**
+   * Return the complex values of the variable, whose last dimension
+   * holds the real and imaginary parts, or an empty vector if there is
+   * no such variable.
+   *
+   * @param name Name of variable.
+   * @return Complex values of variable.
+   */
+  std::vector<std::complex<double>> vals_c(const std::string& name) const {
+    var_view_r values = vals_r_view(name);
+    if (values.empty() || values.dims().empty())
+      return std::vector<std::complex<double>>{};
+    std::vector<std::complex<double>> vec_c(values.size() / 2);
+    size_t offset = values.size() / values.dims()[values.dims().size() - 1];
+    for (size_t i = 0; i < vec_c.size(); ++i)
+      vec_c[i] = std::complex<double>{values[i], values[i + offset]};
+    return vec_c;
+  }
+
+  /**
+   * Return the dimensions of the variable, or an empty vector if there
+   * is no such variable.
+   *
+   * @param name Name of variable.
+   * @return Dimensions of variable.
+   */
+  std::vector<size_t> dims_r(const std::string& name) const {
+    const auto var = vars_.find(name);
+    if (var == vars_.end())
+      return std::vector<size_t>();
+    return var->second.dims;
+  }
+
+  /**
+   * Return a copy of the values of the integer variable, or an empty
+   * vector if there is no such integer variable.
+   *
+   * @param name Name of variable.
+   * @return Values of variable.
+   */
+  std::vector<int> vals_i(const std::string& name) const {
+    return vals_i_view(name).to_vector();
+  }
+
+  /**
+   * Return the dimensions of the integer variable, or an empty vector if
+   * there is no such integer variable.
+   *
+   * @param name Name of variable.
+   * @return Dimensions of variable.
+   */
+  std::vector<size_t> dims_i(const std::string& name) const {
+    if (!contains_i(name))
+      return std::vector<size_t>();
+    return vars_.find(name)->second.dims;
+  }
+
+  /**
+   * Return a view of the values and dimensions of the variable in the
+   * mapped file.  Integer variables are viewed as integers.
+   *
+   * @param name Name of variable.
+   * @return View of the variable; empty if there is no such variable.
+   */
+  var_view_r vals_r_view(const std::string& name) const {
+    const auto var = vars_.find(name);
+    if (var == vars_.end())
+      return var_view_r();
+    const var_entry& entry = var->second;
+    if (entry.is_int)
+      return var_view_r(
+          array_view<int>(reinterpret_cast<const int*>(entry.values),
+                          entry.size),
+          entry.dims);
+    return var_view_r(
+        array_view<double>(reinterpret_cast<const double*>(entry.values),
+                           entry.size),
+        entry.dims);
+  }
+
+  /**
+   * Return a view of the values and dimensions of the integer variable
+   * in the mapped file.
+   *
+   * @param name Name of variable.
+   * @return View of the variable; empty if there is no such integer
+   * variable.
+   */
+  var_view_i vals_i_view(const std::string& name) const {
+    const auto var = vars_.find(name);
+    if (var == vars_.end() || !var->second.is_int)
+      return var_view_i();
+    return var_view_i(
+        array_view<int>(reinterpret_cast<const int*>(var->second.values),
+                        var->second.size),
+        var->second.dims);
+  }
+
+  bool has_dims(const std::string& name,
+                const array_view<size_t>& dims) const {
+    return view_has_dims(name, dims);
+  }
+
+  /**
+   * Return a list of the names of the variables with double values.
+   *
+   * @param names Vector to store the list of names in.
+   */
+  void names_r(std::vector<std::string>& names) const {
+    names.clear();
+    for (const auto& var : vars_)
+      if (!var.second.is_int)
+        names.push_back(var.first);
+  }
+
+  /**
+   * Return a list of the names of the variables with integer values.
+   *
+   * @param names Vector to store the list of names in.
+   */
+  void names_i(std::vector<std::string>& names) const {
+    names.clear();
+    for (const auto& var : vars_)
+      if (var.second.is_int)
+        names.push_back(var.first);
+  }
+
+  /**
+   * Check variable dimensions against variable declaration.
+   *
+   * @param stage stan program processing stage
+   * @param name variable name
+   * @param base_type declared stan variable type
+   * @param dims_declared variable dimensions
+   * @throw std::runtime_error if mismatch between declared
+   *        dimensions and dimensions found in context.
+   */
+  void validate_dims(const std::string& stage, const std::string& name,
+                     const std::string& base_type,
+                     const std::vector<size_t>& dims_declared) const {
+    size_t num_elts = 1;
+    for (auto& d : dims_declared)
+      num_elts *= d;
+    if (num_elts == 0)
+      return;
+    stan::io::validate_dims(*this, stage, name, base_type, dims_declared);
+  }
+
+ private:
+  struct var_entry {
+    bool is_int;
+    std::vector<size_t> dims;
+    const char* values;
+    size_t size;
+  };
+
+  std::unique_ptr<mapped_file> file_;
+  const char* data_;
+  size_t size_;
+  std::map<std::string, var_entry> vars_;
+
+  template <typename T>
+  T read(size_t& pos) const {
+    if (pos + sizeof(T) > size_)
+      throw std::invalid_argument("Error: truncated binary data file");
+    T x;
+    std::memcpy(&x, data_ + pos, sizeof(T));
+    pos += sizeof(T);
+    return x;
+  }
+
+  /**
+   * Read the index, checking that the values of every variable lie
+   * within the file.
+   */
+  void index() {
+    using format = binary_var_context_format;
+    size_t pos = 0;
+    if (size_ < format::header_size
+        || std::memcmp(data_, format::magic, sizeof(format::magic)) != 0)
+      throw std::invalid_argument("Error: not a binary data file");
+    pos += sizeof(format::magic);
+    uint32_t version = read<uint32_t>(pos);
+    uint32_t byte_order_mark = read<uint32_t>(pos);
+    if (byte_order_mark != format::byte_order_mark)
+      throw std::invalid_argument(
+          "Error: binary data file was written with a different byte order");
+    if (version != format::version)
+      throw std::invalid_argument("Error: unsupported binary data version");
+    uint64_t num_vars = read<uint64_t>(pos);
+
+    for (uint64_t n = 0; n < num_vars; ++n) {
+      var_entry entry;
+      uint32_t type = read<uint32_t>(pos);
+      uint32_t num_dims = read<uint32_t>(pos);
+      uint64_t size = read<uint64_t>(pos);
+      uint64_t offset = read<uint64_t>(pos);
+      uint64_t name_size = read<uint64_t>(pos);
+      if (name_size > size_ - pos)
+        throw std::invalid_argument("Error: truncated binary data file");
+      std::string name(data_ + pos, name_size);
+      pos += format::padded_size(name_size);
+      uint64_t num_values = 1;
+      for (uint32_t d = 0; d < num_dims; ++d) {
+        entry.dims.push_back(read<uint64_t>(pos));
+        num_values *= entry.dims.back();
+      }
+
+      if (type != format::int_type && type != format::double_type)
+        throw std::invalid_argument("Error: unknown type of variable " + name
+                                    + " in binary data file");
+      if (num_values != size)
+        throw std::invalid_argument("Error: size of variable " + name
+                                    + " does not match its dimensions");
+      size_t value_size = type == format::int_type ? 4 : 8;
+      if (offset % 8 != 0 || offset > size_
+          || size > (size_ - offset) / value_size)
+        throw std::invalid_argument("Error: values of variable " + name
+                                    + " lie outside the binary data file");
+      entry.is_int = type == format::int_type;
+      entry.values = data_ + offset;
+      entry.size = size;
+      vars_[name] = std::move(entry);
+    }
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+
+#endif
@@ -50,6 +50,22 @@ class chained_var_context : public var_context {
     return vc1_.contains_r(name) ? vc1_.dims_i(name) : vc2_.dims_i(name);
   }
 
+  var_view_r vals_r_view(const std::string& name) const {
+    return vc1_.contains_r(name) ? vc1_.vals_r_view(name)
+                                 : vc2_.vals_r_view(name);
+  }
+
+  var_view_i vals_i_view(const std::string& name) const {
+    return vc1_.contains_i(name) ? vc1_.vals_i_view(name)
+                                 : vc2_.vals_i_view(name);
+  }
+
+  bool has_dims(const std::string& name,
+                const array_view<size_t>& dims) const {
+    return vc1_.contains_r(name) ? vc1_.has_dims(name, dims)
+                                 : vc2_.has_dims(name, dims);
+  }
+
   void names_r(std::vector<std::string>& names) const {
     vc1_.names_r(names);
     std::vector<std::string> names2;
@@ -5,12 +5,18 @@
 #include <stan/io/validate_dims.hpp>
 #include <stan/io/var_context.hpp>
 #include <stan/math/prim.hpp>
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <limits>
 #include <map>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <cctype>
@@ -35,6 +41,10 @@ namespace io {
  * (i.e., undefined) values, because these cannot be
  * represented as <code>double</code> values.
  *
+ * <p>Input is read from the stream in large blocks and scanned from
+ * memory, so the reader may consume input past the last variable it
+ * returns.
+ *
  * <p>The dump reader class follows a standard scanner pattern.
  * The method <code>next()</code> is called to scan the next
  * input.  The type, dimensions, and values of the input is then
@@ -115,15 +125,77 @@ class dump_reader {
   std::vector<double> stack_r_;
   std::vector<size_t> dims_;
   std::istream& in_;
+  std::vector<char> chunk_;  // buffered input, chunk_[pos_, end_) unread
+  size_t pos_;
+  size_t end_;
 
-  bool scan_single_char(char c_expected) {
-    int c = in_.peek();
-    if (in_.fail())
+  static constexpr size_t chunk_size_ = 1 << 16;
+
+  /**
+   * Make at least <code>n</code> unread characters available in the
+   * buffer, reading further input if needed.  Returns
+   * <code>false</code> if the input ends first.
+   */
+  bool fill(size_t n) {
+    if (end_ - pos_ >= n)
+      return true;
+    if (!in_)
       return false;
-    if (c != c_expected)
+    std::copy(chunk_.begin() + pos_, chunk_.begin() + end_, chunk_.begin());
+    end_ -= pos_;
+    pos_ = 0;
+    if (chunk_.size() < std::max(n, chunk_size_))
+      chunk_.resize(std::max(n, chunk_size_));
+    while (end_ < n && in_) {
+      in_.read(chunk_.data() + end_, chunk_.size() - end_);
+      end_ += in_.gcount();
+    }
+    return end_ >= n;
+  }
+
+  bool get(char& c) {
+    if (pos_ == end_ && !fill(1))
+      return false;
+    c = chunk_[pos_++];
+    return true;
+  }
+
+  // only valid directly after a successful get()
+  void unget() { --pos_; }
+
+  int peek() {
+    if (pos_ == end_ && !fill(1))
+      return std::char_traits<char>::eof();
+    return static_cast<unsigned char>(chunk_[pos_]);
+  }
+
+  void skip_space() {
+    while ((pos_ != end_ || fill(1))
+           && std::isspace(static_cast<unsigned char>(chunk_[pos_])))
+      ++pos_;
+  }
+
+  static bool is_number_char(char c) {
+    return std::isdigit(c) || c == '.' || c == 'e' || c == 'E' || c == '-'
+           || c == '+';
+  }
+
+  /**
+   * Return the number of characters of the number starting at the
+   * current position, buffering all of them.
+   */
+  size_t scan_number_length() {
+    size_t n = 0;
+    while ((pos_ + n != end_ || fill(n + 1))
+           && is_number_char(chunk_[pos_ + n]))
+      ++n;
+    return n;
+  }
+
+  bool scan_single_char(char c_expected) {
+    if (peek() != c_expected)
       return false;
-    char c_skip;
-    in_.get(c_skip);
+    ++pos_;
     return true;
   }
 
@@ -137,30 +209,23 @@ class dump_reader {
   }
 
   bool scan_char(char c_expected) {
-    char c;
-    in_ >> c;
-    if (in_.fail())
-      return false;
-    if (c != c_expected) {
-      in_.putback(c);
-      return false;
-    }
-    return true;
+    skip_space();
+    return scan_single_char(c_expected);
   }
 
   bool scan_name_unquoted() {
     char c;
-    in_ >> c;
-    if (in_.fail())
+    skip_space();
+    if (!get(c))
       return false;
     if (!std::isalpha(c))
       return false;
     name_.push_back(c);
-    while (in_.get(c)) {  // get turns off auto space skip
+    while (get(c)) {
       if (std::isalpha(c) || std::isdigit(c) || c == '_' || c == '.') {
         name_.push_back(c);
       } else {
-        in_.putback(c);
+        unget();
         return true;
       }
     }
@@ -186,55 +251,31 @@ class dump_reader {
   }
 
   bool scan_chars(const char* s, bool case_sensitive = true) {
-    for (size_t i = 0; s[i]; ++i) {
-      char c;
-      if (!(in_ >> c)) {
-        for (size_t j = 1; j < i; ++j)
-          in_.putback(s[i - j]);
-        return false;
-      }
-      // all ASCII, so toupper is OK
-      if ((case_sensitive && c != s[i])
-          || (!case_sensitive && ::toupper(c) != ::toupper(s[i]))) {
-        in_.putback(c);
-        for (size_t j = 1; j < i; ++j)
-          in_.putback(s[i - j]);
-        return false;
-      }
-    }
-    return true;
-  }
-
-  bool scan_chars(std::string s, bool case_sensitive = true) {
-    for (size_t i = 0; i < s.size(); ++i) {
-      char c;
-      if (!(in_ >> c)) {
-        for (size_t j = 1; j < i; ++j)
-          in_.putback(s[i - j]);
-        return false;
-      }
+    size_t size = std::strlen(s);
+    skip_space();
+    if (!fill(size))
+      return false;
+    for (size_t i = 0; i < size; ++i) {
+      char c = chunk_[pos_ + i];
       // all ASCII, so toupper is OK
       if ((case_sensitive && c != s[i])
-          || (!case_sensitive && ::toupper(c) != ::toupper(s[i]))) {
-        in_.putback(c);
-        for (size_t j = 1; j < i; ++j)
-          in_.putback(s[i - j]);
+          || (!case_sensitive && ::toupper(c) != ::toupper(s[i])))
         return false;
-      }
     }
+    pos_ += size;
     return true;
   }
 
   size_t scan_dim() {
     char c;
     buf_.clear();
-    while (in_.get(c)) {
+    while (get(c)) {
       if (std::isspace(c))
         continue;
       if (std::isdigit(c)) {
         buf_.push_back(c);
       } else {
-        in_.putback(c);
+        unget();
         break;
       }
     }
@@ -252,40 +293,55 @@ class dump_reader {
   int scan_int() {
     char c;
     buf_.clear();
-    while (in_.get(c)) {
+    while (get(c)) {
       if (std::isspace(c))
         continue;
       if (std::isdigit(c)) {
         buf_.push_back(c);
       } else {
-        in_.putback(c);
+        unget();
         break;
       }
     }
-    return (get_int());
-  }
-
-  int get_int() {
-    int n = 0;
-    try {
-      n = std::stol(buf_);
-    } catch (const std::logic_error& e) {
-      std::string msg = "value " + buf_ + " beyond int range";
+    return get_int(buf_.data(), buf_.data() + buf_.size(), false);
+  }
+
+  int get_int(const char* begin, const char* end, bool negate_val) {
+    long long n = 0;  // NOLINT(runtime/int)
+    auto result = std::from_chars(begin, end, n);
+    if (negate_val)
+      n = -n;
+    if (result.ec != std::errc() || result.ptr != end
+        || n < std::numeric_limits<int>::min()
+        || n > std::numeric_limits<int>::max()) {
+      std::string msg
+          = "value " + std::string(begin, end) + " beyond int range";
       throw std::invalid_argument(msg);
     }
     return n;
   }
 
-  double scan_double() {
+  double scan_double(const char* begin, const char* end) {
+    std::string_view token(begin, end - begin);
     double x = 0;
+#if defined(__cpp_lib_to_chars)
+    if (begin != end && *begin == '+')  // from_chars doesn't skip a '+'
+      ++begin;
+    if (std::from_chars(begin, end, x).ec != std::errc()) {
+      std::string msg = "value " + std::string(token) + " beyond numeric range";
+      throw std::invalid_argument(msg);
+    }
+#else
+    buf_.assign(begin, end);
     try {
       x = std::stod(buf_);
-      if (x == 0)
-        validate_zero_buf(buf_);
     } catch (const std::logic_error& e) {
       std::string msg = "value " + buf_ + " beyond numeric range";
       throw std::invalid_argument(msg);
     }
+#endif
+    if (x == 0)
+      validate_zero_buf(token);
     return x;
   }
 
@@ -303,42 +359,29 @@ class dump_reader {
       return;
     }
 
-    char c;
-    bool is_double = false;
-    buf_.clear();
-    while (in_.get(c)) {
-      if (std::isdigit(c)) {  // before pre-scan || c == '-' || c == '+') {
-        buf_.push_back(c);
-      } else if (c == '.' || c == 'e' || c == 'E' || c == '-' || c == '+') {
-        is_double = true;
-        buf_.push_back(c);
-      } else {
-        in_.putback(c);
-        break;
-      }
-    }
+    size_t length = scan_number_length();
+    const char* begin = chunk_.data() + pos_;
+    const char* end = begin + length;
+    bool is_double
+        = std::find_if(begin, end, [](char c) { return !std::isdigit(c); })
+          != end;
+    pos_ += length;
     if (!is_double && stack_r_.size() == 0) {
-      int n = get_int();
-      stack_i_.push_back(negate_val ? -n : n);
+      stack_i_.push_back(get_int(begin, end, negate_val));
       scan_optional_long();
     } else {
-      for (size_t j = 0; j < stack_i_.size(); ++j)
-        stack_r_.push_back(static_cast<double>(stack_i_[j]));
-      stack_i_.clear();
-      double x = scan_double();
+      if (!stack_i_.empty()) {
+        stack_r_.assign(stack_i_.begin(), stack_i_.end());
+        stack_i_.clear();
+      }
+      double x = scan_double(begin, end);
       stack_r_.push_back(negate_val ? -x : x);
     }
   }
 
   void scan_number() {
-    char c;
-    while (in_.get(c)) {
-      if (std::isspace(c))
-        continue;
-      in_.putback(c);
-      break;
-    }
-    bool negate_val = scan_char('-');
+    skip_space();
+    bool negate_val = scan_single_char('-');
     if (!negate_val)
       scan_char('+');  // flush leading +
     return scan_number(negate_val);
@@ -354,9 +397,7 @@ class dump_reader {
     int s = scan_int();
     if (s < 0)
       return false;
-    for (int i = 0; i < s; ++i) {
-      stack_i_.push_back(0);
-    }
+    stack_i_.assign(s, 0);
     if (!scan_char(')'))
       return false;
     dims_.push_back(s);
@@ -373,15 +414,30 @@ class dump_reader {
     int s = scan_int();
     if (s < 0)
       return false;
-    for (int i = 0; i < s; ++i) {
-      stack_r_.push_back(0);
-    }
+    stack_r_.assign(s, 0);
     if (!scan_char(')'))
       return false;
     dims_.push_back(s);
     return true;
   }
 
+  /**
+   * Reserve space for the values of a sequence if all of it is already
+   * buffered, in which case its size is one more than its number of
+   * commas.  Both stacks are reserved as the type of the values is not
+   * known yet.
+   */
+  void reserve_seq_values() {
+    const char* begin = chunk_.data() + pos_;
+    const char* close
+        = static_cast<const char*>(std::memchr(begin, ')', end_ - pos_));
+    if (close != nullptr) {
+      size_t size = std::count(begin, close, ',') + 1;
+      stack_i_.reserve(size);
+      stack_r_.reserve(size);
+    }
+  }
+
   bool scan_seq_value() {
     if (!scan_char('('))
       return false;
@@ -389,6 +445,7 @@ class dump_reader {
       dims_.push_back(0U);
       return true;
     }
+    reserve_seq_values();
     scan_number();  // first entry
     while (scan_char(',')) {
       scan_number();
@@ -397,6 +454,17 @@ class dump_reader {
     return scan_char(')');
   }
 
+  void push_range(int start, int end) {
+    stack_i_.reserve(std::abs(int64_t{end} - start) + 1);
+    if (start <= end) {
+      for (int i = start; i <= end; ++i)
+        stack_i_.push_back(i);
+    } else {
+      for (int i = start; i >= end; --i)
+        stack_i_.push_back(i);
+    }
+  }
+
   bool scan_struct_value() {
     if (!scan_char('('))
       return false;
@@ -411,13 +479,7 @@ class dump_reader {
       if (!scan_char(':'))
         return false;
       int end = scan_int();
-      if (start <= end) {
-        for (int i = start; i <= end; ++i)
-          stack_i_.push_back(i);
-      } else {
-        for (int i = start; i >= end; --i)
-          stack_i_.push_back(i);
-      }
+      push_range(start, end);
     }
     dims_.clear();
     if (!scan_char(','))
@@ -477,13 +539,7 @@ class dump_reader {
     int start = stack_i_[0];
     int end = stack_i_[1];
     stack_i_.clear();
-    if (start <= end) {
-      for (int i = start; i <= end; ++i)
-        stack_i_.push_back(i);
-    } else {
-      for (int i = start; i >= end; --i)
-        stack_i_.push_back(i);
-    }
+    push_range(start, end);
     dims_.push_back(stack_i_.size());
     return true;
   }
@@ -494,7 +550,7 @@ class dump_reader {
    *
    * @param in Input stream reference from which to read.
    */
-  explicit dump_reader(std::istream& in) : in_(in) {}
+  explicit dump_reader(std::istream& in) : in_(in), pos_(0), end_(0) {}
 
   /**
    * Destroy this reader.
@@ -545,6 +601,22 @@ class dump_reader {
    */
   std::vector<double> double_values() { return stack_r_; }
 
+  /**
+   * Returns the integer values from the last item, moving them out
+   * of the reader rather than copying them.
+   *
+   * @return Integer values of last item.
+   */
+  std::vector<int> release_int_values() { return std::move(stack_i_); }
+
+  /**
+   * Returns the floating point values from the last item, moving them
+   * out of the reader rather than copying them.
+   *
+   * @return Floating point values of last item.
+   */
+  std::vector<double> release_double_values() { return std::move(stack_r_); }
+
   /**
    * Read the next value from the input stream, returning
    * <code>true</code> if successful and <code>false</code> if no
@@ -629,12 +701,12 @@ class dump : public stan::io::var_context {
       if (reader.is_int()) {
         vars_i_[reader.name()]
             = std::pair<std::vector<int>, std::vector<size_t>>(
-                reader.int_values(), reader.dims());
+                reader.release_int_values(), reader.dims());
 
       } else {
         vars_r_[reader.name()]
             = std::pair<std::vector<double>, std::vector<size_t>>(
-                reader.double_values(), reader.dims());
+                reader.release_double_values(), reader.dims());
       }
     }
   }
@@ -759,6 +831,48 @@ class dump : public stan::io::var_context {
     return empty_vec_ui_;
   }
 
+  /**
+   * Return a view of the double values and dimensions of the variable
+   * with the specified name without copying.  Integer variables are
+   * viewed as integers.
+   *
+   * @param name Name of variable.
+   * @return View of the variable; empty if there is no such variable.
+   */
+  var_view_r vals_r_view(const std::string& name) const {
+    const auto val_r = vars_r_.find(name);
+    if (val_r != vars_r_.end()) {
+      return var_view_r(array_view<double>(val_r->second.first),
+                        val_r->second.second);
+    }
+    const auto val_i = vars_i_.find(name);
+    if (val_i != vars_i_.end()) {
+      return var_view_r(array_view<int>(val_i->second.first),
+                        val_i->second.second);
+    }
+    return var_view_r();
+  }
+
+  /**
+   * Return a view of the integer values and dimensions of the variable
+   * with the specified name without copying.
+   *
+   * @param name Name of variable.
+   * @return View of the variable; empty if there is no such variable.
+   */
+  var_view_i vals_i_view(const std::string& name) const {
+    const auto val_i = vars_i_.find(name);
+    if (val_i != vars_i_.end()) {
+      return var_view_i(val_i->second.first, val_i->second.second);
+    }
+    return var_view_i();
+  }
+
+  bool has_dims(const std::string& name,
+                const array_view<size_t>& dims) const {
+    return view_has_dims(name, dims);
+  }
+
   /**
    * Return a list of the names of the floating point variables in
    * the dump.
@@ -83,6 +83,26 @@ class empty_var_context : public var_context {
     return std::vector<size_t>();
   }
 
+  /**
+   * Returns an empty view.
+   *
+   * @param name Name of variable.
+   * @return empty view
+   */
+  var_view_r vals_r_view(const std::string& name) const {
+    return var_view_r();
+  }
+
+  /**
+   * Returns an empty view.
+   *
+   * @param name Name of variable.
+   * @return empty view
+   */
+  var_view_i vals_i_view(const std::string& name) const {
+    return var_view_i();
+  }
+
   /**
    * Check variable dimensions against variable declaration.
    * This context has no variables.
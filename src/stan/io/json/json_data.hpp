@@ -203,6 +203,49 @@ class json_data : public stan::io::var_context {
     return empty_vec_ui_;
   }
 
+  /**
+   * Return a view of the double values and dimensions of the variable
+   * with the specified name without copying.  Integer variables are
+   * viewed as integers.
+   *
+   * @param name Name of variable.
+   * @return View of the variable; empty if there is no such variable.
+   */
+  stan::io::var_view_r vals_r_view(const std::string &name) const {
+    const auto val_r = vars_r_.find(name);
+    if (val_r != vars_r_.end()) {
+      return stan::io::var_view_r(
+          stan::io::array_view<double>(val_r->second.first),
+          val_r->second.second);
+    }
+    const auto val_i = vars_i_.find(name);
+    if (val_i != vars_i_.end()) {
+      return stan::io::var_view_r(
+          stan::io::array_view<int>(val_i->second.first), val_i->second.second);
+    }
+    return stan::io::var_view_r();
+  }
+
+  /**
+   * Return a view of the integer values and dimensions of the variable
+   * with the specified name without copying.
+   *
+   * @param name Name of variable.
+   * @return View of the variable; empty if there is no such variable.
+   */
+  stan::io::var_view_i vals_i_view(const std::string &name) const {
+    const auto val_i = vars_i_.find(name);
+    if (val_i != vars_i_.end()) {
+      return stan::io::var_view_i(val_i->second.first, val_i->second.second);
+    }
+    return stan::io::var_view_i();
+  }
+
+  bool has_dims(const std::string &name,
+                const stan::io::array_view<size_t> &dims) const {
+    return view_has_dims(name, dims);
+  }
+
   /**
    * Return a list of the names of the floating point variables in
    * the json_data.
@@ -13,6 +13,7 @@
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <boost/algorithm/string.hpp>
@@ -82,6 +83,39 @@ class tuple_slots {
   tuple_slots() : slots(0), slots_acc(0), is_first(true) {}
 };
 
+/** State of a variable or tuple slot.  Slots are interned the first
+ *  time their key is seen, so that later events for the slot are
+ *  handled without building or looking up its dotted name.
+ */
+class slot_state {
+ public:
+  std::string name;  // dotted name, e.g. "x.2.1"
+  size_t parent;     // enclosing slot, max size_t for variables
+  int type;          // meta_type
+  bool is_int;       // all values seen so far are ints
+  bool has_dims;
+  array_dims dims;
+  bool has_tuple_slots;
+  tuple_slots tuple;
+  int var_type;    // meta_type when saved to vars_r or vars_i, else -1
+  var_r* value_r;  // entry in vars_r, if any
+  var_i* value_i;  // entry in vars_i, if any
+  std::unordered_map<std::string, size_t> children;
+  slot_state(const std::string& a_name, size_t a_parent)
+      : name(a_name),
+        parent(a_parent),
+        type(meta_type::SCALAR),
+        is_int(true),
+        has_dims(false),
+        dims(),
+        has_tuple_slots(false),
+        tuple(),
+        var_type(-1),
+        value_r(nullptr),
+        value_i(nullptr),
+        children() {}
+};
+
 /**
  * A <code>json_data_handler</code> is an implementation of a
  * <code>json_handler</code> that restricts the allowed JSON text
@@ -109,33 +143,32 @@ class tuple_slots {
  * likewise, in the JSON object, only the innermost elements will be
  * int or real values. For arrays of tuples, the handler needs to track
  * both the array dimension and whether or not the values found so far
- * are of type real or int.  To do this, the handler uses a series of
- * maps between tuple slots seen so far and the C++ storage type (int or real),
- * the variable meta-type (array, tuple, or array of tuples).
+ * are of type real or int.  To do this, the handler interns each tuple
+ * slot seen so far and records its C++ storage type (int or real) and
+ * its meta-type (array, tuple, or array of tuples).
  * For arrays of tuples, we need to ensure that all tuple elements of an array
  * are of the same shape.  To do this we track the number of slots in the tuple
  * as well as the dimensions of any array slots in the tuple.
  *
  * If the top-level object entry key is not a legal Stan variable name
  * the handler will not check the corresponding value, other than maintining
- * the event state and key_stack.
+ * the event state and slot_stack.
  */
 class json_data_handler : public stan::json::json_handler {
  private:
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
   vars_map_r& vars_r;
   vars_map_i& vars_i;
-  std::vector<std::string> key_stack;
-  std::map<std::string, int> var_types_map;   // vars_r and vars_i entries
-  std::map<std::string, int> slot_types_map;  // all slots all vars parsed
-  std::map<std::string, array_dims> slot_dims_map;
-  std::map<std::string, tuple_slots> tuple_slots_map;
-  std::map<std::string, bool> int_slots_map;
-  std::vector<double> values_r;  // accumulates real var values
-  std::vector<int> values_i;     // accumulates int var values
-  size_t array_start_i;          // index into values_i
-  size_t array_start_r;          // index into values_r
-  int event;                     // tracks most recent meta_event
-  bool not_stan_var;             // accept non-Stan entries
+  std::vector<slot_state> slots;  // all slots all vars parsed
+  std::unordered_map<std::string, size_t> var_slots;  // top-level slots
+  std::vector<size_t> slot_stack;  // npos for entries not Stan variables
+  std::vector<double> values_r;    // accumulates real var values
+  std::vector<int> values_i;       // accumulates int var values
+  size_t array_start_i;            // index into values_i
+  size_t array_start_r;            // index into values_r
+  int event;                       // tracks most recent meta_event
+  bool not_stan_var;               // accept non-Stan entries
 
   void reset_values() {
     // Once var values have been copied into var_context maps,
@@ -146,27 +179,10 @@ class json_data_handler : public stan::json::json_handler {
     array_start_r = 0;
   }
 
-  inline std::string key_str() {
-    return boost::algorithm::join(key_stack, ".");
-  }
+  /** The slot of the current key.  */
+  inline slot_state& slot() { return slots[slot_stack.back()]; }
 
-  std::string outer_key_str() {
-    std::string result;
-    if (key_stack.size() > 1) {
-      std::string slot = key_stack.back();
-      key_stack.pop_back();
-      result = key_str();
-      key_stack.push_back(slot);
-    }
-    return result;
-  }
-
-  bool is_init() {
-    return (key_stack.empty() && var_types_map.empty() && slot_types_map.empty()
-            && values_r.empty() && values_i.empty() && slot_dims_map.empty()
-            && array_start_i == 0 && array_start_r == 0
-            && int_slots_map.empty());
-  }
+  inline const std::string& key_str() { return slot().name; }
 
   /** Stan variable names must start with a letter
    *  and contain only letters, numbers, or an underscore.
@@ -176,55 +192,37 @@ class json_data_handler : public stan::json::json_handler {
     return boost::regex_match(name, re);
   }
 
-  bool is_array_tuples(const std::vector<std::string>& keys) {
-    std::vector<std::string> stack(keys);
-    std::string key;
-    stack.pop_back();
-    while (!stack.empty()) {
-      key = boost::algorithm::join(stack, ".");
-      if (slot_types_map[key] == meta_type::ARRAY_OF_TUPLES)
-        return true;
-      stack.pop_back();
-    }
-    return false;
-  }
-
-  array_dims get_outer_dims(const std::vector<std::string>& keys) {
-    std::vector<std::string> stack(keys);
-    std::string key;
-    stack.pop_back();
-    while (!stack.empty()) {
-      key = boost::algorithm::join(stack, ".");
-      if (slot_dims_map.count(key) == 1)
-        return slot_dims_map[key];
-      stack.pop_back();
-    }
-    key = boost::algorithm::join(keys, ".");
-    if (slot_dims_map.count(key) != 1)
-      unexpected_error(key, "not an array");
-    return slot_dims_map[key];
+  /** Return the id of the slot for the key within the enclosing slot,
+   *  interning it if it has not been seen before.
+   */
+  size_t intern_slot(size_t parent, const std::string& key) {
+    auto& children = parent == npos ? var_slots : slots[parent].children;
+    auto found = children.find(key);
+    if (found != children.end())
+      return found->second;
+    size_t id = slots.size();
+    children.emplace(key, id);
+    if (parent == npos)
+      slots.emplace_back(key, parent);
+    else
+      slots.emplace_back(slots[parent].name + "." + key, parent);
+    return id;
   }
 
-  void set_outer_dims(array_dims update) {
-    std::vector<std::string> stack = key_stack;
-    std::string key;
-    stack.pop_back();
-    while (!stack.empty()) {
-      key = boost::algorithm::join(stack, ".");
-      if (slot_dims_map.count(key) == 1)
-        break;
-      stack.pop_back();
-    }
-    if (stack.empty()) {
-      key = boost::algorithm::join(key_stack, ".");
-      unexpected_error(key, "ill-formed array");
-    }
-    slot_dims_map[key] = update;
+  /** Return the id of the innermost enclosing slot of an array of tuples
+   *  slot which holds array dimensions, or npos if there is none.
+   */
+  size_t outer_dims_slot(size_t id) {
+    for (size_t s = slots[id].parent; s != npos; s = slots[s].parent)
+      if (slots[s].has_dims)
+        return s;
+    return npos;
   }
 
   void promote_to_double() {
-    if (int_slots_map[key_str()]) {
-      int_slots_map[key_str()] = false;
+    slot_state& s = slot();
+    if (s.is_int) {
+      s.is_int = false;
       values_r.reserve(values_i.size());
       values_r.insert(values_r.end(), values_i.begin(), values_i.end());
       array_start_r = array_start_i;
@@ -239,153 +237,126 @@ class json_data_handler : public stan::json::json_handler {
    * with previous tuple elements.
    */
   void save_key_value_pair() {
-    if (key_stack.empty())
+    if (slot_stack.empty())
       return;
     if (not_stan_var) {
-      key_stack.pop_back();
+      slot_stack.pop_back();
       return;
     }
-    std::string key = key_str();
-    if (slot_types_map.count(key) < 1)
-      unexpected_error(key, "unknown variable");
-    if (slot_types_map[key] == meta_type::SCALAR
-        || slot_types_map[key] == meta_type::ARRAY) {
-      bool is_new = (vars_r.count(key) == 0 && vars_i.count(key) == 0);
-      bool is_int = int_slots_map[key];
-      bool is_real = vars_r.count(key) == 1;
-      bool was_int = !is_int && vars_i.count(key) == 1;
+    slot_state& s = slot();
+    const std::string& key = s.name;
+    if (s.type == meta_type::SCALAR || s.type == meta_type::ARRAY) {
+      bool is_new = (s.value_r == nullptr && s.value_i == nullptr);
+      bool is_int = s.is_int;
+      bool was_int = !is_int && s.value_i != nullptr;
       std::vector<size_t> dims;
-      if (slot_dims_map.count(key) == 1)
-        dims = slot_dims_map[key].dims;
+      if (s.has_dims)
+        dims = s.dims.dims;
       if (dims.size() > 1) {
         if (is_int) {
           std::vector<int> cm_values_i(values_i.size());
           to_column_major(key, cm_values_i, values_i, dims);
-          values_i.assign(cm_values_i.begin(), cm_values_i.end());
+          values_i.swap(cm_values_i);
         } else {
           std::vector<double> cm_values_r(values_r.size());
           to_column_major(key, cm_values_r, values_r, dims);
-          values_r.assign(cm_values_r.begin(), cm_values_r.end());
+          values_r.swap(cm_values_r);
         }
       }
       if (is_new) {
-        var_types_map[key] = slot_types_map[key];
+        s.var_type = s.type;
         if (is_int) {
-          std::pair<std::vector<int>, std::vector<size_t>> pair;
-          pair = make_pair(values_i, dims);
-          vars_i[key] = pair;
+          s.value_i = &vars_i[key];
+          *s.value_i = make_pair(std::move(values_i), dims);
+          values_i.clear();
         } else {
-          std::pair<std::vector<double>, std::vector<size_t>> pair;
-          pair = make_pair(values_r, dims);
-          vars_r[key] = pair;
+          s.value_r = &vars_r[key];
+          *s.value_r = make_pair(std::move(values_r), dims);
+          values_r.clear();
         }
       } else {
         bool is_aot = false;
-        std::string vname;
-        for (auto& key : key_stack) {
-          vname.append(key);
-          if (slot_types_map[vname] == meta_type::ARRAY_OF_TUPLES) {
+        for (size_t id = slot_stack.back(); id != npos; id = slots[id].parent) {
+          if (slots[id].type == meta_type::ARRAY_OF_TUPLES) {
             is_aot = true;
             break;
           }
-          vname.append(".");
         }
         if (!is_aot)
           unexpected_error(key, "not array of tuples");
-        bool consistent = true;
-        if (is_int || was_int) {
-          auto expect_dims = vars_i[key].second;
-          size_t expect_vals_len = 1;
-          for (auto& x : expect_dims)
-            expect_vals_len *= x;
-          if (is_int) {
-            if (expect_vals_len != values_i.size())
-              consistent = false;
-          } else {
-            if (expect_vals_len != values_r.size())
-              consistent = false;
-          }
-        } else {
-          auto expect_dims = vars_r[key].second;
-          size_t expect_vals_len = 1;
-          for (auto& x : expect_dims)
-            expect_vals_len *= x;
-          if (expect_vals_len != values_r.size())
-            consistent = false;
-        }
-        if (!consistent) {
+        const std::vector<size_t>& expect_dims
+            = s.value_i != nullptr ? s.value_i->second : s.value_r->second;
+        size_t expect_vals_len = 1;
+        for (auto& x : expect_dims)
+          expect_vals_len *= x;
+        if (expect_vals_len != (is_int ? values_i.size() : values_r.size())) {
           std::stringstream errorMsg;
           errorMsg << "Variable " << key
                    << ": size mismatch between tuple elements.";
           throw json_error(errorMsg.str());
         }
-        var_types_map[key] = meta_type::ARRAY;
-        if ((!is_int && was_int) || (is_int && is_real)) {  // promote to double
+        s.var_type = meta_type::ARRAY;
+        if (was_int) {  // promote to double
           std::vector<double> values_tmp;
-          for (auto& x : vars_i[key].first) {
-            values_tmp.push_back(x);
-          }
-          for (auto& x : values_r)
-            values_tmp.push_back(x);
-          std::pair<std::vector<double>, std::vector<size_t>> pair;
-          pair = make_pair(values_tmp, dims);
-          vars_r[key] = pair;
+          values_tmp.reserve(s.value_i->first.size() + values_r.size());
+          values_tmp.insert(values_tmp.end(), s.value_i->first.begin(),
+                            s.value_i->first.end());
+          values_tmp.insert(values_tmp.end(), values_r.begin(),
+                            values_r.end());
+          s.value_r = &vars_r[key];
+          *s.value_r = make_pair(std::move(values_tmp), dims);
           vars_i.erase(key);
+          s.value_i = nullptr;
         } else if (is_int) {
-          for (auto& x : values_i)
-            vars_i[key].first.push_back(x);
-          vars_i[key].second = dims;
+          s.value_i->first.insert(s.value_i->first.end(), values_i.begin(),
+                                  values_i.end());
+          s.value_i->second = dims;
         } else {
-          for (auto& x : values_r)
-            vars_r[key].first.push_back(x);
-          vars_r[key].second = dims;
+          s.value_r->first.insert(s.value_r->first.end(), values_r.begin(),
+                                  values_r.end());
+          s.value_r->second = dims;
         }
       }
     }
-    key_stack.pop_back();
+    slot_stack.pop_back();
   }
 
   /* For array of tuples, concatenate dimensions
    * Update vars_i and vars_r dimensions accordingly.
    */
   void update_array_dims() {
-    for (auto const& var : var_types_map) {
-      if (var.second != meta_type::ARRAY) {
+    std::vector<size_t> path;
+    for (size_t id = 0; id < slots.size(); ++id) {
+      slot_state& var = slots[id];
+      if (var.var_type != meta_type::ARRAY) {
         continue;
       }
+      path.clear();
+      for (size_t s = id; s != npos; s = slots[s].parent)
+        path.push_back(s);
       std::vector<size_t> all_dims;
-      std::vector<std::string> slots;
-      split(slots, var.first, boost::is_any_of("."), boost::token_compress_on);
-      std::string slot;
-      for (size_t i = 0; i < slots.size(); ++i) {
-        slot.append(slots[i]);
-        if (slot_dims_map.count(slot) == 1
-            && !slot_dims_map[slot].dims.empty()) {
-          for (auto& x : slot_dims_map[slot].dims)
-            all_dims.push_back(x);
-        }
-        slot.append(".");
+      for (auto s = path.rbegin(); s != path.rend(); ++s) {
+        const slot_state& slot = slots[*s];
+        if (slot.has_dims)
+          all_dims.insert(all_dims.end(), slot.dims.dims.begin(),
+                          slot.dims.dims.end());
       }
-      if (vars_i.count(var.first) == 1) {
-        if (all_dims.size() == vars_i[var.first].second.size())
-          continue;
-        else
-          vars_i[var.first].second.assign(all_dims.begin(), all_dims.end());
-      } else if (vars_r.count(var.first) == 1) {
-        if (all_dims.size() == vars_r[var.first].second.size())
-          continue;
-        else
-          vars_r[var.first].second.assign(all_dims.begin(), all_dims.end());
+      if (var.value_i != nullptr) {
+        if (all_dims.size() != var.value_i->second.size())
+          var.value_i->second = all_dims;
+      } else if (var.value_r != nullptr) {
+        if (all_dims.size() != var.value_r->second.size())
+          var.value_r->second = all_dims;
       } else {
         std::stringstream errorMsg;
-        errorMsg << "Variable: " << var.first << ", ill-formed JSON.";
+        errorMsg << "Variable: " << var.name << ", ill-formed JSON.";
         throw json_error(errorMsg.str());
       }
     }
   }
 
   template <typename T>
-  void to_column_major(std::string vname, std::vector<T>& cm_vals,
+  void to_column_major(const std::string& vname, std::vector<T>& cm_vals,
                        const std::vector<T>& rm_vals,
                        const std::vector<size_t>& dims) {
     size_t expected_size = 1;
@@ -396,9 +367,25 @@ class json_data_handler : public stan::json::json_handler {
       errorMsg << "Variable: " << vname << ", error: ill-formed array.";
       throw json_error(errorMsg.str());
     }
+    // walk the row-major values, tracking the index of each value
+    // and its column-major offset
+    std::vector<size_t> idx(dims.size(), 0);
+    std::vector<size_t> strides(dims.size());
+    size_t stride = 1;
+    for (size_t k = 0; k < dims.size(); ++k) {
+      strides[k] = stride;
+      stride *= dims[k];
+    }
+    size_t offset = 0;
     for (size_t i = 0; i < rm_vals.size(); i++) {
-      size_t idx = convert_offset_rtl_2_ltr(vname, i, dims);
-      cm_vals[idx] = rm_vals[i];
+      cm_vals[offset] = rm_vals[i];
+      for (size_t k = dims.size(); k-- > 0;) {
+        offset += strides[k];
+        if (++idx[k] < dims[k])
+          break;
+        offset -= strides[k] * dims[k];
+        idx[k] = 0;
+      }
     }
   }
 
@@ -419,12 +406,9 @@ class json_data_handler : public stan::json::json_handler {
       : json_handler(),
         vars_r(a_vars_r),
         vars_i(a_vars_i),
-        key_stack(),
-        var_types_map(),
-        slot_types_map(),
-        slot_dims_map(),
-        tuple_slots_map(),
-        int_slots_map(),
+        slots(),
+        var_slots(),
+        slot_stack(),
         values_r(),
         values_i(),
         array_start_i(0),
@@ -437,11 +421,9 @@ class json_data_handler : public stan::json::json_handler {
   void start_text() {
     vars_i.clear();
     vars_r.clear();
-    var_types_map.clear();
-    slot_types_map.clear();
-    slot_dims_map.clear();
-    tuple_slots_map.clear();
-    int_slots_map.clear();
+    slots.clear();
+    var_slots.clear();
+    slot_stack.clear();
     reset_values();
     not_stan_var = true;
   }
@@ -462,30 +444,27 @@ class json_data_handler : public stan::json::json_handler {
     }
     event = meta_event::KEY;
     reset_values();
-    std::string outer = key_str();
-    key_stack.push_back(key);
-    if (key_stack.size() == 1) {
+    if (slot_stack.empty()) {
       not_stan_var = !valid_varname(key);
     }
-    if (not_stan_var)
+    if (not_stan_var) {
+      slot_stack.push_back(npos);
       return;
-    if (key_stack.size() == 1 && slot_types_map.count(key) == 1) {
+    }
+    size_t outer = slot_stack.empty() ? npos : slot_stack.back();
+    if (outer == npos && var_slots.count(key) == 1) {
       std::stringstream errorMsg;
       errorMsg << "Attempt to redefine variable: " << key << ".";
       throw json_error(errorMsg.str());
-    } else if (key_stack.size() > 1
-               && slot_types_map[outer] == meta_type::ARRAY_OF_TUPLES) {
-      if (tuple_slots_map[outer].is_first) {
-        tuple_slots_map[outer].slots++;
+    } else if (outer != npos
+               && slots[outer].type == meta_type::ARRAY_OF_TUPLES) {
+      if (slots[outer].tuple.is_first) {
+        slots[outer].tuple.slots++;
       } else {
-        tuple_slots_map[outer].slots_acc++;
+        slots[outer].tuple.slots_acc++;
       }
     }
-    std::string vname = key_str();
-    if (slot_types_map.count(vname) == 0) {
-      slot_types_map[vname] = meta_type::SCALAR;
-      int_slots_map[vname] = true;
-    }
+    slot_stack.push_back(intern_slot(outer, key));
   }
 
   /**
@@ -494,21 +473,21 @@ class json_data_handler : public stan::json::json_handler {
    */
   void start_object() {
     event = meta_event::OBJ_OPEN;
-    if (is_init() || not_stan_var)
+    if (slot_stack.empty() || not_stan_var)
       return;
-    std::string key = key_str();
-    if (slot_types_map[key] == meta_type::ARRAY) {
-      slot_types_map[key] = meta_type::ARRAY_OF_TUPLES;
-    } else if (slot_types_map[key_str()] == meta_type::SCALAR) {
-      slot_types_map[key_str()] = meta_type::TUPLE;
+    slot_state& s = slot();
+    if (s.type == meta_type::ARRAY) {
+      s.type = meta_type::ARRAY_OF_TUPLES;
+    } else if (s.type == meta_type::SCALAR) {
+      s.type = meta_type::TUPLE;
     }
-    if (slot_types_map[key] == meta_type::ARRAY_OF_TUPLES) {
-      if (tuple_slots_map.count(key) == 0) {
-        tuple_slots slots;
-        tuple_slots_map[key] = slots;
+    if (s.type == meta_type::ARRAY_OF_TUPLES) {
+      if (!s.has_tuple_slots) {
+        s.has_tuple_slots = true;
+        s.tuple = tuple_slots();
       } else {
-        tuple_slots_map[key].is_first = false;
-        tuple_slots_map[key].slots_acc = 0;
+        s.tuple.is_first = false;
+        s.tuple.slots_acc = 0;
       }
     }
   }
@@ -520,27 +499,31 @@ class json_data_handler : public stan::json::json_handler {
   void end_object() {
     event = meta_event::OBJ_CLOSE;
     if (not_stan_var) {
-      if (!key_stack.empty())
-        key_stack.pop_back();
+      if (!slot_stack.empty())
+        slot_stack.pop_back();
       return;
     }
-    if (key_stack.size() > 1) {
-      std::string tuple = outer_key_str();
-      if (slot_types_map[tuple] == meta_type::ARRAY_OF_TUPLES) {
-        array_dims outer = get_outer_dims(key_stack);
-        if (!outer.dims.empty()) {
-          outer.dims_acc[outer.dims.size() - 1]++;
-          set_outer_dims(outer);
+    if (slot_stack.size() > 1) {
+      size_t id = slot_stack.back();
+      slot_state& tuple = slots[slots[id].parent];
+      if (tuple.type == meta_type::ARRAY_OF_TUPLES) {
+        size_t outer = outer_dims_slot(id);
+        if (outer == npos && !slots[id].has_dims)
+          unexpected_error(slots[id].name, "not an array");
+        array_dims& dims = outer == npos ? slots[id].dims : slots[outer].dims;
+        if (!dims.dims.empty()) {
+          if (outer == npos)
+            unexpected_error(slots[id].name, "ill-formed array");
+          dims.dims_acc[dims.dims.size() - 1]++;
         }
-        if (tuple_slots_map.count(tuple) == 0)
-          unexpected_error(tuple, "found close object, not a tuple var");
-        if (tuple_slots_map[tuple].is_first) {
-          tuple_slots_map[tuple].is_first = false;
+        if (!tuple.has_tuple_slots)
+          unexpected_error(tuple.name, "found close object, not a tuple var");
+        if (tuple.tuple.is_first) {
+          tuple.tuple.is_first = false;
         } else {
-          if (tuple_slots_map[tuple].slots_acc
-              != tuple_slots_map[tuple].slots) {
+          if (tuple.tuple.slots_acc != tuple.tuple.slots) {
             std::stringstream errorMsg;
-            errorMsg << "Variable " << tuple
+            errorMsg << "Variable " << tuple.name
                      << ": size mismatch between tuple elements.";
             throw json_error(errorMsg.str());
           }
@@ -556,25 +539,24 @@ class json_data_handler : public stan::json::json_handler {
    *  Then we add or update the dimensions of the array variable.
    */
   void start_array() {
-    if (key_stack.empty()) {
+    if (slot_stack.empty()) {
       throw json_error("Expecting JSON object, found array.");
     }
     if (not_stan_var)
       return;
-    std::string key(key_str());
-    if (slot_types_map[key] == meta_type::SCALAR
+    slot_state& s = slot();
+    if (s.type == meta_type::SCALAR
         && !(values_r.empty() && values_r.empty())) {
       std::stringstream errorMsg;
-      errorMsg << "Variable: " << key << ", error: non-scalar array value.";
+      errorMsg << "Variable: " << s.name << ", error: non-scalar array value.";
       throw json_error(errorMsg.str());
     }
-    if (slot_types_map[key] == meta_type::SCALAR)
-      slot_types_map[key] = meta_type::ARRAY;
-    else if (slot_types_map[key] == meta_type::TUPLE)
-      unexpected_error(key, "ill-formed tuple");
-    array_dims dims;
-    if (slot_dims_map.count(key) == 1)
-      dims = slot_dims_map[key];
+    if (s.type == meta_type::SCALAR)
+      s.type = meta_type::ARRAY;
+    else if (s.type == meta_type::TUPLE)
+      unexpected_error(s.name, "ill-formed tuple");
+    s.has_dims = true;
+    array_dims& dims = s.dims;
     dims.cur_dim++;
     if (dims.dims.empty() || dims.dims.size() < dims.cur_dim) {
       dims.dims.push_back(0);
@@ -582,7 +564,6 @@ class json_data_handler : public stan::json::json_handler {
     }
     if (dims.cur_dim > 1)
       dims.dims_acc[dims.cur_dim - 2]++;
-    slot_dims_map[key] = dims;
     array_start_i = values_i.size();
     array_start_r = values_r.size();
   }
@@ -596,13 +577,13 @@ class json_data_handler : public stan::json::json_handler {
   void end_array() {
     if (not_stan_var)
       return;
-    if (slot_dims_map.count(key_str()) == 0)
-      unexpected_error(key_str(), "ill-formed array");
-    std::string key(key_str());
-    array_dims dims = slot_dims_map[key];
+    slot_state& s = slot();
+    if (!s.has_dims)
+      unexpected_error(s.name, "ill-formed array");
+    array_dims& dims = s.dims;
     int idx = dims.cur_dim - 1;
-    bool is_int = int_slots_map[key];
-    bool is_last = (slot_types_map[key] != meta_type::ARRAY_OF_TUPLES
+    bool is_int = s.is_int;
+    bool is_last = (s.type != meta_type::ARRAY_OF_TUPLES
                     && dims.cur_dim == dims.dims.size());
     if (is_last && 0 == dims.dims[idx]) {  // innermost row of scalar elts
       if (is_int)
@@ -622,13 +603,13 @@ class json_data_handler : public stan::json::json_handler {
       }
       if (!is_rect) {
         std::stringstream errorMsg;
-        errorMsg << "Variable: " << key << ", error: non-rectangular array.";
+        errorMsg << "Variable: " << s.name
+                 << ", error: non-rectangular array.";
         throw json_error(errorMsg.str());
       }
     }
     dims.dims_acc[idx] = 0;
     dims.cur_dim--;
-    slot_dims_map[key] = dims;
   }
 
   void null() {
@@ -683,7 +664,7 @@ class json_data_handler : public stan::json::json_handler {
   void number_int(int n) {
     if (not_stan_var)
       return;
-    if (int_slots_map[key_str()]) {
+    if (slot().is_int) {
       values_i.push_back(n);
     } else {
       values_r.push_back(n);
@@ -696,7 +677,7 @@ class json_data_handler : public stan::json::json_handler {
     // if integer overflow, promote numeric data to double
     if (n > (unsigned)std::numeric_limits<int>::max())
       promote_to_double();
-    if (int_slots_map[key_str()]) {
+    if (slot().is_int) {
       values_i.push_back(static_cast<int>(n));
     } else {
       values_r.push_back(n);
@@ -718,6 +699,38 @@ class json_data_handler : public stan::json::json_handler {
     number_double(n);
   }
 
+  /* Large flat arrays of numbers arrive in one piece and are moved into
+   * values_i or values_r when they are the first values of the variable.
+   * The rows of a multi-dimensional array are appended in row-major order
+   * like single values and, as for those, transposed by to_column_major
+   * once the whole array has been read: every column-major offset depends
+   * on the extent of the outermost dimension, which is only known then.
+   */
+  bool number_arrays() const { return true; }
+
+  void number_array(std::vector<int>&& values) {
+    if (not_stan_var)
+      return;
+    if (!slot().is_int) {
+      values_r.insert(values_r.end(), values.begin(), values.end());
+    } else if (values_i.empty()) {
+      values_i = std::move(values);
+    } else {
+      values_i.insert(values_i.end(), values.begin(), values.end());
+    }
+  }
+
+  void number_array(std::vector<double>&& values) {
+    if (not_stan_var)
+      return;
+    promote_to_double();
+    if (values_r.empty()) {
+      values_r = std::move(values);
+    } else {
+      values_r.insert(values_r.end(), values.begin(), values.end());
+    }
+  }
+
   /** This function provides the column-major offset of an array element
    *  given its row-major offset and the array dimensions.
    */
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace stan {
 
@@ -97,6 +98,32 @@ class json_handler {
    */
   virtual void number_unsigned_int64(uint64_t n) {}
 
+  /**
+   * Return <code>true</code> if the handler accepts the values of flat
+   * arrays of numbers through <code>number_array</code> rather than one
+   * number event per value.
+   */
+  virtual bool number_arrays() const { return false; }
+
+  /**
+   * Handle the values of a flat array of integers that fit in an
+   * <code>int</code>.  Only called if <code>number_arrays()</code>
+   * returns <code>true</code>, between the start and end of the array.
+   *
+   * @param values Values to handle.
+   */
+  virtual void number_array(std::vector<int>&& values) {}
+
+  /**
+   * Handle the values of a flat array of numbers that are not all
+   * integers fitting in an <code>int</code>.  Only called if
+   * <code>number_arrays()</code> returns <code>true</code>, between the
+   * start and end of the array.
+   *
+   * @param values Values to handle.
+   */
+  virtual void number_array(std::vector<double>&& values) {}
+
   /**
    * Handle the specified string value.
    *
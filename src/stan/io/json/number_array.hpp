@@ -0,0 +1,295 @@
+#ifndef STAN_IO_JSON_NUMBER_ARRAY_HPP
+#define STAN_IO_JSON_NUMBER_ARRAY_HPP
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+namespace stan {
+namespace json {
+namespace internal {
+
+/**
+ * Minimum size in bytes of the text of an array of numbers for it to be
+ * parsed by <code>parse_number_array</code>; smaller arrays are left to
+ * the SAX parser.
+ */
+inline constexpr size_t min_number_array_size = 1 << 16;
+
+/**
+ * Size in bytes of the chunks of text parsed in parallel.
+ */
+inline constexpr size_t number_array_chunk_size = 1 << 16;
+
+/**
+ * Values of a flat array of numbers.  If every number is an integer
+ * representable as an <code>int</code>, the values are held in
+ * <code>ints</code>, otherwise in <code>doubles</code>.
+ */
+struct number_array {
+  bool is_int = true;
+  std::vector<int> ints;
+  std::vector<double> doubles;
+};
+
+inline bool is_json_space(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+/**
+ * Return <code>true</code> if the text is a JSON number, setting
+ * <code>is_int</code> to whether it has neither a fraction nor an
+ * exponent.
+ *
+ * @param[in] begin start of the text
+ * @param[in] end end of the text
+ * @param[out] is_int whether the number is written as an integer
+ */
+inline bool is_json_number(const char* begin, const char* end, bool& is_int) {
+  const char* p = begin;
+  if (p != end && *p == '-')
+    ++p;
+  if (p == end || !is_digit(*p))
+    return false;
+  if (*p++ != '0')
+    while (p != end && is_digit(*p))
+      ++p;
+  is_int = true;
+  if (p != end && *p == '.') {
+    is_int = false;
+    if (++p == end || !is_digit(*p))
+      return false;
+    while (p != end && is_digit(*p))
+      ++p;
+  }
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    is_int = false;
+    if (++p != end && (*p == '+' || *p == '-'))
+      ++p;
+    if (p == end || !is_digit(*p))
+      return false;
+    while (p != end && is_digit(*p))
+      ++p;
+  }
+  return p == end;
+}
+
+/**
+ * Parse a number of a chunk of text into an <code>int</code>, setting
+ * <code>is_int</code> to <code>false</code> if it is not an integer
+ * representable as an <code>int</code>.
+ */
+inline void parse_number_token(const char* begin, const char* end,
+                               bool token_is_int, int& value, bool& is_int) {
+#if defined(__cpp_lib_to_chars)
+  long long n;  // NOLINT(runtime/int)
+  if (token_is_int && std::from_chars(begin, end, n).ec == std::errc()
+      && n >= std::numeric_limits<int>::min()
+      && n <= std::numeric_limits<int>::max())
+    value = static_cast<int>(n);
+  else
+    is_int = false;
+#endif
+}
+
+/**
+ * Parse a number of a chunk of text into a <code>double</code>, setting
+ * <code>is_int</code> to <code>false</code> if it does not fit.
+ */
+inline void parse_number_token(const char* begin, const char* end,
+                               bool token_is_int, double& value,
+                               bool& is_int) {
+#if defined(__cpp_lib_to_chars)
+  if (std::from_chars(begin, end, value).ec != std::errc())
+    is_int = false;
+#endif
+}
+
+/**
+ * Parse the numbers of a chunk of text holding comma separated numbers
+ * into <code>values</code>.  Every chunk but the last ends with the
+ * comma following its last number.
+ *
+ * When parsing into <code>int</code>s, parsing stops at the first
+ * number that is not an <code>int</code>, setting <code>is_int</code>
+ * to <code>false</code>.
+ *
+ * @tparam T type of the values, <code>int</code> or <code>double</code>
+ * @return <code>false</code> if the chunk holds anything but numbers,
+ * or a number that does not fit in a double
+ */
+template <typename T>
+inline bool parse_number_chunk(const char* begin, const char* end, bool last,
+                               T* values, bool& is_int) {
+#if defined(__cpp_lib_to_chars)
+  const char* p = begin;
+  while (true) {
+    while (p != end && is_json_space(*p))
+      ++p;
+    const char* token = p;
+    while (p != end && *p != ',' && !is_json_space(*p))
+      ++p;
+    bool token_is_int;
+    if (!is_json_number(token, p, token_is_int))
+      return false;
+    bool fits = true;
+    parse_number_token(token, p, token_is_int, *values++, fits);
+    if (!fits) {
+      if (std::is_same<T, int>::value) {
+        is_int = false;
+        return true;
+      }
+      return false;
+    }
+    while (p != end && is_json_space(*p))
+      ++p;
+    if (p == end)
+      return last;
+    if (*p++ != ',')
+      return false;
+    if (p == end)
+      return !last;
+  }
+#else
+  return false;
+#endif
+}
+
+/**
+ * Parse the chunks of a flat JSON array of numbers in parallel into
+ * <code>values</code>, which holds the values of all the chunks.
+ *
+ * @tparam T type of the values, <code>int</code> or <code>double</code>
+ * @param[in] bounds start of each chunk, followed by the end of the last
+ * @param[in] offsets offset of the values of each chunk
+ * @param[out] values values of the array
+ * @param[out] is_int set to <code>false</code> if parsing into
+ * <code>int</code>s stopped at a number that is not an <code>int</code>
+ * @return <code>false</code> if the array holds anything but numbers
+ */
+template <typename T>
+inline bool parse_number_chunks(const std::vector<const char*>& bounds,
+                                const std::vector<size_t>& offsets,
+                                std::vector<T>& values, bool& is_int) {
+  const size_t num_chunks = bounds.size() - 1;
+  std::atomic<bool> ok{true};
+  std::atomic<bool> all_int{true};
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, num_chunks),
+      [&](const tbb::blocked_range<size_t>& r) {
+        for (size_t k = r.begin(); k != r.end(); ++k) {
+          if (!ok.load(std::memory_order_relaxed)
+              || !all_int.load(std::memory_order_relaxed))
+            return;
+          bool chunk_is_int = true;
+          if (!parse_number_chunk(bounds[k], bounds[k + 1],
+                                  k + 1 == num_chunks,
+                                  values.data() + offsets[k], chunk_is_int))
+            ok.store(false, std::memory_order_relaxed);
+          if (!chunk_is_int)
+            all_int.store(false, std::memory_order_relaxed);
+        }
+      });
+  is_int = all_int.load();
+  return ok.load();
+}
+
+/**
+ * Parse a flat JSON array of numbers, splitting the text into chunks
+ * that are parsed in parallel straight into the storage of the result.
+ *
+ * The array is only parsed if its text is at least
+ * <code>min_size</code> bytes long and holds nothing but numbers that
+ * the SAX parser would read as integers or doubles without error.
+ * Otherwise, nothing is parsed and the array is left to the SAX parser,
+ * which also reports any errors.
+ *
+ * @param[in] begin text following the opening bracket of the array
+ * @param[in] end end of the whole text
+ * @param[out] values values of the array
+ * @param[in] min_size minimum size of the text of the array in bytes
+ * @return position of the closing bracket, or <code>nullptr</code> if
+ * the array was not parsed
+ */
+inline const char* parse_number_array(const char* begin, const char* end,
+                                      number_array& values,
+                                      size_t min_size = min_number_array_size) {
+#if defined(__cpp_lib_to_chars)
+  const char* close = begin;
+  while (close != end && *close != ']') {
+    char c = *close;
+    if (!(is_digit(c) || c == ',' || c == '-' || c == '+' || c == '.'
+          || c == 'e' || c == 'E' || is_json_space(c)))
+      return nullptr;
+    ++close;
+  }
+  if (close == end || static_cast<size_t>(close - begin) < min_size)
+    return nullptr;
+
+  // chunks end after a comma, so that they hold whole numbers
+  std::vector<const char*> bounds{begin};
+  for (const char* p = begin + number_array_chunk_size; p < close;
+       p += number_array_chunk_size) {
+    while (p != close && *p != ',')
+      ++p;
+    if (p == close)
+      break;
+    bounds.push_back(++p);
+  }
+  bounds.push_back(close);
+  size_t num_chunks = bounds.size() - 1;
+
+  std::vector<size_t> offsets(num_chunks + 1, 0);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks),
+                    [&](const tbb::blocked_range<size_t>& r) {
+                      for (size_t k = r.begin(); k != r.end(); ++k) {
+                        size_t count = 0;
+                        for (const char* p = bounds[k]; p != bounds[k + 1];
+                             ++p)
+                          count += *p == ',';
+                        offsets[k + 1] = count;
+                      }
+                    });
+  offsets[num_chunks] += 1;
+  for (size_t k = 0; k < num_chunks; ++k)
+    offsets[k + 1] += offsets[k];
+
+  // Integers are parsed straight into ints, so that integer arrays never
+  // take the memory of doubles.  Otherwise the ints are released before
+  // parsing again into doubles.
+  bool is_int = true;
+  values.doubles.clear();
+  values.ints.resize(offsets[num_chunks]);
+  if (!parse_number_chunks(bounds, offsets, values.ints, is_int)) {
+    values.ints.clear();
+    return nullptr;
+  }
+  values.is_int = is_int;
+  if (!is_int) {
+    std::vector<int>().swap(values.ints);
+    values.doubles.resize(offsets[num_chunks]);
+    if (!parse_number_chunks(bounds, offsets, values.doubles, is_int)) {
+      values.doubles.clear();
+      return nullptr;
+    }
+  }
+  return close;
+#else
+  return nullptr;
+#endif
+}
+
+}  // namespace internal
+}  // namespace json
+}  // namespace stan
+
+#endif
@@ -2,10 +2,12 @@
 #define STAN_IO_JSON_RAPIDJSON_PARSER_HPP
 
 #include <stan/io/json/json_error.hpp>
+#include <stan/io/json/number_array.hpp>
+#include <stan/io/read_text.hpp>
 #include <stan/io/validate_zero_buf.hpp>
 #include <rapidjson/encodings.h>
 #include <rapidjson/error/en.h>
-#include <rapidjson/istreamwrapper.h>
+#include <rapidjson/memorystream.h>
 #include <rapidjson/reader.h>
 
 #include <cerrno>
@@ -16,6 +18,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace stan {
 namespace json {
@@ -23,7 +26,8 @@ enum class ParsingState { Idle, Started, End };
 
 template <typename Handler>
 struct RapidJSONHandler {
-  explicit RapidJSONHandler(Handler &h) : h_(h), state_(ParsingState::Idle) {}
+  explicit RapidJSONHandler(Handler &h, rapidjson::MemoryStream *stream)
+      : h_(h), state_(ParsingState::Idle), stream_(stream) {}
   bool check_start() {
     if (state_ == ParsingState::Idle) {
       error_message_ = "expecting start of object ({) or array ([)";
@@ -86,6 +90,8 @@ struct RapidJSONHandler {
     state_ = ParsingState::Started;
     error_message_ = "";
     h_.start_array();
+    if (h_.number_arrays())
+      parse_number_array();
     return true;
   }
   bool EndArray(rapidjson::SizeType elementCount) {
@@ -93,8 +99,28 @@ struct RapidJSONHandler {
     return check_start();
   }
 
+  /**
+   * Send the values of a large flat array of numbers starting at the
+   * current position to the handler at once and move the stream to the
+   * closing bracket, so that the reader continues as if the array were
+   * empty.  Other arrays are left to the reader.
+   */
+  void parse_number_array() {
+    internal::number_array values;
+    const char *close
+        = internal::parse_number_array(stream_->src_, stream_->end_, values);
+    if (close == nullptr)
+      return;
+    stream_->src_ = close;
+    if (values.is_int)
+      h_.number_array(std::move(values.ints));
+    else
+      h_.number_array(std::move(values.doubles));
+  }
+
   Handler &h_;
   ParsingState state_;
+  rapidjson::MemoryStream *stream_;
   std::string error_message_;
   std::string last_key_;
 };
@@ -103,6 +129,12 @@ struct RapidJSONHandler {
  * Parse the JSON text represented by the specified input stream,
  * sending events to the specified handler.
  *
+ * <p>The whole text is read into memory before parsing.  Handlers whose
+ * <code>number_arrays()</code> returns <code>true</code> receive the
+ * values of large flat arrays of numbers through a single call to
+ * <code>number_array</code> instead of one event per value; these
+ * arrays are parsed in parallel.
+ *
  * @tparam Handler
  * @param in Input stream from which to parse
  * @param handler Handler for events from parser
@@ -110,12 +142,13 @@ struct RapidJSONHandler {
 template <typename Handler>
 void rapidjson_parse(std::istream &in, Handler &handler) {
   rapidjson::Reader reader;
-  RapidJSONHandler<Handler> filter(handler);
-  rapidjson::IStreamWrapper isw(in);
+  std::string text = stan::io::read_text(in);
+  rapidjson::MemoryStream stream(text.data(), text.size());
+  RapidJSONHandler<Handler> filter(handler, &stream);
   handler.start_text();
   if (!reader.Parse<rapidjson::kParseNanAndInfFlag
                     | rapidjson::kParseValidateEncodingFlag
-                    | rapidjson::kParseFullPrecisionFlag>(isw, filter)) {
+                    | rapidjson::kParseFullPrecisionFlag>(stream, filter)) {
     rapidjson::ParseErrorCode err = reader.GetParseErrorCode();
     std::stringstream ss;
     ss << "Error in JSON parsing " << std::endl
@@ -0,0 +1,98 @@
+#ifndef STAN_IO_MAPPED_FILE_HPP
+#define STAN_IO_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#ifdef _WIN32
+#include <fstream>
+#include <memory>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stan {
+namespace io {
+
+/**
+ * The read-only contents of a file, memory mapped where the platform
+ * supports it and otherwise read into memory.  The contents start at
+ * an address aligned to at least 8 bytes and are valid for the
+ * lifetime of the object.
+ */
+class mapped_file {
+ public:
+  /**
+   * Map the contents of a file.
+   *
+   * @param[in] filename name of the file
+   * @throw std::invalid_argument if the file cannot be opened or mapped
+   */
+  explicit mapped_file(const std::string& filename)
+      : data_(nullptr), size_(0) {
+#ifdef _WIN32
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in)
+      throw std::invalid_argument("Error: cannot open " + filename);
+    size_ = in.tellg();
+    in.seekg(0);
+    buffer_.reset(new double[(size_ + 7) / 8]);
+    in.read(reinterpret_cast<char*>(buffer_.get()), size_);
+    data_ = reinterpret_cast<const char*>(buffer_.get());
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::invalid_argument("Error: cannot open " + filename);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::invalid_argument("Error: cannot read " + filename);
+    }
+    size_ = st.st_size;
+    if (size_ > 0) {
+      void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(fd);
+        throw std::invalid_argument("Error: cannot map " + filename);
+      }
+      data_ = static_cast<const char*>(p);
+    }
+    ::close(fd);
+#endif
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  ~mapped_file() {
+#ifndef _WIN32
+    if (data_ != nullptr)
+      ::munmap(const_cast<char*>(data_), size_);
+#endif
+  }
+
+  /**
+   * Return a pointer to the contents of the file.
+   */
+  const char* data() const { return data_; }
+
+  /**
+   * Return the size of the file in bytes.
+   */
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_;
+  size_t size_;
+#ifdef _WIN32
+  std::unique_ptr<double[]> buffer_;
+#endif
+};
+
+}  // namespace io
+}  // namespace stan
+
+#endif
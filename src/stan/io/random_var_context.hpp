@@ -41,21 +41,11 @@ class random_var_context : public var_context {
    */
   template <class Model, class RNG>
   random_var_context(Model& model, RNG& rng, double init_radius, bool init_zero)
-      : unconstrained_params_(model.num_params_r()) {
-    size_t num_unconstrained_ = model.num_params_r();
+      : unconstrained_params_(
+          draw_unconstrained(model, rng, init_radius, init_zero)) {
     model.get_param_names(names_, false, false);
     model.get_dims(dims_, false, false);
 
-    if (init_zero) {
-      for (size_t n = 0; n < num_unconstrained_; ++n)
-        unconstrained_params_[n] = 0.0;
-    } else {
-      boost::random::uniform_real_distribution<double> unif(-init_radius,
-                                                            init_radius);
-      for (size_t n = 0; n < num_unconstrained_; ++n)
-        unconstrained_params_[n] = unif(rng);
-    }
-
     std::vector<double> constrained_params;
     std::vector<int> int_params;
     model.write_array(rng, unconstrained_params_, int_params,
@@ -64,6 +54,43 @@ class random_var_context : public var_context {
     vals_r_ = constrained_to_vals_r(constrained_params, dims_);
   }
 
+  /**
+   * Return random values for the parameters of the model on the
+   * unconstrained scale, drawn exactly as the constructor draws them.
+   *
+   * Unlike the constructor, this neither constrains the values nor
+   * looks up the parameter names and dimensions, so it is the cheaper
+   * choice when the constrained values are not needed, e.g. when no
+   * initial values are supplied by the user.  Constraining the values
+   * is left to the model's log density, which fails for exactly the
+   * values that could not be constrained.
+   *
+   * @tparam Model Model class
+   * @tparam RNG Random number generator type
+   * @param[in] model instantiated model to generate variables for
+   * @param[in,out] rng pseudo-random number generator
+   * @param[in] init_radius the unconstrained variables are uniform draws
+   *   from -init_radius to init_radius.
+   * @param[in] init_zero indicates whether all unconstrained variables
+   *   should be initialized at 0. When init_zero is false, init_radius
+   *   must be greater than 0.
+   * @return the unconstrained parameters
+   */
+  template <class Model, class RNG>
+  static std::vector<double> draw_unconstrained(const Model& model, RNG& rng,
+                                                double init_radius,
+                                                bool init_zero) {
+    size_t num_unconstrained = model.num_params_r();
+    std::vector<double> unconstrained(num_unconstrained, 0.0);
+    if (!init_zero) {
+      boost::random::uniform_real_distribution<double> unif(-init_radius,
+                                                            init_radius);
+      for (size_t n = 0; n < num_unconstrained; ++n)
+        unconstrained[n] = unif(rng);
+    }
+    return unconstrained;
+  }
+
   /**
    * Destructor.
    */
@@ -132,6 +159,23 @@ class random_var_context : public var_context {
     return dims_[loc - names_.begin()];
   }
 
+  /**
+   * Returns a view of the values and dimensions of the constrained
+   * variable without copying.
+   *
+   * @param name Name of variable.
+   * @return view of the variable if it exists; an empty view is
+   *   returned otherwise
+   */
+  var_view_r vals_r_view(const std::string& name) const {
+    std::vector<std::string>::const_iterator loc
+        = std::find(names_.begin(), names_.end(), name);
+    if (loc == names_.end())
+      return var_view_r();
+    return var_view_r(array_view<double>(vals_r_[loc - names_.begin()]),
+                      dims_[loc - names_.begin()]);
+  }
+
   /**
    * Return <code>true</code> if the specified variable name has
    * integer values. Always returns <code>false</code>.
@@ -164,6 +208,16 @@ class random_var_context : public var_context {
     return empty_dims_i;
   }
 
+  /**
+   * Returns an empty view.
+   *
+   * @param name Name of variable.
+   * @return empty view
+   */
+  var_view_i vals_i_view(const std::string& name) const {
+    return var_view_i();
+  }
+
   /**
    * Fill a list of the names of the floating point variables in
    * the context. This will return the names of the parameters in
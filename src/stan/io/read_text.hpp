@@ -0,0 +1,32 @@
+#ifndef STAN_IO_READ_TEXT_HPP
+#define STAN_IO_READ_TEXT_HPP
+
+#include <istream>
+#include <string>
+
+namespace stan {
+namespace io {
+
+/**
+ * Return the remaining contents of the specified input stream, read
+ * in large blocks directly into the returned string.
+ *
+ * @param in input stream
+ * @return contents of the stream
+ */
+inline std::string read_text(std::istream& in) {
+  constexpr std::streamsize block_size = 1 << 20;
+  std::string text;
+  std::streamsize size = 0;
+  while (in.good()) {
+    text.resize(size + block_size);
+    in.read(&text[size], block_size);
+    size += in.gcount();
+  }
+  text.resize(size);
+  return text;
+}
+
+}  // namespace io
+}  // namespace stan
+#endif
@@ -2,13 +2,21 @@
 #define STAN_IO_STAN_CSV_READER_HPP
 
 #include <boost/algorithm/string.hpp>
+#include <stan/io/read_text.hpp>
 #include <stan/math/prim.hpp>
+#include <algorithm>
 #include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <istream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
 
 namespace stan {
 namespace io {
@@ -290,19 +298,7 @@ class stan_csv_reader {
         break;
 
       if (comment_line) {
-        if (line.find("(Warm-up)") != std::string::npos) {
-          int left = 17;
-          int right = line.find(" seconds");
-          double warmup;
-          std::stringstream(line.substr(left, right - left)) >> warmup;
-          timing.warmup += warmup;
-        } else if (line.find("(Sampling)") != std::string::npos) {
-          int left = 17;
-          int right = line.find(" seconds");
-          double sampling;
-          std::stringstream(line.substr(left, right - left)) >> sampling;
-          timing.sampling += sampling;
-        }
+        read_timing(line, timing);
       } else {
         ss << line << '\n';
         int current_cols = std::count(line.begin(), line.end(), ',') + 1;
@@ -381,6 +377,243 @@ class stan_csv_reader {
     }
     return data;
   }
+
+  /**
+   * Parses the file, reading only the given columns of the draws.
+   *
+   * The stream is read into memory in large blocks and the draws are
+   * parsed from memory in a single pass straight into the samples
+   * matrix, skipping over unselected columns without parsing them.
+   * The header of the result holds the selected column names in the
+   * order requested.  The metadata, adaptation and timing are read as
+   * by <code>parse(std::istream&, std::ostream*)</code>.
+   *
+   * @param[in] in input stream to parse
+   * @param[in] columns names of the columns to read, as they appear in
+   *   the header after prettifying, or all columns if empty
+   * @param[out] out output stream to send messages
+   * @throw std::invalid_argument if the contents can't be parsed into
+   *   header + data rows or a column is not in the header
+   */
+  static stan_csv parse(std::istream& in,
+                        const std::vector<std::string>& columns,
+                        std::ostream* out) {
+    std::string buffer = read_text(in);
+    const char* pos = buffer.data();
+    const char* end = pos + buffer.size();
+
+    stan_csv data;
+    std::stringstream metadata(comment_lines(pos, end));
+    read_metadata(metadata, data.metadata);
+
+    std::stringstream header(next_line(pos, end));
+    if (!read_header(header, data.header))
+      throw std::invalid_argument("Error: no column names found in csv file");
+    std::vector<int> selected;
+    if (columns.empty()) {
+      for (size_t j = 0; j < data.header.size(); ++j)
+        selected.push_back(j);
+    } else {
+      for (const auto& name : columns) {
+        auto it = std::find(data.header.begin(), data.header.end(), name);
+        if (it == data.header.end())
+          throw std::invalid_argument("Error: column " + name
+                                      + " not found in csv file");
+        selected.push_back(it - data.header.begin());
+      }
+      data.header = columns;
+    }
+
+    // skip warmup draws, if any
+    if (data.metadata.algorithm != "fixed_param" && data.metadata.num_warmup > 0
+        && data.metadata.save_warmup) {
+      while (pos < end && *pos != '#')
+        next_line(pos, end);
+    }
+
+    if (data.metadata.algorithm != "fixed_param") {
+      std::stringstream adaptation(comment_lines(pos, end));
+      read_adaptation(adaptation, data.adaptation);
+    }
+
+    if (data.metadata.method == "variational")
+      next_line(pos, end);  // discard variational estimate
+
+    if (!read_samples(pos, end, selected, data.header.size(), data.samples,
+                      data.timing)) {
+      if (out)
+        *out << "Unable to parse sample" << std::endl;
+    }
+    return data;
+  }
+
+ private:
+  /**
+   * Returns the line starting at <code>pos</code>, without its newline,
+   * and moves <code>pos</code> to the start of the next line.
+   */
+  static std::string next_line(const char*& pos, const char* end) {
+    const char* eol
+        = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+    if (eol == nullptr)
+      eol = end;
+    std::string line(pos, eol);
+    pos = eol == end ? end : eol + 1;
+    return line;
+  }
+
+  /**
+   * Returns the consecutive comment lines starting at <code>pos</code>
+   * and moves <code>pos</code> past them.
+   */
+  static std::string comment_lines(const char*& pos, const char* end) {
+    std::string lines;
+    while (pos < end && *pos == '#') {
+      lines += next_line(pos, end);
+      lines += '\n';
+    }
+    return lines;
+  }
+
+  /**
+   * Parses a number ending at a comma, newline or the end of the
+   * buffer, ignoring surrounding blanks, and moves <code>pos</code> to
+   * the delimiter.  Unparseable values are read as zero.
+   */
+  static double read_value(const char*& pos, const char* end) {
+    while (pos < end && (*pos == ' ' || *pos == '\t'))
+      ++pos;
+    const char* delim = pos;
+    skip_value(delim, end);
+    double x = 0;
+    if (pos < delim) {
+#if defined(__cpp_lib_to_chars)
+      const char* first = pos;
+      if (*first == '+')
+        ++first;
+      std::from_chars(first, delim, x);
+#else
+      // strtod skips any whitespace, newlines included, so a blank field
+      // could be read from the next row
+      char* last;
+      double y = std::strtod(pos, &last);
+      if (last <= delim)
+        x = y;
+#endif
+    }
+    pos = delim;
+    return x;
+  }
+
+  /**
+   * Moves <code>pos</code> to the comma or newline ending the current
+   * field.
+   */
+  static void skip_value(const char*& pos, const char* end) {
+    while (pos < end && *pos != ',' && *pos != '\n')
+      ++pos;
+  }
+
+  /**
+   * Reads the timing from a comment line.
+   */
+  static void read_timing(const std::string& line, stan_csv_timing& timing) {
+    if (line.find("(Warm-up)") != std::string::npos) {
+      int left = 17;
+      int right = line.find(" seconds");
+      double warmup;
+      std::stringstream(line.substr(left, right - left)) >> warmup;
+      timing.warmup += warmup;
+    } else if (line.find("(Sampling)") != std::string::npos) {
+      int left = 17;
+      int right = line.find(" seconds");
+      double sampling;
+      std::stringstream(line.substr(left, right - left)) >> sampling;
+      timing.sampling += sampling;
+    }
+  }
+
+  /**
+   * Reads the draws and timing from memory into preallocated storage,
+   * keeping only the selected columns.
+   *
+   * @param[in,out] pos start of the draws, moved to the end of the buffer
+   * @param[in] end end of the buffer
+   * @param[in] selected indexes of the columns to keep
+   * @param[in] num_selected number of selected columns
+   * @param[out] samples draws, one row per draw
+   * @param[out] timing timing read from the comments
+   * @return false if there are no draws to read
+   */
+  static bool read_samples(const char*& pos, const char* end,
+                           const std::vector<int>& selected,
+                           size_t num_selected, Eigen::MatrixXd& samples,
+                           stan_csv_timing& timing) {
+    if (pos >= end || *pos == '#')
+      return false;  // need at least one data row
+
+    int rows = 0;
+    for (const char* p = pos; p < end;) {
+      const char* eol
+          = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      if (eol == nullptr)
+        eol = end;
+      if (eol != p && *p != '#')
+        ++rows;
+      p = eol + 1;
+    }
+
+    // position of each column in the selection, or -1 if not selected
+    int max_column = 0;
+    for (int j : selected)
+      max_column = std::max(max_column, j + 1);
+    std::vector<int> target(max_column, -1);
+    for (size_t k = 0; k < selected.size(); ++k)
+      target[selected[k]] = k;
+
+    samples.resize(rows, num_selected);
+    int cols = -1;
+    int row = 0;
+    while (pos < end) {
+      if (*pos == '\n') {
+        ++pos;
+        continue;
+      }
+      if (*pos == '#') {
+        read_timing(next_line(pos, end), timing);
+        continue;
+      }
+      int col = 0;
+      while (true) {
+        if (col < max_column && target[col] >= 0)
+          samples(row, target[col]) = read_value(pos, end);
+        else
+          skip_value(pos, end);
+        ++col;
+        if (pos >= end || *pos == '\n')
+          break;
+        ++pos;  // comma
+      }
+      if (pos < end)
+        ++pos;  // newline
+      if (cols == -1) {
+        cols = col;
+        if (cols < max_column) {
+          std::stringstream msg;
+          msg << "Error: expected at least " << max_column
+              << " columns, but found " << cols << " instead for row 1";
+          throw std::invalid_argument(msg.str());
+        }
+      } else if (cols != col) {
+        std::stringstream msg;
+        msg << "Error: expected " << cols << " columns, but found " << col
+            << " instead for row " << row + 1;
+        throw std::invalid_argument(msg.str());
+      }
+      ++row;
+    }
+    return true;
+  }
 };
 
 }  // namespace io
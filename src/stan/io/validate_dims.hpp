@@ -42,6 +42,8 @@ inline void validate_dims(const stan::io::var_context& context,
       throw std::runtime_error(msg.str());
     }
   }
+  if (context.has_dims(name, dims_declared))
+    return;
   std::vector<size_t> dims = context.dims_r(name);
   if (dims.size() != dims_declared.size()) {
     std::stringstream msg;
@@ -0,0 +1,91 @@
+#ifndef STAN_IO_VALIDATE_DIMS_PLAN_HPP
+#define STAN_IO_VALIDATE_DIMS_PLAN_HPP
+
+#include <stan/io/var_context.hpp>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * A <code>validate_dims_plan</code> holds the declared base types and
+ * dimensions of a sequence of variables, such as the data of a model,
+ * so that a context can be checked against all of them at once.
+ *
+ * <p>The plan is built once, e.g. per model, and its names and
+ * dimensions are kept in flat arrays.  Checking a context then neither
+ * builds strings nor copies dimensions for variables that match their
+ * declaration, using <code>var_context::has_dims</code>.  Only for
+ * variables that do not match is the context's own
+ * <code>validate_dims</code> called, which decides whether to accept
+ * them (e.g. empty arrays) and formats the error message, so that
+ * checking with a plan behaves exactly like calling
+ * <code>validate_dims</code> for each variable in turn.
+ */
+class validate_dims_plan {
+ public:
+  /**
+   * Construct an empty plan.
+   *
+   * @param stage stan program processing stage, used in error messages
+   */
+  explicit validate_dims_plan(const std::string& stage) : stage_(stage) {}
+
+  /**
+   * Add a variable to the plan.
+   *
+   * @param name variable name
+   * @param base_type declared stan variable type
+   * @param dims_declared variable dimensions
+   */
+  void add(const std::string& name, const std::string& base_type,
+           const std::vector<size_t>& dims_declared) {
+    vars_.push_back(
+        var_decl{name, base_type, base_type == "int", dims_.size(),
+                 dims_declared.size()});
+    dims_.insert(dims_.end(), dims_declared.begin(), dims_declared.end());
+  }
+
+  /**
+   * Return the number of variables in the plan.
+   */
+  size_t size() const { return vars_.size(); }
+
+  /**
+   * Check the dimensions of the variables in the specified context
+   * against their declarations, in the order the variables were added.
+   *
+   * @param context context to check
+   * @throw std::runtime_error if the dimensions of a variable do not
+   *        match its declaration, as thrown by
+   *        <code>context.validate_dims</code>
+   */
+  void validate(const var_context& context) const {
+    for (const var_decl& var : vars_) {
+      array_view<size_t> dims(dims_.data() + var.dims_offset, var.num_dims);
+      bool found = var.is_int ? context.contains_i(var.name)
+                              : context.contains_r(var.name);
+      if (!found || !context.has_dims(var.name, dims))
+        context.validate_dims(stage_, var.name, var.base_type,
+                              dims.to_vector());
+    }
+  }
+
+ private:
+  struct var_decl {
+    std::string name;
+    std::string base_type;
+    bool is_int;
+    size_t dims_offset;  // into dims_
+    size_t num_dims;
+  };
+
+  std::string stage_;
+  std::vector<var_decl> vars_;
+  std::vector<size_t> dims_;
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
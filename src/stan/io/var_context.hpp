@@ -1,6 +1,8 @@
 #ifndef STAN_IO_VAR_CONTEXT_HPP
 #define STAN_IO_VAR_CONTEXT_HPP
 
+#include <stan/io/var_view.hpp>
+#include <algorithm>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -111,6 +113,61 @@ class var_context {
    */
   virtual std::vector<size_t> dims_i(const std::string& name) const = 0;
 
+  /**
+   * Return a view of the floating point values and dimensions of the
+   * variable of the specified name, or an empty view if there is no
+   * such variable.  Values of integer variables may be viewed as
+   * integers and converted on access.
+   *
+   * <p>The default implementation copies the values and dimensions
+   * into storage owned by the view.  Contexts holding their variables
+   * in memory should override it to return a view of that memory,
+   * valid for as long as the variable is.
+   *
+   * @param name Name of variable.
+   * @return View of the values and dimensions of the variable.
+   */
+  virtual var_view_r vals_r_view(const std::string& name) const {
+    return var_view_r(vals_r(name), dims_r(name));
+  }
+
+  /**
+   * Return a view of the integer values and dimensions of the
+   * variable of the specified name, or an empty view if there is no
+   * such integer variable.
+   *
+   * <p>The default implementation copies the values and dimensions
+   * into storage owned by the view.  Contexts holding their variables
+   * in memory should override it to return a view of that memory,
+   * valid for as long as the variable is.
+   *
+   * @param name Name of variable.
+   * @return View of the values and dimensions of the variable.
+   */
+  virtual var_view_i vals_i_view(const std::string& name) const {
+    return var_view_i(vals_i(name), dims_i(name));
+  }
+
+  /**
+   * Return <code>true</code> if the variable of the specified name has
+   * the specified dimensions.  A variable that does not exist has no
+   * dimensions, as for <code>dims_r</code>.
+   *
+   * <p>The default implementation compares against a copy of the
+   * dimensions.  Contexts overriding <code>vals_r_view</code> should
+   * override it to return <code>view_has_dims(name, dims)</code>, so
+   * that it does not allocate.
+   *
+   * @param name Name of variable.
+   * @param dims Dimensions to compare against.
+   * @return <code>true</code> if the dimensions are the same.
+   */
+  virtual bool has_dims(const std::string& name,
+                        const array_view<size_t>& dims) const {
+    std::vector<size_t> found = dims_r(name);
+    return std::equal(found.begin(), found.end(), dims.begin(), dims.end());
+  }
+
   /**
    * Fill a list of the names of the floating point variables in
    * the context.
@@ -233,6 +290,22 @@ class var_context {
     v[7] = n8;
     return v;
   }
+
+ protected:
+  /**
+   * Return <code>true</code> if the variable of the specified name has
+   * the specified dimensions, comparing against the dimensions of
+   * <code>vals_r_view</code> without copying them.
+   *
+   * @param name Name of variable.
+   * @param dims Dimensions to compare against.
+   * @return <code>true</code> if the dimensions are the same.
+   */
+  bool view_has_dims(const std::string& name,
+                     const array_view<size_t>& dims) const {
+    const array_view<size_t> found = vals_r_view(name).dims();
+    return std::equal(found.begin(), found.end(), dims.begin(), dims.end());
+  }
 };
 
 }  // namespace io
@@ -0,0 +1,246 @@
+#ifndef STAN_IO_VAR_VIEW_HPP
+#define STAN_IO_VAR_VIEW_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * A read-only view of a contiguous array of values that it does not
+ * own.
+ *
+ * @tparam T type of the values
+ */
+template <typename T>
+class array_view {
+ public:
+  array_view() : data_(nullptr), size_(0) {}
+
+  /**
+   * Construct a view of an array.
+   *
+   * @param[in] data pointer to the first value
+   * @param[in] size number of values
+   */
+  array_view(const T* data, size_t size) : data_(data), size_(size) {}
+
+  /**
+   * Construct a view of the contents of a vector.  The view is
+   * invalidated when the vector is resized or destroyed.
+   *
+   * @param[in] x vector to view
+   */
+  array_view(const std::vector<T>& x)  // NOLINT(runtime/explicit)
+      : data_(x.data()), size_(x.size()) {}
+
+  const T* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const T* begin() const { return data_; }
+  const T* end() const { return data_ + size_; }
+  const T& operator[](size_t i) const { return data_[i]; }
+
+  /**
+   * Return a copy of the values.
+   */
+  std::vector<T> to_vector() const { return std::vector<T>(begin(), end()); }
+
+ private:
+  const T* data_;
+  size_t size_;
+};
+
+namespace internal {
+
+/**
+ * Storage for the values and dimensions of a variable copied out of a
+ * <code>var_context</code> that cannot provide a view of its own
+ * storage.
+ */
+template <typename T>
+struct var_view_storage {
+  std::vector<T> values;
+  std::vector<size_t> dims;
+};
+
+}  // namespace internal
+
+/**
+ * A read-only view of the integer values and dimensions of a variable
+ * of a <code>var_context</code>, as returned by
+ * <code>var_context::vals_i_view</code>.
+ *
+ * <p>Views of in-tree contexts point into the storage of the context
+ * and are valid until the context is destroyed or the variable is
+ * removed.  Views that had to copy the variable own their copy.
+ */
+class var_view_i {
+ public:
+  var_view_i() {}
+
+  /**
+   * Construct a view of values and dimensions held elsewhere.
+   *
+   * @param[in] values values in last-index-major order
+   * @param[in] dims dimensions
+   */
+  var_view_i(array_view<int> values, array_view<size_t> dims)
+      : values_(values), dims_(dims) {}
+
+  /**
+   * Construct a view owning a copy of the values and dimensions.
+   *
+   * @param[in] values values in last-index-major order
+   * @param[in] dims dimensions
+   */
+  var_view_i(std::vector<int>&& values, std::vector<size_t>&& dims) {
+    auto storage = std::make_shared<internal::var_view_storage<int>>();
+    storage->values = std::move(values);
+    storage->dims = std::move(dims);
+    values_ = storage->values;
+    dims_ = storage->dims;
+    owner_ = std::move(storage);
+  }
+
+  /**
+   * Return the values in last-index-major order.
+   */
+  const array_view<int>& values() const { return values_; }
+
+  /**
+   * Return the dimensions; empty for scalars and missing variables.
+   */
+  const array_view<size_t>& dims() const { return dims_; }
+
+  const int* data() const { return values_.data(); }
+  size_t size() const { return values_.size(); }
+  bool empty() const { return values_.empty(); }
+  int operator[](size_t i) const { return values_[i]; }
+
+  /**
+   * Return a copy of the values.
+   */
+  std::vector<int> to_vector() const { return values_.to_vector(); }
+
+ private:
+  array_view<int> values_;
+  array_view<size_t> dims_;
+  std::shared_ptr<const void> owner_;
+};
+
+/**
+ * A read-only view of the floating point values and dimensions of a
+ * variable of a <code>var_context</code>, as returned by
+ * <code>var_context::vals_r_view</code>.
+ *
+ * <p>Variables whose values are all integers may be stored as
+ * integers.  Their view points to the integers, which are converted to
+ * double on access, rather than to a converted copy; callers that need
+ * a pointer to doubles should check <code>is_int()</code>.
+ *
+ * <p>Views of in-tree contexts point into the storage of the context
+ * and are valid until the context is destroyed or the variable is
+ * removed.  Views that had to copy the variable own their copy.
+ */
+class var_view_r {
+ public:
+  var_view_r() {}
+
+  /**
+   * Construct a view of floating point values and dimensions held
+   * elsewhere.
+   *
+   * @param[in] values values in last-index-major order
+   * @param[in] dims dimensions
+   */
+  var_view_r(array_view<double> values, array_view<size_t> dims)
+      : values_(values), dims_(dims) {}
+
+  /**
+   * Construct a view of integer values and dimensions held elsewhere.
+   *
+   * @param[in] values values in last-index-major order
+   * @param[in] dims dimensions
+   */
+  var_view_r(array_view<int> values, array_view<size_t> dims)
+      : int_values_(values), dims_(dims) {}
+
+  /**
+   * Construct a view owning a copy of the values and dimensions.
+   *
+   * @param[in] values values in last-index-major order
+   * @param[in] dims dimensions
+   */
+  var_view_r(std::vector<double>&& values, std::vector<size_t>&& dims) {
+    auto storage = std::make_shared<internal::var_view_storage<double>>();
+    storage->values = std::move(values);
+    storage->dims = std::move(dims);
+    values_ = storage->values;
+    dims_ = storage->dims;
+    owner_ = std::move(storage);
+  }
+
+  /**
+   * Return <code>true</code> if the values are stored as integers.
+   */
+  bool is_int() const { return int_values_.data() != nullptr; }
+
+  /**
+   * Return the values stored as doubles; empty if the values are
+   * stored as integers.
+   */
+  const array_view<double>& values() const { return values_; }
+
+  /**
+   * Return the values stored as integers; empty if the values are
+   * stored as doubles.
+   */
+  const array_view<int>& int_values() const { return int_values_; }
+
+  /**
+   * Return the dimensions; empty for scalars and missing variables.
+   */
+  const array_view<size_t>& dims() const { return dims_; }
+
+  /**
+   * Return a pointer to the values stored as doubles, or
+   * <code>nullptr</code> if they are stored as integers.
+   */
+  const double* data() const { return values_.data(); }
+
+  size_t size() const { return is_int() ? int_values_.size() : values_.size(); }
+  bool empty() const { return size() == 0; }
+
+  /**
+   * Return the value at the given position as a double.
+   *
+   * @param[in] i position in last-index-major order
+   */
+  double operator[](size_t i) const {
+    return is_int() ? static_cast<double>(int_values_[i]) : values_[i];
+  }
+
+  /**
+   * Return a copy of the values as doubles.
+   */
+  std::vector<double> to_vector() const {
+    if (!is_int())
+      return values_.to_vector();
+    return std::vector<double>(int_values_.begin(), int_values_.end());
+  }
+
+ private:
+  array_view<double> values_;
+  array_view<int> int_values_;
+  array_view<size_t> dims_;
+  std::shared_ptr<const void> owner_;
+};
+
+}  // namespace io
+}  // namespace stan
+
+#endif
@@ -6,6 +6,7 @@
 #include <stan/analyze/mcmc/compute_effective_sample_size.hpp>
 #include <stan/analyze/mcmc/compute_potential_scale_reduction.hpp>
 #include <stan/analyze/mcmc/split_rank_normalized_rhat.hpp>
+#include <stan/analyze/mcmc/summarize_draws.hpp>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
 #include <boost/accumulators/statistics/mean.hpp>
@@ -21,6 +22,7 @@
 #include <stdexcept>
 #include <string>
 #include <sstream>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <cstdlib>
@@ -42,14 +44,26 @@ using Eigen::Dynamic;
  * as global or single-chain read or write methods.
  *
  * <p><b>Storage Order</b>: Storage is column/last-index major.
+ * The storage of each chain grows geometrically, so adding draws one
+ * at a time takes amortized constant time per draw.
  */
 template <typename Unused = void*>
 class chains {
  private:
   std::vector<std::string> param_names_;
+  std::unordered_map<std::string, int> param_index_;
+  /**
+   * Draws of each chain in its leading rows; the remaining rows are
+   * spare capacity.
+   */
   Eigen::Matrix<Eigen::MatrixXd, Dynamic, 1> samples_;
+  Eigen::VectorXi num_samples_;
   Eigen::VectorXi warmup_;
 
+  auto chain_draws(const int chain) const {
+    return samples_(chain).topRows(num_samples_(chain));
+  }
+
   static double mean(const Eigen::VectorXd& x) {
     return (x.array() / x.size()).sum();
   }
@@ -248,7 +262,11 @@ class chains {
 
  public:
   explicit chains(const std::vector<std::string>& param_names)
-      : param_names_(param_names) {}
+      : param_names_(param_names) {
+    param_index_.reserve(param_names_.size());
+    for (int i = 0; i < num_params(); i++)
+      param_index_.emplace(param_names_[i], i);
+  }
 
   explicit chains(const stan::io::stan_csv& stan_csv)
       : chains(stan_csv.header) {
@@ -265,11 +283,8 @@ class chains {
   const std::string& param_name(int j) const { return param_names_[j]; }
 
   int index(const std::string& name) const {
-    int index = -1;
-    for (int i = 0; i < param_names_.size(); i++)
-      if (param_names_[i] == name)
-        return i;
-    return index;
+    auto it = param_index_.find(name);
+    return it == param_index_.end() ? -1 : it->second;
   }
 
   void set_warmup(const int chain, const int warmup) {
@@ -282,7 +297,7 @@ class chains {
 
   int warmup(const int chain) const { return warmup_(chain); }
 
-  int num_samples(const int chain) const { return samples_(chain).rows(); }
+  int num_samples(const int chain) const { return num_samples_(chain); }
 
   int num_samples() const {
     int n = 0;
@@ -313,27 +328,30 @@ class chains {
       // Need this block for Windows. conservativeResize
       // does not keep the references.
       Eigen::Matrix<Eigen::MatrixXd, Dynamic, 1> samples_copy(num_chains());
-      Eigen::VectorXi warmup_copy(num_chains());
-      for (int i = 0; i < n; i++) {
-        samples_copy(i) = samples_(i);
-        warmup_copy(i) = warmup_(i);
-      }
+      for (int i = 0; i < n; i++)
+        samples_copy(i).swap(samples_(i));
 
       samples_.resize(chain + 1);
-      warmup_.resize(chain + 1);
-      for (int i = 0; i < n; i++) {
-        samples_(i) = samples_copy(i);
-        warmup_(i) = warmup_copy(i);
-      }
+      num_samples_.conservativeResize(chain + 1);
+      warmup_.conservativeResize(chain + 1);
+      for (int i = 0; i < n; i++)
+        samples_(i).swap(samples_copy(i));
       for (int i = n; i < chain + 1; i++) {
         samples_(i) = Eigen::MatrixXd(0, num_params());
+        num_samples_(i) = 0;
         warmup_(i) = 0;
       }
     }
-    int row = samples_(chain).rows();
-    Eigen::MatrixXd new_samples(row + sample.rows(), num_params());
-    new_samples << samples_(chain), sample;
-    samples_(chain) = new_samples;
+    int row = num_samples_(chain);
+    int rows = row + sample.rows();
+    if (rows > samples_(chain).rows()) {
+      int capacity = std::max<int>(rows, 2 * samples_(chain).rows());
+      Eigen::MatrixXd new_samples(capacity, num_params());
+      new_samples.topRows(row) = samples_(chain).topRows(row);
+      samples_(chain).swap(new_samples);
+    }
+    samples_(chain).middleRows(row, sample.rows()) = sample;
+    num_samples_(chain) = rows;
   }
 
   void add(const Eigen::MatrixXd& sample) {
@@ -384,8 +402,43 @@ class chains {
       set_warmup(num_chains() - 1, stan_csv.metadata.num_warmup);
   }
 
+  /**
+   * Add the draws of a csv file as a new chain, keeping only the
+   * columns of this object's parameters.
+   *
+   * Unlike <code>add(const stan_csv&)</code>, the header of the csv file
+   * may hold other columns and the parameters may be in any order.  To
+   * avoid parsing the other columns at all, read the file with
+   * <code>stan_csv_reader::parse(in, param_names(), out)</code>.
+   *
+   * @param stan_csv parsed csv file
+   * @throw std::invalid_argument if a parameter is not in the header
+   */
+  void add_selected(const stan::io::stan_csv& stan_csv) {
+    std::unordered_map<std::string, int> header_index;
+    header_index.reserve(stan_csv.header.size());
+    for (size_t j = 0; j < stan_csv.header.size(); j++)
+      header_index.emplace(stan_csv.header[j], j);
+    Eigen::MatrixXd sample(stan_csv.samples.rows(), num_params());
+    for (int i = 0; i < num_params(); i++) {
+      auto it = header_index.find(param_names_[i]);
+      if (it == header_index.end()) {
+        std::stringstream ss;
+        ss << "add_selected(stan_csv): parameter " << param_names_[i]
+           << " not found in header";
+        throw std::invalid_argument(ss.str());
+      }
+      sample.col(i) = stan_csv.samples.col(it->second);
+    }
+    if (sample.rows() == 0)
+      return;
+    add(num_chains(), sample);
+    if (stan_csv.metadata.save_warmup)
+      set_warmup(num_chains() - 1, stan_csv.metadata.num_warmup);
+  }
+
   Eigen::VectorXd samples(const int chain, const int index) const {
-    return samples_(chain).col(index).bottomRows(num_kept_samples(chain));
+    return chain_draws(chain).col(index).bottomRows(num_kept_samples(chain));
   }
 
   Eigen::VectorXd samples(const int index) const {
@@ -393,7 +446,7 @@ class chains {
     int start = 0;
     for (int chain = 0; chain < num_chains(); chain++) {
       int n = num_kept_samples(chain);
-      s.middleRows(start, n) = samples_(chain).col(index).bottomRows(n);
+      s.middleRows(start, n) = chain_draws(chain).col(index).bottomRows(n);
       start += n;
     }
     return s;
@@ -567,7 +620,7 @@ class chains {
     for (int chain = 0; chain < n_chains; ++chain) {
       n_kept_samples = num_kept_samples(chain);
       draws[chain]
-          = samples_(chain).col(index).bottomRows(n_kept_samples).data();
+          = chain_draws(chain).col(index).bottomRows(n_kept_samples).data();
       sizes[chain] = n_kept_samples;
     }
     return analyze::compute_effective_sample_size(draws, sizes);
@@ -585,7 +638,7 @@ class chains {
     for (int chain = 0; chain < n_chains; ++chain) {
       n_kept_samples = num_kept_samples(chain);
       draws[chain]
-          = samples_(chain).col(index).bottomRows(n_kept_samples).data();
+          = chain_draws(chain).col(index).bottomRows(n_kept_samples).data();
       sizes[chain] = n_kept_samples;
     }
 
@@ -604,7 +657,7 @@ class chains {
     for (int chain = 0; chain < n_chains; ++chain) {
       n_kept_samples = num_kept_samples(chain);
       draws[chain]
-          = samples_(chain).col(index).bottomRows(n_kept_samples).data();
+          = chain_draws(chain).col(index).bottomRows(n_kept_samples).data();
       sizes[chain] = n_kept_samples;
     }
 
@@ -624,7 +677,7 @@ class chains {
     }
     Eigen::MatrixXd chains(n_kept_samples, n_chains);
     for (size_t i = 0; i < n_chains; ++i) {
-      auto bottom_rows = samples_(i).col(index).bottomRows(n_kept_samples);
+      auto bottom_rows = chain_draws(i).col(index).bottomRows(n_kept_samples);
       chains.col(i) = bottom_rows.eval();
     }
     return analyze::split_rank_normalized_rhat(chains);
@@ -634,6 +687,27 @@ class chains {
       const std::string& name) const {
     return split_potential_scale_reduction_rank(index(name));
   }
+
+  /**
+   * Summarize all parameters at once, in parallel; see
+   * <code>analyze::summarize_draws</code>.  Like
+   * <code>split_potential_scale_reduction_rank</code>, this uses the
+   * last <code>n</code> kept draws of every chain, where <code>n</code>
+   * is the smallest number of kept draws in a chain.
+   *
+   * @param probs probabilities of the quantiles to compute
+   * @return summary with one entry per parameter
+   */
+  analyze::draws_summary summary(const Eigen::VectorXd& probs) const {
+    int n_kept_samples = std::numeric_limits<int>::max();
+    for (int chain = 0; chain < num_chains(); ++chain)
+      n_kept_samples = std::min(n_kept_samples, num_kept_samples(chain));
+    std::vector<Eigen::MatrixXd> draws;
+    draws.reserve(num_chains());
+    for (int chain = 0; chain < num_chains(); ++chain)
+      draws.emplace_back(chain_draws(chain).bottomRows(n_kept_samples));
+    return analyze::summarize_draws(draws, probs);
+  }
 };
 
 }  // namespace mcmc
@@ -21,20 +21,16 @@ class covar_adaptation : public windowed_adaptation {
     if (end_adaptation_window()) {
       compute_next_window();
 
+      if (defer_update_) {
+        update_pending_ = true;
+        ++adapt_window_counter_;
+        return false;
+      }
+
       estimator_.sample_covariance(covar);
 
       double n = static_cast<double>(estimator_.num_samples());
-      covar = (n / (n + 5.0)) * covar
-              + 1e-3 * (5.0 / (n + 5.0))
-                    * Eigen::MatrixXd::Identity(covar.rows(), covar.cols());
-
-      if (!covar.allFinite())
-        throw std::runtime_error(
-            "Numerical overflow in metric adaptation. "
-            "This occurs when the sampler encounters extreme values on the "
-            "unconstrained space; this may happen when the posterior density "
-            "function is too wide or improper. "
-            "There may be problems with your model specification.");
+      regularize_covariance(covar, n);
 
       estimator_.restart();
 
@@ -46,8 +42,74 @@ class covar_adaptation : public windowed_adaptation {
     return false;
   }
 
+  /**
+   * Compute the regularized covariance of the draws collected during
+   * the last adaptation window by all of the given adaptations, as if
+   * the draws had been fed to a single estimator, and restart each
+   * estimator.  Used with deferred updates to share one metric between
+   * chains run in parallel.
+   *
+   * @param[in,out] adaptations Adaptations to pool, all of the same
+   * dimension
+   * @param[out] covar Pooled covariance
+   * @throw std::runtime_error if the pooled covariance is not finite
+   */
+  static void pool_covariance(
+      const std::vector<covar_adaptation*>& adaptations,
+      Eigen::MatrixXd& covar) {
+    const Eigen::Index dim = covar.rows();
+    double n_total = 0;
+    Eigen::VectorXd mean_total = Eigen::VectorXd::Zero(dim);
+    Eigen::VectorXd mean(dim);
+    for (covar_adaptation* adaptation : adaptations) {
+      double n = adaptation->estimator_.num_samples();
+      adaptation->estimator_.sample_mean(mean);
+      n_total += n;
+      mean_total += n * mean;
+    }
+    if (n_total > 0)
+      mean_total /= n_total;
+
+    // Combine the sums of squared deviations of each estimator about
+    // its own mean with the spread of the means about the pooled mean
+    Eigen::MatrixXd m2 = Eigen::MatrixXd::Zero(dim, dim);
+    Eigen::MatrixXd chain_covar(dim, dim);
+    for (covar_adaptation* adaptation : adaptations) {
+      double n = adaptation->estimator_.num_samples();
+      if (n > 1) {
+        adaptation->estimator_.sample_covariance(chain_covar);
+        m2 += (n - 1) * chain_covar;
+      }
+      if (n > 0) {
+        adaptation->estimator_.sample_mean(mean);
+        mean -= mean_total;
+        m2 += n * mean * mean.transpose();
+      }
+      adaptation->estimator_.restart();
+      adaptation->update_pending_ = false;
+    }
+
+    if (n_total > 1)
+      covar = m2 / (n_total - 1);
+    regularize_covariance(covar, n_total);
+  }
+
  protected:
   stan::math::welford_covar_estimator estimator_;
+
+  static void regularize_covariance(Eigen::MatrixXd& covar, double n) {
+    covar = (n / (n + 5.0)) * covar
+            + 1e-3 * (5.0 / (n + 5.0))
+                  * Eigen::MatrixXd::Identity(covar.rows(), covar.cols());
+
+    if (!covar.allFinite())
+      throw std::runtime_error(
+          "Numerical overflow in metric adaptation. "
+          "This occurs when the sampler encounters extreme values on the "
+          "unconstrained space; this may happen when the posterior density "
+          "function is too wide or improper. "
+          "There may be problems with your model specification.");
+  }
 };
 
 }  // namespace mcmc
@@ -17,6 +17,14 @@ class dense_e_point : public ps_point {
    */
   Eigen::MatrixXd inv_e_metric_;
 
+  /**
+   * Cholesky factorization of the inverse mass matrix, used to
+   * draw momenta without refactorizing on every transition.  Must
+   * be refreshed with <code>update_metric_factorization()</code>
+   * whenever <code>inv_e_metric_</code> is modified in place.
+   */
+  Eigen::LLT<Eigen::MatrixXd> inv_e_metric_llt_;
+
   /**
    * Construct a dense point in n-dimensional phase space
    * with identity matrix as inverse mass matrix.
@@ -25,6 +33,7 @@ class dense_e_point : public ps_point {
    */
   explicit dense_e_point(int n) : ps_point(n), inv_e_metric_(n, n) {
     inv_e_metric_.setIdentity();
+    update_metric_factorization();
   }
 
   /**
@@ -34,6 +43,15 @@ class dense_e_point : public ps_point {
    */
   void set_metric(const Eigen::MatrixXd& inv_e_metric) {
     inv_e_metric_ = inv_e_metric;
+    update_metric_factorization();
+  }
+
+  /**
+   * Recompute the cached Cholesky factorization from the current
+   * inverse mass matrix.
+   */
+  void update_metric_factorization() {
+    inv_e_metric_llt_.compute(inv_e_metric_);
   }
 
   /**
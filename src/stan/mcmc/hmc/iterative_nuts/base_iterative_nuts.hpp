@@ -0,0 +1,576 @@
+#ifndef STAN_MCMC_HMC_ITERATIVE_NUTS_BASE_ITERATIVE_NUTS_HPP
+#define STAN_MCMC_HMC_ITERATIVE_NUTS_BASE_ITERATIVE_NUTS_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/base_hmc.hpp>
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <stan/mcmc/hmc/nuts/nuts_workspace.hpp>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Pending subtree on the explicit stack of the iterative tree
+ * builder.  The pointers refer to the storage that the equivalent
+ * recursive call of <code>base_nuts::build_tree</code> would have
+ * received by reference.
+ */
+struct iterative_nuts_frame {
+  // Depth of the subtree
+  int depth;
+
+  // 0 = build initial subtree, 1 = build final subtree, 2 = merge
+  int stage;
+
+  ps_point* z_propose;
+  Eigen::VectorXd* p_sharp_beg;
+  Eigen::VectorXd* p_sharp_end;
+  Eigen::VectorXd* rho;
+  Eigen::VectorXd* p_beg;
+  Eigen::VectorXd* p_end;
+  double* log_sum_weight;
+
+  double log_sum_weight_init;
+  double log_sum_weight_final;
+};
+
+/**
+ * The No-U-Turn sampler (NUTS) with multinomial sampling, with the
+ * trajectory built iteratively from an explicit stack of pending
+ * subtrees instead of recursively.
+ *
+ * Subtrees are visited in the same order and consume random numbers
+ * in the same order as <code>base_nuts</code>, so for the same seed
+ * both samplers produce the same draws.
+ *
+ * Because the builder state lives in the sampler rather than on the
+ * call stack, a transition can be suspended whenever a leapfrog step
+ * is required.  <code>begin_transition()</code>,
+ * <code>advance_transition()</code> and <code>end_transition()</code>
+ * expose this, so that a driver such as
+ * <code>iterative_nuts_batch_transition()</code> can advance several
+ * samplers in lockstep and evaluate all of their pending gradients
+ * with a single batched call.
+ */
+template <class Model, template <class, class> class Hamiltonian,
+          template <class> class Integrator, class BaseRNG>
+class base_iterative_nuts
+    : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
+ public:
+  base_iterative_nuts(const Model& model, BaseRNG& rng)
+      : base_hmc<Model, Hamiltonian, Integrator, BaseRNG>(model, rng),
+        depth_(0),
+        max_depth_(5),
+        max_deltaH_(1000),
+        n_leapfrog_(0),
+        divergent_(false),
+        energy_(0),
+        workspace_(model.num_params_r()) {}
+
+  ~base_iterative_nuts() {}
+
+  void set_metric(const Eigen::MatrixXd& inv_e_metric) {
+    this->z_.set_metric(inv_e_metric);
+  }
+
+  void set_metric(const Eigen::VectorXd& inv_e_metric) {
+    this->z_.set_metric(inv_e_metric);
+  }
+
+  void set_max_depth(int d) {
+    if (d > 0)
+      max_depth_ = d;
+  }
+
+  void set_max_delta(double d) { max_deltaH_ = d; }
+
+  int get_max_depth() { return this->max_depth_; }
+  double get_max_delta() { return this->max_deltaH_; }
+
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    begin_transition(init_sample, logger);
+    while (advance_transition(logger))
+      this->integrator_.evolve(this->z_, this->hamiltonian_,
+                               leapfrog_stepsize(), logger);
+    return end_transition(logger);
+  }
+
+  /**
+   * Start a new transition from the given sample: jitter the step
+   * size, draw a momentum and evaluate the initial gradient.
+   *
+   * @param init_sample Sample to start the trajectory from
+   * @param logger Logger for messages
+   */
+  void begin_transition(sample& init_sample, callbacks::logger& logger) {
+    this->sample_stepsize();
+
+    this->seed(init_sample.cont_params());
+
+    this->hamiltonian_.sample_p(this->z_, this->rand_int_);
+    this->hamiltonian_.init(this->z_, logger);
+
+    workspace_.reserve_depth(this->max_depth_);
+    stack_.reserve(this->max_depth_ + 1);
+
+    workspace_.z_fwd = this->z_;
+    workspace_.z_bck = workspace_.z_fwd;
+    workspace_.z_sample = workspace_.z_fwd;
+    workspace_.z_propose = workspace_.z_fwd;
+
+    workspace_.p_fwd_fwd = this->z_.p;
+    workspace_.p_sharp_fwd_fwd = this->hamiltonian_.dtau_dp(this->z_);
+    workspace_.p_fwd_bck = this->z_.p;
+    workspace_.p_sharp_fwd_bck = workspace_.p_sharp_fwd_fwd;
+    workspace_.p_bck_fwd = this->z_.p;
+    workspace_.p_sharp_bck_fwd = workspace_.p_sharp_fwd_fwd;
+    workspace_.p_bck_bck = this->z_.p;
+    workspace_.p_sharp_bck_bck = workspace_.p_sharp_fwd_fwd;
+
+    workspace_.rho = this->z_.p;
+
+    log_sum_weight_ = 0;  // log(exp(H0 - H0))
+    H0_ = this->hamiltonian_.H(this->z_);
+    n_leapfrog_tree_ = 0;
+    sum_metro_prob_ = 0;
+
+    this->depth_ = 0;
+    this->divergent_ = false;
+
+    begin_subtree();
+  }
+
+  /**
+   * Continue building the trajectory.  Returns true when the builder
+   * is suspended waiting for the current point <code>z()</code> to be
+   * evolved by one leapfrog step of size <code>leapfrog_stepsize()</code>,
+   * and false once the trajectory is complete.
+   *
+   * @param logger Logger for messages
+   * @return true if a leapfrog step is pending
+   */
+  bool advance_transition(callbacks::logger& logger) {
+    while (!trajectory_done_) {
+      if (advance_tree(logger))
+        return true;
+
+      if (sign_ > 0)
+        workspace_.z_fwd.ps_point::operator=(this->z_);
+      else
+        workspace_.z_bck.ps_point::operator=(this->z_);
+
+      if (!tree_valid_ || !merge_subtree()) {
+        trajectory_done_ = true;
+        break;
+      }
+
+      begin_subtree();
+    }
+    return false;
+  }
+
+  /**
+   * Finish a completed transition and return the selected sample.
+   *
+   * @param logger Logger for messages
+   * @return Sample selected from the trajectory
+   */
+  virtual sample end_transition(callbacks::logger& logger) {
+    this->n_leapfrog_ = n_leapfrog_tree_;
+
+    // Compute average acceptance probability across entire trajectory,
+    // even over subtrees that may have been rejected
+    double accept_prob
+        = sum_metro_prob_ / static_cast<double>(n_leapfrog_tree_);
+
+    this->z_.ps_point::operator=(workspace_.z_sample);
+    this->energy_ = this->hamiltonian_.H(this->z_);
+    return sample(this->z_.q, -this->z_.V, accept_prob);
+  }
+
+  /**
+   * Signed step size of the pending leapfrog step.
+   */
+  double leapfrog_stepsize() const noexcept { return sign_ * this->epsilon_; }
+
+  /**
+   * Apply the first half of a pending explicit leapfrog step: the
+   * initial momentum half step followed by the full position step.
+   * The caller must then supply the log density and its gradient at
+   * the new position through <code>end_leapfrog()</code>.
+   *
+   * @param logger Logger for messages
+   */
+  void begin_leapfrog(callbacks::logger& logger) {
+    double epsilon = leapfrog_stepsize();
+    this->integrator_.begin_update_p(this->z_, this->hamiltonian_,
+                                     0.5 * epsilon, logger);
+    this->z_.q += epsilon * this->hamiltonian_.dtau_dp(this->z_);
+  }
+
+  /**
+   * Complete a pending explicit leapfrog step given the log density
+   * and its gradient at the position produced by
+   * <code>begin_leapfrog()</code>.
+   *
+   * @param log_prob Log density at the new position
+   * @param grad Gradient of the log density at the new position
+   * @param logger Logger for messages
+   */
+  template <typename Vec>
+  void end_leapfrog(double log_prob, const Vec& grad,
+                    callbacks::logger& logger) {
+    this->z_.V = -log_prob;
+    this->z_.g = -grad;
+    this->integrator_.end_update_p(this->z_, this->hamiltonian_,
+                                   0.5 * leapfrog_stepsize(), logger);
+  }
+
+  void get_sampler_param_names(std::vector<std::string>& names) {
+    names.push_back("stepsize__");
+    names.push_back("treedepth__");
+    names.push_back("n_leapfrog__");
+    names.push_back("divergent__");
+    names.push_back("energy__");
+  }
+
+  void get_sampler_params(std::vector<double>& values) {
+    values.push_back(this->epsilon_);
+    values.push_back(this->depth_);
+    values.push_back(this->n_leapfrog_);
+    values.push_back(this->divergent_);
+    values.push_back(this->energy_);
+  }
+
+  virtual bool compute_criterion(Eigen::VectorXd& p_sharp_minus,
+                                 Eigen::VectorXd& p_sharp_plus,
+                                 Eigen::VectorXd& rho) {
+    return p_sharp_plus.dot(rho) > 0 && p_sharp_minus.dot(rho) > 0;
+  }
+
+  /**
+   * Build a new subtree to completion or until the subtree becomes
+   * invalid.  Returns validity of the resulting subtree.  Equivalent
+   * to <code>base_nuts::build_tree</code>, but driven from an explicit
+   * stack of pending subtrees.
+   *
+   * @param depth Depth of the desired subtree
+   * @param z_propose State proposed from subtree
+   * @param p_sharp_beg Sharp momentum at beginning of new tree
+   * @param p_sharp_end Sharp momentum at end of new tree
+   * @param rho Summed momentum across trajectory
+   * @param p_beg Momentum at beginning of returned tree
+   * @param p_end Momentum at end of returned tree
+   * @param H0 Hamiltonian of initial state
+   * @param sign Direction in time to built subtree
+   * @param n_leapfrog Summed number of leapfrog evaluations
+   * @param log_sum_weight Log of summed weights across trajectory
+   * @param sum_metro_prob Summed Metropolis probabilities across trajectory
+   * @param logger Logger for messages
+   */
+  bool build_tree(int depth, ps_point& z_propose, Eigen::VectorXd& p_sharp_beg,
+                  Eigen::VectorXd& p_sharp_end, Eigen::VectorXd& rho,
+                  Eigen::VectorXd& p_beg, Eigen::VectorXd& p_end, double H0,
+                  double sign, int& n_leapfrog, double& log_sum_weight,
+                  double& sum_metro_prob, callbacks::logger& logger) {
+    H0_ = H0;
+    sign_ = sign;
+    n_leapfrog_tree_ = n_leapfrog;
+    sum_metro_prob_ = sum_metro_prob;
+
+    begin_tree(depth, z_propose, p_sharp_beg, p_sharp_end, rho, p_beg, p_end,
+               log_sum_weight);
+    while (advance_tree(logger))
+      this->integrator_.evolve(this->z_, this->hamiltonian_,
+                               leapfrog_stepsize(), logger);
+
+    n_leapfrog = n_leapfrog_tree_;
+    sum_metro_prob = sum_metro_prob_;
+    return tree_valid_;
+  }
+
+  int depth_;
+  int max_depth_;
+  double max_deltaH_;
+
+  int n_leapfrog_;
+  bool divergent_;
+  double energy_;
+
+ protected:
+  /**
+   * Preallocated states and momenta reused across transitions.
+   */
+  nuts_workspace workspace_;
+
+  /**
+   * Pending subtrees, innermost last.
+   */
+  std::vector<iterative_nuts_frame> stack_;
+
+  double H0_{0};
+  double sign_{1};
+  int n_leapfrog_tree_{0};
+  double sum_metro_prob_{0};
+  double log_sum_weight_{0};
+  double log_sum_weight_subtree_{0};
+  bool leaf_pending_{false};
+  bool tree_valid_{false};
+  bool trajectory_done_{true};
+
+  /**
+   * Start a new subtree in a random direction, or finish the
+   * trajectory once the maximum depth has been reached.
+   */
+  void begin_subtree() {
+    if (this->depth_ >= this->max_depth_) {
+      trajectory_done_ = true;
+      return;
+    }
+    trajectory_done_ = false;
+
+    nuts_workspace& ws = workspace_;
+    ws.rho_fwd.setZero();
+    ws.rho_bck.setZero();
+    log_sum_weight_subtree_ = -std::numeric_limits<double>::infinity();
+
+    if (this->rand_uniform_() > 0.5) {
+      // Extend the current trajectory forward
+      this->z_.ps_point::operator=(ws.z_fwd);
+      ws.rho_bck = ws.rho;
+      ws.p_bck_fwd = ws.p_fwd_fwd;
+      ws.p_sharp_bck_fwd = ws.p_sharp_fwd_fwd;
+
+      sign_ = 1;
+      begin_tree(this->depth_, ws.z_propose, ws.p_sharp_fwd_bck,
+                 ws.p_sharp_fwd_fwd, ws.rho_fwd, ws.p_fwd_bck, ws.p_fwd_fwd,
+                 log_sum_weight_subtree_);
+    } else {
+      // Extend the current trajectory backwards
+      this->z_.ps_point::operator=(ws.z_bck);
+      ws.rho_fwd = ws.rho;
+      ws.p_fwd_bck = ws.p_bck_bck;
+      ws.p_sharp_fwd_bck = ws.p_sharp_bck_bck;
+
+      sign_ = -1;
+      begin_tree(this->depth_, ws.z_propose, ws.p_sharp_bck_fwd,
+                 ws.p_sharp_bck_bck, ws.rho_bck, ws.p_bck_fwd, ws.p_bck_bck,
+                 log_sum_weight_subtree_);
+    }
+  }
+
+  /**
+   * Merge a completed, valid subtree into the trajectory.  Returns
+   * false when the no-u-turn criterion is no longer satisfied.
+   */
+  bool merge_subtree() {
+    nuts_workspace& ws = workspace_;
+
+    // Sample from accepted subtree
+    ++(this->depth_);
+
+    if (log_sum_weight_subtree_ > log_sum_weight_) {
+      ws.z_sample = ws.z_propose;
+    } else {
+      double accept_prob = std::exp(log_sum_weight_subtree_ - log_sum_weight_);
+      if (this->rand_uniform_() < accept_prob)
+        ws.z_sample = ws.z_propose;
+    }
+
+    log_sum_weight_
+        = math::log_sum_exp(log_sum_weight_, log_sum_weight_subtree_);
+
+    // Break when no-u-turn criterion is no longer satisfied
+    ws.rho = ws.rho_bck + ws.rho_fwd;
+
+    // Demand satisfaction around merged subtrees
+    bool persist_criterion
+        = compute_criterion(ws.p_sharp_bck_bck, ws.p_sharp_fwd_fwd, ws.rho);
+
+    // Demand satisfaction between subtrees
+    ws.rho_extended = ws.rho_bck + ws.p_fwd_bck;
+
+    persist_criterion &= compute_criterion(ws.p_sharp_bck_bck,
+                                           ws.p_sharp_fwd_bck, ws.rho_extended);
+
+    ws.rho_extended = ws.rho_fwd + ws.p_bck_fwd;
+    persist_criterion &= compute_criterion(ws.p_sharp_bck_fwd,
+                                           ws.p_sharp_fwd_fwd, ws.rho_extended);
+
+    return persist_criterion;
+  }
+
+  /**
+   * Push the root of a new subtree onto the stack.
+   */
+  void begin_tree(int depth, ps_point& z_propose, Eigen::VectorXd& p_sharp_beg,
+                  Eigen::VectorXd& p_sharp_end, Eigen::VectorXd& rho,
+                  Eigen::VectorXd& p_beg, Eigen::VectorXd& p_end,
+                  double& log_sum_weight) {
+    workspace_.reserve_depth(depth);
+    stack_.reserve(depth + 1);
+    stack_.clear();
+    leaf_pending_ = false;
+    tree_valid_ = false;
+    push_frame(depth, &z_propose, &p_sharp_beg, &p_sharp_end, &rho, &p_beg,
+               &p_end, &log_sum_weight);
+  }
+
+  void push_frame(int depth, ps_point* z_propose, Eigen::VectorXd* p_sharp_beg,
+                  Eigen::VectorXd* p_sharp_end, Eigen::VectorXd* rho,
+                  Eigen::VectorXd* p_beg, Eigen::VectorXd* p_end,
+                  double* log_sum_weight) {
+    iterative_nuts_frame frame;
+    frame.depth = depth;
+    frame.stage = 0;
+    frame.z_propose = z_propose;
+    frame.p_sharp_beg = p_sharp_beg;
+    frame.p_sharp_end = p_sharp_end;
+    frame.rho = rho;
+    frame.p_beg = p_beg;
+    frame.p_end = p_end;
+    frame.log_sum_weight = log_sum_weight;
+    frame.log_sum_weight_init = -std::numeric_limits<double>::infinity();
+    frame.log_sum_weight_final = -std::numeric_limits<double>::infinity();
+    stack_.push_back(frame);
+  }
+
+  /**
+   * Pop the innermost subtree.  An invalid subtree invalidates every
+   * enclosing subtree, so the whole stack is discarded.
+   */
+  void pop_frame(bool valid) {
+    stack_.pop_back();
+    if (!valid)
+      stack_.clear();
+    tree_valid_ = valid;
+  }
+
+  /**
+   * Process pending subtrees until a leapfrog step is required, in
+   * which case true is returned, or until the root subtree has been
+   * completed, in which case <code>tree_valid_</code> holds its
+   * validity and false is returned.
+   */
+  bool advance_tree(callbacks::logger& logger) {
+    while (!stack_.empty()) {
+      iterative_nuts_frame& frame = stack_.back();
+
+      // Base case
+      if (frame.depth == 0) {
+        if (!leaf_pending_) {
+          leaf_pending_ = true;
+          return true;
+        }
+        leaf_pending_ = false;
+        pop_frame(complete_leaf(frame));
+        continue;
+      }
+
+      // General recursion
+      nuts_tree_level& level = workspace_.level(frame.depth);
+
+      if (frame.stage == 0) {
+        // Build the initial subtree
+        frame.stage = 1;
+        level.rho_init.setZero();
+        push_frame(frame.depth - 1, frame.z_propose, frame.p_sharp_beg,
+                   &level.p_sharp_init_end, &level.rho_init, frame.p_beg,
+                   &level.p_init_end, &frame.log_sum_weight_init);
+      } else if (frame.stage == 1) {
+        // Build the final subtree
+        frame.stage = 2;
+        level.z_propose_final = this->z_;
+        level.rho_final.setZero();
+        push_frame(frame.depth - 1, &level.z_propose_final,
+                   &level.p_sharp_final_beg, frame.p_sharp_end,
+                   &level.rho_final, &level.p_final_beg, frame.p_end,
+                   &frame.log_sum_weight_final);
+      } else {
+        pop_frame(merge_frame(frame, level));
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Account for the leapfrog step that has just been taken at the
+   * bottom of the tree.
+   */
+  bool complete_leaf(iterative_nuts_frame& frame) {
+    ++n_leapfrog_tree_;
+
+    double h = this->hamiltonian_.H(this->z_);
+    if (std::isnan(h))
+      h = std::numeric_limits<double>::infinity();
+
+    if ((h - H0_) > this->max_deltaH_)
+      this->divergent_ = true;
+
+    *frame.log_sum_weight = math::log_sum_exp(*frame.log_sum_weight, H0_ - h);
+
+    if (H0_ - h > 0)
+      sum_metro_prob_ += 1;
+    else
+      sum_metro_prob_ += std::exp(H0_ - h);
+
+    *frame.z_propose = this->z_;
+
+    *frame.p_sharp_beg = this->hamiltonian_.dtau_dp(this->z_);
+    *frame.p_sharp_end = *frame.p_sharp_beg;
+
+    *frame.rho += this->z_.p;
+    *frame.p_beg = this->z_.p;
+    *frame.p_end = *frame.p_beg;
+
+    return !this->divergent_;
+  }
+
+  /**
+   * Combine the initial and final subtrees of a completed frame.
+   */
+  bool merge_frame(iterative_nuts_frame& frame, nuts_tree_level& level) {
+    // Multinomial sample from right subtree
+    double log_sum_weight_subtree = math::log_sum_exp(
+        frame.log_sum_weight_init, frame.log_sum_weight_final);
+    *frame.log_sum_weight
+        = math::log_sum_exp(*frame.log_sum_weight, log_sum_weight_subtree);
+
+    if (frame.log_sum_weight_final > log_sum_weight_subtree) {
+      *frame.z_propose = level.z_propose_final;
+    } else {
+      double accept_prob
+          = std::exp(frame.log_sum_weight_final - log_sum_weight_subtree);
+      if (this->rand_uniform_() < accept_prob)
+        *frame.z_propose = level.z_propose_final;
+    }
+
+    Eigen::VectorXd& rho_subtree = level.rho_subtree;
+    rho_subtree = level.rho_init + level.rho_final;
+    *frame.rho += rho_subtree;
+
+    // Demand satisfaction around merged subtrees
+    bool persist_criterion = compute_criterion(
+        *frame.p_sharp_beg, *frame.p_sharp_end, rho_subtree);
+
+    // Demand satisfaction between subtrees
+    rho_subtree = level.rho_init + level.p_final_beg;
+    persist_criterion &= compute_criterion(
+        *frame.p_sharp_beg, level.p_sharp_final_beg, rho_subtree);
+
+    rho_subtree = level.rho_final + level.p_init_end;
+    persist_criterion &= compute_criterion(level.p_sharp_init_end,
+                                           *frame.p_sharp_end, rho_subtree);
+
+    return persist_criterion;
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,100 @@
+#ifndef STAN_MCMC_HMC_ITERATIVE_NUTS_BATCH_TRANSITION_HPP
+#define STAN_MCMC_HMC_ITERATIVE_NUTS_BATCH_TRANSITION_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/sample.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Advance each of a set of iterative NUTS samplers by one transition,
+ * running their trajectories in lockstep.  Whenever samplers are
+ * waiting on a leapfrog step, the positions of all of them are
+ * gathered into the columns of a matrix and their log densities and
+ * gradients are computed with a single call to the batched functor.
+ *
+ * The functor must have the signature
+ *
+ *   <code>void(const Eigen::MatrixXd& q, Eigen::VectorXd& log_prob,
+ *   Eigen::MatrixXd& grad)</code>
+ *
+ * where column <code>j</code> of <code>q</code> is an unconstrained
+ * position, <code>log_prob(j)</code> must be set to the log density,
+ * with constants dropped and Jacobian included as for
+ * <code>log_prob_propto</code>, and column <code>j</code> of
+ * <code>grad</code> to its gradient.  Positions outside the support
+ * must be reported with a log density of negative infinity rather
+ * than by throwing.  <code>log_prob</code> and <code>grad</code> are
+ * already sized on entry.
+ *
+ * Every sampler draws its own random numbers exactly as in
+ * <code>transition()</code>, so each chain's draws do not depend on
+ * how the chains are batched.  Only explicit leapfrog integrators on
+ * Euclidean metrics are supported.
+ *
+ * @tparam Sampler An iterative NUTS sampler type
+ * @tparam F Type of batched log density and gradient functor
+ * @param[in,out] samplers Samplers to advance
+ * @param[in,out] samples On input the current sample of each
+ * sampler, on output the new sample
+ * @param[in] log_prob_grad Batched log density and gradient functor
+ * @param[in,out] logger Logger for messages
+ * @throw std::invalid_argument if the numbers of samplers and samples
+ * differ
+ */
+template <class Sampler, class F>
+void iterative_nuts_batch_transition(std::vector<Sampler>& samplers,
+                                     std::vector<sample>& samples,
+                                     F&& log_prob_grad,
+                                     callbacks::logger& logger) {
+  if (samplers.size() != samples.size())
+    throw std::invalid_argument(
+        "Number of samplers and samples must match in "
+        "iterative_nuts_batch_transition");
+  const size_t num_chains = samplers.size();
+  if (num_chains == 0)
+    return;
+  const Eigen::Index num_params = samples[0].cont_params().size();
+
+  std::vector<size_t> pending;
+  pending.reserve(num_chains);
+  for (size_t n = 0; n < num_chains; ++n) {
+    samplers[n].begin_transition(samples[n], logger);
+    if (samplers[n].advance_transition(logger))
+      pending.push_back(n);
+  }
+
+  while (!pending.empty()) {
+    const Eigen::Index batch_size = pending.size();
+    Eigen::MatrixXd q(num_params, batch_size);
+    for (Eigen::Index j = 0; j < batch_size; ++j) {
+      Sampler& sampler = samplers[pending[j]];
+      sampler.begin_leapfrog(logger);
+      q.col(j) = sampler.z().q;
+    }
+
+    Eigen::VectorXd log_prob(batch_size);
+    Eigen::MatrixXd grad(num_params, batch_size);
+    log_prob_grad(q, log_prob, grad);
+
+    size_t still_pending = 0;
+    for (Eigen::Index j = 0; j < batch_size; ++j) {
+      Sampler& sampler = samplers[pending[j]];
+      sampler.end_leapfrog(log_prob(j), grad.col(j), logger);
+      if (sampler.advance_transition(logger))
+        pending[still_pending++] = pending[j];
+    }
+    pending.resize(still_pending);
+  }
+
+  for (size_t n = 0; n < num_chains; ++n)
+    samples[n] = samplers[n].end_transition(logger);
+}
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
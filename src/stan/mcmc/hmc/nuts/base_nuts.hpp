@@ -5,6 +5,7 @@
 #include <stan/math/prim.hpp>
 #include <stan/mcmc/hmc/base_hmc.hpp>
 #include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <stan/mcmc/hmc/nuts/nuts_workspace.hpp>
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -27,7 +28,8 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         max_deltaH_(1000),
         n_leapfrog_(0),
         divergent_(false),
-        energy_(0) {}
+        energy_(0),
+        workspace_(model.num_params_r()) {}
 
   /**
    * specialized constructor for specified diag mass matrix
@@ -40,7 +42,8 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         max_deltaH_(1000),
         n_leapfrog_(0),
         divergent_(false),
-        energy_(0) {}
+        energy_(0),
+        workspace_(model.num_params_r()) {}
 
   /**
    * specialized constructor for specified dense mass matrix
@@ -53,7 +56,8 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         max_deltaH_(1000),
         n_leapfrog_(0),
         divergent_(false),
-        energy_(0) {}
+        energy_(0),
+        workspace_(model.num_params_r()) {}
 
   ~base_nuts() {}
 
@@ -84,30 +88,49 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     this->hamiltonian_.sample_p(this->z_, this->rand_int_);
     this->hamiltonian_.init(this->z_, logger);
 
-    ps_point z_fwd(this->z_);  // State at forward end of trajectory
-    ps_point z_bck(z_fwd);     // State at backward end of trajectory
+    workspace_.reserve_depth(this->max_depth_);
 
-    ps_point z_sample(z_fwd);
-    ps_point z_propose(z_fwd);
+    ps_point& z_fwd = workspace_.z_fwd;  // State at forward end of trajectory
+    ps_point& z_bck = workspace_.z_bck;  // State at backward end of trajectory
+    z_fwd = this->z_;
+    z_bck = z_fwd;
+
+    ps_point& z_sample = workspace_.z_sample;
+    ps_point& z_propose = workspace_.z_propose;
+    z_sample = z_fwd;
+    z_propose = z_fwd;
 
     // Momentum and sharp momentum at forward end of forward subtree
-    Eigen::VectorXd p_fwd_fwd = this->z_.p;
-    Eigen::VectorXd p_sharp_fwd_fwd = this->hamiltonian_.dtau_dp(this->z_);
+    Eigen::VectorXd& p_fwd_fwd = workspace_.p_fwd_fwd;
+    Eigen::VectorXd& p_sharp_fwd_fwd = workspace_.p_sharp_fwd_fwd;
+    p_fwd_fwd = this->z_.p;
+    p_sharp_fwd_fwd = this->hamiltonian_.dtau_dp(this->z_);
 
     // Momentum and sharp momentum at backward end of forward subtree
-    Eigen::VectorXd p_fwd_bck = this->z_.p;
-    Eigen::VectorXd p_sharp_fwd_bck = p_sharp_fwd_fwd;
+    Eigen::VectorXd& p_fwd_bck = workspace_.p_fwd_bck;
+    Eigen::VectorXd& p_sharp_fwd_bck = workspace_.p_sharp_fwd_bck;
+    p_fwd_bck = this->z_.p;
+    p_sharp_fwd_bck = p_sharp_fwd_fwd;
 
     // Momentum and sharp momentum at forward end of backward subtree
-    Eigen::VectorXd p_bck_fwd = this->z_.p;
-    Eigen::VectorXd p_sharp_bck_fwd = p_sharp_fwd_fwd;
+    Eigen::VectorXd& p_bck_fwd = workspace_.p_bck_fwd;
+    Eigen::VectorXd& p_sharp_bck_fwd = workspace_.p_sharp_bck_fwd;
+    p_bck_fwd = this->z_.p;
+    p_sharp_bck_fwd = p_sharp_fwd_fwd;
 
     // Momentum and sharp momentum at backward end of backward subtree
-    Eigen::VectorXd p_bck_bck = this->z_.p;
-    Eigen::VectorXd p_sharp_bck_bck = p_sharp_fwd_fwd;
+    Eigen::VectorXd& p_bck_bck = workspace_.p_bck_bck;
+    Eigen::VectorXd& p_sharp_bck_bck = workspace_.p_sharp_bck_bck;
+    p_bck_bck = this->z_.p;
+    p_sharp_bck_bck = p_sharp_fwd_fwd;
 
     // Integrated momenta along trajectory
-    Eigen::VectorXd rho = this->z_.p.transpose();
+    Eigen::VectorXd& rho = workspace_.rho;
+    rho = this->z_.p;
+
+    Eigen::VectorXd& rho_fwd = workspace_.rho_fwd;
+    Eigen::VectorXd& rho_bck = workspace_.rho_bck;
+    Eigen::VectorXd& rho_extended = workspace_.rho_extended;
 
     // Log sum of state weights (offset by H0) along trajectory
     double log_sum_weight = 0;  // log(exp(H0 - H0))
@@ -122,8 +145,8 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
 
     while (this->depth_ < this->max_depth_) {
       // Build a new subtree in a random direction
-      Eigen::VectorXd rho_fwd = Eigen::VectorXd::Zero(rho.size());
-      Eigen::VectorXd rho_bck = Eigen::VectorXd::Zero(rho.size());
+      rho_fwd.setZero();
+      rho_bck.setZero();
 
       bool valid_subtree = false;
       double log_sum_weight_subtree = -std::numeric_limits<double>::infinity();
@@ -179,7 +202,7 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
           = compute_criterion(p_sharp_bck_bck, p_sharp_fwd_fwd, rho);
 
       // Demand satisfaction between subtrees
-      Eigen::VectorXd rho_extended = rho_bck + p_fwd_bck;
+      rho_extended = rho_bck + p_fwd_bck;
 
       persist_criterion
           &= compute_criterion(p_sharp_bck_bck, p_sharp_fwd_bck, rho_extended);
@@ -281,15 +304,18 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
       return !this->divergent_;
     }
     // General recursion
+    workspace_.reserve_depth(depth);
+    nuts_tree_level& level = workspace_.level(depth);
 
     // Build the initial subtree
     double log_sum_weight_init = -std::numeric_limits<double>::infinity();
 
     // Momentum and sharp momentum at end of the initial subtree
-    Eigen::VectorXd p_init_end(this->z_.p.size());
-    Eigen::VectorXd p_sharp_init_end(this->z_.p.size());
+    Eigen::VectorXd& p_init_end = level.p_init_end;
+    Eigen::VectorXd& p_sharp_init_end = level.p_sharp_init_end;
 
-    Eigen::VectorXd rho_init = Eigen::VectorXd::Zero(rho.size());
+    Eigen::VectorXd& rho_init = level.rho_init;
+    rho_init.setZero();
 
     bool valid_init
         = build_tree(depth - 1, z_propose, p_sharp_beg, p_sharp_init_end,
@@ -300,15 +326,17 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
       return false;
 
     // Build the final subtree
-    ps_point z_propose_final(this->z_);
+    ps_point& z_propose_final = level.z_propose_final;
+    z_propose_final = this->z_;
 
     double log_sum_weight_final = -std::numeric_limits<double>::infinity();
 
     // Momentum and sharp momentum at beginning of the final subtree
-    Eigen::VectorXd p_final_beg(this->z_.p.size());
-    Eigen::VectorXd p_sharp_final_beg(this->z_.p.size());
+    Eigen::VectorXd& p_final_beg = level.p_final_beg;
+    Eigen::VectorXd& p_sharp_final_beg = level.p_sharp_final_beg;
 
-    Eigen::VectorXd rho_final = Eigen::VectorXd::Zero(rho.size());
+    Eigen::VectorXd& rho_final = level.rho_final;
+    rho_final.setZero();
 
     bool valid_final
         = build_tree(depth - 1, z_propose_final, p_sharp_final_beg, p_sharp_end,
@@ -332,7 +360,8 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         z_propose = z_propose_final;
     }
 
-    Eigen::VectorXd rho_subtree = rho_init + rho_final;
+    Eigen::VectorXd& rho_subtree = level.rho_subtree;
+    rho_subtree = rho_init + rho_final;
     rho += rho_subtree;
 
     // Demand satisfaction around merged subtrees
@@ -358,6 +387,12 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
   int n_leapfrog_;
   bool divergent_;
   double energy_;
+
+ protected:
+  /**
+   * Preallocated states and momenta reused across transitions.
+   */
+  nuts_workspace workspace_;
 };
 
 }  // namespace mcmc
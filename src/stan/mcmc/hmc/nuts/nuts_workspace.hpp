@@ -0,0 +1,129 @@
+#ifndef STAN_MCMC_HMC_NUTS_NUTS_WORKSPACE_HPP
+#define STAN_MCMC_HMC_NUTS_NUTS_WORKSPACE_HPP
+
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Scratch storage used by one level of the recursive tree builder
+ * in <code>base_nuts</code>.  A subtree of depth <code>d</code>
+ * only ever uses the level <code>d</code> storage, so each level
+ * can be reused across all subtrees of that depth.
+ */
+struct nuts_tree_level {
+  explicit nuts_tree_level(int n)
+      : z_propose_final(n),
+        p_init_end(n),
+        p_sharp_init_end(n),
+        rho_init(n),
+        p_final_beg(n),
+        p_sharp_final_beg(n),
+        rho_final(n),
+        rho_subtree(n) {}
+
+  // State proposed from the final subtree
+  ps_point z_propose_final;
+
+  // Momentum and sharp momentum at end of the initial subtree
+  Eigen::VectorXd p_init_end;
+  Eigen::VectorXd p_sharp_init_end;
+  Eigen::VectorXd rho_init;
+
+  // Momentum and sharp momentum at beginning of the final subtree
+  Eigen::VectorXd p_final_beg;
+  Eigen::VectorXd p_sharp_final_beg;
+  Eigen::VectorXd rho_final;
+
+  // Summed momenta used by the no-u-turn checks of the merged subtree
+  Eigen::VectorXd rho_subtree;
+};
+
+/**
+ * Preallocated storage for the states and momenta that the
+ * No-U-Turn sampler tracks while building a trajectory, so
+ * that a transition does not allocate once the workspace has
+ * been sized for the maximum tree depth and the dimension of
+ * the parameter space.
+ */
+class nuts_workspace {
+ public:
+  explicit nuts_workspace(int n)
+      : z_fwd(n),
+        z_bck(n),
+        z_sample(n),
+        z_propose(n),
+        p_fwd_fwd(n),
+        p_sharp_fwd_fwd(n),
+        p_fwd_bck(n),
+        p_sharp_fwd_bck(n),
+        p_bck_fwd(n),
+        p_sharp_bck_fwd(n),
+        p_bck_bck(n),
+        p_sharp_bck_bck(n),
+        rho(n),
+        rho_fwd(n),
+        rho_bck(n),
+        rho_extended(n),
+        n_(n) {}
+
+  /**
+   * Ensure storage exists for subtrees up to the given depth.
+   * Only allocates when the depth exceeds the current capacity.
+   *
+   * @param max_depth Maximum depth of a subtree
+   */
+  inline void reserve_depth(int max_depth) {
+    levels_.reserve(max_depth + 1);
+    while (static_cast<int>(levels_.size()) <= max_depth)
+      levels_.emplace_back(n_);
+  }
+
+  /**
+   * Return the storage for subtrees of the given depth.
+   *
+   * @param depth Depth of the subtree
+   * @return Scratch storage for that depth
+   */
+  inline nuts_tree_level& level(int depth) { return levels_[depth]; }
+
+  // States at the forward and backward ends of the trajectory
+  ps_point z_fwd;
+  ps_point z_bck;
+
+  // States sampled from the trajectory and proposed from a subtree
+  ps_point z_sample;
+  ps_point z_propose;
+
+  // Momentum and sharp momentum at forward end of forward subtree
+  Eigen::VectorXd p_fwd_fwd;
+  Eigen::VectorXd p_sharp_fwd_fwd;
+
+  // Momentum and sharp momentum at backward end of forward subtree
+  Eigen::VectorXd p_fwd_bck;
+  Eigen::VectorXd p_sharp_fwd_bck;
+
+  // Momentum and sharp momentum at forward end of backward subtree
+  Eigen::VectorXd p_bck_fwd;
+  Eigen::VectorXd p_sharp_bck_fwd;
+
+  // Momentum and sharp momentum at backward end of backward subtree
+  Eigen::VectorXd p_bck_bck;
+  Eigen::VectorXd p_sharp_bck_bck;
+
+  // Integrated momenta along trajectory and its subtrees
+  Eigen::VectorXd rho;
+  Eigen::VectorXd rho_fwd;
+  Eigen::VectorXd rho_bck;
+  Eigen::VectorXd rho_extended;
+
+ private:
+  int n_;
+  std::vector<nuts_tree_level> levels_;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -36,6 +36,7 @@ class adapt_dense_e_static_hmc : public dense_e_static_hmc<Model, BaseRNG>,
           this->z_.inv_e_metric_, this->z_.q);
 
       if (update) {
+        this->z_.update_metric_factorization();
         this->init_stepsize(logger);
         this->update_L_();
 
@@ -21,19 +21,16 @@ class var_adaptation : public windowed_adaptation {
     if (end_adaptation_window()) {
       compute_next_window();
 
+      if (defer_update_) {
+        update_pending_ = true;
+        ++adapt_window_counter_;
+        return false;
+      }
+
       estimator_.sample_variance(var);
 
       double n = static_cast<double>(estimator_.num_samples());
-      var = (n / (n + 5.0)) * var
-            + 1e-3 * (5.0 / (n + 5.0)) * Eigen::VectorXd::Ones(var.size());
-
-      if (!var.allFinite())
-        throw std::runtime_error(
-            "Numerical overflow in metric adaptation. "
-            "This occurs when the sampler encounters extreme values on the "
-            "unconstrained space; this may happen when the posterior density "
-            "function is too wide or improper. "
-            "There may be problems with your model specification.");
+      regularize_variance(var, n);
 
       estimator_.restart();
 
@@ -45,8 +42,71 @@ class var_adaptation : public windowed_adaptation {
     return false;
   }
 
+  /**
+   * Compute the regularized variance of the draws collected during the
+   * last adaptation window by all of the given adaptations, as if the
+   * draws had been fed to a single estimator, and restart each
+   * estimator.  Used with deferred updates to share one metric between
+   * chains run in parallel.
+   *
+   * @param[in,out] adaptations Adaptations to pool, all of the same
+   * dimension
+   * @param[out] var Pooled variance
+   * @throw std::runtime_error if the pooled variance is not finite
+   */
+  static void pool_variance(const std::vector<var_adaptation*>& adaptations,
+                            Eigen::VectorXd& var) {
+    const Eigen::Index dim = var.size();
+    double n_total = 0;
+    Eigen::VectorXd mean_total = Eigen::VectorXd::Zero(dim);
+    Eigen::VectorXd mean(dim);
+    for (var_adaptation* adaptation : adaptations) {
+      double n = adaptation->estimator_.num_samples();
+      adaptation->estimator_.sample_mean(mean);
+      n_total += n;
+      mean_total += n * mean;
+    }
+    if (n_total > 0)
+      mean_total /= n_total;
+
+    // Combine the sums of squared deviations of each estimator about
+    // its own mean with the spread of the means about the pooled mean
+    Eigen::VectorXd m2 = Eigen::VectorXd::Zero(dim);
+    Eigen::VectorXd chain_var(dim);
+    for (var_adaptation* adaptation : adaptations) {
+      double n = adaptation->estimator_.num_samples();
+      if (n > 1) {
+        adaptation->estimator_.sample_variance(chain_var);
+        m2 += (n - 1) * chain_var;
+      }
+      if (n > 0) {
+        adaptation->estimator_.sample_mean(mean);
+        m2 += n * (mean - mean_total).array().square().matrix();
+      }
+      adaptation->estimator_.restart();
+      adaptation->update_pending_ = false;
+    }
+
+    if (n_total > 1)
+      var = m2 / (n_total - 1);
+    regularize_variance(var, n_total);
+  }
+
  protected:
   stan::math::welford_var_estimator estimator_;
+
+  static void regularize_variance(Eigen::VectorXd& var, double n) {
+    var = (n / (n + 5.0)) * var
+          + 1e-3 * (5.0 / (n + 5.0)) * Eigen::VectorXd::Ones(var.size());
+
+    if (!var.allFinite())
+      throw std::runtime_error(
+          "Numerical overflow in metric adaptation. "
+          "This occurs when the sampler encounters extreme values on the "
+          "unconstrained space; this may happen when the posterior density "
+          "function is too wide or improper. "
+          "There may be problems with your model specification.");
+  }
 };
 
 }  // namespace mcmc
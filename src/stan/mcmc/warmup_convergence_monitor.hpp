@@ -0,0 +1,122 @@
+#ifndef STAN_MCMC_WARMUP_CONVERGENCE_MONITOR_HPP
+#define STAN_MCMC_WARMUP_CONVERGENCE_MONITOR_HPP
+
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/math/prim.hpp>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Tracks how much the adapted step size and inverse metric change
+ * from one adaptation window to the next, and decides when warmup has
+ * converged.
+ *
+ * The change in step size is the absolute relative change of the
+ * averaged step size.  The change in the inverse metric is the
+ * relative Frobenius distance <code>||new - old|| / ||old||</code>,
+ * which for a diagonal metric is the relative Euclidean distance
+ * between the diagonals.  Warmup has converged once both changes are
+ * at or below their tolerances at the end of a window.
+ */
+class warmup_convergence_monitor {
+ public:
+  /**
+   * @param stepsize_tolerance largest relative change in step size
+   * between windows considered converged; zero or less disables early
+   * termination
+   * @param metric_tolerance largest relative change in inverse metric
+   * between windows considered converged; zero or less disables early
+   * termination
+   */
+  warmup_convergence_monitor(double stepsize_tolerance,
+                             double metric_tolerance)
+      : stepsize_tolerance_(stepsize_tolerance),
+        metric_tolerance_(metric_tolerance),
+        num_windows_(0),
+        stepsize_(0),
+        stepsize_change_(std::numeric_limits<double>::quiet_NaN()),
+        metric_change_(std::numeric_limits<double>::quiet_NaN()),
+        converged_(false) {}
+
+  /**
+   * Return true if warmup can end early once converged.
+   */
+  bool enabled() const noexcept {
+    return stepsize_tolerance_ > 0 && metric_tolerance_ > 0;
+  }
+
+  /**
+   * Record the step size and inverse metric adapted over the window
+   * that just ended.
+   *
+   * @tparam EigMat type of inverse metric, vector or matrix
+   * @param stepsize step size averaged over the window
+   * @param inv_metric inverse metric estimated from the window
+   * @return true if warmup has converged
+   */
+  template <typename EigMat>
+  bool update(double stepsize, const EigMat& inv_metric) {
+    if (num_windows_ > 0) {
+      stepsize_change_ = std::fabs(stepsize - stepsize_) / stepsize_;
+      metric_change_ = (inv_metric - inv_metric_).norm() / inv_metric_.norm();
+      converged_ = enabled() && stepsize_change_ <= stepsize_tolerance_
+                   && metric_change_ <= metric_tolerance_;
+    }
+    stepsize_ = stepsize;
+    inv_metric_ = inv_metric;
+    ++num_windows_;
+    return converged_;
+  }
+
+  bool converged() const noexcept { return converged_; }
+
+  int num_windows() const noexcept { return num_windows_; }
+
+  double stepsize_change() const noexcept { return stepsize_change_; }
+
+  double metric_change() const noexcept { return metric_change_; }
+
+  /**
+   * Write a record of how warmup ended.  Warmup is reported as
+   * converged only if it ended before the maximum number of warmup
+   * iterations; convergence at the last window, after which the full
+   * terminal buffer is run anyway, is reported as reaching
+   * <code>num_warmup</code>.
+   *
+   * @param writer structured writer for the record
+   * @param num_warmup_run number of warmup iterations that were run
+   * @param num_warmup maximum number of warmup iterations
+   */
+  void write(callbacks::structured_writer& writer, unsigned int num_warmup_run,
+             unsigned int num_warmup) const {
+    bool ended_early = converged_ && num_warmup_run < num_warmup;
+    writer.begin_record();
+    writer.write("warmup_end_reason",
+                 ended_early ? "converged" : "num_warmup_reached");
+    writer.write("num_warmup", num_warmup_run);
+    writer.write("num_windows", num_windows_);
+    writer.write("stepsize_change", stepsize_change_);
+    writer.write("stepsize_tolerance", stepsize_tolerance_);
+    writer.write("metric_change", metric_change_);
+    writer.write("metric_tolerance", metric_tolerance_);
+    writer.end_record();
+  }
+
+ private:
+  double stepsize_tolerance_;
+  double metric_tolerance_;
+  int num_windows_;
+  double stepsize_;
+  Eigen::MatrixXd inv_metric_;
+  double stepsize_change_;
+  double metric_change_;
+  bool converged_;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -11,7 +11,8 @@ namespace mcmc {
 
 class windowed_adaptation : public base_adaptation {
  public:
-  explicit windowed_adaptation(std::string name) : estimator_name_(name) {
+  explicit windowed_adaptation(std::string name)
+      : estimator_name_(name), defer_update_(false) {
     num_warmup_ = 0;
     adapt_init_buffer_ = 0;
     adapt_term_buffer_ = 0;
@@ -24,6 +25,34 @@ class windowed_adaptation : public base_adaptation {
     adapt_window_counter_ = 0;
     adapt_window_size_ = adapt_base_window_;
     adapt_next_window_ = adapt_init_buffer_ + adapt_window_size_ - 1;
+    update_pending_ = false;
+  }
+
+  /**
+   * When deferred, the end of an adaptation window only flags that an
+   * update is pending instead of computing the new metric, so that the
+   * estimators of several chains can be pooled before the update.
+   *
+   * @param defer Whether to defer metric updates
+   */
+  void set_defer_update(bool defer) { defer_update_ = defer; }
+
+  bool update_pending() const noexcept { return update_pending_; }
+
+  unsigned int get_init_buffer() const noexcept { return adapt_init_buffer_; }
+
+  unsigned int get_term_buffer() const noexcept { return adapt_term_buffer_; }
+
+  /**
+   * Return the number of iterations left until the current adaptation
+   * window ends, counting the iteration that ends it, or zero if no
+   * further window will end during warmup.
+   */
+  unsigned int remaining_window_iterations() const noexcept {
+    if (adapt_next_window_ >= num_warmup_
+        || adapt_window_counter_ > adapt_next_window_)
+      return 0;
+    return adapt_next_window_ - adapt_window_counter_ + 1;
   }
 
   void set_window_params(unsigned int num_warmup, unsigned int init_buffer,
@@ -120,6 +149,9 @@ class windowed_adaptation : public base_adaptation {
   unsigned int adapt_window_counter_;
   unsigned int adapt_next_window_;
   unsigned int adapt_window_size_;
+
+  bool defer_update_;
+  bool update_pending_;
 };
 
 }  // namespace mcmc
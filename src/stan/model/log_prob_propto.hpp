@@ -2,12 +2,54 @@
 #define STAN_MODEL_LOG_PROB_PROPTO_HPP
 
 #include <stan/math/rev.hpp>
+#ifdef STAN_MODEL_LOG_PROB_PROPTO_FVAR
+#include <stan/math/fwd.hpp>
+#endif
 #include <iostream>
 #include <vector>
 
 namespace stan {
 namespace model {
 
+#ifdef STAN_MODEL_LOG_PROB_PROPTO_FVAR
+namespace internal {
+
+/**
+ * Return the log density up to a proportion, evaluated without an
+ * autodiff tape.
+ *
+ * The parameters are wrapped in <code>stan::math::fvar<double></code>
+ * with zero tangents.  Like <code>var</code>, these are not constant,
+ * so the model drops exactly the same terms, but evaluating them takes
+ * only about twice the arithmetic of <code>double</code> and never
+ * touches the reverse-mode arena.  This requires the model to support
+ * forward mode, so it is only used if
+ * <code>STAN_MODEL_LOG_PROB_PROPTO_FVAR</code> is defined, which also
+ * declares the <code>fvar<double></code> overloads of
+ * <code>model_base::log_prob</code>.
+ *
+ * @tparam jacobian_adjust_transform True if the log absolute
+ * Jacobian determinant of inverse parameter transforms is added to
+ * the log probability.
+ * @tparam M Class of model.
+ * @param[in] model Model.
+ * @param[in] params_r Real-valued parameters.
+ * @param[in,out] msgs
+ */
+template <bool jacobian_adjust_transform, class M>
+double log_prob_propto_fvar(const M& model, const double* params_r,
+                            std::ostream* msgs) {
+  Eigen::Matrix<stan::math::fvar<double>, -1, 1> fvar_params_r
+      = Eigen::Map<const Eigen::VectorXd>(params_r, model.num_params_r())
+            .cast<stan::math::fvar<double>>();
+  return model
+      .template log_prob<true, jacobian_adjust_transform>(fvar_params_r, msgs)
+      .val();
+}
+
+}  // namespace internal
+#endif
+
 /**
  * Helper function to calculate log probability for
  * <code>double</code> scalars up to a proportion.
@@ -16,7 +58,10 @@ namespace model {
  * <code>stan::math::var</code> and calls the model's
  * <code>log_prob()</code> function with <code>propto=true</code>
  * and the specified parameter for applying the Jacobian
- * adjustment for transformed parameters.
+ * adjustment for transformed parameters.  If
+ * <code>STAN_MODEL_LOG_PROB_PROPTO_FVAR</code> is defined, the values
+ * are wrapped in <code>stan::math::fvar<double></code> instead,
+ * which drops the same terms without building an autodiff tape.
  *
  * @tparam propto True if calculation is up to proportion
  * (double-only terms dropped).
@@ -32,6 +77,10 @@ namespace model {
 template <bool jacobian_adjust_transform, class M>
 double log_prob_propto(const M& model, std::vector<double>& params_r,
                        std::vector<int>& params_i, std::ostream* msgs = 0) {
+#ifdef STAN_MODEL_LOG_PROB_PROPTO_FVAR
+  return internal::log_prob_propto_fvar<jacobian_adjust_transform>(
+      model, params_r.data(), msgs);
+#else
   using stan::math::var;
   using std::vector;
   try {
@@ -49,6 +98,7 @@ double log_prob_propto(const M& model, std::vector<double>& params_r,
     stan::math::recover_memory();
     throw;
   }
+#endif
 }
 
 /**
@@ -59,7 +109,10 @@ double log_prob_propto(const M& model, std::vector<double>& params_r,
  * <code>stan::math::var</code> and calls the model's
  * <code>log_prob()</code> function with <code>propto=true</code>
  * and the specified parameter for applying the Jacobian
- * adjustment for transformed parameters.
+ * adjustment for transformed parameters.  If
+ * <code>STAN_MODEL_LOG_PROB_PROPTO_FVAR</code> is defined, the values
+ * are wrapped in <code>stan::math::fvar<double></code> instead,
+ * which drops the same terms without building an autodiff tape.
  *
  * @tparam propto True if calculation is up to proportion
  * (double-only terms dropped).
@@ -74,6 +127,10 @@ double log_prob_propto(const M& model, std::vector<double>& params_r,
 template <bool jacobian_adjust_transform, class M>
 double log_prob_propto(const M& model, Eigen::VectorXd& params_r,
                        std::ostream* msgs = 0) {
+#ifdef STAN_MODEL_LOG_PROB_PROPTO_FVAR
+  return internal::log_prob_propto_fvar<jacobian_adjust_transform>(
+      model, params_r.data(), msgs);
+#else
   using stan::math::var;
   using std::vector;
   vector<int> params_i(0);
@@ -92,6 +149,7 @@ double log_prob_propto(const M& model, Eigen::VectorXd& params_r,
     stan::math::recover_memory();
     throw;
   }
+#endif
 }
 
 }  // namespace model
@@ -4,10 +4,14 @@
 #ifdef STAN_MODEL_FVAR_VAR
 #include <stan/math/mix.hpp>
 #endif
+#ifdef STAN_MODEL_LOG_PROB_PROPTO_FVAR
+#include <stan/math/fwd.hpp>
+#endif
 #include <stan/io/var_context.hpp>
 #include <stan/math/rev/core.hpp>
 #include <stan/model/prob_grad.hpp>
 #include <stan/services/util/create_rng.hpp>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -638,6 +642,32 @@ class model_base : public prob_grad {
       const std::vector<double>& params_r_constrained,
       std::vector<double>& params_r, std::ostream* msgs = nullptr) const = 0;
 
+  /**
+   * Return a new model with the same data as this model, except for
+   * the data variables defined in the specified context, whose values
+   * are replaced.  The result is the same as constructing the model
+   * from this model's data with the context laid over it, but only the
+   * replaced variables have to be read and validated, and the
+   * transformed data are recomputed from the new values.
+   *
+   * <p>Models that do not support updating their data return a null
+   * pointer, which is the default; callers then have to construct
+   * the model from all of its data, see
+   * <code>stan::services::util::update_data</code>.
+   *
+   * @param[in] delta values of the data variables to replace
+   * @param[in] random_seed seed for the random number generator used
+   * to compute the transformed data
+   * @param[in,out] msgs stream to which messages are written
+   * @return the new model, or a null pointer if not supported
+   * @throw std::exception if the new values fail validation
+   */
+  virtual std::unique_ptr<model_base> update_data(
+      const io::var_context& delta, unsigned int random_seed,
+      std::ostream* msgs) const {
+    return nullptr;
+  }
+
 #ifdef STAN_MODEL_FVAR_VAR
 
   /**
@@ -700,6 +730,61 @@ class model_base : public prob_grad {
       Eigen::Matrix<math::fvar<math::var>, -1, 1>& params_r,
       std::ostream* msgs) const = 0;
 #endif
+
+#ifdef STAN_MODEL_LOG_PROB_PROPTO_FVAR
+
+  /**
+   * Return the log density for the specified unconstrained
+   * parameters, without Jacobian and with normalizing constants for
+   * probability functions.
+   *
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] msgs message stream
+   * @return log density for specified parameters
+   */
+  virtual math::fvar<double> log_prob(
+      Eigen::Matrix<math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const = 0;
+
+  /**
+   * Return the log density for the specified unconstrained
+   * parameters, with Jacobian correction for constraints and with
+   * normalizing constants for probability functions.
+   *
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] msgs message stream
+   * @return log density for specified parameters
+   */
+  virtual math::fvar<double> log_prob_jacobian(
+      Eigen::Matrix<math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const = 0;
+
+  /**
+   * Return the log density for the specified unconstrained
+   * parameters, without Jacobian correction for constraints and
+   * dropping normalizing constants.
+   *
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] msgs message stream
+   * @return log density for specified parameters
+   */
+  virtual math::fvar<double> log_prob_propto(
+      Eigen::Matrix<math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const = 0;
+
+  /**
+   * Return the log density for the specified unconstrained
+   * parameters, with Jacobian correction for constraints and dropping
+   * normalizing constants.
+   *
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] msgs message stream
+   * @return log density for specified parameters
+   */
+  virtual math::fvar<double> log_prob_propto_jacobian(
+      Eigen::Matrix<math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const = 0;
+#endif
 };
 
 }  // namespace model
@@ -4,6 +4,9 @@
 #ifdef STAN_MODEL_FVAR_VAR
 #include <stan/math/mix.hpp>
 #endif
+#ifdef STAN_MODEL_LOG_PROB_PROPTO_FVAR
+#include <stan/math/fwd.hpp>
+#endif
 #include <stan/model/model_base.hpp>
 #include <iostream>
 #include <utility>
@@ -298,6 +301,73 @@ class model_base_crtp : public stan::model::model_base {
                                                                       msgs);
   }
 #endif
+
+#ifdef STAN_MODEL_LOG_PROB_PROPTO_FVAR
+
+  /**
+   * Return the log density for the specified unconstrained
+   * parameters, without Jacobian and with normalizing constants for
+   * probability functions.
+   *
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] msgs message stream
+   * @return log density for specified parameters
+   */
+  inline math::fvar<double> log_prob(
+      Eigen::Matrix<math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const override {
+    return static_cast<const M*>(this)->template log_prob<false, false>(
+        params_r, msgs);
+  }
+
+  /**
+   * Return the log density for the specified unconstrained
+   * parameters, with Jacobian correction for constraints and with
+   * normalizing constants for probability functions.
+   *
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] msgs message stream
+   * @return log density for specified parameters
+   */
+  inline math::fvar<double> log_prob_jacobian(
+      Eigen::Matrix<math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const override {
+    return static_cast<const M*>(this)->template log_prob<false, true>(params_r,
+                                                                       msgs);
+  }
+
+  /**
+   * Return the log density for the specified unconstrained
+   * parameters, without Jacobian correction for constraints and
+   * dropping normalizing constants.
+   *
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] msgs message stream
+   * @return log density for specified parameters
+   */
+  inline math::fvar<double> log_prob_propto(
+      Eigen::Matrix<math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const override {
+    return static_cast<const M*>(this)->template log_prob<true, false>(params_r,
+                                                                       msgs);
+  }
+
+  /**
+   * Return the log density for the specified unconstrained
+   * parameters, with Jacobian correction for constraints and dropping
+   * normalizing constants.
+   *
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] msgs message stream
+   * @return log density for specified parameters
+   */
+  inline math::fvar<double> log_prob_propto_jacobian(
+      Eigen::Matrix<math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const override {
+    return static_cast<const M*>(this)->template log_prob<true, true>(params_r,
+                                                                      msgs);
+  }
+#endif
 };
 
 }  // namespace model
@@ -13,8 +13,12 @@
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/duration_diff.hpp>
 #include <stan/services/util/initialize.hpp>
+#include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
 #include <boost/random/discrete_distribution.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -87,6 +91,14 @@ namespace pathfinder {
  *  samples are written to `parameter_writer`. If `false`, no psis resampling is
  * performed and (`num_paths` * `num_draws`) samples are written to
  * `parameter_writer`.
+ * @param[in] elbo_stride Positive value for how often each single pathfinder
+ * estimates the ELBO. See `pathfinder_lbfgs_single`. If it is less than 1,
+ * nothing is run and `error_codes::CONFIG` is returned.
+ * @param[in] stream_draws If `true` and psis resampling is performed, the
+ * single pathfinders keep their draws unconstrained and only the
+ * `num_multi_draws` resampled draws are transformed to the constrained space,
+ * in parallel. The draws of the individual pathfinders are then not written to
+ * `single_path_parameter_writer`.
  * @return error_codes::OK if successful
  */
 template <class Model, typename InitContext, typename InitWriter,
@@ -103,7 +115,13 @@ inline int pathfinder_lbfgs_multi(
     std::vector<SingleParamWriter>& single_path_parameter_writer,
     std::vector<SingleDiagnosticWriter>& single_path_diagnostic_writer,
     ParamWriter& parameter_writer, DiagnosticWriter& diagnostic_writer,
-    bool calculate_lp = true, bool psis_resample = true) {
+    bool calculate_lp = true, bool psis_resample = true, int elbo_stride = 1,
+    bool stream_draws = false) {
+  if (unlikely(elbo_stride < 1)) {
+    logger.error("elbo_stride must be positive, but is "
+                 + std::to_string(elbo_stride) + ".");
+    return error_codes::CONFIG;
+  }
   const auto start_pathfinders_time = std::chrono::steady_clock::now();
   std::vector<std::string> param_names;
   param_names.push_back("lp_approx__");
@@ -117,6 +135,8 @@ inline int pathfinder_lbfgs_multi(
       individual_samples;
   individual_samples.resize(num_paths);
   std::atomic<size_t> lp_calls{0};
+  const bool constrain_resampled
+      = stream_draws && psis_resample && calculate_lp;
   try {
     tbb::parallel_for(
         tbb::blocked_range<int>(0, num_paths), [&](tbb::blocked_range<int> r) {
@@ -129,7 +149,8 @@ inline int pathfinder_lbfgs_multi(
                     num_elbo_draws, num_draws, save_iterations, refresh,
                     interrupt, logger, init_writers[iter],
                     single_path_parameter_writer[iter],
-                    single_path_diagnostic_writer[iter], calculate_lp);
+                    single_path_diagnostic_writer[iter], calculate_lp,
+                    elbo_stride, !constrain_resampled);
             if (unlikely(std::get<0>(pathfinder_ret) != error_codes::OK)) {
               logger.error(std::string("Pathfinder iteration: ")
                            + std::to_string(iter) + " failed.");
@@ -175,19 +196,23 @@ inline int pathfinder_lbfgs_multi(
     num_returned_samples += ilpr.size();
   }
   // Rows are individual parameters and columns are samples per iteration
-  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> samples(
-      individual_samples[0].rows(), num_returned_samples);
-  Eigen::Index filling_start_row = 0;
-  for (size_t i = 0; i < successful_pathfinders; ++i) {
-    const Eigen::Index individ_num_samples = individual_samples[i].cols();
-    samples.middleCols(filling_start_row, individ_num_samples)
-        = individual_samples[i].matrix();
-    filling_start_row += individ_num_samples;
-  }
+  auto concat_samples = [&individual_samples, successful_pathfinders,
+                         num_returned_samples]() {
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> samples(
+        individual_samples[0].rows(), num_returned_samples);
+    Eigen::Index filling_start_row = 0;
+    for (size_t i = 0; i < successful_pathfinders; ++i) {
+      const Eigen::Index individ_num_samples = individual_samples[i].cols();
+      samples.middleCols(filling_start_row, individ_num_samples)
+          = individual_samples[i].matrix();
+      filling_start_row += individ_num_samples;
+    }
+    return samples;
+  };
   double psis_delta_time = 0;
   if (psis_resample && calculate_lp) {
     Eigen::Array<double, Eigen::Dynamic, 1> lp_ratios(num_returned_samples);
-    filling_start_row = 0;
+    Eigen::Index filling_start_row = 0;
     for (size_t i = 0; i < successful_pathfinders; ++i) {
       const Eigen::Index individ_num_samples = individual_lp_ratios[i].size();
       lp_ratios.segment(filling_start_row, individ_num_samples)
@@ -195,8 +220,8 @@ inline int pathfinder_lbfgs_multi(
       filling_start_row += individ_num_samples;
     }
 
-    const auto tail_len = std::min(0.2 * num_returned_samples,
-                                   3 * std::sqrt(num_returned_samples));
+    const Eigen::Index tail_len
+        = stan::services::psis::tail_length(num_returned_samples);
     Eigen::Array<double, Eigen::Dynamic, 1> weight_vals
         = stan::services::psis::psis_weights(lp_ratios, tail_len, logger);
     stan::rng_t rng = util::create_rng(random_seed, stride_id);
@@ -207,15 +232,79 @@ inline int pathfinder_lbfgs_multi(
                      boost::iterator_range<double*>(
                          weight_vals.data(),
                          weight_vals.data() + weight_vals.size())));
-    for (size_t i = 0; i <= num_multi_draws - 1; ++i) {
-      parameter_writer(samples.col(rand_psis_idx()));
+    if (constrain_resampled) {
+      // Locate the resampled draws in the individual samples, which hold the
+      // unconstrained parameters, and constrain only those.
+      std::vector<Eigen::Index> path_starts(successful_pathfinders + 1, 0);
+      for (size_t i = 0; i < successful_pathfinders; ++i) {
+        path_starts[i + 1] = path_starts[i] + individual_samples[i].cols();
+      }
+      std::vector<Eigen::Index> draw_idxs(num_multi_draws);
+      for (size_t i = 0; i <= num_multi_draws - 1; ++i) {
+        draw_idxs[i] = rand_psis_idx();
+      }
+      Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> samples(
+          param_names.size(), num_multi_draws);
+      const Eigen::Index num_constrained_params = param_names.size() - 2;
+      // Messages of draws that could not be constrained, logged afterwards
+      // in draw order as the logger is not thread safe
+      std::vector<std::string> draw_errors(num_multi_draws);
+      try {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, num_multi_draws),
+            [&](const tbb::blocked_range<size_t>& r) {
+              Eigen::VectorXd unconstrained_col;
+              Eigen::VectorXd constrained_col;
+              for (size_t i = r.begin(); i < r.end(); ++i) {
+                const size_t path
+                    = std::upper_bound(path_starts.begin(), path_starts.end(),
+                                       draw_idxs[i])
+                      - path_starts.begin() - 1;
+                auto&& path_draw = individual_samples[path].col(
+                    draw_idxs[i] - path_starts[path]);
+                samples.col(i).head(2) = path_draw.head(2).matrix();
+                unconstrained_col
+                    = path_draw.tail(path_draw.size() - 2).matrix();
+                // Each draw has its own rng so the results do not depend on
+                // the number of threads
+                stan::rng_t draw_rng
+                    = util::create_rng(random_seed, stride_id, i + 1);
+                try {
+                  model.write_array(draw_rng, unconstrained_col,
+                                    constrained_col);
+                  samples.col(i).tail(num_constrained_params)
+                      = constrained_col;
+                } catch (const std::domain_error& e) {
+                  draw_errors[i] = e.what();
+                  samples.col(i).tail(num_constrained_params).setConstant(
+                      std::numeric_limits<double>::quiet_NaN());
+                }
+              }
+            });
+      } catch (const std::exception& e) {
+        logger.error(e.what());
+        return error_codes::SOFTWARE;
+      }
+      for (size_t i = 0; i <= num_multi_draws - 1; ++i) {
+        if (!draw_errors[i].empty()) {
+          logger.warn("Constraining resampled draw " + std::to_string(i)
+                      + " failed with error: " + draw_errors[i]);
+        }
+        parameter_writer(samples.col(i));
+      }
+    } else {
+      Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> samples
+          = concat_samples();
+      for (size_t i = 0; i <= num_multi_draws - 1; ++i) {
+        parameter_writer(samples.col(rand_psis_idx()));
+      }
     }
     const auto end_psis_time = std::chrono::steady_clock::now();
     psis_delta_time
         = stan::services::util::duration_diff(start_psis_time, end_psis_time);
 
   } else {
-    parameter_writer(samples);
+    parameter_writer(concat_samples());
   }
   parameter_writer();
   const auto time_header = std::string("Elapsed Time: ");
@@ -12,9 +12,11 @@
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/duration_diff.hpp>
 #include <boost/circular_buffer.hpp>
+#include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
 #include <tbb/concurrent_queue.h>
 #include <tbb/task_group.h>
+#include <iterator>
 #include <string>
 #include <vector>
 #include <atomic>
@@ -191,6 +193,10 @@ generate_matrix(Generator&& variate_generator, const Eigen::Index num_params,
 /**
  * Estimate the approximate draws given the taylor approximation.
  *
+ * The log density of the draws is evaluated in parallel.  The draws
+ * themselves are generated serially from `rng`, so the results do not
+ * depend on the number of threads.
+ *
  * @tparam ReturnElbo If true, calculate ELBO and return it in `elbo_est_t`. If
  * `false` ELBO is set in the return as `-Infinity`
  * @tparam LPF Type of log probability functor
@@ -199,7 +205,8 @@ generate_matrix(Generator&& variate_generator, const Eigen::Index num_params,
  * @tparam EigVec Type inheriting from `Eigen::DenseBase` with 1 column at
  * compile time.
  * @tparam Logger Type of logger callback
- * @param lp_fun Functor to calculate the log density
+ * @param lp_fun Functor to calculate the log density. It is called
+ * concurrently from multiple threads.
  * @param constrain_fun A functor to transform parameters to the constrained
  * space
  * @param[in,out] rng A generator to produce standard gaussian random variables
@@ -234,26 +241,35 @@ inline elbo_est_t est_approx_draws(LPF&& lp_fun, ConstrainF&& constrain_fun,
                            + num_params * stan::math::LOG_TWO_PI);
   Eigen::MatrixXd approx_samples
       = approximate_samples(std::move(unit_samps), taylor_approx);
-  const auto log_stream
-      = [](auto& logger, auto& pathfinder_ss, const auto& iter_msg) {
-          if (pathfinder_ss.str().length() == 0)
-            return;
-          logger.info(iter_msg + pathfinder_ss.str());
-          pathfinder_ss.str(std::string());
-        };
-  Eigen::VectorXd approx_samples_col;
-  std::stringstream pathfinder_ss;
   Eigen::Array<double, Eigen::Dynamic, 1> lp_ratio;
   if (calculate_lp) {
-    for (Eigen::Index i = 0; i < num_samples; ++i) {
-      try {
-        approx_samples_col = approx_samples.col(i);
-        ++lp_fun_calls;
-        lp_mat.coeffRef(i, 1) = lp_fun(approx_samples_col, pathfinder_ss);
-      } catch (const std::domain_error& e) {
-        lp_mat.coeffRef(i, 1) = -std::numeric_limits<double>::infinity();
+    // The draws are generated above from the single rng, so evaluating
+    // them in parallel gives the same results for any number of threads.
+    // Messages are collected per draw and logged in order afterwards.
+    std::vector<std::string> lp_msgs(num_samples);
+    tbb::parallel_for(
+        tbb::blocked_range<Eigen::Index>(0, num_samples),
+        [&](const tbb::blocked_range<Eigen::Index>& r) {
+          Eigen::VectorXd approx_samples_col;
+          std::stringstream pathfinder_ss;
+          for (Eigen::Index i = r.begin(); i < r.end(); ++i) {
+            try {
+              approx_samples_col = approx_samples.col(i);
+              lp_mat.coeffRef(i, 1) = lp_fun(approx_samples_col, pathfinder_ss);
+            } catch (const std::domain_error& e) {
+              lp_mat.coeffRef(i, 1) = -std::numeric_limits<double>::infinity();
+            }
+            if (pathfinder_ss.str().length() > 0) {
+              lp_msgs[i] = pathfinder_ss.str();
+              pathfinder_ss.str(std::string());
+            }
+          }
+        });
+    lp_fun_calls = num_samples;
+    for (const std::string& lp_msg : lp_msgs) {
+      if (lp_msg.length() > 0) {
+        logger.info(iter_msg + lp_msg);
       }
-      log_stream(logger, pathfinder_ss, iter_msg);
     }
     lp_ratio = lp_mat.col(1) - lp_mat.col(0);
   } else {
@@ -536,6 +552,18 @@ auto pathfinder_impl(RNG&& rng, LPFun&& lp_fun, ConstrainFun&& constrain_fun,
     return std::make_pair(internal::elbo_est_t{}, internal::taylor_approx_t{});
   }
 }
+
+/**
+ * State of an iteration of LBFGS whose ELBO estimation was deferred
+ */
+struct lbfgs_iter_t {
+  Eigen::Index iter;        // Iteration number
+  Eigen::VectorXd alpha;    // diagonal of the initial inv hessian
+  Eigen::VectorXd params;   // Parameters at this iteration
+  Eigen::VectorXd grads;    // Gradients at this iteration
+  Eigen::MatrixXd Ykt_mat;  // Last `history_size` changes in the gradient
+  Eigen::MatrixXd Skt_mat;  // Last `history_size` changes in the parameters
+};
 }  // namespace internal
 
 /**
@@ -590,6 +618,19 @@ auto pathfinder_impl(RNG&& rng, LPFun&& lp_fun, ConstrainFun&& constrain_fun,
  * probability calculations will be `NA` and psis resampling will not be
  * performed. Setting this parameter to `false` will also set all of the lp
  * ratios to `NaN`.
+ * @param[in] elbo_stride Positive value for how often the ELBO is estimated.
+ * If greater than 1, the ELBO is only estimated at every `elbo_stride`th
+ * iteration of LBFGS and at the last one. The skipped iterations next to the
+ * best of those are estimated after LBFGS finishes, so at most
+ * `2 * (elbo_stride - 1)` of their states are kept in memory. With
+ * `save_iterations`, each of those estimates is written to
+ * `diagnostic_writer` in a record named `elbo_<iter>`. If it is less than 1,
+ * nothing is run and `error_codes::CONFIG` is returned.
+ * @param[in] constrain_draws If `true`, the draws are transformed to the
+ * constrained space and written to `parameter_writer`. If `false`, the
+ * returned draws hold the unconstrained parameters after `lp_approx__` and
+ * `lp__` and are not written, so that the caller can constrain only the
+ * draws it needs.
  * @return If `ReturnLpSamples` is `true`, returns a tuple of the error code,
  * approximate draws, and a vector of the lp ratio. If `false`, only returns an
  * error code `error_codes::OK` if successful, `error_codes::SOFTWARE`
@@ -605,7 +646,15 @@ inline auto pathfinder_lbfgs_single(
     int num_elbo_draws, int num_draws, bool save_iterations, int refresh,
     callbacks::interrupt& interrupt, callbacks::logger& logger,
     callbacks::writer& init_writer, ParamWriter& parameter_writer,
-    DiagnosticWriter& diagnostic_writer, bool calculate_lp = true) {
+    DiagnosticWriter& diagnostic_writer, bool calculate_lp = true,
+    int elbo_stride = 1, bool constrain_draws = true) {
+  if (unlikely(elbo_stride < 1)) {
+    logger.error("elbo_stride must be positive, but is "
+                 + std::to_string(elbo_stride) + ".");
+    return internal::ret_pathfinder<ReturnLpSamples>(
+        error_codes::CONFIG, Eigen::Array<double, Eigen::Dynamic, 1>(0),
+        Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(0, 0), 0);
+  }
   const auto start_pathfinder_time = std::chrono::steady_clock::now();
   stan::rng_t rng = util::create_rng(random_seed, stride_id);
   std::vector<int> disc_vector;
@@ -679,6 +728,11 @@ inline auto pathfinder_lbfgs_single(
   Eigen::Index best_iteration = -1;
   internal::elbo_est_t elbo_best;
   internal::taylor_approx_t taylor_approx_best;
+  // Iterations skipped since the ELBO was last estimated, and the skipped
+  // iterations on either side of the best one
+  Eigen::Index last_elbo_iteration = -1;
+  std::vector<internal::lbfgs_iter_t> skipped_iters;
+  std::vector<internal::lbfgs_iter_t> best_neighbor_iters;
   std::size_t num_evals{lbfgs.grad_evals()};
   Eigen::MatrixXd Ykt_mat(num_parameters, max_history_size);
   Eigen::MatrixXd Skt_mat(num_parameters, max_history_size);
@@ -775,6 +829,26 @@ inline auto pathfinder_lbfgs_single(
       }
       std::string iter_msg(path_num + "Iter: ["
                            + std::to_string(lbfgs.iter_num()) + "] ");
+      if (elbo_stride > 1 && ret == 0 && lbfgs.iter_num() % elbo_stride != 0) {
+        skipped_iters.push_back({static_cast<Eigen::Index>(lbfgs.iter_num()),
+                                 alpha, lbfgs.curr_x(), lbfgs.curr_g(),
+                                 Ykt_map, Skt_map});
+        print_log_remainder(write_log_cond, msg, ret, num_evals, lbfgs,
+                            elbo_best.elbo,
+                            std::numeric_limits<double>::quiet_NaN(),
+                            lbfgs_ss, logger);
+        if (unlikely(save_iterations)) {
+          diagnostic_writer.write("lbfgs_success", true);
+          diagnostic_writer.write("elbo_skipped", true);
+          diagnostic_writer.write("lbfgs_note", lbfgs_ss.str());
+          diagnostic_writer.end_record();
+        }
+        if (lbfgs_ss.str().length() > 0) {
+          logger.info(lbfgs_ss);
+          lbfgs_ss.str("");
+        }
+        continue;
+      }
 
       auto pathfinder_res = internal::pathfinder_impl(
           rng, lp_fun, constrain_fun, alpha, lbfgs.curr_x(), lbfgs.curr_g(),
@@ -805,7 +879,15 @@ inline auto pathfinder_lbfgs_single(
         elbo_best = std::move(pathfinder_res.first);
         taylor_approx_best = std::move(pathfinder_res.second);
         best_iteration = lbfgs.iter_num();
+        best_neighbor_iters = std::move(skipped_iters);
+      } else if (best_iteration == last_elbo_iteration) {
+        best_neighbor_iters.insert(
+            best_neighbor_iters.end(),
+            std::make_move_iterator(skipped_iters.begin()),
+            std::make_move_iterator(skipped_iters.end()));
       }
+      skipped_iters.clear();
+      last_elbo_iteration = lbfgs.iter_num();
     } catch (const std::exception& e) {
       if (unlikely(save_iterations)) {
         diagnostic_writer.write("lbfgs_success", true);
@@ -832,13 +914,13 @@ inline auto pathfinder_lbfgs_single(
       }
     }
   }
-  if (unlikely(save_iterations)) {
-    diagnostic_writer.end_record();
-  }
   if (unlikely(ret <= 0)) {
     std::string prefix_err_msg
         = "Optimization terminated with error: " + lbfgs.get_code_string(ret);
     if (lbfgs.iter_num() < 2) {
+      if (unlikely(save_iterations)) {
+        diagnostic_writer.end_record();
+      }
       logger.error(
           prefix_err_msg
           + " Optimization failed to start, pathfinder cannot be run.");
@@ -852,6 +934,68 @@ inline auto pathfinder_lbfgs_single(
           "incorrect results.");
     }
   }
+  // Estimate the ELBO for the skipped iterations around the best one
+  if (best_iteration == last_elbo_iteration) {
+    best_neighbor_iters.insert(best_neighbor_iters.end(),
+                               std::make_move_iterator(skipped_iters.begin()),
+                               std::make_move_iterator(skipped_iters.end()));
+  }
+  for (auto&& skipped_iter : best_neighbor_iters) {
+    std::string iter_msg(path_num + "Iter: ["
+                         + std::to_string(skipped_iter.iter) + "] ");
+    if (unlikely(save_iterations)) {
+      diagnostic_writer.begin_record("elbo_"
+                                     + std::to_string(skipped_iter.iter));
+      diagnostic_writer.write("iter", static_cast<int>(skipped_iter.iter));
+      diagnostic_writer.write("elbo_deferred", true);
+    }
+    try {
+      auto pathfinder_res = internal::pathfinder_impl(
+          rng, lp_fun, constrain_fun, skipped_iter.alpha, skipped_iter.params,
+          skipped_iter.grads, skipped_iter.Ykt_mat, skipped_iter.Skt_mat,
+          num_elbo_draws, iter_msg, logger);
+      num_evals += pathfinder_res.first.fn_calls;
+      if (refresh != 0) {
+        logger.info(iter_msg + "ELBO ("
+                    + std::to_string(pathfinder_res.first.elbo) + ")");
+      }
+      if (unlikely(save_iterations)) {
+        diagnostic_writer.write("pathfinder_success", true);
+        diagnostic_writer.write("x_center", pathfinder_res.second.x_center);
+        diagnostic_writer.write("logDetCholHk",
+                                pathfinder_res.second.logdetcholHk);
+        diagnostic_writer.write("L_approx", pathfinder_res.second.L_approx);
+        diagnostic_writer.write("Qk", pathfinder_res.second.Qk);
+        diagnostic_writer.write("alpha", pathfinder_res.second.alpha);
+        diagnostic_writer.write("full", pathfinder_res.second.use_full);
+        diagnostic_writer.end_record();
+      }
+      if (pathfinder_res.first.elbo > elbo_best.elbo) {
+        elbo_best = std::move(pathfinder_res.first);
+        taylor_approx_best = std::move(pathfinder_res.second);
+        best_iteration = skipped_iter.iter;
+      }
+    } catch (const std::exception& e) {
+      if (unlikely(save_iterations)) {
+        diagnostic_writer.write("pathfinder_success", false);
+        diagnostic_writer.write("pathfinder_error", std::string(e.what()));
+        // close the estimate's record and the enclosing one
+        diagnostic_writer.end_record();
+        diagnostic_writer.end_record();
+      }
+      if (ReturnLpSamples) {
+        throw;
+      } else {
+        logger.error(e.what());
+        return internal::ret_pathfinder<ReturnLpSamples>(
+            error_codes::SOFTWARE, Eigen::Array<double, Eigen::Dynamic, 1>(0),
+            Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(0, 0), 0);
+      }
+    }
+  }
+  if (unlikely(save_iterations)) {
+    diagnostic_writer.end_record();
+  }
   if (unlikely(best_iteration == -1)) {
     logger.error(path_num +
         "Failure: None of the LBFGS iterations completed "
@@ -872,7 +1016,19 @@ inline auto pathfinder_lbfgs_single(
   auto&& elbo_lp_ratio = elbo_best.lp_ratio;
   auto&& elbo_lp_mat = elbo_best.lp_mat;
   const int remaining_draws = num_draws - elbo_lp_ratio.rows();
-  const Eigen::Index num_unconstrained_params = names.size() - 2;
+  // The caller may constrain the draws itself, e.g. only those it selects
+  const Eigen::Index num_draw_params
+      = constrain_draws ? names.size() - 2 : num_parameters;
+  auto draw_fun = [&model, &rng, constrain_draws](
+                      Eigen::VectorXd& unconstrained_col,
+                      Eigen::VectorXd& constrained_col)
+      -> const Eigen::VectorXd& {
+    if (!constrain_draws) {
+      return unconstrained_col;
+    }
+    model.write_array(rng, unconstrained_col, constrained_col);
+    return constrained_col;
+  };
   if (likely(remaining_draws > 0)) {
     try {
       internal::elbo_est_t est_draws = internal::est_approx_draws<false>(
@@ -888,26 +1044,22 @@ inline auto pathfinder_lbfgs_single(
       lp_ratio.tail(new_lp_ratio.size()) = new_lp_ratio.array();
       const auto total_size = elbo_draws.cols() + new_draws.cols();
       constrained_draws_mat
-          = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(names.size(),
-                                                                  total_size);
+          = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(
+              num_draw_params + 2, total_size);
       Eigen::VectorXd unconstrained_col;
       Eigen::VectorXd approx_samples_constrained_col;
       for (Eigen::Index i = 0; i < elbo_draws.cols(); ++i) {
         constrained_draws_mat.col(i).head(2) = elbo_lp_mat.row(i).matrix();
         unconstrained_col = elbo_draws.col(i);
-        constrained_draws_mat.col(i).tail(num_unconstrained_params)
-            = constrain_fun(rng, unconstrained_col,
-                            approx_samples_constrained_col)
-                  .matrix();
+        constrained_draws_mat.col(i).tail(num_draw_params)
+            = draw_fun(unconstrained_col, approx_samples_constrained_col);
       }
       for (Eigen::Index i = elbo_draws.cols(), j = 0; i < total_size;
            ++i, ++j) {
         constrained_draws_mat.col(i).head(2) = lp_draws.row(j).matrix();
         unconstrained_col = new_draws.col(j);
-        constrained_draws_mat.col(i).tail(num_unconstrained_params)
-            = constrain_fun(rng, unconstrained_col,
-                            approx_samples_constrained_col)
-                  .matrix();
+        constrained_draws_mat.col(i).tail(num_draw_params)
+            = draw_fun(unconstrained_col, approx_samples_constrained_col);
       }
     } catch (const std::domain_error& e) {
       std::string err_msg = e.what();
@@ -919,37 +1071,35 @@ inline auto pathfinder_lbfgs_single(
           + err_msg);
       constrained_draws_mat
           = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(
-              names.size(), elbo_draws.cols());
+              num_draw_params + 2, elbo_draws.cols());
       Eigen::VectorXd approx_samples_constrained_col;
       Eigen::VectorXd unconstrained_col;
       for (Eigen::Index i = 0; i < elbo_draws.cols(); ++i) {
         constrained_draws_mat.col(i).head(2) = elbo_lp_mat.row(i).matrix();
         unconstrained_col = elbo_draws.col(i);
-        constrained_draws_mat.col(i).tail(num_unconstrained_params)
-            = constrain_fun(rng, unconstrained_col,
-                            approx_samples_constrained_col)
-                  .matrix();
+        constrained_draws_mat.col(i).tail(num_draw_params)
+            = draw_fun(unconstrained_col, approx_samples_constrained_col);
       }
       lp_ratio = std::move(elbo_best.lp_ratio);
     }
   } else {
     // output only first num_draws from what we computed for ELBO
     constrained_draws_mat
-        = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(names.size(),
-                                                                num_draws);
+        = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(
+            num_draw_params + 2, num_draws);
     Eigen::VectorXd approx_samples_constrained_col;
     Eigen::VectorXd unconstrained_col;
     for (Eigen::Index i = 0; i < num_draws; ++i) {
       constrained_draws_mat.col(i).head(2) = elbo_lp_mat.row(i).matrix();
       unconstrained_col = elbo_draws.col(i);
-      constrained_draws_mat.col(i).tail(num_unconstrained_params)
-          = constrain_fun(rng, unconstrained_col,
-                          approx_samples_constrained_col)
-                .matrix();
+      constrained_draws_mat.col(i).tail(num_draw_params)
+          = draw_fun(unconstrained_col, approx_samples_constrained_col);
     }
     lp_ratio = std::move(elbo_best.lp_ratio.head(num_draws));
   }
-  parameter_writer(constrained_draws_mat);
+  if (constrain_draws) {
+    parameter_writer(constrained_draws_mat);
+  }
   parameter_writer();
   const auto end_pathfinder_time = std::chrono::steady_clock::now();
   const double pathfinder_delta_time = stan::services::util::duration_diff(
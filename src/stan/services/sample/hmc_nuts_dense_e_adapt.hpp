@@ -8,11 +8,15 @@
 #include <stan/io/var_context.hpp>
 #include <stan/math/prim.hpp>
 #include <stan/mcmc/hmc/nuts/adapt_dense_e_nuts.hpp>
+#include <stan/mcmc/warmup_convergence_monitor.hpp>
 #include <stan/services/error_codes.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/initialize.hpp>
+#include <stan/services/util/initialize_parallel.hpp>
 #include <stan/services/util/inv_metric.hpp>
 #include <stan/services/util/run_adaptive_sampler.hpp>
+#include <stan/services/util/run_adaptive_warmup_sampler.hpp>
+#include <stan/services/util/run_cross_chain_adaptive_sampler.hpp>
 #include <vector>
 
 namespace stan {
@@ -111,6 +115,110 @@ int hmc_nuts_dense_e_adapt(
   return error_codes::OK;
 }
 
+/**
+ * Runs HMC with NUTS with adaptation using dense Euclidean metric
+ * with a pre-specified dense metric and saves adapted tuning parameters.
+ * Warmup ends early, after a terminal buffer for the step size, once
+ * the adapted step size and metric stop changing between adaptation
+ * windows, and a record of how warmup ended is written.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] init_inv_metric var context exposing an initial dense
+ *            inverse Euclidean metric (must be positive definite)
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in] warmup_stepsize_tol end warmup early once the relative change
+ * in the adapted step size between adaptation windows is at most this value
+ * @param[in] warmup_metric_tol end warmup early once the relative change in
+ * the adapted inverse metric between adaptation windows is at most this value
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @param[in,out] warmup_writer Writer for the record of how warmup ended
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_dense_e_adapt(
+    Model& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, double warmup_stepsize_tol, double warmup_metric_tol,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer,
+    callbacks::structured_writer& warmup_writer) {
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  std::vector<double> cont_vector;
+
+  Eigen::MatrixXd inv_metric;
+  try {
+    cont_vector = util::initialize(model, init, rng, init_radius, true, logger,
+                                   init_writer);
+    inv_metric = util::read_dense_inv_metric(init_inv_metric,
+                                             model.num_params_r(), logger);
+    util::validate_dense_inv_metric(inv_metric, logger);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+
+  stan::mcmc::adapt_dense_e_nuts<Model, stan::rng_t> sampler(model, rng);
+
+  sampler.set_metric(inv_metric);
+
+  sampler.set_nominal_stepsize(stepsize);
+  sampler.set_stepsize_jitter(stepsize_jitter);
+  sampler.set_max_depth(max_depth);
+
+  sampler.get_stepsize_adaptation().set_mu(log(10 * stepsize));
+  sampler.get_stepsize_adaptation().set_delta(delta);
+  sampler.get_stepsize_adaptation().set_gamma(gamma);
+  sampler.get_stepsize_adaptation().set_kappa(kappa);
+  sampler.get_stepsize_adaptation().set_t0(t0);
+
+  sampler.set_window_params(num_warmup, init_buffer, term_buffer, window,
+                            logger);
+  try {
+    stan::mcmc::warmup_convergence_monitor monitor(warmup_stepsize_tol,
+                                                   warmup_metric_tol);
+    util::run_adaptive_warmup_sampler(
+        sampler, model, cont_vector, num_warmup, num_samples, num_thin,
+        refresh, save_warmup, monitor, rng, interrupt, logger, sample_writer,
+        diagnostic_writer, metric_writer, warmup_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+
+  return error_codes::OK;
+}
+
 /**
  * Runs HMC with NUTS with adaptation using dense Euclidean metric
  * with a pre-specified dense metric.
@@ -315,6 +423,17 @@ int hmc_nuts_dense_e_adapt(
  * @param[in] init_buffer width of initial fast adaptation interval
  * @param[in] term_buffer width of final fast adaptation interval
  * @param[in] window initial width of slow adaptation interval
+ * @param[in] cross_chain_adapt if true, the chains pool their warmup
+ * statistics at the end of each adaptation window so that all chains share
+ * one metric and step size
+ * @param[in] cross_chain_ess_target when pooling, end warmup early once the
+ * effective sample size of lp__ over all chains within an adaptation window
+ * reaches this value; zero disables early termination
+ * @param[in] init_batch_size number of candidate initial values of a
+ * chain evaluated concurrently; 1 evaluates them one at a time
+ * @param[in] init_num_best number of valid candidate initial values to
+ * choose the highest log density initial value of a chain from; 1 takes
+ * the first valid one
  * @param[in,out] interrupt Callback for interrupts
  * @param[in,out] logger Logger for messages
  * @param[in,out] init_writer std vector of Writer callbacks for unconstrained
@@ -336,12 +455,15 @@ int hmc_nuts_dense_e_adapt(
     int refresh, double stepsize, double stepsize_jitter, int max_depth,
     double delta, double gamma, double kappa, double t0,
     unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    bool cross_chain_adapt, double cross_chain_ess_target,
+    size_t init_batch_size, size_t init_num_best,
     callbacks::interrupt& interrupt, callbacks::logger& logger,
     std::vector<InitWriter>& init_writer,
     std::vector<SampleWriter>& sample_writer,
     std::vector<DiagnosticWriter>& diagnostic_writer,
     std::vector<MetricWriter>& metric_writer) {
-  if (num_chains == 1) {
+  if (num_chains == 1 && !cross_chain_adapt && init_batch_size == 1
+      && init_num_best == 1) {
     return hmc_nuts_dense_e_adapt(
         model, *init[0], *init_inv_metric[0], random_seed, init_chain_id,
         init_radius, num_warmup, num_samples, num_thin, save_warmup, refresh,
@@ -359,8 +481,9 @@ int hmc_nuts_dense_e_adapt(
   try {
     for (int i = 0; i < num_chains; ++i) {
       rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
-      cont_vectors.emplace_back(util::initialize(
-          model, *init[i], rngs[i], init_radius, true, logger, init_writer[i]));
+      cont_vectors.emplace_back(util::initialize_parallel(
+          model, *init[i], rngs[i], init_radius, true, init_batch_size,
+          init_num_best, logger, init_writer[i]));
       Eigen::MatrixXd inv_metric = util::read_dense_inv_metric(
           *init_inv_metric[i], model.num_params_r(), logger);
       util::validate_dense_inv_metric(inv_metric, logger);
@@ -383,6 +506,19 @@ int hmc_nuts_dense_e_adapt(
     logger.error(e.what());
     return error_codes::CONFIG;
   }
+  if (cross_chain_adapt) {
+    try {
+      util::run_cross_chain_adaptive_sampler(
+          samplers, model, cont_vectors, num_warmup, num_samples, num_thin,
+          refresh, save_warmup, cross_chain_ess_target, rngs, interrupt,
+          logger, sample_writer, diagnostic_writer, metric_writer,
+          init_chain_id);
+    } catch (const std::exception& e) {
+      logger.error(e.what());
+      return error_codes::SOFTWARE;
+    }
+    return error_codes::OK;
+  }
   try {
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, num_chains, 1),
@@ -406,6 +542,82 @@ int hmc_nuts_dense_e_adapt(
   return error_codes::OK;
 }
 
+/**
+ * Runs multiple chains of NUTS with adaptation using dense Euclidean metric
+ * with a pre-specified dense metric and saves adapted tuning parameters
+ * stepsize and inverse metric.
+ *
+ * @tparam Model Model class
+ * @tparam InitContextPtr A pointer with underlying type derived from
+ * `stan::io::var_context`
+ * @tparam InitInvContextPtr A pointer with underlying type derived from
+ * `stan::io::var_context`
+ * @tparam InitWriter A type derived from `stan::callbacks::writer`
+ * @tparam SamplerWriter A type derived from `stan::callbacks::writer`
+ * @tparam DiagnosticWriter A type derived from `stan::callbacks::writer`
+ * @tparam MetricWriter A type derived from `stan::callbacks::structured_writer`
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] num_chains The number of chains to run in parallel. `init`,
+ * `init_inv_metric`, `init_writer`, `sample_writer`, and `diagnostic_writer`
+ * must be the same length as this value.
+ * @param[in] init A std vector of init var contexts for per-chain
+ * initialization.
+ * @param[in] init_inv_metric A std vector of var contexts exposing an initial
+ * dense inverse Euclidean metric for each chain (must be positive definite)
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] init_chain_id first chain id. The pseudo random number generator
+ * will advance by for each chain by an integer sequence from `init_chain_id` to
+ * `init_chain_id+num_chains-1`
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer std vector of Writer callbacks for unconstrained
+ * inits of each chain.
+ * @param[in,out] sample_writer std vector of Writers for draws of each chain.
+ * @param[in,out] diagnostic_writer std vector of Writers for diagnostic
+ * information of each chain.
+ * @param[in,out] metric_writer std vector of Writers for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model, typename InitContextPtr, typename InitInvContextPtr,
+          typename InitWriter, typename SampleWriter, typename DiagnosticWriter,
+          typename MetricWriter>
+int hmc_nuts_dense_e_adapt(
+    Model& model, size_t num_chains, const std::vector<InitContextPtr>& init,
+    const std::vector<InitInvContextPtr>& init_inv_metric,
+    unsigned int random_seed, unsigned int init_chain_id, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    std::vector<InitWriter>& init_writer,
+    std::vector<SampleWriter>& sample_writer,
+    std::vector<DiagnosticWriter>& diagnostic_writer,
+    std::vector<MetricWriter>& metric_writer) {
+  return hmc_nuts_dense_e_adapt(
+      model, num_chains, init, init_inv_metric, random_seed, init_chain_id,
+      init_radius, num_warmup, num_samples, num_thin, save_warmup, refresh,
+      stepsize, stepsize_jitter, max_depth, delta, gamma, kappa, t0,
+      init_buffer, term_buffer, window, false, 0, 1, 1, interrupt, logger,
+      init_writer, sample_writer, diagnostic_writer, metric_writer);
+}
+
 /**
  * Runs multiple chains of NUTS with adaptation using dense Euclidean metric,
  * with a pre-specified dense metric.
@@ -0,0 +1,404 @@
+#ifndef STAN_SERVICES_UTIL_ASYNC_MCMC_WRITER_HPP
+#define STAN_SERVICES_UTIL_ASYNC_MCMC_WRITER_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/base_mcmc.hpp>
+#include <stan/mcmc/sample.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <tbb/concurrent_queue.h>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+namespace internal {
+
+/**
+ * Sampler standing in for the real sampler on the writer thread,
+ * replaying the sampler parameters and diagnostics recorded when a
+ * draw was queued.
+ */
+class recorded_sampler_state : public stan::mcmc::base_mcmc {
+ public:
+  stan::mcmc::sample transition(stan::mcmc::sample& init_sample,
+                                callbacks::logger& logger) {
+    return init_sample;
+  }
+
+  void get_sampler_params(std::vector<double>& values) {
+    values.insert(values.end(), params_.begin(), params_.end());
+  }
+
+  void get_sampler_diagnostics(std::vector<double>& values) {
+    values.insert(values.end(), diagnostics_.begin(), diagnostics_.end());
+  }
+
+  std::vector<double> params_;
+  std::vector<double> diagnostics_;
+};
+
+/**
+ * Logger queuing the messages logged on the writer thread, so that they
+ * can be passed on to the real logger from the sampling thread.
+ */
+class queued_logger : public callbacks::logger {
+ public:
+  void debug(const std::string& message) { push(level::debug, message); }
+  void debug(const std::stringstream& message) {
+    push(level::debug, message.str());
+  }
+  void info(const std::string& message) { push(level::info, message); }
+  void info(const std::stringstream& message) {
+    push(level::info, message.str());
+  }
+  void warn(const std::string& message) { push(level::warn, message); }
+  void warn(const std::stringstream& message) {
+    push(level::warn, message.str());
+  }
+  void error(const std::string& message) { push(level::error, message); }
+  void error(const std::stringstream& message) {
+    push(level::error, message.str());
+  }
+  void fatal(const std::string& message) { push(level::fatal, message); }
+  void fatal(const std::stringstream& message) {
+    push(level::fatal, message.str());
+  }
+
+  /**
+   * Passes the queued messages on to the specified logger in the order
+   * they were logged.
+   *
+   * @param[in,out] logger logger for the messages
+   */
+  void replay(callbacks::logger& logger) {
+    std::pair<level, std::string> message;
+    while (messages_.try_pop(message)) {
+      switch (message.first) {
+        case level::debug:
+          logger.debug(message.second);
+          break;
+        case level::info:
+          logger.info(message.second);
+          break;
+        case level::warn:
+          logger.warn(message.second);
+          break;
+        case level::error:
+          logger.error(message.second);
+          break;
+        case level::fatal:
+          logger.fatal(message.second);
+          break;
+      }
+    }
+  }
+
+ private:
+  enum class level { debug, info, warn, error, fatal };
+
+  void push(level lvl, const std::string& message) {
+    messages_.push(std::make_pair(lvl, message));
+  }
+
+  tbb::concurrent_queue<std::pair<level, std::string>> messages_;
+};
+
+}  // namespace internal
+
+/**
+ * Writer with the interface of <code>mcmc_writer</code> that moves
+ * the work of writing draws off the sampling thread.
+ *
+ * Writing a draw only copies the unconstrained draw and the sampler
+ * parameters into a preallocated buffer and hands it to a background
+ * thread through a bounded concurrent queue.  The background thread
+ * runs <code>model.write_array</code> and the output writers in the
+ * order the draws were queued.  Once all buffers are in flight,
+ * writing blocks until the background thread frees one.
+ *
+ * Headers, the adaptation message and timing are written after all
+ * queued draws, so output is in the same order as with
+ * <code>mcmc_writer</code>.  Because <code>write_array</code> runs
+ * concurrently with the sampler, it must be given its own random number
+ * generator rather than the one the sampler uses.  Any draw that the
+ * sampler does not use for <code>write_array</code> will differ from a
+ * run with <code>mcmc_writer</code>.
+ *
+ * The writers are only used from the background thread while draws are
+ * in flight.  The logger is only ever used from the sampling thread, as
+ * the sampler logs through it concurrently: messages logged while
+ * writing a draw are queued and passed on to the logger by the next
+ * call on the sampling thread, so they may follow messages the sampler
+ * logged later.  An exception thrown while writing a draw
+ * stops further output and is rethrown on the sampling thread by the
+ * next call that writes, by <code>flush()</code>, or by
+ * <code>finish()</code>.
+ *
+ * @tparam Model Model class
+ * @tparam RNG Random number generator class used by write_array
+ */
+template <class Model, class RNG>
+class async_mcmc_writer {
+ public:
+  /**
+   * Construct the writer and start its background thread.
+   *
+   * @param[in,out] sample_writer samples are "written" to this stream
+   * @param[in,out] diagnostic_writer diagnostic info is "written" to this
+   *   stream
+   * @param[in,out] logger messages are written through the logger
+   * @param[in] model model used to generate quantities for each draw
+   * @param[in,out] rng random number generator used only for write_array
+   * @param[in] capacity maximum number of draws in flight
+   */
+  async_mcmc_writer(callbacks::writer& sample_writer,
+                    callbacks::writer& diagnostic_writer,
+                    callbacks::logger& logger, Model& model, RNG& rng,
+                    size_t capacity = 64)
+      : logger_(logger),
+        writer_(sample_writer, diagnostic_writer, queued_logger_),
+        model_(model),
+        rng_(rng),
+        failed_(false) {
+    if (capacity < 1)
+      capacity = 1;
+    items_.reserve(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+      items_.emplace_back(new item());
+      free_.push(items_.back().get());
+    }
+    queued_.set_capacity(capacity + 1);
+    thread_ = std::thread([this]() { consume(); });
+  }
+
+  async_mcmc_writer(const async_mcmc_writer&) = delete;
+  async_mcmc_writer& operator=(const async_mcmc_writer&) = delete;
+
+  /**
+   * Waits for all queued draws to be written.  Errors raised while
+   * writing are only reported by <code>finish()</code>.
+   */
+  ~async_mcmc_writer() {
+    try {
+      finish();
+    } catch (...) {
+    }
+  }
+
+  /**
+   * Writes the parameter names after all queued draws.
+   *
+   * @tparam M Model class
+   * @param[in] sample a sample (unconstrained) that works with the model
+   * @param[in] sampler a stan::mcmc::base_mcmc object
+   * @param[in] model the model
+   */
+  template <class M>
+  void write_sample_names(stan::mcmc::sample& sample,
+                          stan::mcmc::base_mcmc& sampler, M& model) {
+    flush();
+    writer_.write_sample_names(sample, sampler, model);
+    queued_logger_.replay(logger_);
+  }
+
+  /**
+   * Queues a draw to be written to the sample stream.  The random
+   * number generator and model arguments are ignored in favor of those
+   * given on construction; they are accepted so that this writer can
+   * replace <code>mcmc_writer</code>.
+   *
+   * @tparam R Random number generator class
+   * @tparam M Model class
+   * @param[in] sample the sample in unconstrained space
+   * @param[in] sampler the sampler
+   */
+  template <class R, class M>
+  void write_sample_params(R&, stan::mcmc::sample& sample,
+                           stan::mcmc::base_mcmc& sampler, M&) {
+    item* draw = acquire();
+    draw->kind = item_kind::sample_params;
+    draw->sample = sample;
+    draw->sampler.params_.clear();
+    sampler.get_sampler_params(draw->sampler.params_);
+    queued_.push(draw);
+  }
+
+  /**
+   * Writes the adaptation message after all queued draws.
+   *
+   * @param[in] sampler sampler
+   */
+  void write_adapt_finish(stan::mcmc::base_mcmc& sampler) {
+    flush();
+    writer_.write_adapt_finish(sampler);
+    queued_logger_.replay(logger_);
+  }
+
+  /**
+   * Writes the diagnostic names after all queued draws.
+   *
+   * @tparam M Model class
+   * @param[in] sample unconstrained sample
+   * @param[in] sampler sampler
+   * @param[in] model model
+   */
+  template <class M>
+  void write_diagnostic_names(stan::mcmc::sample sample,
+                              stan::mcmc::base_mcmc& sampler, M& model) {
+    flush();
+    writer_.write_diagnostic_names(sample, sampler, model);
+    queued_logger_.replay(logger_);
+  }
+
+  /**
+   * Queues a draw to be written to the diagnostic stream.
+   *
+   * @param[in] sample unconstrained sample
+   * @param[in] sampler sampler
+   */
+  void write_diagnostic_params(stan::mcmc::sample& sample,
+                               stan::mcmc::base_mcmc& sampler) {
+    item* draw = acquire();
+    draw->kind = item_kind::diagnostic_params;
+    draw->sample = sample;
+    draw->sampler.params_.clear();
+    sampler.get_sampler_params(draw->sampler.params_);
+    draw->sampler.diagnostics_.clear();
+    sampler.get_sampler_diagnostics(draw->sampler.diagnostics_);
+    queued_.push(draw);
+  }
+
+  /**
+   * Writes timing information after all queued draws.
+   *
+   * @param[in] warmDeltaT warmup time (sec)
+   * @param[in] sampleDeltaT sample time (sec)
+   */
+  void write_timing(double warmDeltaT, double sampleDeltaT) {
+    flush();
+    writer_.write_timing(warmDeltaT, sampleDeltaT);
+    queued_logger_.replay(logger_);
+  }
+
+  /**
+   * Blocks until every queued draw has been written.
+   *
+   * @throw the first exception raised while writing a draw
+   */
+  void flush() {
+    if (!thread_.joinable()) {
+      rethrow_if_failed();
+      return;
+    }
+    std::promise<void> done;
+    std::future<void> written = done.get_future();
+    item* marker = acquire();
+    marker->kind = item_kind::flush;
+    marker->done = &done;
+    queued_.push(marker);
+    written.wait();
+    rethrow_if_failed();
+  }
+
+  /**
+   * Writes all queued draws and stops the background thread.  No
+   * further draws may be written.
+   *
+   * @throw the first exception raised while writing a draw
+   */
+  void finish() {
+    if (thread_.joinable()) {
+      item* marker = free_pop();
+      marker->kind = item_kind::stop;
+      queued_.push(marker);
+      thread_.join();
+    }
+    rethrow_if_failed();
+  }
+
+ private:
+  enum class item_kind { sample_params, diagnostic_params, flush, stop };
+
+  struct item {
+    item() : sample(Eigen::VectorXd(), 0, 0), done(nullptr) {}
+    item_kind kind;
+    stan::mcmc::sample sample;
+    internal::recorded_sampler_state sampler;
+    std::promise<void>* done;
+  };
+
+  callbacks::logger& logger_;
+  internal::queued_logger queued_logger_;
+  mcmc_writer writer_;
+  Model& model_;
+  RNG& rng_;
+
+  std::vector<std::unique_ptr<item>> items_;
+  tbb::concurrent_bounded_queue<item*> free_;
+  tbb::concurrent_bounded_queue<item*> queued_;
+  std::thread thread_;
+
+  std::atomic<bool> failed_;
+  std::exception_ptr error_;
+
+  item* free_pop() {
+    item* next;
+    free_.pop(next);
+    return next;
+  }
+
+  item* acquire() {
+    rethrow_if_failed();
+    return free_pop();
+  }
+
+  void rethrow_if_failed() {
+    queued_logger_.replay(logger_);
+    if (failed_.load(std::memory_order_acquire))
+      std::rethrow_exception(error_);
+  }
+
+  void consume() {
+    while (true) {
+      item* next;
+      queued_.pop(next);
+      if (next->kind == item_kind::stop) {
+        free_.push(next);
+        return;
+      }
+      if (next->kind == item_kind::flush) {
+        std::promise<void>* done = next->done;
+        free_.push(next);
+        done->set_value();
+        continue;
+      }
+      if (!failed_.load(std::memory_order_relaxed)) {
+        try {
+          if (next->kind == item_kind::sample_params)
+            writer_.write_sample_params(rng_, next->sample, next->sampler,
+                                        model_);
+          else
+            writer_.write_diagnostic_params(next->sample, next->sampler);
+        } catch (...) {
+          error_ = std::current_exception();
+          failed_.store(true, std::memory_order_release);
+        }
+      }
+      free_.push(next);
+    }
+  }
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
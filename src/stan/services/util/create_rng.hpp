@@ -10,6 +10,27 @@ using rng_t = boost::random::mixmax;
 namespace services {
 namespace util {
 
+/**
+ * Creates a pseudo random number generator for one of the independent
+ * streams of a chain, such as one per draw when draws are generated in
+ * parallel, so that the results do not depend on the number of threads.
+ * Stream 0 is the generator returned by <code>create_rng(seed,
+ * chain)</code>.
+ *
+ * @param[in] seed the random seed
+ * @param[in] chain the chain id
+ * @param[in] stream the stream id within the chain
+ * @return an stan::rng_t instance
+ */
+inline rng_t create_rng(unsigned int seed, unsigned int chain,
+                        unsigned int stream) {
+  // RNG state is 128 bits, but user only provides 64 total bits
+  // Additionally, there are issues if all 128 bits are 0, hence
+  // the 1 as the second argument
+  rng_t rng(stream, 1, seed, chain);
+  return rng;
+}
+
 /**
  * Creates a pseudo random number generator from a random seed
  * and a chain id by initializing the PRNG with the seed and
@@ -26,11 +47,7 @@ namespace util {
  * @return an stan::rng_t instance
  */
 inline rng_t create_rng(unsigned int seed, unsigned int chain) {
-  // RNG state is 128 bits, but user only provides 64 total bits
-  // Additionally, there are issues if all 128 bits are 0, hence
-  // the 1 as the second argument
-  rng_t rng(0, 1, seed, chain);
-  return rng;
+  return create_rng(seed, chain, 0);
 }
 
 }  // namespace util
@@ -11,10 +11,18 @@ namespace services {
 namespace util {
 
 /**
- * Generates MCMC transitions.
+ * Generates MCMC transitions for part of a warmup or sampling phase
+ * that is run over several calls.
+ *
+ * Draws are thinned and iteration number messages are printed as if
+ * the whole phase were generated in a single call starting at
+ * <code>phase_start</code>, so splitting a phase into segments does
+ * not change which draws are written.
  *
  * @tparam Model model class
  * @tparam RNG random number generator class
+ * @tparam McmcWriter writer with the interface of
+ *   <code>mcmc_writer</code>, such as <code>async_mcmc_writer</code>
  * @param[in,out] sampler MCMC sampler used to generate transitions
  * @param[in] num_iterations number of MCMC transitions
  * @param[in] start starting iteration number used for printing messages
@@ -38,21 +46,24 @@ namespace util {
  * @param[in] chain_id The id of the current chain, used in output.
  * @param[in] num_chains The number of chains used in the program. This
  *  is used in generate transitions to print out the chain number.
+ * @param[in] phase_start iteration number at which the phase started,
+ *   at most <code>start</code>
  */
-template <class Model, class RNG>
+template <class Model, class RNG, class McmcWriter>
 void generate_transitions(stan::mcmc::base_mcmc& sampler, int num_iterations,
                           int start, int finish, int num_thin, int refresh,
-                          bool save, bool warmup,
-                          util::mcmc_writer& mcmc_writer,
+                          bool save, bool warmup, McmcWriter& mcmc_writer,
                           stan::mcmc::sample& init_s, Model& model,
                           RNG& base_rng, callbacks::interrupt& callback,
-                          callbacks::logger& logger, size_t chain_id = 1,
-                          size_t num_chains = 1) {
+                          callbacks::logger& logger, size_t chain_id,
+                          size_t num_chains, int phase_start) {
   for (int m = 0; m < num_iterations; ++m) {
     callback();
 
+    // iteration within the phase
+    int n = start - phase_start + m;
     if (refresh > 0
-        && (start + m + 1 == finish || m == 0 || (m + 1) % refresh == 0)) {
+        && (start + m + 1 == finish || n == 0 || (n + 1) % refresh == 0)) {
       int it_print_width = std::ceil(std::log10(static_cast<double>(finish)));
       std::stringstream message;
       if (num_chains != 1) {
@@ -69,13 +80,57 @@ void generate_transitions(stan::mcmc::base_mcmc& sampler, int num_iterations,
 
     init_s = sampler.transition(init_s, logger);
 
-    if (save && ((m % num_thin) == 0)) {
+    if (save && ((n % num_thin) == 0)) {
       mcmc_writer.write_sample_params(base_rng, init_s, sampler, model);
       mcmc_writer.write_diagnostic_params(init_s, sampler);
     }
   }
 }
 
+/**
+ * Generates MCMC transitions.
+ *
+ * @tparam Model model class
+ * @tparam RNG random number generator class
+ * @tparam McmcWriter writer with the interface of
+ *   <code>mcmc_writer</code>, such as <code>async_mcmc_writer</code>
+ * @param[in,out] sampler MCMC sampler used to generate transitions
+ * @param[in] num_iterations number of MCMC transitions
+ * @param[in] start starting iteration number used for printing messages
+ * @param[in] finish end iteration number used for printing messages
+ * @param[in] num_thin when save is true, a draw will be written to the
+ *   mcmc_writer every num_thin iterations
+ * @param[in] refresh number of iterations to print a message. If
+ *   refresh is zero, iteration number messages will not be printed
+ * @param[in] save if save is true, the transitions will be written
+ *   to the mcmc_writer. If false, transitions will not be written
+ * @param[in] warmup indicates whether these transitions are warmup. Used
+ *   for printing iteration number messages
+ * @param[in,out] mcmc_writer writer to handle mcmc output
+ * @param[in,out] init_s starts as the initial unconstrained parameter
+ *   values. When the function completes, this will have the final
+ *   iteration's unconstrained parameter values
+ * @param[in] model model
+ * @param[in,out] base_rng random number generator
+ * @param[in,out] callback interrupt callback called once an iteration
+ * @param[in,out] logger logger for messages
+ * @param[in] chain_id The id of the current chain, used in output.
+ * @param[in] num_chains The number of chains used in the program. This
+ *  is used in generate transitions to print out the chain number.
+ */
+template <class Model, class RNG, class McmcWriter>
+void generate_transitions(stan::mcmc::base_mcmc& sampler, int num_iterations,
+                          int start, int finish, int num_thin, int refresh,
+                          bool save, bool warmup, McmcWriter& mcmc_writer,
+                          stan::mcmc::sample& init_s, Model& model,
+                          RNG& base_rng, callbacks::interrupt& callback,
+                          callbacks::logger& logger, size_t chain_id = 1,
+                          size_t num_chains = 1) {
+  generate_transitions(sampler, num_iterations, start, finish, num_thin,
+                       refresh, save, warmup, mcmc_writer, init_s, model,
+                       base_rng, callback, logger, chain_id, num_chains, start);
+}
+
 }  // namespace util
 }  // namespace services
 }  // namespace stan
@@ -0,0 +1,397 @@
+#ifndef STAN_SERVICES_UTIL_INITIALIZE_PARALLEL_HPP
+#define STAN_SERVICES_UTIL_INITIALIZE_PARALLEL_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/io/random_var_context.hpp>
+#include <stan/io/chained_var_context.hpp>
+#include <stan/model/log_prob_grad.hpp>
+#include <stan/math/prim.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+namespace internal {
+
+/**
+ * Messages for the logger recorded while an initial value is evaluated
+ * on a worker thread, so that they can be written in candidate order
+ * afterwards.
+ */
+class init_log {
+ public:
+  enum level { INFO, WARN, ERROR };
+
+  void info(const std::string& message) {
+    messages_.emplace_back(INFO, message);
+  }
+  void info(const std::stringstream& message) { info(message.str()); }
+  void warn(const std::string& message) {
+    messages_.emplace_back(WARN, message);
+  }
+  void error(const std::string& message) {
+    messages_.emplace_back(ERROR, message);
+  }
+
+  /**
+   * Write the recorded messages to the logger.
+   *
+   * @param[in,out] logger logger for messages
+   */
+  void replay(stan::callbacks::logger& logger) const {
+    for (const auto& message : messages_) {
+      if (message.first == INFO)
+        logger.info(message.second);
+      else if (message.first == WARN)
+        logger.warn(message.second);
+      else
+        logger.error(message.second);
+    }
+  }
+
+ private:
+  std::vector<std::pair<level, std::string>> messages_;
+};
+
+/**
+ * A candidate initial value and the outcome of its evaluation.
+ */
+struct init_candidate {
+  // only constructed if some initial values are supplied
+  std::unique_ptr<stan::io::random_var_context> random_context;
+  std::vector<double> unconstrained;
+  double log_prob = -std::numeric_limits<double>::infinity();
+  double gradient_time = 0;  // seconds
+  bool generated = false;    // random values were drawn without error
+  bool valid = false;
+  std::exception_ptr error;  // unrecoverable error from the model
+  init_log log;
+};
+
+inline void reject_init(init_log& log, const std::string& reason) {
+  log.warn("Rejecting initial value:");
+  log.warn("  Error evaluating the log probability at the initial value.");
+  log.warn(reason);
+}
+
+inline void fail_init(init_log& log) {
+  log.error(
+      "Unrecoverable error evaluating the log probability"
+      " at the initial value.");
+}
+
+/**
+ * Evaluate a candidate whose random values have been drawn, recording
+ * the messages to log for it.  Safe to call concurrently for different
+ * candidates.
+ */
+template <bool Jacobian, typename Model, typename InitContext>
+void evaluate_init_candidate(const Model& model, const InitContext& init,
+                             bool any_initialized, init_candidate& candidate) {
+  std::vector<int> disc_vector;
+  std::stringstream msg;
+  try {
+    if (any_initialized) {
+      stan::io::chained_var_context context(init, *candidate.random_context);
+      model.transform_inits(context, disc_vector, candidate.unconstrained,
+                            &msg);
+    }
+  } catch (std::domain_error& e) {
+    if (msg.str().length() > 0)
+      candidate.log.info(msg);
+    reject_init(candidate.log, e.what());
+    return;
+  } catch (std::exception& e) {
+    if (msg.str().length() > 0)
+      candidate.log.info(msg);
+    fail_init(candidate.log);
+    candidate.error = std::current_exception();
+    return;
+  }
+  candidate.random_context.reset();
+
+  msg.str("");
+  double log_prob(0);
+  try {
+    // we evaluate the log_prob function with propto=false
+    // because we're evaluating with `double` as the type of
+    // the parameters.
+    log_prob = model.template log_prob<false, Jacobian>(
+        candidate.unconstrained, disc_vector, &msg);
+    if (msg.str().length() > 0)
+      candidate.log.info(msg);
+  } catch (std::domain_error& e) {
+    if (msg.str().length() > 0)
+      candidate.log.info(msg);
+    reject_init(candidate.log, e.what());
+    return;
+  } catch (std::exception& e) {
+    if (msg.str().length() > 0)
+      candidate.log.info(msg);
+    fail_init(candidate.log);
+    candidate.error = std::current_exception();
+    return;
+  }
+  if (!std::isfinite(log_prob)) {
+    candidate.log.warn("Rejecting initial value:");
+    candidate.log.warn(
+        "  Log probability evaluates to log(0), i.e. negative infinity.");
+    candidate.log.warn("  Stan can't start sampling from this initial value.");
+    return;
+  }
+
+  std::stringstream log_prob_msg;
+  std::vector<double> gradient;
+  auto start = std::chrono::steady_clock::now();
+  try {
+    // we evaluate this with propto=true since we're
+    // evaluating with autodiff variables
+    stan::model::log_prob_grad<true, Jacobian>(model, candidate.unconstrained,
+                                               disc_vector, gradient,
+                                               &log_prob_msg);
+  } catch (const std::exception& e) {
+    if (log_prob_msg.str().length() > 0)
+      candidate.log.info(log_prob_msg);
+    candidate.log.error(e.what());
+    candidate.error = std::current_exception();
+    return;
+  }
+  auto end = std::chrono::steady_clock::now();
+  candidate.gradient_time
+      = std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count()
+        / 1000000.0;
+  if (log_prob_msg.str().length() > 0)
+    candidate.log.info(log_prob_msg);
+
+  if (!std::isfinite(stan::math::sum(gradient))) {
+    candidate.log.warn("Rejecting initial value:");
+    candidate.log.warn(
+        "  Gradient evaluated at the initial value is not finite.");
+    candidate.log.warn("  Stan can't start sampling from this initial value.");
+    return;
+  }
+  candidate.log_prob = log_prob;
+  candidate.valid = true;
+}
+
+}  // namespace internal
+
+/**
+ * Returns a valid initial value of the parameters of the model on the
+ * unconstrained scale, evaluating batches of candidate initial values
+ * concurrently.
+ *
+ * This is the implementation of <code>initialize</code>, which calls it
+ * with a batch size of 1; larger batches are for models whose random
+ * initial values are often rejected.  The random values
+ * of each batch of candidates are drawn sequentially from
+ * <code>rng</code>; the candidates are then evaluated in parallel and
+ * examined in the order they were drawn.  Messages are written to the
+ * logger in that order, as if the candidates had been evaluated one at
+ * a time, and none are written for candidates after the one returned.
+ *
+ * With <code>num_best</code> equal to 1, the first valid candidate is
+ * returned.  Otherwise, the candidate with the highest log density
+ * among the first <code>num_best</code> valid candidates is returned,
+ * or among all valid candidates if fewer are found within
+ * <code>MAX_INIT_TRIES = 100</code> attempts; ties go to the earlier
+ * candidate.
+ *
+ * On return, and when an exception is thrown, <code>rng</code> is in
+ * the state it would have after drawing the candidates up to the last
+ * one examined, regardless of the batch size.  So with
+ * <code>num_best</code> equal to 1, this function returns the same
+ * initial value and leaves <code>rng</code> in the same state for any
+ * batch size.
+ *
+ * The model's <code>log_prob</code>, <code>transform_inits</code> and
+ * gradient are evaluated concurrently, so the model must be safe to
+ * evaluate from multiple threads, as for running multiple chains in
+ * parallel.
+ *
+ * @tparam Jacobian indicates whether to include the Jacobian term when
+ *   evaluating the log density function
+ * @tparam Model the type of the model class
+ * @tparam InitContext the type of the var_context with initial values
+ * @tparam RNG the type of the random number generator, which must be
+ *   copy assignable
+ *
+ * @param[in] model the model
+ * @param[in] init a var_context with initial values
+ * @param[in,out] rng random number generator
+ * @param[in] init_radius the radius for generating random values.
+ *   A value of 0 indicates that the unconstrained parameters (not
+ *   provided by init) should be initialized with 0.
+ * @param[in] print_timing indicates whether a timing message should
+ *   be printed to the logger
+ * @param[in] batch_size number of candidates evaluated concurrently;
+ *   must be positive
+ * @param[in] num_best number of valid candidates to choose the
+ *   initial value from; must be positive
+ * @param[in,out] logger logger for messages
+ * @param[in,out] init_writer init writer (on the unconstrained scale)
+ * @throws std::invalid_argument if batch_size or num_best is 0
+ * @throws exception passed through from the model if the model has a
+ *   fatal error (not a std::domain_error)
+ * @throws std::domain_error if the model can not be initialized and
+ *   the model does not have a fatal error (only allows for
+ *   std::domain_error)
+ * @return valid unconstrained parameters for the model
+ */
+template <bool Jacobian = true, typename Model, typename InitContext,
+          typename RNG>
+std::vector<double> initialize_parallel(Model& model, const InitContext& init,
+                                        RNG& rng, double init_radius,
+                                        bool print_timing, size_t batch_size,
+                                        size_t num_best,
+                                        stan::callbacks::logger& logger,
+                                        stan::callbacks::writer& init_writer) {
+  if (batch_size == 0)
+    throw std::invalid_argument("batch_size must be positive");
+  if (num_best == 0)
+    throw std::invalid_argument("num_best must be positive");
+
+  bool is_fully_initialized = true;
+  bool any_initialized = false;
+  std::vector<std::string> param_names;
+  model.get_param_names(param_names, false, false);
+  for (size_t n = 0; n < param_names.size(); n++) {
+    is_fully_initialized &= init.contains_r(param_names[n]);
+    any_initialized |= init.contains_r(param_names[n]);
+  }
+
+  bool is_initialized_with_zero = init_radius == 0.0;
+
+  size_t MAX_INIT_TRIES
+      = is_fully_initialized || is_initialized_with_zero ? 1 : 100;
+  std::vector<internal::init_candidate> candidates;
+  std::vector<RNG> rng_states;
+  std::vector<double> best;
+  double best_log_prob = -std::numeric_limits<double>::infinity();
+  size_t num_valid = 0;
+  for (size_t num_init_tries = 0; num_init_tries < MAX_INIT_TRIES;) {
+    size_t size = std::min(batch_size, MAX_INIT_TRIES - num_init_tries);
+    candidates.clear();
+    candidates.resize(size);
+    rng_states.clear();
+
+    // draw the random values sequentially, as they share the rng
+    for (size_t i = 0; i < size; ++i) {
+      internal::init_candidate& candidate = candidates[i];
+      try {
+        if (!any_initialized)
+          candidate.unconstrained
+              = stan::io::random_var_context::draw_unconstrained(
+                  model, rng, init_radius, is_initialized_with_zero);
+        else
+          candidate.random_context
+              = std::make_unique<stan::io::random_var_context>(
+                  model, rng, init_radius, is_initialized_with_zero);
+        candidate.generated = true;
+      } catch (std::domain_error& e) {
+        internal::reject_init(candidate.log, e.what());
+      } catch (std::exception& e) {
+        internal::fail_init(candidate.log);
+        candidate.error = std::current_exception();
+      }
+      rng_states.push_back(rng);
+      if (candidate.error) {
+        size = i + 1;
+        break;
+      }
+    }
+
+    if (size == 1) {
+      if (candidates[0].generated)
+        internal::evaluate_init_candidate<Jacobian>(model, init,
+                                                    any_initialized,
+                                                    candidates[0]);
+    } else {
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, size, 1),
+          [&](const tbb::blocked_range<size_t>& r) {
+            for (size_t i = r.begin(); i != r.end(); ++i)
+              if (candidates[i].generated)
+                internal::evaluate_init_candidate<Jacobian>(
+                    model, init, any_initialized, candidates[i]);
+          },
+          tbb::simple_partitioner());
+    }
+
+    // examine the candidates in the order they were drawn
+    for (size_t i = 0; i < size; ++i) {
+      internal::init_candidate& candidate = candidates[i];
+      ++num_init_tries;
+      candidate.log.replay(logger);
+      if (candidate.error) {
+        rng = rng_states[i];
+        std::rethrow_exception(candidate.error);
+      }
+      if (!candidate.valid)
+        continue;
+      if (num_valid == 0 && print_timing) {
+        logger.info("");
+        std::stringstream msg1;
+        msg1 << "Gradient evaluation took " << candidate.gradient_time
+             << " seconds";
+        logger.info(msg1);
+
+        std::stringstream msg2;
+        msg2 << "1000 transitions using 10 leapfrog steps"
+             << " per transition would take"
+             << " " << 1e4 * candidate.gradient_time << " seconds.";
+        logger.info(msg2);
+
+        logger.info("Adjust your expectations accordingly!");
+        logger.info("");
+        logger.info("");
+      }
+      if (num_valid == 0 || candidate.log_prob > best_log_prob) {
+        best = std::move(candidate.unconstrained);
+        best_log_prob = candidate.log_prob;
+      }
+      if (++num_valid == num_best) {
+        rng = rng_states[i];
+        init_writer(best);
+        return best;
+      }
+    }
+  }
+
+  if (num_valid > 0) {
+    init_writer(best);
+    return best;
+  }
+  if (!is_initialized_with_zero) {
+    logger.info("");
+    std::stringstream msg;
+    msg << "Initialization between (-" << init_radius << ", " << init_radius
+        << ") failed after"
+        << " " << MAX_INIT_TRIES << " attempts. ";
+    logger.error(msg);
+    logger.error(
+        " Try specifying initial values,"
+        " reducing ranges of constrained values,"
+        " or reparameterizing the model.");
+  }
+  throw std::domain_error("Initialization failed.");
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
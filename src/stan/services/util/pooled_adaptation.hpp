@@ -0,0 +1,93 @@
+#ifndef STAN_SERVICES_UTIL_POOLED_ADAPTATION_HPP
+#define STAN_SERVICES_UTIL_POOLED_ADAPTATION_HPP
+
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/covar_adaptation.hpp>
+#include <stan/mcmc/stepsize_covar_adapter.hpp>
+#include <stan/mcmc/stepsize_var_adapter.hpp>
+#include <stan/mcmc/var_adaptation.hpp>
+#include <stan/mcmc/windowed_adaptation.hpp>
+#include <cmath>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+namespace internal {
+
+/**
+ * Return the windowed metric adaptation of an adaptive sampler with
+ * a diagonal metric.
+ */
+inline stan::mcmc::windowed_adaptation& metric_adaptation(
+    stan::mcmc::stepsize_var_adapter& adapter) {
+  return adapter.get_var_adaptation();
+}
+
+/**
+ * Return the windowed metric adaptation of an adaptive sampler with
+ * a dense metric.
+ */
+inline stan::mcmc::windowed_adaptation& metric_adaptation(
+    stan::mcmc::stepsize_covar_adapter& adapter) {
+  return adapter.get_covar_adaptation();
+}
+
+/**
+ * Apply the pending deferred metric update of the given samplers
+ * with diagonal metrics, setting all of them to the variance pooled
+ * over their last adaptation window.  The second argument only
+ * selects the metric type.
+ */
+template <typename Sampler>
+void pool_metric(const std::vector<Sampler*>& samplers,
+                 stan::mcmc::stepsize_var_adapter&) {
+  std::vector<stan::mcmc::var_adaptation*> adaptations;
+  adaptations.reserve(samplers.size());
+  for (Sampler* sampler : samplers)
+    adaptations.push_back(&sampler->get_var_adaptation());
+  Eigen::VectorXd inv_metric = samplers[0]->z().inv_e_metric_;
+  stan::mcmc::var_adaptation::pool_variance(adaptations, inv_metric);
+  for (Sampler* sampler : samplers)
+    sampler->set_metric(inv_metric);
+}
+
+/**
+ * Apply the pending deferred metric update of the given samplers
+ * with dense metrics, setting all of them to the covariance pooled
+ * over their last adaptation window.  The second argument only
+ * selects the metric type.
+ */
+template <typename Sampler>
+void pool_metric(const std::vector<Sampler*>& samplers,
+                 stan::mcmc::stepsize_covar_adapter&) {
+  std::vector<stan::mcmc::covar_adaptation*> adaptations;
+  adaptations.reserve(samplers.size());
+  for (Sampler* sampler : samplers)
+    adaptations.push_back(&sampler->get_covar_adaptation());
+  Eigen::MatrixXd inv_metric = samplers[0]->z().inv_e_metric_;
+  stan::mcmc::covar_adaptation::pool_covariance(adaptations, inv_metric);
+  for (Sampler* sampler : samplers)
+    sampler->set_metric(inv_metric);
+}
+
+/**
+ * Set every sampler to the geometric mean of their nominal step
+ * sizes and return it.
+ */
+template <typename Sampler>
+double pool_stepsize(const std::vector<Sampler*>& samplers) {
+  double log_stepsize = 0;
+  for (Sampler* sampler : samplers)
+    log_stepsize += std::log(sampler->get_nominal_stepsize());
+  double stepsize = std::exp(log_stepsize / samplers.size());
+  for (Sampler* sampler : samplers)
+    sampler->set_nominal_stepsize(stepsize);
+  return stepsize;
+}
+
+}  // namespace internal
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -4,6 +4,7 @@
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/structured_writer.hpp>
 #include <stan/callbacks/writer.hpp>
+#include <stan/services/util/async_mcmc_writer.hpp>
 #include <stan/services/util/generate_transitions.hpp>
 #include <stan/services/util/mcmc_writer.hpp>
 #include <tbb/parallel_for.h>
@@ -15,10 +16,77 @@ namespace stan {
 namespace services {
 namespace util {
 
+namespace internal {
+
+/**
+ * Runs the sampler with adaptation, writing the draws through the
+ * specified writer.  See <code>util::run_adaptive_sampler</code> for the
+ * remaining parameters.
+ *
+ * @tparam McmcWriter Type of writer for the draws
+ * @param[in,out] writer writer for the draws
+ */
+template <typename McmcWriter, typename Sampler, typename Model,
+          typename RNG>
+void run_adaptive_sampler(McmcWriter& writer, Sampler& sampler, Model& model,
+                          std::vector<double>& cont_vector, int num_warmup,
+                          int num_samples, int num_thin, int refresh,
+                          bool save_warmup, RNG& rng,
+                          callbacks::interrupt& interrupt,
+                          callbacks::logger& logger,
+                          callbacks::writer& sample_writer,
+                          callbacks::structured_writer& metric_writer,
+                          size_t chain_id, size_t num_chains) {
+  Eigen::Map<Eigen::VectorXd> cont_params(cont_vector.data(),
+                                          cont_vector.size());
+  stan::mcmc::sample s(cont_params, 0, 0);
+
+  // Headers
+  writer.write_sample_names(s, sampler, model);
+  writer.write_diagnostic_names(s, sampler, model);
+
+  auto start_warm = std::chrono::steady_clock::now();
+  util::generate_transitions(sampler, num_warmup, 0, num_warmup + num_samples,
+                             num_thin, refresh, save_warmup, true, writer, s,
+                             model, rng, interrupt, logger, chain_id,
+                             num_chains);
+  auto end_warm = std::chrono::steady_clock::now();
+  double warm_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            end_warm - start_warm)
+                            .count()
+                        / 1000.0;
+  sampler.disengage_adaptation();
+  writer.write_adapt_finish(sampler);
+  sampler.write_sampler_state(sample_writer);
+  sampler.write_sampler_state_struct(metric_writer);
+
+  auto start_sample = std::chrono::steady_clock::now();
+  util::generate_transitions(sampler, num_samples, num_warmup,
+                             num_warmup + num_samples, num_thin, refresh, true,
+                             false, writer, s, model, rng, interrupt, logger,
+                             chain_id, num_chains);
+  auto end_sample = std::chrono::steady_clock::now();
+  double sample_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              end_sample - start_sample)
+                              .count()
+                          / 1000.0;
+  writer.write_timing(warm_delta_t, sample_delta_t);
+}
+
+}  // namespace internal
+
 /**
  * Runs the sampler with adaptation, with writers for the sample,
  * diagnostics, and the adapted hmc tuning parameters.
  *
+ * With <code>async_write</code> set, the draws are written and their
+ * generated quantities computed on a background thread while sampling
+ * continues (see <code>async_mcmc_writer</code>).  The generated
+ * quantities then use their own random number generator, seeded from a
+ * single draw of <code>rng</code>, instead of sharing <code>rng</code>
+ * with the sampler.  The draws are therefore not the same as those of a
+ * synchronous run with the same seed, although both are reproducible.
+ *
  * @tparam Sampler Type of adaptive sampler.
  * @tparam Model Type of model
  * @tparam RNG Type of random number generator
@@ -42,6 +110,8 @@ namespace util {
  * @param[in] num_chains The number of chains used in the program. This
  *  is used in generate transitions to print out the chain number,
  *  (optional, default == 1)
+ * @param[in] async_write whether to write the draws on a background
+ *  thread, (optional, default == false)
  */
 template <typename Sampler, typename Model, typename RNG>
 void run_adaptive_sampler(Sampler& sampler, Model& model,
@@ -53,7 +123,8 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
                           callbacks::writer& sample_writer,
                           callbacks::writer& diagnostic_writer,
                           callbacks::structured_writer& metric_writer,
-                          size_t chain_id = 1, size_t num_chains = 1) {
+                          size_t chain_id = 1, size_t num_chains = 1,
+                          bool async_write = false) {
   Eigen::Map<Eigen::VectorXd> cont_params(cont_vector.data(),
                                           cont_vector.size());
 
@@ -67,39 +138,25 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
     return;
   }
 
-  services::util::mcmc_writer writer(sample_writer, diagnostic_writer, logger);
-  stan::mcmc::sample s(cont_params, 0, 0);
-
-  // Headers
-  writer.write_sample_names(s, sampler, model);
-  writer.write_diagnostic_names(s, sampler, model);
-
-  auto start_warm = std::chrono::steady_clock::now();
-  util::generate_transitions(sampler, num_warmup, 0, num_warmup + num_samples,
-                             num_thin, refresh, save_warmup, true, writer, s,
-                             model, rng, interrupt, logger, chain_id,
-                             num_chains);
-  auto end_warm = std::chrono::steady_clock::now();
-  double warm_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
-                            end_warm - start_warm)
-                            .count()
-                        / 1000.0;
-  sampler.disengage_adaptation();
-  writer.write_adapt_finish(sampler);
-  sampler.write_sampler_state(sample_writer);
-  sampler.write_sampler_state_struct(metric_writer);
-
-  auto start_sample = std::chrono::steady_clock::now();
-  util::generate_transitions(sampler, num_samples, num_warmup,
-                             num_warmup + num_samples, num_thin, refresh, true,
-                             false, writer, s, model, rng, interrupt, logger,
-                             chain_id, num_chains);
-  auto end_sample = std::chrono::steady_clock::now();
-  double sample_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
-                              end_sample - start_sample)
-                              .count()
-                          / 1000.0;
-  writer.write_timing(warm_delta_t, sample_delta_t);
+  if (async_write) {
+    RNG output_rng(rng());
+    services::util::async_mcmc_writer<Model, RNG> writer(
+        sample_writer, diagnostic_writer, logger, model, output_rng);
+    internal::run_adaptive_sampler(writer, sampler, model, cont_vector,
+                                   num_warmup, num_samples, num_thin, refresh,
+                                   save_warmup, rng, interrupt, logger,
+                                   sample_writer, metric_writer, chain_id,
+                                   num_chains);
+    writer.finish();
+  } else {
+    services::util::mcmc_writer writer(sample_writer, diagnostic_writer,
+                                       logger);
+    internal::run_adaptive_sampler(writer, sampler, model, cont_vector,
+                                   num_warmup, num_samples, num_thin, refresh,
+                                   save_warmup, rng, interrupt, logger,
+                                   sample_writer, metric_writer, chain_id,
+                                   num_chains);
+  }
 }
 
 /**
@@ -127,6 +184,8 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
  * @param[in] num_chains The number of chains used in the program. This
  *  is used in generate transitions to print out the chain number,
  *  (optional, default == 1)
+ * @param[in] async_write whether to write the draws on a background
+ *  thread, (optional, default == false)
  */
 template <typename Sampler, typename Model, typename RNG>
 void run_adaptive_sampler(Sampler& sampler, Model& model,
@@ -137,12 +196,13 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
                           callbacks::logger& logger,
                           callbacks::writer& sample_writer,
                           callbacks::writer& diagnostic_writer,
-                          size_t chain_id = 1, size_t num_chains = 1) {
+                          size_t chain_id = 1, size_t num_chains = 1,
+                          bool async_write = false) {
   callbacks::structured_writer dummy_metric_writer;
   return run_adaptive_sampler(
       sampler, model, cont_vector, num_warmup, num_samples, num_thin, refresh,
       save_warmup, rng, interrupt, logger, sample_writer, diagnostic_writer,
-      dummy_metric_writer, chain_id, num_chains);
+      dummy_metric_writer, chain_id, num_chains, async_write);
 }
 
 }  // namespace util
@@ -0,0 +1,165 @@
+#ifndef STAN_SERVICES_UTIL_RUN_ADAPTIVE_WARMUP_SAMPLER_HPP
+#define STAN_SERVICES_UTIL_RUN_ADAPTIVE_WARMUP_SAMPLER_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/warmup_convergence_monitor.hpp>
+#include <stan/services/util/generate_transitions.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <stan/services/util/pooled_adaptation.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Runs the sampler with adaptation, ending warmup as soon as the
+ * adapted step size and metric stop changing between adaptation
+ * windows, with writers for the sample, diagnostics, the adapted hmc
+ * tuning parameters and a record of how warmup ended.
+ *
+ * Warmup is run one adaptation window at a time.  At the end of each
+ * window the metric is updated as usual, and the step size averaged
+ * over the window and the new metric are passed to the monitor.  Once
+ * the monitor reports convergence no further metric updates are made,
+ * the step size is adapted for the length of the terminal buffer and
+ * sampling starts.  Warmup draws are thinned and progress is reported
+ * as if warmup were run in one piece.
+ *
+ * @tparam Sampler Type of adaptive sampler, derived from either
+ * <code>stepsize_var_adapter</code> or
+ * <code>stepsize_covar_adapter</code>
+ * @tparam Model Type of model
+ * @tparam RNG Type of random number generator
+ * @param[in,out] sampler the mcmc sampler to use on the model, with
+ *   window parameters already set
+ * @param[in] model the model concept to use for computing log probability
+ * @param[in] cont_vector initial parameter values
+ * @param[in] num_warmup maximum number of warmup draws
+ * @param[in] num_samples number of post warmup draws
+ * @param[in] num_thin number to thin the draws. Must be greater than
+ *   or equal to 1.
+ * @param[in] refresh controls output to the <code>logger</code>
+ * @param[in] save_warmup indicates whether the warmup draws should be
+ *   sent to the sample writer
+ * @param[in,out] monitor convergence monitor for the adaptation
+ * @param[in,out] rng random number generator
+ * @param[in,out] interrupt interrupt callback
+ * @param[in,out] logger logger for messages
+ * @param[in,out] sample_writer writer for draws
+ * @param[in,out] diagnostic_writer writer for diagnostic information
+ * @param[in,out] metric_writer writer for adapted stepsize, metric
+ * @param[in,out] warmup_writer writer for the record of how warmup ended
+ * @param[in] chain_id The id for a given chain, (optional, default == 1)
+ * @param[in] num_chains The number of chains used in the program. This
+ *  is used in generate transitions to print out the chain number,
+ *  (optional, default == 1)
+ */
+template <typename Sampler, typename Model, typename RNG>
+void run_adaptive_warmup_sampler(
+    Sampler& sampler, Model& model, std::vector<double>& cont_vector,
+    int num_warmup, int num_samples, int num_thin, int refresh,
+    bool save_warmup, stan::mcmc::warmup_convergence_monitor& monitor,
+    RNG& rng, callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer,
+    callbacks::structured_writer& warmup_writer, size_t chain_id = 1,
+    size_t num_chains = 1) {
+  Eigen::Map<Eigen::VectorXd> cont_params(cont_vector.data(),
+                                          cont_vector.size());
+
+  std::vector<Sampler*> chain{&sampler};
+  stan::mcmc::windowed_adaptation& windows
+      = internal::metric_adaptation(sampler);
+
+  sampler.engage_adaptation();
+  windows.set_defer_update(true);
+  try {
+    sampler.z().q = cont_params;
+    sampler.init_stepsize(logger);
+  } catch (const std::exception& e) {
+    logger.error("Exception initializing step size.");
+    logger.error(e.what());
+    return;
+  }
+
+  services::util::mcmc_writer writer(sample_writer, diagnostic_writer, logger);
+  stan::mcmc::sample s(cont_params, 0, 0);
+
+  // Headers
+  writer.write_sample_names(s, sampler, model);
+  writer.write_diagnostic_names(s, sampler, model);
+
+  auto start_warm = std::chrono::steady_clock::now();
+  int warmup_done = 0;
+  int warmup_end = num_warmup;
+  while (warmup_done < warmup_end) {
+    int segment = warmup_end - warmup_done;
+    if (!monitor.converged()) {
+      int window_remaining = windows.remaining_window_iterations();
+      if (window_remaining > 0 && window_remaining < segment)
+        segment = window_remaining;
+    }
+    util::generate_transitions(sampler, segment, warmup_done,
+                               warmup_end + num_samples, num_thin, refresh,
+                               save_warmup, true, writer, s, model, rng,
+                               interrupt, logger, chain_id, num_chains, 0);
+    warmup_done += segment;
+
+    if (monitor.converged() || !windows.update_pending())
+      continue;
+
+    double window_stepsize = 0;
+    sampler.get_stepsize_adaptation().complete_adaptation(window_stepsize);
+    internal::pool_metric(chain, sampler);
+    sampler.init_stepsize(logger);
+    sampler.get_stepsize_adaptation().set_mu(
+        std::log(10 * sampler.get_nominal_stepsize()));
+    sampler.get_stepsize_adaptation().restart();
+
+    if (monitor.update(window_stepsize, sampler.z().inv_e_metric_)) {
+      warmup_end = std::min(
+          num_warmup,
+          warmup_done + static_cast<int>(windows.get_term_buffer()));
+      std::stringstream msg;
+      msg << "Adaptation converged after iteration " << warmup_done
+          << "; ending warmup after " << warmup_end << " iterations.";
+      logger.info(msg);
+    }
+  }
+  auto end_warm = std::chrono::steady_clock::now();
+  double warm_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            end_warm - start_warm)
+                            .count()
+                        / 1000.0;
+  sampler.disengage_adaptation();
+  windows.set_defer_update(false);
+  writer.write_adapt_finish(sampler);
+  sampler.write_sampler_state(sample_writer);
+  sampler.write_sampler_state_struct(metric_writer);
+  monitor.write(warmup_writer, warmup_done, num_warmup);
+
+  auto start_sample = std::chrono::steady_clock::now();
+  util::generate_transitions(sampler, num_samples, warmup_end,
+                             warmup_end + num_samples, num_thin, refresh, true,
+                             false, writer, s, model, rng, interrupt, logger,
+                             chain_id, num_chains);
+  auto end_sample = std::chrono::steady_clock::now();
+  double sample_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              end_sample - start_sample)
+                              .count()
+                          / 1000.0;
+  writer.write_timing(warm_delta_t, sample_delta_t);
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
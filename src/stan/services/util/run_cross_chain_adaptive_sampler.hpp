@@ -0,0 +1,290 @@
+#ifndef STAN_SERVICES_UTIL_RUN_CROSS_CHAIN_ADAPTIVE_SAMPLER_HPP
+#define STAN_SERVICES_UTIL_RUN_CROSS_CHAIN_ADAPTIVE_SAMPLER_HPP
+
+#include <stan/analyze/mcmc/compute_effective_sample_size.hpp>
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/base_mcmc.hpp>
+#include <stan/services/util/generate_transitions.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <stan/services/util/pooled_adaptation.hpp>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+namespace internal {
+
+/**
+ * Sampler that forwards to another sampler and records the log
+ * density of every draw it produces.
+ */
+class lp_recording_sampler : public stan::mcmc::base_mcmc {
+ public:
+  lp_recording_sampler(stan::mcmc::base_mcmc& sampler, std::vector<double>& lp)
+      : sampler_(sampler), lp_(lp) {}
+
+  stan::mcmc::sample transition(stan::mcmc::sample& init_sample,
+                                callbacks::logger& logger) {
+    stan::mcmc::sample s = sampler_.transition(init_sample, logger);
+    lp_.push_back(s.log_prob());
+    return s;
+  }
+
+  void get_sampler_param_names(std::vector<std::string>& names) {
+    sampler_.get_sampler_param_names(names);
+  }
+
+  void get_sampler_params(std::vector<double>& values) {
+    sampler_.get_sampler_params(values);
+  }
+
+  void write_sampler_state(callbacks::writer& writer) {
+    sampler_.write_sampler_state(writer);
+  }
+
+  void get_sampler_diagnostic_names(std::vector<std::string>& model_names,
+                                    std::vector<std::string>& names) {
+    sampler_.get_sampler_diagnostic_names(model_names, names);
+  }
+
+  void get_sampler_diagnostics(std::vector<double>& values) {
+    sampler_.get_sampler_diagnostics(values);
+  }
+
+ private:
+  stan::mcmc::base_mcmc& sampler_;
+  std::vector<double>& lp_;
+};
+
+}  // namespace internal
+
+/**
+ * Runs several adaptive samplers in parallel with warmup statistics
+ * shared across chains, with writers for the sample, diagnostics,
+ * and the adapted hmc tuning parameters.
+ *
+ * The chains are advanced in lockstep from one adaptation window
+ * boundary to the next.  At each boundary the draws every chain
+ * collected during the window are pooled into a single metric
+ * estimate, which is given to all chains, and the step sizes found
+ * for that metric are replaced by their geometric mean before dual
+ * averaging restarts.  At the end of warmup the adapted step sizes
+ * are pooled the same way, so all chains sample with the same tuning
+ * parameters.
+ *
+ * If <code>ess_target</code> is positive, warmup ends early once the
+ * effective sample size of <code>lp__</code> over the draws of all
+ * chains since the previous boundary reaches it; the metric is then
+ * left as is and the step size is adapted for the length of the
+ * terminal buffer before sampling.  Draws in the initial fast
+ * adaptation buffer are left out of the first check, as the chains
+ * are not yet stationary.
+ *
+ * Warmup draws are thinned and progress is reported as if warmup were
+ * run in one piece.
+ *
+ * @tparam Sampler Type of adaptive sampler, derived from either
+ * <code>stepsize_var_adapter</code> or
+ * <code>stepsize_covar_adapter</code>
+ * @tparam Model Type of model
+ * @tparam RNG Type of random number generator
+ * @tparam SampleWriter A type derived from `stan::callbacks::writer`
+ * @tparam DiagnosticWriter A type derived from `stan::callbacks::writer`
+ * @tparam MetricWriter A type derived from
+ * `stan::callbacks::structured_writer`
+ * @param[in,out] samplers the mcmc samplers to use on the model, one
+ *   per chain, with window parameters already set
+ * @param[in] model the model concept to use for computing log probability
+ * @param[in] cont_vectors initial parameter values of each chain
+ * @param[in] num_warmup number of warmup draws
+ * @param[in] num_samples number of post warmup draws
+ * @param[in] num_thin number to thin the draws. Must be greater than
+ *   or equal to 1.
+ * @param[in] refresh controls output to the <code>logger</code>
+ * @param[in] save_warmup indicates whether the warmup draws should be
+ *   sent to the sample writer
+ * @param[in] ess_target effective sample size of <code>lp__</code>
+ *   within an adaptation window at which warmup ends early, or zero
+ *   to always run the full warmup
+ * @param[in,out] rngs random number generator of each chain
+ * @param[in,out] interrupt interrupt callback
+ * @param[in,out] logger logger for messages
+ * @param[in,out] sample_writers writer for draws of each chain
+ * @param[in,out] diagnostic_writers writer for diagnostic information
+ *   of each chain
+ * @param[in,out] metric_writers writer for adapted stepsize, metric of
+ *   each chain
+ * @param[in] init_chain_id The id of the first chain
+ */
+template <typename Sampler, typename Model, typename RNG,
+          typename SampleWriter, typename DiagnosticWriter,
+          typename MetricWriter>
+void run_cross_chain_adaptive_sampler(
+    std::vector<Sampler>& samplers, Model& model,
+    std::vector<std::vector<double>>& cont_vectors, int num_warmup,
+    int num_samples, int num_thin, int refresh, bool save_warmup,
+    double ess_target, std::vector<RNG>& rngs,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    std::vector<SampleWriter>& sample_writers,
+    std::vector<DiagnosticWriter>& diagnostic_writers,
+    std::vector<MetricWriter>& metric_writers, size_t init_chain_id = 1) {
+  const size_t num_chains = samplers.size();
+  if (num_chains == 0)
+    return;
+
+  std::vector<Sampler*> chains;
+  chains.reserve(num_chains);
+  for (auto& sampler : samplers)
+    chains.push_back(&sampler);
+
+  std::vector<stan::mcmc::sample> samples;
+  samples.reserve(num_chains);
+  std::vector<services::util::mcmc_writer> writers;
+  writers.reserve(num_chains);
+  for (size_t i = 0; i < num_chains; ++i) {
+    Eigen::Map<Eigen::VectorXd> cont_params(cont_vectors[i].data(),
+                                            cont_vectors[i].size());
+    samplers[i].engage_adaptation();
+    internal::metric_adaptation(samplers[i]).set_defer_update(true);
+    try {
+      samplers[i].z().q = cont_params;
+      samplers[i].init_stepsize(logger);
+    } catch (const std::exception& e) {
+      logger.error("Exception initializing step size.");
+      logger.error(e.what());
+      return;
+    }
+    samples.emplace_back(cont_params, 0, 0);
+    writers.emplace_back(sample_writers[i], diagnostic_writers[i], logger);
+  }
+  internal::pool_stepsize(chains);
+
+  for (size_t i = 0; i < num_chains; ++i) {
+    writers[i].write_sample_names(samples[i], samplers[i], model);
+    writers[i].write_diagnostic_names(samples[i], samplers[i], model);
+  }
+
+  // Runs all chains for the given number of iterations, recording the
+  // log density of each draw for the convergence check
+  std::vector<std::vector<double>> lp(num_chains);
+  auto run_segment = [&](int num_iterations, int start, int finish,
+                         int phase_start, bool save, bool warmup) {
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, num_chains, 1),
+        [&](const tbb::blocked_range<size_t>& r) {
+          for (size_t i = r.begin(); i != r.end(); ++i) {
+            lp[i].clear();
+            internal::lp_recording_sampler recorder(samplers[i], lp[i]);
+            util::generate_transitions(recorder, num_iterations, start, finish,
+                                       num_thin, refresh, save, warmup,
+                                       writers[i], samples[i], model, rngs[i],
+                                       interrupt, logger, init_chain_id + i,
+                                       num_chains, phase_start);
+          }
+        },
+        tbb::simple_partitioner());
+  };
+
+  auto start_warm = std::chrono::steady_clock::now();
+  int warmup_done = 0;
+  int warmup_end = num_warmup;
+  bool adapting_metric = true;
+  stan::mcmc::windowed_adaptation& windows
+      = internal::metric_adaptation(samplers[0]);
+  while (warmup_done < warmup_end) {
+    int segment = warmup_end - warmup_done;
+    if (adapting_metric) {
+      int window_remaining = windows.remaining_window_iterations();
+      if (window_remaining > 0 && window_remaining < segment)
+        segment = window_remaining;
+    }
+    run_segment(segment, warmup_done, warmup_end + num_samples, 0,
+                save_warmup, true);
+    warmup_done += segment;
+
+    if (!adapting_metric || !windows.update_pending())
+      continue;
+
+    internal::pool_metric(chains, samplers[0]);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, num_chains, 1),
+        [&](const tbb::blocked_range<size_t>& r) {
+          for (size_t i = r.begin(); i != r.end(); ++i)
+            samplers[i].init_stepsize(logger);
+        },
+        tbb::simple_partitioner());
+    double stepsize = internal::pool_stepsize(chains);
+    for (auto& sampler : samplers) {
+      sampler.get_stepsize_adaptation().set_mu(std::log(10 * stepsize));
+      sampler.get_stepsize_adaptation().restart();
+    }
+
+    if (ess_target > 0) {
+      // leave out the draws of the initial buffer
+      size_t segment_start = warmup_done - segment;
+      size_t init_buffer = windows.get_init_buffer();
+      size_t skip = segment_start < init_buffer ? init_buffer - segment_start
+                                                : 0;
+      std::vector<const double*> draws;
+      std::vector<size_t> sizes;
+      for (size_t i = 0; i < num_chains; ++i) {
+        size_t chain_skip = std::min(skip, lp[i].size());
+        draws.push_back(lp[i].data() + chain_skip);
+        sizes.push_back(lp[i].size() - chain_skip);
+      }
+      double ess = stan::analyze::compute_effective_sample_size(draws, sizes);
+      if (ess >= ess_target) {
+        adapting_metric = false;
+        warmup_end = std::min(
+            num_warmup,
+            warmup_done + static_cast<int>(windows.get_term_buffer()));
+        std::stringstream msg;
+        msg << "Effective sample size of lp__ reached " << ess
+            << " after iteration " << warmup_done << "; ending warmup after "
+            << warmup_end << " iterations.";
+        logger.info(msg);
+      }
+    }
+  }
+  auto end_warm = std::chrono::steady_clock::now();
+  double warm_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            end_warm - start_warm)
+                            .count()
+                        / 1000.0;
+
+  for (auto& sampler : samplers) {
+    sampler.disengage_adaptation();
+    internal::metric_adaptation(sampler).set_defer_update(false);
+  }
+  internal::pool_stepsize(chains);
+  for (size_t i = 0; i < num_chains; ++i) {
+    writers[i].write_adapt_finish(samplers[i]);
+    samplers[i].write_sampler_state(sample_writers[i]);
+    samplers[i].write_sampler_state_struct(metric_writers[i]);
+  }
+
+  auto start_sample = std::chrono::steady_clock::now();
+  run_segment(num_samples, warmup_end, warmup_end + num_samples, warmup_end,
+              true, false);
+  auto end_sample = std::chrono::steady_clock::now();
+  double sample_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              end_sample - start_sample)
+                              .count()
+                          / 1000.0;
+  for (auto& writer : writers)
+    writer.write_timing(warm_delta_t, sample_delta_t);
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
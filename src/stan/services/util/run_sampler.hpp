@@ -3,6 +3,7 @@
 
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
+#include <stan/services/util/async_mcmc_writer.hpp>
 #include <stan/services/util/generate_transitions.hpp>
 #include <stan/services/util/mcmc_writer.hpp>
 #include <chrono>
@@ -12,41 +13,25 @@ namespace stan {
 namespace services {
 namespace util {
 
+namespace internal {
+
 /**
- * Runs the sampler without adaptation.
+ * Runs the sampler without adaptation, writing the draws through the
+ * specified writer.  See <code>util::run_sampler</code> for the
+ * remaining parameters.
  *
- * @tparam Model Type of model
- * @tparam RNG Type of random number generator
- * @param[in,out] sampler the mcmc sampler to use on the model
- * @param[in] model the model concept to use for computing log probability
- * @param[in] cont_vector initial parameter values
- * @param[in] num_warmup number of warmup draws
- * @param[in] num_samples number of post warmup draws
- * @param[in] num_thin number to thin the draws. Must be greater than or
- *   equal to 1.
- * @param[in] refresh controls output to the <code>logger</code>
- * @param[in] save_warmup indicates whether the warmup draws should be
- *   sent to the sample writer
- * @param[in,out] rng random number generator
- * @param[in,out] interrupt interrupt callback
- * @param[in,out] logger logger for messages
- * @param[in,out] sample_writer writer for draws
- * @param[in,out] diagnostic_writer writer for diagnostic information
- * @param[in] chain_id The id for a given chain.
- * @param[in] num_chains The number of chains used in the program. This
- *  is used in generate transitions to print out the chain number.
+ * @tparam McmcWriter Type of writer for the draws
+ * @param[in,out] writer writer for the draws
  */
-template <class Model, class RNG>
-void run_sampler(stan::mcmc::base_mcmc& sampler, Model& model,
-                 std::vector<double>& cont_vector, int num_warmup,
-                 int num_samples, int num_thin, int refresh, bool save_warmup,
-                 RNG& rng, callbacks::interrupt& interrupt,
+template <class McmcWriter, class Model, class RNG>
+void run_sampler(McmcWriter& writer, stan::mcmc::base_mcmc& sampler,
+                 Model& model, std::vector<double>& cont_vector,
+                 int num_warmup, int num_samples, int num_thin, int refresh,
+                 bool save_warmup, RNG& rng, callbacks::interrupt& interrupt,
                  callbacks::logger& logger, callbacks::writer& sample_writer,
-                 callbacks::writer& diagnostic_writer, size_t chain_id = 1,
-                 size_t num_chains = 1) {
+                 size_t chain_id, size_t num_chains) {
   Eigen::Map<Eigen::VectorXd> cont_params(cont_vector.data(),
                                           cont_vector.size());
-  services::util::mcmc_writer writer(sample_writer, diagnostic_writer, logger);
   stan::mcmc::sample s(cont_params, 0, 0);
 
   // Headers
@@ -78,6 +63,69 @@ void run_sampler(stan::mcmc::base_mcmc& sampler, Model& model,
                           / 1000.0;
   writer.write_timing(warm_delta_t, sample_delta_t);
 }
+
+}  // namespace internal
+
+/**
+ * Runs the sampler without adaptation.
+ *
+ * With <code>async_write</code> set, the draws are written and their
+ * generated quantities computed on a background thread while sampling
+ * continues (see <code>async_mcmc_writer</code>).  The generated
+ * quantities then use their own random number generator, seeded from a
+ * single draw of <code>rng</code>, instead of sharing <code>rng</code>
+ * with the sampler.  The draws are therefore not the same as those of a
+ * synchronous run with the same seed, although both are reproducible.
+ *
+ * @tparam Model Type of model
+ * @tparam RNG Type of random number generator
+ * @param[in,out] sampler the mcmc sampler to use on the model
+ * @param[in] model the model concept to use for computing log probability
+ * @param[in] cont_vector initial parameter values
+ * @param[in] num_warmup number of warmup draws
+ * @param[in] num_samples number of post warmup draws
+ * @param[in] num_thin number to thin the draws. Must be greater than or
+ *   equal to 1.
+ * @param[in] refresh controls output to the <code>logger</code>
+ * @param[in] save_warmup indicates whether the warmup draws should be
+ *   sent to the sample writer
+ * @param[in,out] rng random number generator
+ * @param[in,out] interrupt interrupt callback
+ * @param[in,out] logger logger for messages
+ * @param[in,out] sample_writer writer for draws
+ * @param[in,out] diagnostic_writer writer for diagnostic information
+ * @param[in] chain_id The id for a given chain.
+ * @param[in] num_chains The number of chains used in the program. This
+ *  is used in generate transitions to print out the chain number.
+ * @param[in] async_write whether to write the draws on a background
+ *  thread, (optional, default == false)
+ */
+template <class Model, class RNG>
+void run_sampler(stan::mcmc::base_mcmc& sampler, Model& model,
+                 std::vector<double>& cont_vector, int num_warmup,
+                 int num_samples, int num_thin, int refresh, bool save_warmup,
+                 RNG& rng, callbacks::interrupt& interrupt,
+                 callbacks::logger& logger, callbacks::writer& sample_writer,
+                 callbacks::writer& diagnostic_writer, size_t chain_id = 1,
+                 size_t num_chains = 1, bool async_write = false) {
+  if (async_write) {
+    RNG output_rng(rng());
+    services::util::async_mcmc_writer<Model, RNG> writer(
+        sample_writer, diagnostic_writer, logger, model, output_rng);
+    internal::run_sampler(writer, sampler, model, cont_vector, num_warmup,
+                          num_samples, num_thin, refresh, save_warmup, rng,
+                          interrupt, logger, sample_writer, chain_id,
+                          num_chains);
+    writer.finish();
+  } else {
+    services::util::mcmc_writer writer(sample_writer, diagnostic_writer,
+                                       logger);
+    internal::run_sampler(writer, sampler, model, cont_vector, num_warmup,
+                          num_samples, num_thin, refresh, save_warmup, rng,
+                          interrupt, logger, sample_writer, chain_id,
+                          num_chains);
+  }
+}
 }  // namespace util
 }  // namespace services
 }  // namespace stan
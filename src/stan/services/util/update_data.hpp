@@ -0,0 +1,71 @@
+#ifndef STAN_SERVICES_UTIL_UPDATE_DATA_HPP
+#define STAN_SERVICES_UTIL_UPDATE_DATA_HPP
+
+#include <stan/io/chained_var_context.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/model/model_base.hpp>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Return a new model for refitting the specified model on changed
+ * data, e.g. for simulation-based calibration or rolling windows.
+ * The new model has the data of the specified model, except for the
+ * variables defined in <code>delta</code>, whose values are replaced.
+ *
+ * <p>If the model supports <code>model_base::update_data</code>, only
+ * the replaced variables are read and validated.  Otherwise, the model
+ * is constructed by <code>new_model</code> from its data with
+ * <code>delta</code> laid over it, as a fallback.
+ *
+ * @tparam NewModel type of a callable with signature
+ * <code>std::unique_ptr<stan::model::model_base>(const
+ * stan::io::var_context&, unsigned int, std::ostream*)</code>
+ * constructing a model from its data
+ * @param[in] model model to refit
+ * @param[in] data data the model was constructed from
+ * @param[in] delta values of the data variables to replace
+ * @param[in] random_seed seed for the random number generator used to
+ * compute the transformed data
+ * @param[in] new_model callable constructing a model from its data
+ * @param[in,out] msgs stream to which messages are written
+ * @return the new model
+ * @throw std::invalid_argument if <code>delta</code> defines a
+ * variable that is not in <code>data</code>
+ * @throw std::exception if the new values fail validation
+ */
+template <typename NewModel>
+std::unique_ptr<stan::model::model_base> update_data(
+    const stan::model::model_base& model, const stan::io::var_context& data,
+    const stan::io::var_context& delta, unsigned int random_seed,
+    NewModel&& new_model, std::ostream* msgs = nullptr) {
+  std::vector<std::string> names;
+  delta.names_r(names);
+  std::vector<std::string> names_i;
+  delta.names_i(names_i);
+  names.insert(names.end(), names_i.begin(), names_i.end());
+  for (const std::string& name : names)
+    if (!data.contains_r(name))
+      throw std::invalid_argument("Variable " + name
+                                  + " to update is not in the model data");
+
+  std::unique_ptr<stan::model::model_base> updated
+      = model.update_data(delta, random_seed, msgs);
+  if (updated)
+    return updated;
+  stan::io::chained_var_context context(delta, data);
+  return new_model(context, random_seed, msgs);
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
@@ -0,0 +1,131 @@
+#include <stan/analyze/mcmc/summarize_draws.hpp>
+#include <stan/analyze/mcmc/split_rank_normalized_ess.hpp>
+#include <stan/analyze/mcmc/split_rank_normalized_rhat.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <boost/math/distributions/normal.hpp>
+#include <boost/random/additive_combine.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class SummarizeDraws : public testing::Test {
+ public:
+  void SetUp() {
+    std::stringstream out;
+    for (std::string file : {"eight_schools_1", "eight_schools_2"}) {
+      std::ifstream stream("src/test/unit/mcmc/test_csv_files/" + file
+                           + ".csv");
+      chains.push_back(stan::io::stan_csv_reader::parse(stream, &out).samples);
+    }
+  }
+
+  std::vector<Eigen::MatrixXd> chains;
+};
+
+TEST_F(SummarizeDraws, matches_single_column_diagnostics) {
+  Eigen::VectorXd probs(3);
+  probs << 0.05, 0.5, 0.95;
+  stan::analyze::draws_summary summary
+      = stan::analyze::summarize_draws(chains, probs);
+
+  const int num_params = chains[0].cols();
+  ASSERT_EQ(num_params, summary.mean.size());
+  ASSERT_EQ(num_params, summary.quantiles.rows());
+  ASSERT_EQ(3, summary.quantiles.cols());
+  for (int j = 7; j < num_params; ++j) {
+    Eigen::MatrixXd draws(chains[0].rows(), 2);
+    draws.col(0) = chains[0].col(j);
+    draws.col(1) = chains[1].col(j);
+    auto ess = stan::analyze::split_rank_normalized_ess(draws);
+    auto rhat = stan::analyze::split_rank_normalized_rhat(draws);
+    EXPECT_NEAR(ess.first, summary.ess_bulk(j), 1e-6 * ess.first) << j;
+    EXPECT_NEAR(ess.second, summary.ess_tail(j), 1e-6 * ess.second) << j;
+    EXPECT_NEAR(rhat.first, summary.rhat_bulk(j), 1e-10) << j;
+    EXPECT_NEAR(rhat.second, summary.rhat_tail(j), 1e-10) << j;
+
+    Eigen::Map<Eigen::VectorXd> all(draws.data(), draws.size());
+    double mean = all.mean();
+    double sd = std::sqrt((all.array() - mean).square().sum()
+                          / (all.size() - 1.0));
+    EXPECT_FLOAT_EQ(mean, summary.mean(j));
+    EXPECT_FLOAT_EQ(sd, summary.sd(j));
+    for (int k = 0; k < probs.size(); ++k)
+      EXPECT_FLOAT_EQ(stan::math::quantile(all, probs(k)),
+                      summary.quantiles(j, k));
+
+    Eigen::MatrixXd split = stan::analyze::split_chains(draws);
+    EXPECT_FLOAT_EQ(sd / std::sqrt(stan::analyze::ess(split)),
+                    summary.mcse_mean(j));
+  }
+}
+
+TEST_F(SummarizeDraws, constant_column) {
+  for (auto& chain : chains)
+    chain.col(7).setConstant(1.5);
+  Eigen::VectorXd probs(1);
+  probs << 0.5;
+  stan::analyze::draws_summary summary
+      = stan::analyze::summarize_draws(chains, probs);
+  EXPECT_FLOAT_EQ(1.5, summary.mean(7));
+  EXPECT_FLOAT_EQ(0, summary.sd(7));
+  EXPECT_FLOAT_EQ(1.5, summary.quantiles(7, 0));
+  EXPECT_TRUE(std::isnan(summary.ess_bulk(7)));
+  EXPECT_TRUE(std::isnan(summary.ess_tail(7)));
+  EXPECT_TRUE(std::isnan(summary.rhat_bulk(7)));
+  EXPECT_TRUE(std::isnan(summary.rhat_tail(7)));
+  EXPECT_TRUE(std::isnan(summary.mcse_mean(7)));
+  EXPECT_TRUE(std::isnan(summary.mcse_q5(7)));
+  EXPECT_TRUE(std::isnan(summary.mcse_q50(7)));
+  EXPECT_TRUE(std::isnan(summary.mcse_q95(7)));
+  EXPECT_FALSE(std::isnan(summary.mcse_q50(8)));
+  EXPECT_FALSE(std::isnan(summary.ess_bulk(8)));
+}
+
+TEST_F(SummarizeDraws, invalid_chains) {
+  Eigen::VectorXd probs(1);
+  probs << 0.5;
+  EXPECT_THROW(stan::analyze::summarize_draws({}, probs),
+               std::invalid_argument);
+  chains[1].conservativeResize(10, Eigen::NoChange);
+  EXPECT_THROW(stan::analyze::summarize_draws(chains, probs),
+               std::invalid_argument);
+}
+
+TEST(SummarizeDrawsIid, mcse_quantiles) {
+  // For independent standard normal draws the standard error of the
+  // quantile for probability p is sqrt(p (1 - p) / N) / density; the
+  // estimates are noisy, so compare their average over many columns
+  boost::ecuyer1988 rng(1234);
+  boost::normal_distribution<> normal;
+  const int num_draws = 1000;
+  const int num_params = 50;
+  std::vector<Eigen::MatrixXd> chains(4,
+                                      Eigen::MatrixXd(num_draws, num_params));
+  for (auto& chain : chains)
+    for (int j = 0; j < num_params; ++j)
+      for (int n = 0; n < num_draws; ++n)
+        chain(n, j) = normal(rng);
+  Eigen::VectorXd probs(1);
+  probs << 0.5;
+  stan::analyze::draws_summary summary
+      = stan::analyze::summarize_draws(chains, probs);
+
+  const double size = 4 * num_draws;
+  auto expected_mcse = [&](double p) {
+    double z = boost::math::quantile(boost::math::normal(), p);
+    double density = boost::math::pdf(boost::math::normal(), z);
+    return std::sqrt(p * (1 - p) / size) / density;
+  };
+  EXPECT_NEAR(expected_mcse(0.05), summary.mcse_q5.mean(),
+              0.1 * expected_mcse(0.05));
+  EXPECT_NEAR(expected_mcse(0.5), summary.mcse_q50.mean(),
+              0.1 * expected_mcse(0.5));
+  EXPECT_NEAR(expected_mcse(0.95), summary.mcse_q95.mean(),
+              0.1 * expected_mcse(0.95));
+  EXPECT_NEAR(1 / std::sqrt(size), summary.mcse_mean.mean(),
+              0.1 / std::sqrt(size));
+}
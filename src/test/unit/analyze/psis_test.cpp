@@ -0,0 +1,44 @@
+#include <stan/analyze/psis.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+
+TEST(AnalyzePsis, psis_tail_length) {
+  EXPECT_EQ(20, stan::analyze::psis_tail_length(100));
+  EXPECT_EQ(3000, stan::analyze::psis_tail_length(1000000));
+  EXPECT_EQ(0, stan::analyze::psis_tail_length(1));
+}
+
+TEST(AnalyzePsis, psis) {
+  Eigen::Array<double, -1, 1> log_ratios(1000);
+  for (Eigen::Index i = 0; i < log_ratios.size(); ++i) {
+    log_ratios(i) = 2 * std::sin(0.37 * i) + std::cos(2.3 * i);
+  }
+  stan::test::unit::instrumented_logger logger;
+  auto result = stan::analyze::psis(log_ratios, logger);
+  EXPECT_EQ(stan::analyze::psis_tail_length(1000), result.tail_len);
+  EXPECT_TRUE(std::isfinite(result.pareto_k));
+  EXPECT_FLOAT_EQ(0, result.log_weights.maxCoeff());
+  EXPECT_EQ(0, logger.call_count_warn());
+
+  auto short_tail = stan::analyze::psis(log_ratios, 4, logger);
+  EXPECT_EQ(0, short_tail.tail_len);
+  EXPECT_TRUE(std::isnan(short_tail.pareto_k));
+  for (Eigen::Index i = 0; i < log_ratios.size(); ++i) {
+    EXPECT_FLOAT_EQ(log_ratios(i) - log_ratios.maxCoeff(),
+                    short_tail.log_weights(i));
+  }
+}
+
+TEST(AnalyzePsis, psis_heavy_tail) {
+  // log ratios of a Pareto distribution with shape 1
+  Eigen::Array<double, -1, 1> log_ratios(1000);
+  for (Eigen::Index i = 0; i < log_ratios.size(); ++i) {
+    log_ratios(i) = -std::log1p(-(i + 0.5) / log_ratios.size());
+  }
+  stan::test::unit::instrumented_logger logger;
+  auto result = stan::analyze::psis(log_ratios, logger);
+  EXPECT_GT(result.pareto_k, 0.7);
+  EXPECT_EQ(1, logger.call_count_warn());
+  EXPECT_EQ(1, logger.find_warn("Pareto k value"));
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/binary_columnar_writer.hpp>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+class StanInterfaceCallbacksBinaryColumnarWriter : public ::testing::Test {
+ public:
+  using format = stan::callbacks::binary_columnar_format;
+  using writer_t
+      = stan::callbacks::binary_columnar_writer<std::stringstream,
+                                                deleter_noop>;
+
+  StanInterfaceCallbacksBinaryColumnarWriter() : ss() {}
+
+  std::unique_ptr<std::stringstream, deleter_noop> output() {
+    return std::unique_ptr<std::stringstream, deleter_noop>(&ss);
+  }
+
+  template <typename T>
+  T read(size_t& pos) {
+    std::string s = ss.str();
+    T x;
+    std::memcpy(&x, s.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return x;
+  }
+
+  std::stringstream ss;
+};
+
+TEST_F(StanInterfaceCallbacksBinaryColumnarWriter, header) {
+  { writer_t writer(output()); }
+  std::string s = ss.str();
+  ASSERT_EQ(format::header_size, s.size());
+  EXPECT_EQ(0, std::memcmp(s.data(), format::magic, 8));
+  size_t pos = 8;
+  EXPECT_EQ(format::version, read<uint32_t>(pos));
+  EXPECT_EQ(format::byte_order_mark, read<uint32_t>(pos));
+}
+
+TEST_F(StanInterfaceCallbacksBinaryColumnarWriter, names_and_comment) {
+  {
+    writer_t writer(output());
+    writer(std::vector<std::string>{"lp__", "theta"});
+    writer(std::string("Adaptation terminated"));
+    writer();
+  }
+  size_t pos = format::header_size;
+  EXPECT_EQ(format::names_record, read<uint32_t>(pos));
+  EXPECT_EQ(0, read<uint32_t>(pos));
+  uint64_t size = read<uint64_t>(pos);
+  EXPECT_EQ(format::padded_size(8 + 12 + 13), size);
+  size_t end = pos + size;
+  EXPECT_EQ(2, read<uint64_t>(pos));
+  EXPECT_EQ(4, read<uint64_t>(pos));
+  EXPECT_EQ("lp__", ss.str().substr(pos, 4));
+  pos = end;
+
+  EXPECT_EQ(format::comment_record, read<uint32_t>(pos));
+  read<uint32_t>(pos);
+  EXPECT_EQ(format::padded_size(8 + 21), read<uint64_t>(pos));
+  EXPECT_EQ(21, read<uint64_t>(pos));
+  EXPECT_EQ("Adaptation terminated", ss.str().substr(pos, 21));
+  pos += format::padded_size(21);
+
+  EXPECT_EQ(format::comment_record, read<uint32_t>(pos));
+  read<uint32_t>(pos);
+  EXPECT_EQ(8, read<uint64_t>(pos));
+  EXPECT_EQ(0, read<uint64_t>(pos));
+  EXPECT_EQ(ss.str().size(), pos);
+}
+
+TEST_F(StanInterfaceCallbacksBinaryColumnarWriter, chunks_are_column_major) {
+  {
+    writer_t writer(output(), 2);
+    for (int n = 0; n < 3; ++n)
+      writer(std::vector<double>{1.0 * n, 10.0 * n + 0.1});
+  }
+  size_t pos = format::header_size;
+  EXPECT_EQ(format::chunk_record, read<uint32_t>(pos));
+  read<uint32_t>(pos);
+  EXPECT_EQ(16 + 4 * sizeof(double), read<uint64_t>(pos));
+  EXPECT_EQ(2, read<uint64_t>(pos));
+  EXPECT_EQ(2, read<uint64_t>(pos));
+  EXPECT_EQ(0.0, read<double>(pos));
+  EXPECT_EQ(1.0, read<double>(pos));
+  EXPECT_EQ(0.1, read<double>(pos));
+  EXPECT_EQ(10.1, read<double>(pos));
+
+  // the last, partial chunk is written on destruction
+  EXPECT_EQ(format::chunk_record, read<uint32_t>(pos));
+  read<uint32_t>(pos);
+  EXPECT_EQ(16 + 2 * sizeof(double), read<uint64_t>(pos));
+  EXPECT_EQ(1, read<uint64_t>(pos));
+  EXPECT_EQ(2, read<uint64_t>(pos));
+  EXPECT_EQ(2.0, read<double>(pos));
+  EXPECT_EQ(20.1, read<double>(pos));
+  EXPECT_EQ(ss.str().size(), pos);
+}
+
+TEST_F(StanInterfaceCallbacksBinaryColumnarWriter, comment_ends_chunk) {
+  writer_t writer(output());
+  writer(std::vector<double>{1, 2, 3});
+  EXPECT_EQ(format::header_size, ss.str().size());
+  writer(std::string("x"));
+  size_t pos = format::header_size;
+  EXPECT_EQ(format::chunk_record, read<uint32_t>(pos));
+  read<uint32_t>(pos);
+  EXPECT_EQ(16 + 3 * sizeof(double), read<uint64_t>(pos));
+  EXPECT_EQ(1, read<uint64_t>(pos));
+  EXPECT_EQ(3, read<uint64_t>(pos));
+}
+
+TEST_F(StanInterfaceCallbacksBinaryColumnarWriter, eigen_matrix) {
+  {
+    writer_t writer(output());
+    Eigen::MatrixXd x(2, 3);
+    x << 1, 2, 3, 4, 5, 6;
+    writer(x);
+  }
+  size_t pos = format::header_size + format::record_header_size;
+  EXPECT_EQ(3, read<uint64_t>(pos));
+  EXPECT_EQ(2, read<uint64_t>(pos));
+  for (double x : {1, 2, 3, 4, 5, 6})
+    EXPECT_EQ(x, read<double>(pos));
+}
+
+TEST_F(StanInterfaceCallbacksBinaryColumnarWriter, null) {
+  std::unique_ptr<std::stringstream, deleter_noop> null_output(nullptr);
+  writer_t writer(std::move(null_output));
+  EXPECT_NO_THROW(writer(std::vector<double>{1, 2}));
+  EXPECT_NO_THROW(writer(std::string("x")));
+  EXPECT_NO_THROW(writer.flush());
+}
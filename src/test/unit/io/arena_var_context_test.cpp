@@ -0,0 +1,147 @@
+#include <stan/io/arena_var_context.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <gtest/gtest.h>
+#include <complex>
+#include <string>
+#include <vector>
+
+class arena_var_context : public testing::Test {
+ public:
+  arena_var_context()
+      : names_r{"alpha", "beta", "empty"},
+        values_r{0.5, 1, 2, 3, 4, 5, 6},
+        dims_r{{}, {2, 3}, {3, 0}},
+        names_i{"n", "k"},
+        values_i{7, 8, 9, 10},
+        dims_i{{3}, {}} {}
+
+  std::vector<std::string> names_r;
+  std::vector<double> values_r;
+  std::vector<std::vector<size_t>> dims_r;
+  std::vector<std::string> names_i;
+  std::vector<int> values_i;
+  std::vector<std::vector<size_t>> dims_i;
+};
+
+TEST_F(arena_var_context, matches_array_var_context) {
+  stan::io::array_var_context avc(names_r, values_r, dims_r, names_i,
+                                  values_i, dims_i);
+  stan::io::arena_var_context context(names_r, values_r, dims_r, names_i,
+                                      values_i, dims_i);
+
+  for (const std::string name : {"alpha", "beta", "empty", "n", "k", "x"}) {
+    EXPECT_EQ(avc.contains_r(name), context.contains_r(name)) << name;
+    EXPECT_EQ(avc.contains_i(name), context.contains_i(name)) << name;
+    EXPECT_EQ(avc.vals_r(name), context.vals_r(name)) << name;
+    EXPECT_EQ(avc.dims_r(name), context.dims_r(name)) << name;
+    EXPECT_EQ(avc.vals_i(name), context.vals_i(name)) << name;
+    EXPECT_EQ(avc.dims_i(name), context.dims_i(name)) << name;
+  }
+  EXPECT_EQ(avc.vals_c("beta"), context.vals_c("beta"));
+  EXPECT_EQ(avc.vals_c("empty"), context.vals_c("empty"));
+  EXPECT_TRUE(context.vals_c("x").empty());
+  EXPECT_NO_THROW(context.validate_dims("data", "beta", "double", {2, 3}));
+  EXPECT_NO_THROW(context.validate_dims("data", "n", "int", {3}));
+  EXPECT_THROW(context.validate_dims("data", "beta", "double", {3, 2}),
+               std::exception);
+
+  std::vector<std::string> names;
+  context.names_r(names);
+  EXPECT_EQ(std::vector<std::string>({"alpha", "beta", "empty"}), names);
+  context.names_i(names);
+  EXPECT_EQ(std::vector<std::string>({"n", "k"}), names);
+}
+
+TEST_F(arena_var_context, ctor_moves_values) {
+  const double* data_r = values_r.data();
+  const int* data_i = values_i.data();
+  stan::io::arena_var_context context(names_r, std::move(values_r), dims_r,
+                                      names_i, std::move(values_i), dims_i);
+  EXPECT_EQ(data_r, context.values_r().data());
+  EXPECT_EQ(data_i, context.values_i().data());
+  EXPECT_EQ(data_r + 1, context.vals_r_view("beta").data());
+  EXPECT_EQ(data_i, context.vals_i_view("n").data());
+
+  stan::io::var_view_r n_r = context.vals_r_view("n");
+  EXPECT_TRUE(n_r.is_int());
+  EXPECT_EQ(data_i, n_r.int_values().data());
+  EXPECT_EQ(std::vector<double>({7, 8, 9}), n_r.to_vector());
+}
+
+TEST_F(arena_var_context, ctor_single_type) {
+  stan::io::arena_var_context context_r(names_r, values_r, dims_r);
+  EXPECT_TRUE(context_r.contains_r("beta"));
+  EXPECT_FALSE(context_r.contains_r("n"));
+  stan::io::arena_var_context context_i(names_i, values_i, dims_i);
+  EXPECT_TRUE(context_i.contains_i("n"));
+  EXPECT_EQ(std::vector<int>({10}), context_i.vals_i("k"));
+  EXPECT_FALSE(context_i.contains_r("beta"));
+}
+
+TEST_F(arena_var_context, invalid_input) {
+  std::vector<double> short_values_r{0.5, 1, 2};
+  EXPECT_THROW(stan::io::arena_var_context(names_r, short_values_r, dims_r),
+               std::invalid_argument);
+  values_r.push_back(7);
+  EXPECT_THROW(stan::io::arena_var_context(names_r, values_r, dims_r),
+               std::invalid_argument);
+  dims_r.pop_back();
+  EXPECT_THROW(stan::io::arena_var_context(names_r, values_r, dims_r),
+               std::invalid_argument);
+  names_i[1] = "alpha";
+  EXPECT_THROW(stan::io::arena_var_context(names_r, short_values_r,
+                                           {{}, {2}, {0}}, names_i, values_i,
+                                           dims_i),
+               std::invalid_argument);
+}
+
+TEST_F(arena_var_context, assign) {
+  stan::io::arena_var_context context(names_r, values_r, dims_r, names_i,
+                                      values_i, dims_i);
+  stan::io::var_view_r beta = context.vals_r_view("beta");
+  const double* data_r = context.values_r().data();
+
+  std::vector<double> new_values_r{-0.5, -1, -2, -3, -4, -5, -6};
+  context.assign_r(new_values_r);
+  EXPECT_EQ(data_r, context.values_r().data());
+  EXPECT_EQ(std::vector<double>({-0.5}), context.vals_r("alpha"));
+  EXPECT_FLOAT_EQ(-6, beta[5]) << "views see assigned values";
+
+  context.assign_r("beta", {11, 12, 13, 14, 15, 16});
+  EXPECT_EQ(std::vector<double>({-0.5}), context.vals_r("alpha"));
+  EXPECT_EQ(std::vector<double>({11, 12, 13, 14, 15, 16}),
+            context.vals_r("beta"));
+  context.assign_i({1, 2, 3, 4});
+  EXPECT_EQ(std::vector<int>({4}), context.vals_i("k"));
+  context.assign_i("n", {5, 6, 7});
+  EXPECT_EQ(std::vector<int>({5, 6, 7, 4}), context.values_i());
+
+  EXPECT_THROW(context.assign_r({1, 2}), std::invalid_argument);
+  EXPECT_THROW(context.assign_r("beta", {1, 2}), std::invalid_argument);
+  EXPECT_THROW(context.assign_r("n", {1, 2, 3}), std::invalid_argument);
+  EXPECT_THROW(context.assign_i("beta", {1, 2, 3, 4, 5, 6}),
+               std::invalid_argument);
+  EXPECT_THROW(context.assign_i("x", {1}), std::invalid_argument);
+  EXPECT_EQ(std::vector<int>({5, 6, 7, 4}), context.values_i());
+}
+
+TEST_F(arena_var_context, swap) {
+  stan::io::arena_var_context context(names_r, values_r, dims_r, names_i,
+                                      values_i, dims_i);
+  std::vector<double> buffer_r{-0.5, -1, -2, -3, -4, -5, -6};
+  const double* data_r = buffer_r.data();
+  context.swap_r(buffer_r);
+  EXPECT_EQ(data_r, context.values_r().data());
+  EXPECT_EQ(values_r, buffer_r);
+  EXPECT_EQ(std::vector<double>({-0.5}), context.vals_r("alpha"));
+
+  std::vector<int> buffer_i{1, 2, 3, 4};
+  context.swap_i(buffer_i);
+  EXPECT_EQ(values_i, buffer_i);
+  EXPECT_EQ(std::vector<int>({1, 2, 3}), context.vals_i("n"));
+
+  std::vector<double> wrong_size{1};
+  EXPECT_THROW(context.swap_r(wrong_size), std::invalid_argument);
+  EXPECT_EQ(1, wrong_size.size());
+  EXPECT_EQ(std::vector<double>({-0.5}), context.vals_r("alpha"));
+}
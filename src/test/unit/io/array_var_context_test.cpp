@@ -307,3 +307,35 @@ TEST(array_var_context, ctor_complex) {
   std::vector<std::complex<double>> eta;
   EXPECT_EQ(eta, avc.vals_c("eta"));
 }
+
+TEST(array_var_context, views) {
+  std::vector<std::string> names_r{"alpha", "beta"};
+  std::vector<double> values_r{0.5, 1, 2, 3, 4, 5, 6};
+  std::vector<std::vector<size_t>> dims_r{{}, {2, 3}};
+  std::vector<std::string> names_i{"n"};
+  std::vector<int> values_i{7, 8, 9};
+  std::vector<std::vector<size_t>> dims_i{{3}};
+  stan::io::array_var_context avc(names_r, values_r, dims_r, names_i,
+                                  values_i, dims_i);
+
+  stan::io::var_view_r beta = avc.vals_r_view("beta");
+  EXPECT_FALSE(beta.is_int());
+  EXPECT_EQ(avc.vals_r("beta"), beta.to_vector());
+  EXPECT_EQ(avc.dims_r("beta"), beta.dims().to_vector());
+  EXPECT_EQ(beta.data(), avc.vals_r_view("beta").data());
+
+  stan::io::var_view_r n_r = avc.vals_r_view("n");
+  EXPECT_TRUE(n_r.is_int());
+  EXPECT_EQ(nullptr, n_r.data());
+  EXPECT_EQ(avc.vals_r("n"), n_r.to_vector());
+  EXPECT_FLOAT_EQ(8.0, n_r[1]);
+  EXPECT_EQ(avc.dims_r("n"), n_r.dims().to_vector());
+
+  stan::io::var_view_i n = avc.vals_i_view("n");
+  EXPECT_EQ(avc.vals_i("n"), n.to_vector());
+  EXPECT_EQ(n_r.int_values().data(), n.data());
+
+  EXPECT_TRUE(avc.vals_r_view("gamma").empty());
+  EXPECT_TRUE(avc.vals_r_view("gamma").dims().empty());
+  EXPECT_TRUE(avc.vals_i_view("beta").empty());
+}
@@ -0,0 +1,190 @@
+#include <stan/io/binary_columnar_reader.hpp>
+#include <stan/callbacks/binary_columnar_writer.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+using stream_writer
+    = stan::callbacks::binary_columnar_writer<std::stringstream, deleter_noop>;
+
+// Writes the contents of a Stan csv file through a binary columnar
+// writer, as the services would have written them
+void convert_csv(std::istream& in, stan::callbacks::writer& writer) {
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty())
+      continue;
+    if (line[0] == '#') {
+      writer(line.substr(1));
+    } else if (std::isalpha(line[0])) {
+      std::vector<std::string> names;
+      std::stringstream ss(line);
+      std::string name;
+      while (std::getline(ss, name, ','))
+        names.push_back(name);
+      writer(names);
+    } else {
+      std::vector<double> values;
+      std::stringstream ss(line);
+      std::string value;
+      while (std::getline(ss, value, ','))
+        values.push_back(std::strtod(value.c_str(), nullptr));
+      writer(values);
+    }
+  }
+}
+}  // namespace
+
+class StanIoBinaryColumnarReader : public testing::Test {
+ public:
+  // Copies the written bytes into a buffer aligned for doubles
+  void finish() {
+    std::string s = ss.str();
+    buffer.assign((s.size() + 7) / 8, 0);
+    std::memcpy(buffer.data(), s.data(), s.size());
+    size = s.size();
+  }
+
+  const char* data() const {
+    return reinterpret_cast<const char*>(buffer.data());
+  }
+
+  std::unique_ptr<std::stringstream, deleter_noop> output() {
+    return std::unique_ptr<std::stringstream, deleter_noop>(&ss);
+  }
+
+  std::stringstream ss;
+  std::vector<double> buffer;
+  size_t size;
+};
+
+TEST_F(StanIoBinaryColumnarReader, chunks) {
+  {
+    stream_writer writer(output(), 4);
+    writer(std::vector<std::string>{"lp__", "theta"});
+    for (int n = 0; n < 10; ++n)
+      writer(std::vector<double>{-1.0 * n, 0.5 * n});
+  }
+  finish();
+  stan::io::binary_columnar_reader reader(data(), size);
+
+  ASSERT_EQ(2, reader.names().size());
+  EXPECT_EQ("theta", reader.names()[1]);
+  EXPECT_EQ(1, reader.index("theta"));
+  EXPECT_EQ(-1, reader.index("mu"));
+  EXPECT_EQ(3, reader.num_chunks());
+  EXPECT_EQ(10, reader.num_draws());
+  EXPECT_EQ(2, reader.num_columns());
+
+  auto chunk = reader.chunk(2);
+  ASSERT_EQ(2, chunk.rows());
+  ASSERT_EQ(2, chunk.cols());
+  EXPECT_FLOAT_EQ(-8, chunk(0, 0));
+  EXPECT_FLOAT_EQ(4.5, chunk(1, 1));
+  // chunks point into the buffer
+  EXPECT_GE(reinterpret_cast<const char*>(chunk.data()), data());
+  EXPECT_LT(reinterpret_cast<const char*>(chunk.data()), data() + size);
+
+  Eigen::VectorXd theta = reader.column(1);
+  Eigen::MatrixXd draws = reader.draws();
+  ASSERT_EQ(10, theta.size());
+  ASSERT_EQ(10, draws.rows());
+  for (int n = 0; n < 10; ++n) {
+    EXPECT_FLOAT_EQ(0.5 * n, theta(n));
+    EXPECT_FLOAT_EQ(-1.0 * n, draws(n, 0));
+    EXPECT_FLOAT_EQ(0.5 * n, draws(n, 1));
+  }
+}
+
+TEST_F(StanIoBinaryColumnarReader, parse_matches_csv) {
+  for (std::string file : {"blocker.0", "bernoulli_warmup", "eight_schools",
+                           "fixed_param_output", "bernoulli_thin"}) {
+    std::string path = "src/test/unit/io/test_csv_files/" + file + ".csv";
+    std::ifstream csv_in(path);
+    stan::io::stan_csv expected
+        = stan::io::stan_csv_reader::parse(csv_in, nullptr);
+
+    ss.str(std::string());
+    {
+      stream_writer writer(output(), 64);
+      std::ifstream in(path);
+      convert_csv(in, writer);
+    }
+    finish();
+    stan::io::binary_columnar_reader reader(data(), size);
+    stan::io::stan_csv result = reader.parse();
+
+    EXPECT_EQ(expected.metadata.model, result.metadata.model) << file;
+    EXPECT_EQ(expected.metadata.num_samples, result.metadata.num_samples);
+    EXPECT_EQ(expected.metadata.num_warmup, result.metadata.num_warmup);
+    EXPECT_EQ(expected.metadata.save_warmup, result.metadata.save_warmup);
+    EXPECT_EQ(expected.metadata.algorithm, result.metadata.algorithm);
+    EXPECT_EQ(expected.header, result.header) << file;
+    EXPECT_FLOAT_EQ(expected.adaptation.step_size,
+                    result.adaptation.step_size)
+        << file;
+    ASSERT_EQ(expected.adaptation.metric.rows(),
+              result.adaptation.metric.rows())
+        << file;
+    ASSERT_EQ(expected.adaptation.metric.cols(),
+              result.adaptation.metric.cols());
+    EXPECT_TRUE(expected.adaptation.metric.isApprox(result.adaptation.metric))
+        << file;
+    ASSERT_EQ(expected.samples.rows(), result.samples.rows()) << file;
+    ASSERT_EQ(expected.samples.cols(), result.samples.cols()) << file;
+    EXPECT_TRUE(expected.samples.isApprox(result.samples)) << file;
+    EXPECT_FLOAT_EQ(expected.timing.warmup, result.timing.warmup) << file;
+    EXPECT_FLOAT_EQ(expected.timing.sampling, result.timing.sampling) << file;
+  }
+}
+
+TEST_F(StanIoBinaryColumnarReader, file) {
+  std::string path = "binary_columnar_reader_test.bin";
+  {
+    stan::callbacks::binary_columnar_writer<std::ofstream> writer(
+        std::make_unique<std::ofstream>(path, std::ios::binary), 3);
+    writer(std::vector<std::string>{"x"});
+    for (int n = 0; n < 7; ++n)
+      writer(std::vector<double>{1.0 * n});
+  }
+  {
+    stan::io::binary_columnar_reader reader(path);
+    EXPECT_EQ(3, reader.num_chunks());
+    Eigen::VectorXd x = reader.column(0);
+    ASSERT_EQ(7, x.size());
+    EXPECT_FLOAT_EQ(6, x(6));
+  }
+  std::remove(path.c_str());
+
+  EXPECT_THROW(stan::io::binary_columnar_reader("no/such/file.bin"),
+               std::invalid_argument);
+}
+
+TEST_F(StanIoBinaryColumnarReader, invalid) {
+  ss << "lp__,theta\n1,2\n";
+  finish();
+  EXPECT_THROW(stan::io::binary_columnar_reader(data(), size),
+               std::invalid_argument);
+
+  ss.str(std::string());
+  {
+    stream_writer writer(output());
+    writer(std::vector<double>{1, 2, 3});
+  }
+  finish();
+  EXPECT_NO_THROW(stan::io::binary_columnar_reader(data(), size));
+  EXPECT_THROW(stan::io::binary_columnar_reader(data(), size - 8),
+               std::invalid_argument);
+}
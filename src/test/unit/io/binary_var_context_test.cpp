@@ -0,0 +1,202 @@
+#include <stan/io/binary_var_context.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/dump.hpp>
+#include <stan/io/json/json_data.hpp>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class binary_var_context_test : public ::testing::Test {
+ public:
+  // Copies the written bytes into storage aligned to 8 bytes
+  void convert(const stan::io::var_context& context) {
+    std::stringstream out;
+    stan::io::write_binary_var_context(context, out);
+    bytes = out.str();
+    buffer.assign((bytes.size() + 7) / 8, 0);
+    std::memcpy(buffer.data(), bytes.data(), bytes.size());
+  }
+
+  const char* data() const {
+    return reinterpret_cast<const char*>(buffer.data());
+  }
+
+  std::string bytes;
+  std::vector<double> buffer;
+};
+
+void expect_same_context(const stan::io::var_context& expected,
+                         const stan::io::var_context& context) {
+  std::vector<std::string> names_r, expected_names_r;
+  context.names_r(names_r);
+  expected.names_r(expected_names_r);
+  EXPECT_EQ(expected_names_r, names_r);
+  std::vector<std::string> names_i, expected_names_i;
+  context.names_i(names_i);
+  expected.names_i(expected_names_i);
+  EXPECT_EQ(expected_names_i, names_i);
+
+  for (const auto& name : names_r) {
+    EXPECT_TRUE(context.contains_r(name));
+    EXPECT_FALSE(context.contains_i(name));
+    EXPECT_EQ(expected.vals_r(name), context.vals_r(name)) << name;
+    EXPECT_EQ(expected.dims_r(name), context.dims_r(name)) << name;
+  }
+  for (const auto& name : names_i) {
+    EXPECT_TRUE(context.contains_r(name));
+    EXPECT_TRUE(context.contains_i(name));
+    EXPECT_EQ(expected.vals_i(name), context.vals_i(name)) << name;
+    EXPECT_EQ(expected.dims_i(name), context.dims_i(name)) << name;
+    EXPECT_EQ(expected.vals_r(name), context.vals_r(name)) << name;
+    EXPECT_EQ(expected.dims_r(name), context.dims_r(name)) << name;
+  }
+}
+
+TEST_F(binary_var_context_test, json) {
+  std::string txt
+      = "{ \"N\" : 3, \"y\" : [0, 1, 1], \"sigma\" : 2.5,"
+        " \"x\" : [[1.5, 2, 3], [4, 5, 6]], \"empty\" : [],"
+        " \"z\" : [[1, 2], [3, 4]] }";
+  std::stringstream in(txt);
+  stan::json::json_data jdata(in);
+  convert(jdata);
+  stan::io::binary_var_context context(data(), bytes.size());
+  expect_same_context(jdata, context);
+  EXPECT_EQ(jdata.vals_c("x"), context.vals_c("x"));
+  EXPECT_FALSE(context.contains_r("w"));
+  EXPECT_TRUE(context.vals_r("w").empty());
+  EXPECT_TRUE(context.dims_r("w").empty());
+  EXPECT_TRUE(context.vals_i("x").empty());
+  EXPECT_TRUE(context.dims_i("x").empty());
+}
+
+TEST_F(binary_var_context_test, dump) {
+  std::string txt
+      = "N <- 3L\n"
+        "y <- c(0L, 1L, 1L)\n"
+        "x <- structure(c(1.5, 2, 3, 4, 5, 6), .Dim = c(2, 3))\n"
+        "z <- integer(0)\n";
+  std::stringstream in(txt);
+  stan::io::dump dump(in);
+  convert(dump);
+  stan::io::binary_var_context context(data(), bytes.size());
+  expect_same_context(dump, context);
+}
+
+TEST_F(binary_var_context_test, array_var_context) {
+  std::vector<std::string> names_r{"a", "b"};
+  std::vector<double> values_r{1.5, 1, 2, 3};
+  std::vector<std::vector<size_t>> dims_r{{}, {3}};
+  std::vector<std::string> names_i{"n"};
+  std::vector<int> values_i{4, 5};
+  std::vector<std::vector<size_t>> dims_i{{2}};
+  stan::io::array_var_context avc(names_r, values_r, dims_r, names_i,
+                                  values_i, dims_i);
+  convert(avc);
+  stan::io::binary_var_context context(data(), bytes.size());
+  EXPECT_EQ(avc.vals_r("a"), context.vals_r("a"));
+  EXPECT_EQ(avc.vals_r("b"), context.vals_r("b"));
+  EXPECT_EQ(avc.dims_r("b"), context.dims_r("b"));
+  EXPECT_EQ(avc.vals_i("n"), context.vals_i("n"));
+  EXPECT_EQ(avc.dims_i("n"), context.dims_i("n"));
+}
+
+TEST_F(binary_var_context_test, views) {
+  std::string txt = "{ \"n\" : [1, 2, 3], \"x\" : [[1.5, 2], [3, 4]] }";
+  std::stringstream in(txt);
+  stan::json::json_data jdata(in);
+  convert(jdata);
+  stan::io::binary_var_context context(data(), bytes.size());
+
+  stan::io::var_view_r x = context.vals_r_view("x");
+  EXPECT_FALSE(x.is_int());
+  EXPECT_GE(x.data(), reinterpret_cast<const double*>(data()));
+  EXPECT_LT(x.data(), reinterpret_cast<const double*>(data() + bytes.size()));
+  EXPECT_EQ(jdata.vals_r("x"), x.to_vector());
+  EXPECT_EQ(jdata.dims_r("x"), x.dims().to_vector());
+
+  stan::io::var_view_r n_r = context.vals_r_view("n");
+  EXPECT_TRUE(n_r.is_int());
+  EXPECT_EQ(jdata.vals_r("n"), n_r.to_vector());
+  stan::io::var_view_i n = context.vals_i_view("n");
+  EXPECT_EQ(n_r.int_values().data(), n.data());
+  EXPECT_EQ(jdata.vals_i("n"), n.to_vector());
+
+  EXPECT_TRUE(context.vals_r_view("w").empty());
+  EXPECT_TRUE(context.vals_i_view("x").empty());
+}
+
+TEST_F(binary_var_context_test, file) {
+  std::string txt = "{ \"N\" : 2, \"x\" : [0.25, 0.5] }";
+  std::stringstream in(txt);
+  stan::json::json_data jdata(in);
+  std::string path = "binary_var_context_test.bin";
+  {
+    std::ofstream out(path, std::ios::binary);
+    stan::io::write_binary_var_context(jdata, out);
+  }
+  {
+    stan::io::binary_var_context context(path);
+    expect_same_context(jdata, context);
+  }
+  std::remove(path.c_str());
+  EXPECT_THROW(stan::io::binary_var_context("no_such_file.bin"),
+               std::invalid_argument);
+}
+
+TEST_F(binary_var_context_test, validate_dims) {
+  std::string txt = "{ \"N\" : 2, \"x\" : [0.25, 0.5], \"e\" : [] }";
+  std::stringstream in(txt);
+  stan::json::json_data jdata(in);
+  convert(jdata);
+  stan::io::binary_var_context context(data(), bytes.size());
+  EXPECT_NO_THROW(context.validate_dims("data", "N", "int", {}));
+  EXPECT_NO_THROW(context.validate_dims("data", "x", "double", {2}));
+  EXPECT_NO_THROW(context.validate_dims("data", "e", "double", {0, 3}));
+  EXPECT_THROW(context.validate_dims("data", "x", "int", {2}),
+               std::runtime_error);
+  EXPECT_THROW(context.validate_dims("data", "x", "double", {3}),
+               std::runtime_error);
+  EXPECT_THROW(context.validate_dims("data", "w", "double", {1}),
+               std::runtime_error);
+}
+
+TEST_F(binary_var_context_test, errors) {
+  std::string txt = "{ \"N\" : 2, \"x\" : [0.25, 0.5] }";
+  std::stringstream in(txt);
+  stan::json::json_data jdata(in);
+  convert(jdata);
+
+  EXPECT_THROW(stan::io::binary_var_context(data() + 4, bytes.size() - 4),
+               std::invalid_argument);
+  EXPECT_THROW(stan::io::binary_var_context(data(), 10),
+               std::invalid_argument);
+  // truncated index
+  EXPECT_THROW(stan::io::binary_var_context(data(), 40),
+               std::invalid_argument);
+  // truncated values
+  EXPECT_THROW(stan::io::binary_var_context(data(), bytes.size() - 8),
+               std::invalid_argument);
+
+  std::vector<double> copy = buffer;
+  char* bytes_copy = reinterpret_cast<char*>(copy.data());
+  bytes_copy[0] = 'X';
+  EXPECT_THROW(stan::io::binary_var_context(bytes_copy, bytes.size()),
+               std::invalid_argument);
+
+  copy = buffer;
+  uint32_t byte_order_mark = 0x04030201;
+  std::memcpy(bytes_copy + 12, &byte_order_mark, 4);
+  EXPECT_THROW(stan::io::binary_var_context(bytes_copy, bytes.size()),
+               std::invalid_argument);
+
+  copy = buffer;
+  uint32_t type = 7;
+  std::memcpy(bytes_copy + 24, &type, 4);
+  EXPECT_THROW(stan::io::binary_var_context(bytes_copy, bytes.size()),
+               std::invalid_argument);
+}
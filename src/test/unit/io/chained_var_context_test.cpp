@@ -53,3 +53,21 @@ TEST(chained_var_context, ctor) {
   std::vector<double> alpha(1, 0);
   EXPECT_EQ(alpha, vcc.vals_r("alpha"));
 }
+
+TEST(chained_var_context, views) {
+  std::vector<std::string> names1{"alpha"};
+  std::vector<double> v1{1.5};
+  std::vector<std::vector<size_t> > dims1{{}};
+  stan::io::array_var_context avc1(names1, v1, dims1);
+  std::vector<std::string> names2{"alpha", "n"};
+  std::vector<int> v2{1, 2, 3};
+  std::vector<std::vector<size_t> > dims2{{}, {2}};
+  stan::io::array_var_context avc2(names2, v2, dims2);
+  stan::io::chained_var_context vcc(avc1, avc2);
+
+  EXPECT_EQ(avc1.vals_r_view("alpha").data(), vcc.vals_r_view("alpha").data());
+  EXPECT_EQ(avc2.vals_i_view("alpha").data(), vcc.vals_i_view("alpha").data());
+  EXPECT_EQ(avc2.vals_i_view("n").data(), vcc.vals_i_view("n").data());
+  EXPECT_EQ(std::vector<double>({2, 3}), vcc.vals_r_view("n").to_vector());
+  EXPECT_TRUE(vcc.vals_r_view("beta").empty());
+}
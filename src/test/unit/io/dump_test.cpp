@@ -683,3 +683,69 @@ TEST(io_dump, too_large_zero_array) {
   test_exception(
       "a <- structure(double(999918446744073709551616L), .Dim = c(2,3))");
 }
+
+TEST(io_dump, views) {
+  std::string txt
+      = "a <- structure(c(1.5, 2, 3, 4), .Dim = c(2, 2))\n"
+        "n <- c(1L, 2L, 3L)\n";
+  std::stringstream in(txt);
+  stan::io::dump dump(in);
+
+  stan::io::var_view_r a = dump.vals_r_view("a");
+  EXPECT_FALSE(a.is_int());
+  EXPECT_EQ(dump.vals_r("a"), a.to_vector());
+  EXPECT_EQ(dump.dims_r("a"), a.dims().to_vector());
+  EXPECT_EQ(a.data(), dump.vals_r_view("a").data());
+
+  stan::io::var_view_r n_r = dump.vals_r_view("n");
+  EXPECT_TRUE(n_r.is_int());
+  EXPECT_EQ(dump.vals_r("n"), n_r.to_vector());
+  stan::io::var_view_i n = dump.vals_i_view("n");
+  EXPECT_EQ(dump.vals_i("n"), n.to_vector());
+  EXPECT_EQ(dump.dims_i("n"), n.dims().to_vector());
+  EXPECT_EQ(n.data(), n_r.int_values().data());
+
+  EXPECT_TRUE(dump.vals_r_view("b").empty());
+  EXPECT_TRUE(dump.vals_i_view("a").empty());
+}
+
+TEST(io_dump, int_beyond_int_range) {
+  test_exception("k <- 3000000000");
+  test_exception("k <- c(1, -3000000000L)");
+  test_val("k", INT_MIN, "k <- -2147483648");
+}
+
+TEST(io_dump, values_span_buffered_blocks) {
+  // more than one block of input, with names, keywords and numbers
+  // split between blocks
+  size_t N = 50000;
+  std::stringstream txt;
+  txt.precision(17);
+  std::vector<int> expected_n;
+  std::vector<double> expected_x;
+  for (size_t k = 0; k < 3; ++k) {
+    txt << "n" << k << " <- c(";
+    for (size_t i = 0; i < N; ++i) {
+      expected_n.push_back(i * (k + 1) - 7);
+      txt << (i == 0 ? "" : ", ") << expected_n.back() << "L";
+    }
+    txt << ")\nx" << k << " <-\n  structure(c(";
+    for (size_t i = 0; i < N; ++i) {
+      expected_x.push_back(i * 0.25 + k);
+      txt << (i == 0 ? "" : ",\n") << expected_x.back();
+    }
+    txt << "), .Dim = c(" << N / 2 << ", 2))\n";
+  }
+  stan::io::dump dump(txt);
+  for (size_t k = 0; k < 3; ++k) {
+    std::string n = "n" + std::to_string(k);
+    std::string x = "x" + std::to_string(k);
+    EXPECT_EQ(std::vector<int>(expected_n.begin() + k * N,
+                               expected_n.begin() + (k + 1) * N),
+              dump.vals_i(n));
+    EXPECT_EQ(std::vector<double>(expected_x.begin() + k * N,
+                                  expected_x.begin() + (k + 1) * N),
+              dump.vals_r(x));
+    EXPECT_EQ(std::vector<size_t>({N / 2, 2}), dump.dims_r(x));
+  }
+}
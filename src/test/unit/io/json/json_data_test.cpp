@@ -494,3 +494,86 @@ TEST(ioJson, jsonData_promote_extra_large_int_to_double) {
   test_real_var(jdata, "foo", foo_vals_r, expected_dims);
   test_real_var(jdata, "bar", bar_vals_r, expected_dims);
 }
+
+TEST(ioJson, jsonData_views) {
+  std::string txt = "{ \"a\" : [[1.5, 2], [3, 4], [5, 6]], \"n\" : [1, 2] }";
+  std::stringstream in(txt);
+  stan::json::json_data jdata(in);
+
+  stan::io::var_view_r a = jdata.vals_r_view("a");
+  EXPECT_FALSE(a.is_int());
+  EXPECT_EQ(jdata.vals_r("a"), a.to_vector());
+  EXPECT_EQ(jdata.dims_r("a"), a.dims().to_vector());
+  EXPECT_EQ(a.data(), jdata.vals_r_view("a").data());
+
+  stan::io::var_view_r n_r = jdata.vals_r_view("n");
+  EXPECT_TRUE(n_r.is_int());
+  EXPECT_EQ(jdata.vals_r("n"), n_r.to_vector());
+  stan::io::var_view_i n = jdata.vals_i_view("n");
+  EXPECT_EQ(jdata.vals_i("n"), n.to_vector());
+  EXPECT_EQ(n.data(), n_r.int_values().data());
+
+  EXPECT_TRUE(jdata.vals_r_view("b").empty());
+  EXPECT_TRUE(jdata.vals_i_view("a").empty());
+}
+
+TEST(ioJson, jsonData_large_arrays) {
+  std::stringstream txt;
+  txt.precision(17);
+  std::vector<int> n;
+  std::vector<double> x;
+  std::vector<double> z;
+  for (int i = 0; i < 100000; ++i) {
+    n.push_back(i % 2 == 0 ? i : -i);
+    x.push_back(i * 0.25);
+    z.push_back(i % 3 == 0 ? 3e9 : i);
+  }
+  auto write = [&txt](const auto& values) {
+    txt << "[";
+    for (size_t i = 0; i < values.size(); ++i)
+      txt << (i > 0 ? ", " : "") << values[i];
+    txt << "]";
+  };
+  txt << "{ \"n\" : ";
+  write(n);
+  txt << ", \"x\" : ";
+  write(x);
+  txt << ", \"z\" : ";
+  write(z);
+  txt << ", \"m\" : [";
+  write(n);
+  txt << ", ";
+  write(x);
+  txt << "], \"_ignored\" : ";
+  write(x);
+  txt << "}";
+  stan::json::json_data jdata(txt);
+
+  test_int_var(jdata, "n", n, {n.size()});
+  test_real_var(jdata, "x", x, {x.size()});
+  EXPECT_FALSE(jdata.contains_i("z"));
+  EXPECT_EQ(z, jdata.vals_r("z"));
+  std::vector<double> m(2 * n.size());
+  for (size_t i = 0; i < n.size(); ++i) {
+    m[2 * i] = n[i];
+    m[2 * i + 1] = x[i];
+  }
+  test_real_var(jdata, "m", m, {2, n.size()});
+  EXPECT_FALSE(jdata.contains_r("_ignored"));
+}
+
+TEST(ioJson, jsonData_large_array_errors) {
+  std::stringstream txt;
+  txt << "{ \"x\" : [";
+  for (int i = 0; i < 100000; ++i)
+    txt << i << ", ";
+  txt << "01] }";
+  EXPECT_THROW(stan::json::json_data jdata(txt), stan::json::json_error);
+
+  std::stringstream txt2;
+  txt2 << "{ \"x\" : [";
+  for (int i = 0; i < 100000; ++i)
+    txt2 << i << ", ";
+  txt2 << "] }";
+  EXPECT_THROW(stan::json::json_data jdata(txt2), stan::json::json_error);
+}
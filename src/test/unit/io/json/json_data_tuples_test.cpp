@@ -230,3 +230,42 @@ TEST(ioJsonTuples, jsonData_plus_comments_2) {
   std::vector<size_t> expected_dims_y;
   test_real_var(jdata, "y", expected_vals_y, expected_dims_y);
 }
+
+// array[N, 2] tuple(int, array[3] real, tuple(array[2, 2] int, int)) x;
+// values of arrays of tuples are stored in element order
+TEST(ioJsonTuples, jsonData_large_array_tuples) {
+  size_t N = 2000;
+  std::stringstream txt;
+  txt << "{ \"x\" : [";
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < 2; ++j) {
+      txt << (j == 0 ? (i == 0 ? "[" : ", [") : ", ") << "{ \"1\" : "
+          << 2 * i + j << ", \"2\" : [" << i << ".5, 1, 2], \"3\" : "
+          << "{ \"1\" : [[1, 2], [3, 4]], \"2\" : " << j << " } }";
+    }
+    txt << "]";
+  }
+  txt << "], \"y\" : 3 }";
+  stan::json::json_data jdata(txt);
+
+  std::vector<int> expected_vals_x1(2 * N);
+  std::vector<int> expected_vals_x31;
+  std::vector<double> expected_vals_x2(6 * N);
+  std::vector<int> expected_vals_x32(2 * N);
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < 2; ++j) {
+      size_t k = 2 * i + j;
+      expected_vals_x1[k] = k;
+      expected_vals_x2[3 * k] = i + 0.5;
+      expected_vals_x2[3 * k + 1] = 1;
+      expected_vals_x2[3 * k + 2] = 2;
+      expected_vals_x31.insert(expected_vals_x31.end(), {1, 3, 2, 4});
+      expected_vals_x32[k] = j;
+    }
+  }
+  test_int_var(jdata, "x.1", expected_vals_x1, {N, 2});
+  test_real_var(jdata, "x.2", expected_vals_x2, {N, 2, 3});
+  test_int_var(jdata, "x.3.1", expected_vals_x31, {N, 2, 2, 2});
+  test_int_var(jdata, "x.3.2", expected_vals_x32, {N, 2});
+  test_int_var(jdata, "y", {3}, {});
+}
@@ -0,0 +1,130 @@
+#include <stan/io/json/number_array.hpp>
+#include <stan/io/json/rapidjson_parser.hpp>
+#include <stan/io/json/json_handler.hpp>
+#include <gtest/gtest.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__cpp_lib_to_chars)
+
+namespace {
+// Collects the numbers of the text, one number event per value
+class number_handler : public stan::json::json_handler {
+ public:
+  void number_double(double x) { values.push_back(x); }
+  void number_int(int n) { values.push_back(n); }
+  void number_unsigned_int(unsigned n) { values.push_back(n); }
+  void number_int64(int64_t n) { values.push_back(n); }
+  void number_unsigned_int64(uint64_t n) { values.push_back(n); }
+  std::vector<double> values;
+};
+
+std::vector<double> sax_values(const std::string& text) {
+  std::stringstream in(text);
+  number_handler handler;
+  stan::json::rapidjson_parse(in, handler);
+  return handler.values;
+}
+
+const char* parse(const std::string& text,
+                  stan::json::internal::number_array& values) {
+  return stan::json::internal::parse_number_array(
+      text.data() + 1, text.data() + text.size(), values, 0);
+}
+}  // namespace
+
+TEST(ioJson, number_array_matches_sax_parser) {
+  boost::random::mt19937 rng(1234);
+  boost::random::uniform_real_distribution<double> exponent(-300, 300);
+  boost::random::uniform_real_distribution<double> mantissa(-1, 1);
+  std::stringstream text;
+  text << "[";
+  char buffer[64];
+  for (int n = 0; n < 200000; ++n) {
+    double x = mantissa(rng) * std::pow(10, exponent(rng));
+    std::snprintf(buffer, sizeof(buffer), n % 3 == 0 ? "%.17g" : "%.6e", x);
+    text << (n > 0 ? ", " : "") << buffer;
+    if (n % 7 == 0)
+      text << ",\n " << n - 100000;
+  }
+  text << "]";
+
+  std::string json = text.str();
+  stan::json::internal::number_array values;
+  const char* close = parse(json, values);
+  ASSERT_NE(nullptr, close);
+  EXPECT_EQ(']', *close);
+  EXPECT_FALSE(values.is_int);
+  EXPECT_EQ(sax_values(json), values.doubles);
+}
+
+TEST(ioJson, number_array_ints) {
+  std::stringstream text;
+  text << "[ ";
+  for (int n = -150000; n < 150000; ++n)
+    text << n << (n + 1 < 150000 ? " ,\t" : " ");
+  text << "]";
+
+  stan::json::internal::number_array values;
+  ASSERT_NE(nullptr, parse(text.str(), values));
+  EXPECT_TRUE(values.is_int);
+  ASSERT_EQ(300000, values.ints.size());
+  EXPECT_EQ(-150000, values.ints[0]);
+  EXPECT_EQ(149999, values.ints.back());
+
+  std::string wide = "[1, -2, 2147483648, 0]";
+  ASSERT_NE(nullptr, parse(wide, values));
+  EXPECT_FALSE(values.is_int);
+  EXPECT_EQ(sax_values(wide), values.doubles);
+}
+
+TEST(ioJson, number_array_ints_then_doubles) {
+  // the only double is in the last chunk, after the integers
+  std::stringstream text;
+  text << "[";
+  for (int n = 0; n < 300000; ++n)
+    text << n << ", ";
+  text << "0.5, 7]";
+
+  std::string json = text.str();
+  stan::json::internal::number_array values;
+  ASSERT_NE(nullptr, parse(json, values));
+  EXPECT_FALSE(values.is_int);
+  EXPECT_TRUE(values.ints.empty());
+  EXPECT_EQ(sax_values(json), values.doubles);
+
+  // invalid numbers after the first double are still found
+  EXPECT_EQ(nullptr, parse("[1, 2.5, 1e400]", values));
+  EXPECT_EQ(nullptr, parse("[1, 2.5, 01]", values));
+}
+
+TEST(ioJson, number_array_left_to_parser) {
+  stan::json::internal::number_array values;
+  // not flat arrays of numbers
+  EXPECT_EQ(nullptr, parse("[1, [2]]", values));
+  EXPECT_EQ(nullptr, parse("[1, \"NaN\"]", values));
+  EXPECT_EQ(nullptr, parse("[1, NaN]", values));
+  EXPECT_EQ(nullptr, parse("[1, 2", values));
+  EXPECT_EQ(nullptr, parse("[ ]", values));
+  // not JSON numbers
+  EXPECT_EQ(nullptr, parse("[1, 2,]", values));
+  EXPECT_EQ(nullptr, parse("[1 2]", values));
+  EXPECT_EQ(nullptr, parse("[01]", values));
+  EXPECT_EQ(nullptr, parse("[1.]", values));
+  EXPECT_EQ(nullptr, parse("[.5]", values));
+  EXPECT_EQ(nullptr, parse("[+1]", values));
+  EXPECT_EQ(nullptr, parse("[1e]", values));
+  EXPECT_EQ(nullptr, parse("[1-2]", values));
+  // out of the range of double
+  EXPECT_EQ(nullptr, parse("[1e400]", values));
+  // too short
+  EXPECT_EQ(nullptr, stan::json::internal::parse_number_array(
+                         "1, 2]", "1, 2]" + 5, values));
+}
+
+#endif
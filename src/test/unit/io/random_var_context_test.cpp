@@ -137,6 +137,18 @@ TEST_F(random_var_context, dims_r) {
   EXPECT_EQ(2, dims_r[0]);
 }
 
+TEST_F(random_var_context, vals_r_view) {
+  stan::io::random_var_context context(model, rng, 2, false);
+  EXPECT_TRUE(context.vals_r_view("").empty());
+
+  stan::io::var_view_r y = context.vals_r_view("y");
+  EXPECT_FALSE(y.is_int());
+  EXPECT_EQ(context.vals_r("y"), y.to_vector());
+  EXPECT_EQ(context.dims_r("y"), y.dims().to_vector());
+  EXPECT_EQ(y.data(), context.vals_r_view("y").data());
+  EXPECT_TRUE(context.vals_i_view("y").empty());
+}
+
 TEST_F(random_var_context, contains_i) {
   stan::io::random_var_context context(model, rng, 2, false);
   EXPECT_FALSE(context.contains_i(""));
@@ -174,3 +186,19 @@ TEST_F(random_var_context, construct) {
   EXPECT_THROW_MSG(stan::io::random_var_context(throwing_model, rng, 2, false),
                    std::domain_error, "throwing within write_array");
 }
+
+TEST_F(random_var_context, draw_unconstrained) {
+  stan::rng_t expected_rng = rng;
+  stan::io::random_var_context context(model, expected_rng, 2, false);
+  std::vector<double> params
+      = stan::io::random_var_context::draw_unconstrained(model, rng, 2, false);
+  EXPECT_EQ(context.get_unconstrained(), params);
+  EXPECT_EQ(expected_rng(), rng()) << "rng in the same state";
+
+  EXPECT_EQ(std::vector<double>(model.num_params_r(), 0.0),
+            stan::io::random_var_context::draw_unconstrained(model, rng, 0,
+                                                             true));
+  EXPECT_NO_THROW(stan::io::random_var_context::draw_unconstrained(
+      throwing_model, rng, 2, false));
+  EXPECT_EQ(0, throwing_model.write_array_calls);
+}
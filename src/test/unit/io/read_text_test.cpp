@@ -0,0 +1,24 @@
+#include <stan/io/read_text.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+TEST(ioReadText, empty) {
+  std::stringstream in;
+  EXPECT_EQ("", stan::io::read_text(in));
+}
+
+TEST(ioReadText, remaining_contents) {
+  std::stringstream in("skip\nrest of\nthe text");
+  std::string line;
+  std::getline(in, line);
+  EXPECT_EQ("rest of\nthe text", stan::io::read_text(in));
+}
+
+TEST(ioReadText, multiple_blocks) {
+  std::string text(3 * (1 << 20) + 17, 'x');
+  for (size_t i = 0; i < text.size(); i += 1000)
+    text[i] = '\n';
+  std::stringstream in(text);
+  EXPECT_EQ(text, stan::io::read_text(in));
+}
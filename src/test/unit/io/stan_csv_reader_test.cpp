@@ -591,3 +591,90 @@ TEST_F(StanIoStanCsvReader, variational) {
   variational_stream.close();
   ASSERT_EQ(1000, variational.metadata.num_samples);
 }
+
+TEST_F(StanIoStanCsvReader, parse_columns_matches_parse) {
+  for (std::string file :
+       {"blocker.0", "eight_schools", "bernoulli_warmup", "bernoulli_thin",
+        "fixed_param_output", "bernoulli_variational"}) {
+    std::string path = "src/test/unit/io/test_csv_files/" + file + ".csv";
+    std::ifstream expected_stream(path);
+    stan::io::stan_csv expected
+        = stan::io::stan_csv_reader::parse(expected_stream, nullptr);
+    std::ifstream stream(path);
+    std::stringstream out;
+    stan::io::stan_csv result
+        = stan::io::stan_csv_reader::parse(stream, {}, &out);
+
+    EXPECT_EQ("", out.str()) << file;
+    EXPECT_EQ(expected.metadata.model, result.metadata.model) << file;
+    EXPECT_EQ(expected.metadata.num_samples, result.metadata.num_samples);
+    EXPECT_EQ(expected.header, result.header) << file;
+    EXPECT_FLOAT_EQ(expected.adaptation.step_size,
+                    result.adaptation.step_size)
+        << file;
+    EXPECT_EQ(expected.adaptation.metric, result.adaptation.metric) << file;
+    ASSERT_EQ(expected.samples.rows(), result.samples.rows()) << file;
+    ASSERT_EQ(expected.samples.cols(), result.samples.cols()) << file;
+    for (int i = 0; i < expected.samples.rows(); ++i)
+      for (int j = 0; j < expected.samples.cols(); ++j)
+        ASSERT_FLOAT_EQ(expected.samples(i, j), result.samples(i, j))
+            << file << " " << i << ", " << j;
+    EXPECT_FLOAT_EQ(expected.timing.warmup, result.timing.warmup) << file;
+    EXPECT_FLOAT_EQ(expected.timing.sampling, result.timing.sampling) << file;
+  }
+}
+
+TEST_F(StanIoStanCsvReader, parse_columns_selected) {
+  stan::io::stan_csv blocker0
+      = stan::io::stan_csv_reader::parse(blocker0_stream, nullptr);
+  std::ifstream stream("src/test/unit/io/test_csv_files/blocker.0.csv");
+  std::vector<std::string> columns{"mu[3]", "lp__", "d"};
+  stan::io::stan_csv selected
+      = stan::io::stan_csv_reader::parse(stream, columns, nullptr);
+
+  EXPECT_EQ(columns, selected.header);
+  ASSERT_EQ(blocker0.samples.rows(), selected.samples.rows());
+  ASSERT_EQ(3, selected.samples.cols());
+  int mu3 = std::find(blocker0.header.begin(), blocker0.header.end(), "mu[3]")
+            - blocker0.header.begin();
+  int d = std::find(blocker0.header.begin(), blocker0.header.end(), "d")
+          - blocker0.header.begin();
+  for (int i = 0; i < blocker0.samples.rows(); ++i) {
+    EXPECT_FLOAT_EQ(blocker0.samples(i, mu3), selected.samples(i, 0));
+    EXPECT_FLOAT_EQ(blocker0.samples(i, 0), selected.samples(i, 1));
+    EXPECT_FLOAT_EQ(blocker0.samples(i, d), selected.samples(i, 2));
+  }
+  EXPECT_FLOAT_EQ(blocker0.adaptation.step_size,
+                  selected.adaptation.step_size);
+}
+
+TEST_F(StanIoStanCsvReader, parse_columns_errors) {
+  std::vector<std::string> columns{"not_a_column"};
+  EXPECT_THROW(stan::io::stan_csv_reader::parse(blocker0_stream, columns,
+                                                nullptr),
+               std::invalid_argument);
+
+  std::stringstream ragged("a,b,c\n1,2,3\n4,5\n");
+  EXPECT_THROW(stan::io::stan_csv_reader::parse(ragged, {}, nullptr),
+               std::invalid_argument);
+
+  std::stringstream no_header("1,2,3\n");
+  EXPECT_THROW(stan::io::stan_csv_reader::parse(no_header, {}, nullptr),
+               std::invalid_argument);
+
+  std::ifstream no_samples_stream(
+      "src/test/unit/io/test_csv_files/bernoulli_no_samples.csv");
+  std::stringstream out;
+  stan::io::stan_csv_reader::parse(no_samples_stream, {}, &out);
+  EXPECT_EQ("Unable to parse sample\n", out.str());
+}
+
+TEST_F(StanIoStanCsvReader, parse_columns_blank_cells) {
+  std::stringstream in("a,b,c\n1,2,\n4, ,6\n7,8,9");
+  stan::io::stan_csv csv = stan::io::stan_csv_reader::parse(in, {}, nullptr);
+  ASSERT_EQ(3, csv.samples.rows());
+  ASSERT_EQ(3, csv.samples.cols());
+  Eigen::MatrixXd expected(3, 3);
+  expected << 1, 2, 0, 4, 0, 6, 7, 8, 9;
+  EXPECT_MATRIX_EQ(expected, csv.samples);
+}
@@ -0,0 +1,145 @@
+#include <stan/io/validate_dims_plan.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/chained_var_context.hpp>
+#include <stan/io/dump.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/io/json/json_data.hpp>
+#include <gtest/gtest.h>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace test {
+// Context forwarding to another one and counting the calls that copy
+// dimensions or format messages.
+class counting_var_context : public stan::io::chained_var_context {
+ public:
+  explicit counting_var_context(const stan::io::var_context& context)
+      : chained_var_context(context, empty_) {}
+
+  std::vector<size_t> dims_r(const std::string& name) const {
+    ++dims_r_calls;
+    return chained_var_context::dims_r(name);
+  }
+
+  void validate_dims(const std::string& stage, const std::string& name,
+                     const std::string& base_type,
+                     const std::vector<size_t>& dims_declared) const {
+    ++validate_dims_calls;
+    chained_var_context::validate_dims(stage, name, base_type, dims_declared);
+  }
+
+  mutable int dims_r_calls = 0;
+  mutable int validate_dims_calls = 0;
+
+ private:
+  stan::io::empty_var_context empty_;
+};
+}  // namespace test
+
+class validate_dims_plan : public testing::Test {
+ public:
+  validate_dims_plan() : plan("data initialization") {
+    add("N", "int", {});
+    add("y", "int", {3});
+    add("x", "vector_d", {3, 2});
+    add("empty", "double", {0});
+  }
+
+  void add(const std::string& name, const std::string& base_type,
+           const std::vector<size_t>& dims) {
+    plan.add(name, base_type, dims);
+    decls.push_back([=](const stan::io::var_context& context) {
+      context.validate_dims("data initialization", name, base_type, dims);
+    });
+  }
+
+  // Expect the plan to behave as validate_dims for each variable.
+  void expect_same(const stan::io::var_context& context) {
+    std::string expected;
+    try {
+      for (const auto& decl : decls)
+        decl(context);
+    } catch (const std::exception& e) {
+      expected = e.what();
+    }
+    std::string found;
+    try {
+      plan.validate(context);
+    } catch (const std::exception& e) {
+      found = e.what();
+    }
+    EXPECT_EQ(expected, found);
+  }
+
+  stan::io::validate_dims_plan plan;
+  std::vector<std::function<void(const stan::io::var_context&)>> decls;
+};
+
+TEST_F(validate_dims_plan, valid) {
+  EXPECT_EQ(4, plan.size());
+  stan::io::array_var_context context(
+      {"x", "empty"}, std::vector<double>{1, 2, 3, 4, 5, 6}, {{3, 2}, {0}},
+      {"N", "y"}, std::vector<int>{3, 1, 2, 3}, {{}, {3}});
+  EXPECT_NO_THROW(plan.validate(context));
+  expect_same(context);
+
+  test::counting_var_context counting(context);
+  EXPECT_NO_THROW(plan.validate(counting));
+  EXPECT_EQ(0, counting.dims_r_calls);
+  EXPECT_EQ(0, counting.validate_dims_calls);
+}
+
+TEST_F(validate_dims_plan, invalid) {
+  std::vector<std::string> texts{
+      // missing
+      "N <- 3\ny <- c(1, 2, 3)\nempty <- double(0)",
+      // not an int
+      "N <- 3.5\ny <- c(1, 2, 3)\nx <- structure(c(1, 2, 3, 4, 5, 6), "
+      ".Dim = c(3, 2))\nempty <- double(0)",
+      // number of dimensions
+      "N <- 3\ny <- c(1, 2, 3)\nx <- c(1, 2, 3, 4, 5, 6)\nempty <- double(0)",
+      // dimension
+      "N <- 3\ny <- c(1, 2)\nx <- structure(c(1, 2, 3, 4, 5, 6), "
+      ".Dim = c(2, 3))\nempty <- double(0)"};
+  for (const std::string& text : texts) {
+    std::stringstream in(text);
+    stan::io::dump context(in);
+    EXPECT_THROW(plan.validate(context), std::runtime_error) << text;
+    expect_same(context);
+  }
+}
+
+TEST_F(validate_dims_plan, defers_to_context) {
+  // JSON accepts an empty array for any empty variable, such as the
+  // missing empty
+  std::stringstream in(
+      "{\"N\": 3, \"y\": [1, 2, 3], \"x\": [[1, 2], [3, 4], [5, 6]]}");
+  stan::json::json_data context(in);
+  EXPECT_NO_THROW(plan.validate(context));
+  expect_same(context);
+
+  std::stringstream bad_in(
+      "{\"N\": 3, \"y\": [1, 2, 3], \"x\": [[1, 2, 3], [4, 5, 6]]}");
+  stan::json::json_data bad_context(bad_in);
+  EXPECT_THROW(plan.validate(bad_context), std::runtime_error);
+  expect_same(bad_context);
+}
+
+TEST_F(validate_dims_plan, has_dims) {
+  stan::io::array_var_context context(
+      {"x"}, std::vector<double>{1, 2, 3, 4, 5, 6}, {{3, 2}});
+  std::vector<size_t> dims{3, 2};
+  EXPECT_TRUE(context.has_dims("x", dims));
+  EXPECT_FALSE(context.has_dims("x", std::vector<size_t>{2, 3}));
+  EXPECT_FALSE(context.has_dims("x", std::vector<size_t>{3}));
+  EXPECT_TRUE(context.has_dims("z", std::vector<size_t>{}));
+
+  test::counting_var_context counting(context);
+  EXPECT_TRUE(counting.has_dims("x", dims));
+  EXPECT_EQ(0, counting.dims_r_calls);
+  const stan::io::var_context& base = counting;
+  EXPECT_TRUE(base.var_context::has_dims("x", dims));
+  EXPECT_EQ(1, counting.dims_r_calls);
+}
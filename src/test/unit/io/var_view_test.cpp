@@ -0,0 +1,94 @@
+#include <stan/io/var_view.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace test {
+// Forwards the by-value accessors only, so views use the copying
+// default implementation
+class copying_var_context : public stan::io::var_context {
+ public:
+  explicit copying_var_context(const stan::io::var_context& context)
+      : context_(context) {}
+  bool contains_r(const std::string& name) const {
+    return context_.contains_r(name);
+  }
+  std::vector<double> vals_r(const std::string& name) const {
+    return context_.vals_r(name);
+  }
+  std::vector<std::complex<double>> vals_c(const std::string& name) const {
+    return context_.vals_c(name);
+  }
+  std::vector<size_t> dims_r(const std::string& name) const {
+    return context_.dims_r(name);
+  }
+  bool contains_i(const std::string& name) const {
+    return context_.contains_i(name);
+  }
+  std::vector<int> vals_i(const std::string& name) const {
+    return context_.vals_i(name);
+  }
+  std::vector<size_t> dims_i(const std::string& name) const {
+    return context_.dims_i(name);
+  }
+  void names_r(std::vector<std::string>& names) const {
+    context_.names_r(names);
+  }
+  void names_i(std::vector<std::string>& names) const {
+    context_.names_i(names);
+  }
+  void validate_dims(const std::string& stage, const std::string& name,
+                     const std::string& base_type,
+                     const std::vector<size_t>& dims_declared) const {
+    context_.validate_dims(stage, name, base_type, dims_declared);
+  }
+
+ private:
+  const stan::io::var_context& context_;
+};
+}  // namespace test
+
+TEST(io_var_view, array_view) {
+  std::vector<double> x{1, 2, 3};
+  stan::io::array_view<double> view(x);
+  EXPECT_EQ(x.data(), view.data());
+  EXPECT_EQ(3, view.size());
+  EXPECT_FALSE(view.empty());
+  EXPECT_FLOAT_EQ(2, view[1]);
+  EXPECT_EQ(x, std::vector<double>(view.begin(), view.end()));
+  EXPECT_EQ(x, view.to_vector());
+  EXPECT_TRUE(stan::io::array_view<double>().empty());
+}
+
+TEST(io_var_view, default_copies) {
+  std::vector<std::string> names_r{"a"};
+  std::vector<double> values_r{1, 2, 3, 4};
+  std::vector<std::vector<size_t>> dims_r{{2, 2}};
+  std::vector<std::string> names_i{"n"};
+  std::vector<int> values_i{5, 6};
+  std::vector<std::vector<size_t>> dims_i{{2}};
+  stan::io::array_var_context avc(names_r, values_r, dims_r, names_i,
+                                  values_i, dims_i);
+  test::copying_var_context context(avc);
+
+  stan::io::var_view_r a;
+  {
+    stan::io::var_view_r copy = context.vals_r_view("a");
+    EXPECT_NE(avc.vals_r_view("a").data(), copy.data());
+    a = copy;
+  }
+  EXPECT_EQ(values_r, a.to_vector());
+  EXPECT_EQ(dims_r[0], a.dims().to_vector());
+
+  stan::io::var_view_r n_r = context.vals_r_view("n");
+  EXPECT_FALSE(n_r.is_int());
+  EXPECT_EQ(std::vector<double>({5, 6}), n_r.to_vector());
+
+  stan::io::var_view_i n = context.vals_i_view("n");
+  EXPECT_EQ(values_i, n.to_vector());
+  EXPECT_EQ(dims_i[0], n.dims().to_vector());
+
+  EXPECT_TRUE(context.vals_r_view("b").empty());
+  EXPECT_TRUE(context.vals_i_view("a").empty());
+}
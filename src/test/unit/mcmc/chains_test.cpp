@@ -171,6 +171,70 @@ TEST_F(McmcChains, add_adapter) {
   EXPECT_EQ(1000, chains.num_samples(0));
 }
 
+TEST_F(McmcChains, add_incrementally) {
+  std::stringstream out;
+  stan::io::stan_csv blocker1
+      = stan::io::stan_csv_reader::parse(blocker1_stream, &out);
+  stan::mcmc::chains<> expected(blocker1);
+
+  // draws added one at a time, to two chains in turn
+  stan::mcmc::chains<> chains(blocker1.header);
+  for (int i = 0; i < blocker1.samples.rows(); i++) {
+    chains.add(0, blocker1.samples.row(i));
+    chains.add(1, blocker1.samples.row(i));
+  }
+  ASSERT_EQ(2, chains.num_chains());
+  EXPECT_EQ(1000, chains.num_samples(0));
+  EXPECT_EQ(1000, chains.num_samples(1));
+  EXPECT_EQ(2000, chains.num_samples());
+  for (int j = 0; j < chains.num_params(); j++) {
+    Eigen::VectorXd x = chains.samples(1, j);
+    ASSERT_EQ(1000, x.size());
+    for (int i = 0; i < x.size(); i++)
+      EXPECT_EQ(blocker1.samples(i, j), x(i));
+  }
+  EXPECT_FLOAT_EQ(expected.mean(0, 3), chains.mean(1, 3));
+  EXPECT_EQ(2000, chains.samples(3).size());
+
+  chains.set_warmup(100);
+  EXPECT_EQ(900, chains.samples(0, 2).size());
+  EXPECT_EQ(blocker1.samples(100, 2), chains.samples(0, 2)(0));
+  EXPECT_EQ(1800, chains.num_kept_samples());
+}
+
+TEST_F(McmcChains, index) {
+  std::stringstream out;
+  stan::io::stan_csv blocker1
+      = stan::io::stan_csv_reader::parse(blocker1_stream, &out);
+  stan::mcmc::chains<> chains(blocker1.header);
+  for (int i = 0; i < chains.num_params(); i++)
+    EXPECT_EQ(i, chains.index(blocker1.header[i]));
+  EXPECT_EQ(-1, chains.index("not_a_parameter"));
+}
+
+TEST_F(McmcChains, add_selected) {
+  std::stringstream out;
+  stan::io::stan_csv blocker1
+      = stan::io::stan_csv_reader::parse(blocker1_stream, &out);
+  stan::mcmc::chains<> all(blocker1);
+
+  std::vector<std::string> names{"mu[2]", "lp__", "d"};
+  stan::mcmc::chains<> chains(names);
+  chains.add_selected(blocker1);
+  ASSERT_EQ(1, chains.num_chains());
+  EXPECT_EQ(1000, chains.num_samples(0));
+  for (const auto& name : names) {
+    Eigen::VectorXd expected = all.samples(0, name);
+    Eigen::VectorXd x = chains.samples(0, name);
+    ASSERT_EQ(expected.size(), x.size());
+    for (int i = 0; i < x.size(); i++)
+      EXPECT_EQ(expected(i), x(i)) << name;
+  }
+
+  stan::mcmc::chains<> missing(std::vector<std::string>{"not_a_parameter"});
+  EXPECT_THROW(missing.add_selected(blocker1), std::invalid_argument);
+}
+
 TEST_F(McmcChains, blocker1_num_chains) {
   std::stringstream out;
   stan::io::stan_csv blocker1
@@ -924,3 +988,29 @@ TEST_F(McmcChains, blocker_split_potential_scale_reduction_rank) {
               chains.split_potential_scale_reduction_rank(name));
   }
 }
+
+TEST_F(McmcChains, blocker_summary) {
+  std::stringstream out;
+  stan::io::stan_csv blocker1
+      = stan::io::stan_csv_reader::parse(blocker1_stream, &out);
+  stan::io::stan_csv blocker2
+      = stan::io::stan_csv_reader::parse(blocker2_stream, &out);
+  stan::mcmc::chains<> chains(blocker1);
+  chains.add(blocker2);
+
+  Eigen::VectorXd probs(2);
+  probs << 0.025, 0.975;
+  stan::analyze::draws_summary summary = chains.summary(probs);
+  ASSERT_EQ(chains.num_params(), summary.mean.size());
+  for (int j = 0; j < chains.num_params(); ++j) {
+    EXPECT_FLOAT_EQ(chains.mean(j), summary.mean(j));
+    EXPECT_FLOAT_EQ(chains.sd(j), summary.sd(j));
+    auto rhat = chains.split_potential_scale_reduction_rank(j);
+    if (std::isnan(rhat.first)) {
+      EXPECT_TRUE(std::isnan(summary.rhat_bulk(j)));
+    } else {
+      EXPECT_FLOAT_EQ(rhat.first, summary.rhat_bulk(j));
+      EXPECT_FLOAT_EQ(rhat.second, summary.rhat_tail(j));
+    }
+  }
+}
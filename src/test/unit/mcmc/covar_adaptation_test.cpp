@@ -27,3 +27,54 @@ TEST(McmcCovarAdaptation, learn_covariance) {
   }
   EXPECT_EQ(0, logger.call_count());
 }
+
+TEST(McmcCovarAdaptation, pool_covariance) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 3;
+  const int n_learn = 10;
+
+  stan::mcmc::covar_adaptation adapter1(n);
+  stan::mcmc::covar_adaptation adapter2(n);
+  stan::mcmc::covar_adaptation adapter_all(n);
+  adapter1.set_window_params(50, 0, 0, n_learn, logger);
+  adapter2.set_window_params(50, 0, 0, n_learn, logger);
+  adapter_all.set_window_params(50, 0, 0, 2 * n_learn, logger);
+  adapter1.set_defer_update(true);
+  adapter2.set_defer_update(true);
+
+  Eigen::MatrixXd covar1(Eigen::MatrixXd::Identity(n, n));
+  Eigen::MatrixXd covar2(Eigen::MatrixXd::Identity(n, n));
+  Eigen::MatrixXd covar_all(Eigen::MatrixXd::Zero(n, n));
+  Eigen::VectorXd q(n);
+  bool update1 = false;
+  bool update2 = false;
+  for (int i = 0; i < n_learn; ++i) {
+    q << i, i * i, std::sin(i);
+    update1 = adapter1.learn_covariance(covar1, q);
+    adapter_all.learn_covariance(covar_all, q);
+    q << 2 * i + 3, -i, std::cos(i);
+    update2 = adapter2.learn_covariance(covar2, q);
+    adapter_all.learn_covariance(covar_all, q);
+  }
+
+  EXPECT_FALSE(update1);
+  EXPECT_FALSE(update2);
+  EXPECT_TRUE(adapter1.update_pending());
+  EXPECT_TRUE(adapter2.update_pending());
+  EXPECT_TRUE(covar1.isIdentity());
+
+  std::vector<stan::mcmc::covar_adaptation*> adaptations{&adapter1,
+                                                         &adapter2};
+  Eigen::MatrixXd covar_pooled(Eigen::MatrixXd::Zero(n, n));
+  stan::mcmc::covar_adaptation::pool_covariance(adaptations, covar_pooled);
+
+  EXPECT_FALSE(adapter1.update_pending());
+  EXPECT_FALSE(adapter2.update_pending());
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      EXPECT_FLOAT_EQ(covar_all(i, j), covar_pooled(i, j));
+    }
+  }
+  EXPECT_EQ(0, logger.call_count());
+}
@@ -59,6 +59,43 @@ TEST(McmcDenseEMetric, sample_p) {
               < 5.0 * sqrt(var(1, 1) / n_samples));
 }
 
+TEST(McmcDenseEMetric, cached_factorization) {
+  Eigen::MatrixXd m(2, 2);
+  m << 3.0, -2.0, -2.0, 4.0;
+
+  stan::mcmc::mock_model model(2);
+  stan::mcmc::dense_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(model);
+  stan::mcmc::dense_e_point z(2);
+
+  EXPECT_TRUE(z.inv_e_metric_llt_.matrixL().toDenseMatrix().isIdentity());
+
+  z.set_metric(m);
+  Eigen::MatrixXd L = m.llt().matrixL();
+  EXPECT_TRUE(L.isApprox(z.inv_e_metric_llt_.matrixL().toDenseMatrix()));
+
+  // In-place updates only take effect once the factorization is refreshed
+  z.inv_e_metric_ = 2.0 * m;
+  EXPECT_TRUE(L.isApprox(z.inv_e_metric_llt_.matrixL().toDenseMatrix()));
+
+  z.update_metric_factorization();
+  Eigen::MatrixXd L2 = (2.0 * m).llt().matrixL();
+  EXPECT_TRUE(L2.isApprox(z.inv_e_metric_llt_.matrixL().toDenseMatrix()));
+
+  stan::rng_t rng_1 = stan::services::util::create_rng(0, 0);
+  stan::rng_t rng_2 = stan::services::util::create_rng(0, 0);
+  Eigen::VectorXd u(2);
+  for (int n = 0; n < 10; ++n) {
+    metric.sample_p(z, rng_1);
+    boost::variate_generator<stan::rng_t&, boost::normal_distribution<> >
+        rand_gaus(rng_2, boost::normal_distribution<>());
+    u(0) = rand_gaus();
+    u(1) = rand_gaus();
+    Eigen::VectorXd expected = (2.0 * m).llt().matrixU().solve(u);
+    EXPECT_FLOAT_EQ(expected(0), z.p(0));
+    EXPECT_FLOAT_EQ(expected(1), z.p(1));
+  }
+}
+
 TEST(McmcDenseEMetric, gradients) {
   Eigen::VectorXd q = Eigen::VectorXd::Ones(11);
 
@@ -0,0 +1,129 @@
+#include <test/test-models/good/mcmc/hmc/common/gauss3D.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/model/log_prob_grad.hpp>
+#include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/iterative_nuts/diag_e_iterative_nuts.hpp>
+#include <stan/mcmc/hmc/iterative_nuts/adapt_unit_e_iterative_nuts.hpp>
+#include <stan/mcmc/hmc/iterative_nuts/adapt_diag_e_iterative_nuts.hpp>
+#include <stan/mcmc/hmc/iterative_nuts/adapt_dense_e_iterative_nuts.hpp>
+#include <stan/mcmc/hmc/iterative_nuts/batch_transition.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+typedef gauss3D_model_namespace::gauss3D_model model_t;
+
+class McmcIterativeNutsBatch : public testing::Test {
+ public:
+  McmcIterativeNutsBatch()
+      : model(data_var_context),
+        logger(debug, info, warn, error, fatal) {}
+
+  stan::io::empty_var_context data_var_context;
+  model_t model;
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger;
+};
+
+TEST_F(McmcIterativeNutsBatch, instantiation) {
+  stan::rng_t base_rng = stan::services::util::create_rng(4839294, 0);
+
+  stan::mcmc::adapt_unit_e_iterative_nuts<model_t, stan::rng_t>
+      adapt_unit_e_sampler(model, base_rng);
+  stan::mcmc::adapt_diag_e_iterative_nuts<model_t, stan::rng_t>
+      adapt_diag_e_sampler(model, base_rng);
+  stan::mcmc::adapt_dense_e_iterative_nuts<model_t, stan::rng_t>
+      adapt_dense_e_sampler(model, base_rng);
+}
+
+TEST_F(McmcIterativeNutsBatch, matches_recursive_nuts) {
+  stan::rng_t rng_recursive = stan::services::util::create_rng(12345, 0);
+  stan::rng_t rng_iterative = stan::services::util::create_rng(12345, 0);
+
+  stan::mcmc::diag_e_nuts<model_t, stan::rng_t> recursive(model,
+                                                          rng_recursive);
+  stan::mcmc::diag_e_iterative_nuts<model_t, stan::rng_t> iterative(
+      model, rng_iterative);
+  recursive.set_nominal_stepsize(0.4);
+  iterative.set_nominal_stepsize(0.4);
+  recursive.set_stepsize_jitter(0.2);
+  iterative.set_stepsize_jitter(0.2);
+
+  Eigen::VectorXd q = Eigen::VectorXd::Ones(model.num_params_r());
+  stan::mcmc::sample s_recursive(q, 0, 0);
+  stan::mcmc::sample s_iterative(q, 0, 0);
+
+  for (int n = 0; n < 100; ++n) {
+    s_recursive = recursive.transition(s_recursive, logger);
+    s_iterative = iterative.transition(s_iterative, logger);
+    for (int i = 0; i < q.size(); ++i)
+      EXPECT_EQ(s_recursive.cont_params()(i), s_iterative.cont_params()(i));
+    EXPECT_EQ(recursive.depth_, iterative.depth_);
+    EXPECT_EQ(recursive.n_leapfrog_, iterative.n_leapfrog_);
+    EXPECT_EQ(s_recursive.accept_stat(), s_iterative.accept_stat());
+  }
+  EXPECT_EQ("", error.str());
+}
+
+TEST_F(McmcIterativeNutsBatch, batch_matches_sequential) {
+  typedef stan::mcmc::diag_e_iterative_nuts<model_t, stan::rng_t> sampler_t;
+  const int num_chains = 4;
+
+  std::vector<stan::rng_t> rngs_batch;
+  std::vector<stan::rng_t> rngs_sequential;
+  for (int n = 0; n < num_chains; ++n) {
+    rngs_batch.emplace_back(stan::services::util::create_rng(98765, n));
+    rngs_sequential.emplace_back(stan::services::util::create_rng(98765, n));
+  }
+
+  std::vector<sampler_t> batch;
+  std::vector<sampler_t> sequential;
+  batch.reserve(num_chains);
+  sequential.reserve(num_chains);
+  for (int n = 0; n < num_chains; ++n) {
+    batch.emplace_back(model, rngs_batch[n]);
+    sequential.emplace_back(model, rngs_sequential[n]);
+    batch[n].set_nominal_stepsize(0.4);
+    sequential[n].set_nominal_stepsize(0.4);
+  }
+
+  Eigen::VectorXd q = Eigen::VectorXd::Ones(model.num_params_r());
+  std::vector<stan::mcmc::sample> s_batch(num_chains,
+                                          stan::mcmc::sample(q, 0, 0));
+  std::vector<stan::mcmc::sample> s_sequential(s_batch);
+
+  int num_batch_calls = 0;
+  int max_batch_size = 0;
+  auto log_prob_grad = [&](const Eigen::MatrixXd& q_batch,
+                           Eigen::VectorXd& lp, Eigen::MatrixXd& grad) {
+    ++num_batch_calls;
+    max_batch_size
+        = std::max(max_batch_size, static_cast<int>(q_batch.cols()));
+    for (int j = 0; j < q_batch.cols(); ++j) {
+      Eigen::VectorXd q_j = q_batch.col(j);
+      Eigen::VectorXd grad_j;
+      lp(j) = stan::model::log_prob_grad<true, true>(model, q_j, grad_j);
+      grad.col(j) = grad_j;
+    }
+  };
+
+  int num_leapfrog = 0;
+  for (int m = 0; m < 50; ++m) {
+    stan::mcmc::iterative_nuts_batch_transition(batch, s_batch, log_prob_grad,
+                                                logger);
+    for (int n = 0; n < num_chains; ++n) {
+      s_sequential[n] = sequential[n].transition(s_sequential[n], logger);
+      num_leapfrog += sequential[n].n_leapfrog_;
+      EXPECT_EQ(sequential[n].n_leapfrog_, batch[n].n_leapfrog_);
+      for (int i = 0; i < q.size(); ++i)
+        EXPECT_FLOAT_EQ(s_sequential[n].cont_params()(i),
+                        s_batch[n].cont_params()(i));
+    }
+  }
+
+  EXPECT_EQ(num_chains, max_batch_size);
+  EXPECT_LT(num_batch_calls, num_leapfrog);
+  EXPECT_EQ("", error.str());
+}
@@ -372,6 +372,45 @@ TEST(McmcNutsBaseNuts, transition) {
   EXPECT_EQ("", fatal.str());
 }
 
+TEST(McmcNutsBaseNuts, transition_grow_max_depth) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  int model_size = 1;
+  double init_momentum = 1.5;
+
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q(0) = 0;
+  z_init.p(0) = init_momentum;
+
+  stan::mcmc::mock_model model(model_size);
+  stan::mcmc::mock_nuts sampler(model, base_rng);
+
+  sampler.set_max_depth(2);
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.sample_stepsize();
+  sampler.z() = z_init;
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+
+  stan::mcmc::sample s = sampler.transition(init_sample, logger);
+  EXPECT_EQ(2, sampler.depth_);
+  EXPECT_EQ(3, sampler.n_leapfrog_);
+
+  // Workspace is extended when the maximum depth grows between transitions
+  sampler.set_max_depth(6);
+  sampler.z() = z_init;
+  s = sampler.transition(init_sample, logger);
+  EXPECT_EQ(6, sampler.depth_);
+  EXPECT_EQ((2 << 5) - 1, sampler.n_leapfrog_);
+  EXPECT_FALSE(sampler.divergent_);
+  EXPECT_EQ(1, s.accept_stat());
+  EXPECT_EQ("", error.str());
+}
+
 TEST(McmcNutsBaseNuts, transition_egde_momenta) {
   stan::rng_t base_rng = stan::services::util::create_rng(42424253, 0);
 
@@ -25,3 +25,51 @@ TEST(McmcVarAdaptation, learn_variance) {
 
   EXPECT_EQ(0, logger.call_count());
 }
+
+TEST(McmcVarAdaptation, pool_variance) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 3;
+  const int n_learn = 10;
+
+  stan::mcmc::var_adaptation adapter1(n);
+  stan::mcmc::var_adaptation adapter2(n);
+  stan::mcmc::var_adaptation adapter_all(n);
+  adapter1.set_window_params(50, 0, 0, n_learn, logger);
+  adapter2.set_window_params(50, 0, 0, n_learn, logger);
+  adapter_all.set_window_params(50, 0, 0, 2 * n_learn, logger);
+  adapter1.set_defer_update(true);
+  adapter2.set_defer_update(true);
+
+  Eigen::VectorXd var1(Eigen::VectorXd::Ones(n));
+  Eigen::VectorXd var2(Eigen::VectorXd::Ones(n));
+  Eigen::VectorXd var_all(Eigen::VectorXd::Zero(n));
+  Eigen::VectorXd q(n);
+  bool update1 = false;
+  bool update2 = false;
+  for (int i = 0; i < n_learn; ++i) {
+    q << i, i * i, std::sin(i);
+    update1 = adapter1.learn_variance(var1, q);
+    adapter_all.learn_variance(var_all, q);
+    q << 2 * i + 3, -i, std::cos(i);
+    update2 = adapter2.learn_variance(var2, q);
+    adapter_all.learn_variance(var_all, q);
+  }
+
+  EXPECT_FALSE(update1);
+  EXPECT_FALSE(update2);
+  EXPECT_TRUE(adapter1.update_pending());
+  EXPECT_TRUE(adapter2.update_pending());
+  for (int i = 0; i < n; ++i)
+    EXPECT_EQ(1.0, var1(i));
+
+  std::vector<stan::mcmc::var_adaptation*> adaptations{&adapter1, &adapter2};
+  Eigen::VectorXd var_pooled(Eigen::VectorXd::Zero(n));
+  stan::mcmc::var_adaptation::pool_variance(adaptations, var_pooled);
+
+  EXPECT_FALSE(adapter1.update_pending());
+  EXPECT_FALSE(adapter2.update_pending());
+  for (int i = 0; i < n; ++i)
+    EXPECT_FLOAT_EQ(var_all(i), var_pooled(i));
+  EXPECT_EQ(0, logger.call_count());
+}
@@ -0,0 +1,102 @@
+#include <stan/mcmc/warmup_convergence_monitor.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <sstream>
+
+namespace {
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+}  // namespace
+
+TEST(McmcWarmupConvergenceMonitor, diag_metric) {
+  stan::mcmc::warmup_convergence_monitor monitor(0.1, 0.05);
+  EXPECT_TRUE(monitor.enabled());
+
+  Eigen::VectorXd inv_metric = Eigen::VectorXd::Ones(4);
+  EXPECT_FALSE(monitor.update(0.5, inv_metric));
+  EXPECT_TRUE(std::isnan(monitor.stepsize_change()));
+
+  // Step size has settled but the metric has not
+  inv_metric(0) = 2;
+  EXPECT_FALSE(monitor.update(0.52, inv_metric));
+  EXPECT_FLOAT_EQ(0.04, monitor.stepsize_change());
+  EXPECT_FLOAT_EQ(0.5, monitor.metric_change());
+
+  inv_metric(0) = 2.1;
+  EXPECT_TRUE(monitor.update(0.54, inv_metric));
+  EXPECT_TRUE(monitor.converged());
+  EXPECT_EQ(3, monitor.num_windows());
+  EXPECT_FLOAT_EQ(0.1 / std::sqrt(7.0), monitor.metric_change());
+}
+
+TEST(McmcWarmupConvergenceMonitor, dense_metric) {
+  stan::mcmc::warmup_convergence_monitor monitor(0.1, 0.05);
+
+  Eigen::MatrixXd inv_metric = Eigen::MatrixXd::Identity(3, 3);
+  EXPECT_FALSE(monitor.update(1.0, inv_metric));
+
+  inv_metric(0, 1) = inv_metric(1, 0) = 0.01;
+  EXPECT_TRUE(monitor.update(1.05, inv_metric));
+  EXPECT_FLOAT_EQ(std::sqrt(2e-4 / 3), monitor.metric_change());
+}
+
+TEST(McmcWarmupConvergenceMonitor, disabled) {
+  stan::mcmc::warmup_convergence_monitor monitor(0, 0);
+  EXPECT_FALSE(monitor.enabled());
+
+  Eigen::VectorXd inv_metric = Eigen::VectorXd::Ones(2);
+  for (int n = 0; n < 5; ++n)
+    EXPECT_FALSE(monitor.update(1.0, inv_metric));
+  EXPECT_EQ(0, monitor.metric_change());
+}
+
+namespace {
+std::string write_record(const stan::mcmc::warmup_convergence_monitor& monitor,
+                         unsigned int num_warmup_run,
+                         unsigned int num_warmup) {
+  std::stringstream ss;
+  std::unique_ptr<std::stringstream, deleter_noop> output(&ss);
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> writer(
+      std::move(output));
+  monitor.write(writer, num_warmup_run, num_warmup);
+  return ss.str();
+}
+}  // namespace
+
+TEST(McmcWarmupConvergenceMonitor, write) {
+  stan::mcmc::warmup_convergence_monitor monitor(0.1, 0.1);
+  Eigen::VectorXd inv_metric = Eigen::VectorXd::Ones(2);
+  monitor.update(1.0, inv_metric);
+  monitor.update(1.0, inv_metric);
+  ASSERT_TRUE(monitor.converged());
+
+  std::string record = write_record(monitor, 150, 1000);
+  EXPECT_NE(std::string::npos,
+            record.find("\"warmup_end_reason\" : \"converged\""));
+  EXPECT_NE(std::string::npos, record.find("\"num_warmup\" : 150"));
+  EXPECT_NE(std::string::npos, record.find("\"num_windows\" : 2"));
+
+  // Converged at the last window, so all of warmup was run
+  record = write_record(monitor, 1000, 1000);
+  EXPECT_NE(std::string::npos,
+            record.find("\"warmup_end_reason\" : \"num_warmup_reached\""));
+  EXPECT_NE(std::string::npos, record.find("\"num_warmup\" : 1000"));
+}
+
+TEST(McmcWarmupConvergenceMonitor, write_not_converged) {
+  stan::mcmc::warmup_convergence_monitor monitor(0.1, 0.1);
+  Eigen::VectorXd inv_metric = Eigen::VectorXd::Ones(2);
+  monitor.update(1.0, inv_metric);
+  inv_metric(0) = 2;
+  monitor.update(1.0, inv_metric);
+  ASSERT_FALSE(monitor.converged());
+
+  std::string record = write_record(monitor, 1000, 1000);
+  EXPECT_NE(std::string::npos,
+            record.find("\"warmup_end_reason\" : \"num_warmup_reached\""));
+}
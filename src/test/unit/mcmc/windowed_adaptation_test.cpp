@@ -46,3 +46,15 @@ TEST(McmcWindowedAdaptation, set_window_params3) {
   ASSERT_EQ(0, logger.call_count());
   ASSERT_EQ(0, logger.call_count_info());
 }
+
+TEST(McmcWindowedAdaptation, remaining_window_iterations) {
+  stan::test::unit::instrumented_logger logger;
+
+  stan::mcmc::windowed_adaptation adapter("test");
+  EXPECT_EQ(0, adapter.remaining_window_iterations());
+
+  adapter.set_window_params(1000, 75, 50, 25, logger);
+  EXPECT_EQ(75, adapter.get_init_buffer());
+  EXPECT_EQ(50, adapter.get_term_buffer());
+  EXPECT_EQ(100, adapter.remaining_window_iterations());
+}
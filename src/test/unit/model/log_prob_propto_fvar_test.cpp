@@ -0,0 +1,151 @@
+#define STAN_MODEL_LOG_PROB_PROPTO_FVAR
+#include <stan/model/log_prob_propto.hpp>
+#include <stan/model/model_base_crtp.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace test {
+// Mock model with a log density of a standard normal, recording the
+// scalar type it was evaluated with.
+class mock_normal_model
+    : public stan::model::model_base_crtp<mock_normal_model> {
+ public:
+  mock_normal_model() : model_base_crtp(1) {}
+
+  std::string model_name() const override { return "mock_normal_model"; }
+
+  std::vector<std::string> model_compile_info() const { return {}; }
+
+  void get_param_names(std::vector<std::string>& names, bool include_tparams,
+                       bool include_gqs) const override {}
+  void get_dims(std::vector<std::vector<size_t>>& dimss, bool include_tparams,
+                bool include_gqs) const override {}
+
+  void constrained_param_names(std::vector<std::string>& param_names,
+                               bool include_tparams,
+                               bool include_gqs) const override {}
+
+  void unconstrained_param_names(std::vector<std::string>& param_names,
+                                 bool include_tparams,
+                                 bool include_gqs) const override {}
+
+  template <bool propto__, bool jacobian__, typename T__>
+  T__ log_prob(Eigen::Matrix<T__, -1, 1>& params_r__,
+               std::ostream* pstream__ = 0) const {
+    is_fvar = stan::math::is_fvar<T__>::value;
+    is_var = stan::math::is_var<T__>::value;
+    if (params_r__(0) > 10)
+      throw std::domain_error("too large");
+    T__ lp(0.0);
+    if (stan::math::include_summand<propto__>::value)
+      lp -= 0.918938533204672741780329736406;
+    if (stan::math::include_summand<propto__, T__>::value)
+      lp -= 0.5 * params_r__(0) * params_r__(0);
+    if (jacobian__)
+      lp += params_r__(0);
+    return lp;
+  }
+
+  template <bool propto__, bool jacobian__, typename T__>
+  T__ log_prob(std::vector<T__>& params_r__, std::vector<int>& params_i__,
+               std::ostream* pstream__ = 0) const {
+    Eigen::Matrix<T__, -1, 1> params_r_vec__(params_r__.size());
+    for (size_t i = 0; i < params_r__.size(); ++i)
+      params_r_vec__(i) = params_r__[i];
+    return log_prob<propto__, jacobian__>(params_r_vec__, pstream__);
+  }
+
+  void transform_inits(const stan::io::var_context& context,
+                       Eigen::VectorXd& params_r,
+                       std::ostream* msgs) const override {}
+
+  void transform_inits(const stan::io::var_context& context,
+                       std::vector<int>& params_i,
+                       std::vector<double>& params_r,
+                       std::ostream* msgs) const override {}
+
+  template <typename RNG>
+  void write_array(RNG& base_rng, Eigen::VectorXd& params_r,
+                   Eigen::VectorXd& params_constrained_r, bool include_tparams,
+                   bool include_gqs, std::ostream* msgs) const {}
+
+  template <typename RNG>
+  void write_array(RNG& base_rng, std::vector<double>& params_r,
+                   std::vector<int>& params_i,
+                   std::vector<double>& params_r_constrained,
+                   bool include_tparams, bool include_gqs,
+                   std::ostream* msgs) const {}
+
+  void unconstrain_array(const Eigen::VectorXd& params_constrained_r,
+                         Eigen::VectorXd& params_r,
+                         std::ostream* msgs = nullptr) const override {}
+  void unconstrain_array(const std::vector<double>& params_constrained_r,
+                         std::vector<double>& params_r,
+                         std::ostream* msgs = nullptr) const override {}
+
+  mutable bool is_fvar = false;
+  mutable bool is_var = false;
+};
+}  // namespace test
+
+TEST(ModelUtil, log_prob_propto_fvar) {
+  test::mock_normal_model model;
+  std::vector<double> params_r{1.5};
+  std::vector<int> params_i;
+
+  double lp = stan::model::log_prob_propto<false>(model, params_r, params_i);
+  EXPECT_FLOAT_EQ(-0.5 * 1.5 * 1.5, lp);
+  EXPECT_TRUE(model.is_fvar);
+  EXPECT_FALSE(model.is_var);
+  EXPECT_EQ(0, stan::math::ChainableStack::instance_->var_stack_.size());
+
+  lp = stan::model::log_prob_propto<true>(model, params_r, params_i);
+  EXPECT_FLOAT_EQ(-0.5 * 1.5 * 1.5 + 1.5, lp);
+
+  Eigen::VectorXd params_r_vec(1);
+  params_r_vec << -2;
+  lp = stan::model::log_prob_propto<true>(model, params_r_vec);
+  EXPECT_FLOAT_EQ(-0.5 * 2 * 2 - 2, lp);
+  EXPECT_TRUE(model.is_fvar);
+  EXPECT_EQ(0, stan::math::ChainableStack::instance_->var_stack_.size());
+}
+
+TEST(ModelUtil, log_prob_propto_fvar_model_base) {
+  // services instantiate the helpers with model_base, which dispatches
+  // to the fvar<double> virtuals
+  test::mock_normal_model model;
+  const stan::model::model_base& base_model = model;
+  std::vector<double> params_r{1.5};
+  std::vector<int> params_i;
+
+  double lp
+      = stan::model::log_prob_propto<false>(base_model, params_r, params_i);
+  EXPECT_FLOAT_EQ(-0.5 * 1.5 * 1.5, lp);
+  EXPECT_TRUE(model.is_fvar);
+  EXPECT_FALSE(model.is_var);
+
+  Eigen::VectorXd params_r_vec(1);
+  params_r_vec << -2;
+  lp = stan::model::log_prob_propto<true>(base_model, params_r_vec);
+  EXPECT_FLOAT_EQ(-0.5 * 2 * 2 - 2, lp);
+  EXPECT_TRUE(model.is_fvar);
+  EXPECT_EQ(0, stan::math::ChainableStack::instance_->var_stack_.size());
+}
+
+TEST(ModelUtil, log_prob_propto_fvar_throws) {
+  test::mock_normal_model model;
+  const stan::model::model_base& base_model = model;
+  std::vector<double> params_r{11};
+  std::vector<int> params_i;
+  EXPECT_THROW(stan::model::log_prob_propto<true>(model, params_r, params_i),
+               std::domain_error);
+  EXPECT_THROW(
+      stan::model::log_prob_propto<true>(base_model, params_r, params_i),
+      std::domain_error);
+  Eigen::VectorXd params_r_vec(1);
+  params_r_vec << 11;
+  EXPECT_THROW(stan::model::log_prob_propto<true>(model, params_r_vec),
+               std::domain_error);
+}
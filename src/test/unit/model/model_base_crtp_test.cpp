@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <stan/model/model_base.hpp>
 #include <stan/model/model_base_crtp.hpp>
+#include <stan/io/array_var_context.hpp>
 #include <ostream>
 #include <stdexcept>
 #include <string>
@@ -155,3 +156,14 @@ TEST(model, modelTemplateLogProb) {
   double v8 = bm.template log_prob<true, true>(params_r_v, msgs).val();
   EXPECT_FLOAT_EQ(8, v8);
 }
+
+TEST(model, modelUpdateDataDefault) {
+  mock_model m(17);
+  stan::model::model_base& bm = m;
+  std::stringstream ss;
+  std::vector<std::string> names;
+  std::vector<double> values;
+  std::vector<std::vector<size_t>> dims;
+  stan::io::array_var_context delta(names, values, dims);
+  EXPECT_EQ(nullptr, bm.update_data(delta, 0, &ss));
+}
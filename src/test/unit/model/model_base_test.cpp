@@ -175,6 +175,33 @@ struct mock_model : public stan::model::model_base {
     return 21;
   }
 #endif
+
+#ifdef STAN_MODEL_LOG_PROB_PROPTO_FVAR
+
+  stan::math::fvar<double> log_prob(
+      Eigen::Matrix<stan::math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const override {
+    return 22;
+  }
+
+  stan::math::fvar<double> log_prob_jacobian(
+      Eigen::Matrix<stan::math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const override {
+    return 23;
+  }
+
+  stan::math::fvar<double> log_prob_propto(
+      Eigen::Matrix<stan::math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const override {
+    return 24;
+  }
+
+  stan::math::fvar<double> log_prob_propto_jacobian(
+      Eigen::Matrix<stan::math::fvar<double>, -1, 1>& params_r,
+      std::ostream* msgs) const override {
+    return 25;
+  }
+#endif
 };
 
 TEST(model, modelBaseInheritance) {
@@ -243,4 +270,19 @@ TEST(model, modelTemplateLogProb) {
   double v12 = bm.template log_prob<true, true>(params_r_fv, msgs).val().val();
   EXPECT_FLOAT_EQ(21, v12);
 #endif
+
+#ifdef STAN_MODEL_LOG_PROB_PROPTO_FVAR
+  Eigen::Matrix<stan::math::fvar<double>, -1, 1> params_r_fd(3);
+  double v13 = bm.template log_prob<false, false>(params_r_fd, msgs).val();
+  EXPECT_FLOAT_EQ(22, v13);
+
+  double v14 = bm.template log_prob<false, true>(params_r_fd, msgs).val();
+  EXPECT_FLOAT_EQ(23, v14);
+
+  double v15 = bm.template log_prob<true, false>(params_r_fd, msgs).val();
+  EXPECT_FLOAT_EQ(24, v15);
+
+  double v16 = bm.template log_prob<true, true>(params_r_fd, msgs).val();
+  EXPECT_FLOAT_EQ(25, v16);
+#endif
 }
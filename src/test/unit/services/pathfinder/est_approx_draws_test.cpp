@@ -0,0 +1,96 @@
+#include <stan/services/pathfinder/single.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <tbb/task_arena.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class ServicesPathfinderEstApproxDraws : public testing::Test {
+ public:
+  ServicesPathfinderEstApproxDraws() : num_calls(0) {
+    taylor_approx.x_center = Eigen::VectorXd::Zero(num_params);
+    taylor_approx.logdetcholHk = 0;
+    taylor_approx.L_approx = Eigen::MatrixXd::Identity(num_params, num_params);
+    taylor_approx.alpha = Eigen::VectorXd::Ones(num_params);
+    taylor_approx.use_full = true;
+  }
+
+  // Estimate the draws with a standard normal log density, which fails
+  // for large first coordinates and prints for small second ones.
+  stan::services::pathfinder::internal::elbo_est_t estimate(
+      int num_threads, stan::test::unit::instrumented_logger& logger) {
+    auto lp_fun = [this](auto&& u, auto&& msgs) {
+      ++num_calls;
+      if (u(0) > 1.5)
+        throw std::domain_error("too large");
+      if (u(1) < -1)
+        msgs << "small " << u(1);
+      return -0.5 * u.squaredNorm();
+    };
+    auto constrain_fun = [](auto&& rng, auto&& unconstrained_draws,
+                            auto&& constrained_draws) {
+      constrained_draws = unconstrained_draws;
+      return constrained_draws;
+    };
+    stan::rng_t rng(123);
+    tbb::task_arena arena(num_threads);
+    return arena.execute([&]() {
+      return stan::services::pathfinder::internal::est_approx_draws(
+          lp_fun, constrain_fun, rng, taylor_approx, num_samples,
+          taylor_approx.alpha, "Iter: [1] ", logger);
+    });
+  }
+
+  const int num_params = 3;
+  const size_t num_samples = 200;
+  std::atomic<size_t> num_calls;
+  stan::services::pathfinder::internal::taylor_approx_t taylor_approx;
+};
+
+TEST_F(ServicesPathfinderEstApproxDraws, parallel_matches_serial) {
+  stan::test::unit::instrumented_logger serial_logger;
+  auto serial = estimate(1, serial_logger);
+  EXPECT_EQ(num_samples, num_calls);
+  EXPECT_EQ(num_samples, serial.fn_calls);
+
+  stan::test::unit::instrumented_logger parallel_logger;
+  auto parallel = estimate(4, parallel_logger);
+  EXPECT_EQ(2 * num_samples, num_calls);
+  EXPECT_EQ(num_samples, parallel.fn_calls);
+
+  EXPECT_EQ(serial.elbo, parallel.elbo);
+  EXPECT_TRUE(serial.repeat_draws == parallel.repeat_draws);
+  EXPECT_TRUE((serial.lp_mat == parallel.lp_mat).all());
+  EXPECT_TRUE((serial.lp_ratio == parallel.lp_ratio).all());
+
+  ASSERT_LT(0, serial_logger.call_count_info());
+  std::stringstream serial_info;
+  serial_logger.print_info(serial_info);
+  std::stringstream parallel_info;
+  parallel_logger.print_info(parallel_info);
+  EXPECT_EQ(serial_info.str(), parallel_info.str());
+  EXPECT_EQ(serial_logger.call_count_info(), serial_logger.find_info("small"));
+  EXPECT_EQ(serial_logger.call_count_info(),
+            serial_logger.find_info("Iter: [1] small"));
+}
+
+TEST_F(ServicesPathfinderEstApproxDraws, domain_error) {
+  stan::test::unit::instrumented_logger logger;
+  auto est = estimate(4, logger);
+  int num_failed = 0;
+  for (Eigen::Index i = 0; i < est.repeat_draws.cols(); ++i) {
+    if (est.repeat_draws(0, i) > 1.5) {
+      ++num_failed;
+      EXPECT_EQ(-std::numeric_limits<double>::infinity(), est.lp_mat(i, 1));
+    } else {
+      EXPECT_FLOAT_EQ(-0.5 * est.repeat_draws.col(i).squaredNorm(),
+                      est.lp_mat(i, 1));
+    }
+  }
+  EXPECT_LT(0, num_failed);
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), est.elbo);
+}
@@ -0,0 +1,149 @@
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/json/json_data.hpp>
+#include <stan/services/pathfinder/multi.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <test/test-models/good/services/normal_glm.hpp>
+#include <test/unit/services/pathfinder/util.hpp>
+#include <test/unit/util.hpp>
+#include <tbb/task_arena.h>
+#include <gtest/gtest.h>
+
+// The draws are compared across thread counts, so allow up to 4 threads
+auto&& threadpool_init = stan::math::init_threadpool_tbb(4);
+
+auto init_context() {
+  std::fstream stream(
+      "./src/test/unit/services/pathfinder/"
+      "normal_glm_test.json",
+      std::fstream::in);
+  return stan::json::json_data(stream);
+}
+
+stan::io::array_var_context init_init_context() {
+  std::vector<std::string> names_r{"b", "Intercept", "sigma"};
+  std::vector<double> values_r{0, 0, 0, 0, 0, 0, 1};
+  using size_vec = std::vector<size_t>;
+  std::vector<size_vec> dims_r{size_vec{5}, size_vec{}, size_vec{}};
+  return stan::io::array_var_context(names_r, values_r, dims_r);
+}
+
+class ServicesPathfinderGLMParallel : public testing::Test {
+ public:
+  ServicesPathfinderGLMParallel()
+      : context(init_context()), model(context, 0, &model_ss) {}
+
+  /**
+   * Run multi-path pathfinder with the specified number of threads and
+   * return the resampled draws, one per column.
+   */
+  Eigen::MatrixXd multi(bool stream_draws, int num_threads) {
+    constexpr unsigned int seed = 0;
+    constexpr unsigned int chain = 1;
+    constexpr double init_radius = 1;
+    constexpr double num_multi_draws = 100;
+    constexpr int num_paths = 4;
+    constexpr double num_elbo_draws = 1000;
+    constexpr double num_draws = 2000;
+    constexpr int history_size = 15;
+    constexpr double init_alpha = 1;
+    constexpr double tol_obj = 0;
+    constexpr double tol_rel_obj = 0;
+    constexpr double tol_grad = 0;
+    constexpr double tol_rel_grad = 0;
+    constexpr double tol_param = 0;
+    constexpr int num_iterations = 220;
+    constexpr bool save_iterations = false;
+    constexpr int refresh = 0;
+    constexpr bool calculate_lp = true;
+    constexpr bool resample = true;
+    constexpr int elbo_stride = 1;
+
+    std::unique_ptr<std::ostream> empty_ostream(nullptr);
+    stan::test::test_logger logger(std::move(empty_ostream));
+    std::stringstream init_ss, parameter_ss;
+    stan::callbacks::stream_writer init(init_ss);
+    stan::test::in_memory_writer parameter(parameter_ss);
+    stan::callbacks::json_writer<std::stringstream> diagnostics;
+    std::vector<std::stringstream> single_path_parameter_ss(num_paths);
+    std::vector<stan::test::in_memory_writer> single_path_parameter_writer;
+    for (int i = 0; i < num_paths; ++i) {
+      single_path_parameter_writer.emplace_back(single_path_parameter_ss[i]);
+    }
+    std::vector<stan::callbacks::json_writer<std::stringstream>>
+        single_path_diagnostic_writer(num_paths);
+    std::vector<std::unique_ptr<decltype(init_init_context())>>
+        single_path_inits;
+    for (int i = 0; i < num_paths; ++i) {
+      single_path_inits.emplace_back(
+          std::make_unique<decltype(init_init_context())>(
+              init_init_context()));
+    }
+    stan::test::mock_callback callback;
+    tbb::task_arena arena(num_threads);
+    int rc = arena.execute([&]() {
+      return stan::services::pathfinder::pathfinder_lbfgs_multi(
+          model, single_path_inits, seed, chain, init_radius, history_size,
+          init_alpha, tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param,
+          num_iterations, num_elbo_draws, num_draws, num_multi_draws,
+          num_paths, save_iterations, refresh, callback, logger,
+          std::vector<stan::callbacks::stream_writer>(num_paths, init),
+          single_path_parameter_writer, single_path_diagnostic_writer,
+          parameter, diagnostics, calculate_lp, resample, elbo_stride,
+          stream_draws);
+    });
+    EXPECT_EQ(0, rc);
+    for (auto&& single_path_parameter : single_path_parameter_writer) {
+      if (stream_draws) {
+        EXPECT_EQ(0, single_path_parameter.values_.size())
+            << "single path draws are not constrained";
+      } else {
+        EXPECT_EQ(num_draws, single_path_parameter.values_.cols());
+      }
+    }
+    EXPECT_EQ(num_multi_draws, parameter.eigen_states_.size());
+    if (parameter.eigen_states_.empty()) {
+      return Eigen::MatrixXd(0, 0);
+    }
+    Eigen::MatrixXd param_vals(parameter.eigen_states_[0].size(),
+                               parameter.eigen_states_.size());
+    for (size_t i = 0; i < parameter.eigen_states_.size(); ++i) {
+      param_vals.col(i) = parameter.eigen_states_[i];
+    }
+    return param_vals;
+  }
+
+  std::stringstream model_ss;
+  stan::json::json_data context;
+  stan_model model;
+};
+
+TEST_F(ServicesPathfinderGLMParallel, multi_stream_draws) {
+  Eigen::MatrixXd serial = multi(true, 1);
+  Eigen::MatrixXd parallel = multi(true, 4);
+  ASSERT_EQ(100, serial.cols());
+  ASSERT_EQ(serial.rows(), parallel.rows());
+  ASSERT_EQ(serial.cols(), parallel.cols());
+  EXPECT_TRUE((serial.array() == parallel.array()).all())
+      << "streamed draws depend on the number of threads";
+
+  // The same draws are resampled, and normal_glm has no random generated
+  // quantities, so all the columns match the draws constrained by the
+  // individual pathfinders
+  Eigen::MatrixXd expected = multi(false, 4);
+  ASSERT_EQ(expected.rows(), serial.rows());
+  ASSERT_EQ(expected.cols(), serial.cols());
+  for (Eigen::Index j = 0; j < expected.cols(); ++j) {
+    for (Eigen::Index i = 0; i < expected.rows(); ++i) {
+      EXPECT_FLOAT_EQ(expected(i, j), serial(i, j)) << i << ", " << j;
+    }
+  }
+
+  Eigen::VectorXd mean_vals = serial.rowwise().mean();
+  Eigen::VectorXd prev_mean_vals
+      = stan::test::normal_glm_param_summary().first;
+  ASSERT_EQ(prev_mean_vals.size(), mean_vals.size());
+  for (int i = 2; i < mean_vals.size(); ++i) {
+    EXPECT_NEAR(prev_mean_vals(i), mean_vals(i), .01);
+  }
+}
@@ -11,6 +11,9 @@
 #include <test/unit/services/util.hpp>
 #include <test/unit/util.hpp>
 #include <gtest/gtest.h>
+#include <limits>
+#include <map>
+#include <regex>
 
 // Locally tests can use threads but for jenkins we should just use 1 thread
 #ifdef LOCAL_THREADS_TEST
@@ -179,6 +182,201 @@ TEST_F(ServicesPathfinderGLM, single_noreturnlp) {
   }
 }
 
+TEST_F(ServicesPathfinderGLM, single_elbo_stride) {
+  constexpr unsigned int seed = 3;
+  constexpr unsigned int chain = 1;
+  constexpr double init_radius = 2;
+  constexpr double num_elbo_draws = 80;
+  constexpr double num_draws = 500;
+  constexpr int history_size = 35;
+  constexpr double init_alpha = 1;
+  constexpr double tol_obj = 0;
+  constexpr double tol_rel_obj = 0;
+  constexpr double tol_grad = 0;
+  constexpr double tol_rel_grad = 0;
+  constexpr double tol_param = 0;
+  constexpr int num_iterations = 400;
+  constexpr bool save_iterations = true;
+  constexpr int refresh = 1;
+  constexpr bool calculate_lp = true;
+  constexpr int elbo_stride = 4;
+
+  stan::test::mock_callback callback;
+  stan::io::array_var_context init_context = init_init_context();
+  stan::test::unit::instrumented_logger logger;
+
+  int rc = stan::services::pathfinder::pathfinder_lbfgs_single(
+      model, init_context, seed, chain, init_radius, history_size, init_alpha,
+      tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param, num_iterations,
+      num_elbo_draws, num_draws, save_iterations, refresh, callback, logger,
+      init, parameter, diagnostics, calculate_lp, elbo_stride);
+  ASSERT_EQ(rc, 0);
+
+  Eigen::MatrixXd param_vals = std::move(parameter.values_);
+  EXPECT_EQ(num_draws, param_vals.cols());
+  Eigen::VectorXd mean_vals = param_vals.rowwise().mean().eval();
+  Eigen::VectorXd prev_mean_vals
+      = stan::test::normal_glm_param_summary().first;
+  for (int i = 2; i < mean_vals.size(); ++i) {
+    EXPECT_NEAR(prev_mean_vals(i), mean_vals(i), .1);
+  }
+  auto json = diagnostic_ss.str();
+  ASSERT_TRUE(stan::test::is_valid_JSON(json));
+  EXPECT_NE(std::string::npos, json.find("elbo_skipped"));
+}
+
+TEST_F(ServicesPathfinderGLM, single_elbo_stride_deferred_best) {
+  constexpr unsigned int seed = 3;
+  constexpr unsigned int chain = 1;
+  constexpr double init_radius = 2;
+  constexpr double num_elbo_draws = 80;
+  constexpr double num_draws = 500;
+  constexpr int history_size = 35;
+  constexpr double init_alpha = 1;
+  constexpr double tol_obj = 0;
+  constexpr double tol_rel_obj = 0;
+  constexpr double tol_grad = 0;
+  constexpr double tol_rel_grad = 0;
+  constexpr double tol_param = 0;
+  constexpr int num_iterations = 400;
+  constexpr bool save_iterations = true;
+  constexpr int refresh = 1;
+  constexpr bool calculate_lp = true;
+  // Only the last iteration can be estimated during LBFGS, so the others
+  // are all deferred
+  constexpr int elbo_stride = 1000;
+
+  stan::test::mock_callback callback;
+  stan::io::array_var_context init_context = init_init_context();
+  stan::test::unit::instrumented_logger logger;
+
+  int rc = stan::services::pathfinder::pathfinder_lbfgs_single(
+      model, init_context, seed, chain, init_radius, history_size, init_alpha,
+      tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param, num_iterations,
+      num_elbo_draws, num_draws, save_iterations, refresh, callback, logger,
+      init, parameter, diagnostics, calculate_lp, elbo_stride);
+  ASSERT_EQ(rc, 0);
+
+  std::stringstream log;
+  logger.print_info(log);
+  const std::regex deferred_re("^Path \\[1\\] :Iter: \\[(\\d+)\\] "
+                               "ELBO \\(([^)]*)\\)$");
+  const std::regex best_re("Best Iter: \\[(\\d+)\\] ELBO \\(([^)]*)\\)");
+  std::map<int, double> deferred_elbos;
+  int best_iter = -1;
+  double best_elbo = std::numeric_limits<double>::quiet_NaN();
+  std::string line;
+  while (std::getline(log, line)) {
+    std::smatch match;
+    if (std::regex_search(line, match, deferred_re)) {
+      deferred_elbos[std::stoi(match[1])] = std::stod(match[2]);
+    } else if (std::regex_search(line, match, best_re)) {
+      best_iter = std::stoi(match[1]);
+      best_elbo = std::stod(match[2]);
+    }
+  }
+  ASSERT_LT(1, deferred_elbos.size());
+  ASSERT_EQ(1, deferred_elbos.count(best_iter))
+      << "best iteration " << best_iter << " was not deferred";
+  for (auto&& deferred : deferred_elbos) {
+    EXPECT_LE(deferred.second, best_elbo) << deferred.first;
+  }
+
+  auto json = diagnostic_ss.str();
+  ASSERT_TRUE(stan::test::is_valid_JSON(json));
+  for (auto&& deferred : deferred_elbos) {
+    auto record = json.find("\"elbo_" + std::to_string(deferred.first) + "\"");
+    ASSERT_NE(std::string::npos, record) << deferred.first;
+    auto record_end = json.find('}', record);
+    for (auto&& field : {"\"elbo_deferred\"", "\"x_center\"",
+                         "\"logDetCholHk\"", "\"L_approx\"", "\"Qk\"",
+                         "\"alpha\"", "\"full\""}) {
+      EXPECT_LT(json.find(field, record), record_end)
+          << deferred.first << " " << field;
+    }
+  }
+}
+
+TEST_F(ServicesPathfinderGLM, single_elbo_stride_invalid) {
+  constexpr unsigned int seed = 3;
+  constexpr unsigned int chain = 1;
+  constexpr double init_radius = 2;
+  constexpr double num_elbo_draws = 80;
+  constexpr double num_draws = 500;
+  constexpr int history_size = 35;
+  constexpr double init_alpha = 1;
+  constexpr double tol_obj = 0;
+  constexpr double tol_rel_obj = 0;
+  constexpr double tol_grad = 0;
+  constexpr double tol_rel_grad = 0;
+  constexpr double tol_param = 0;
+  constexpr int num_iterations = 400;
+  constexpr bool save_iterations = true;
+  constexpr int refresh = 1;
+  constexpr bool calculate_lp = true;
+
+  stan::test::mock_callback callback;
+  stan::io::array_var_context init_context = init_init_context();
+  for (int elbo_stride : {0, -1}) {
+    stan::test::unit::instrumented_logger logger;
+    int rc = stan::services::pathfinder::pathfinder_lbfgs_single(
+        model, init_context, seed, chain, init_radius, history_size,
+        init_alpha, tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param,
+        num_iterations, num_elbo_draws, num_draws, save_iterations, refresh,
+        callback, logger, init, parameter, diagnostics, calculate_lp,
+        elbo_stride);
+    EXPECT_EQ(stan::services::error_codes::CONFIG, rc);
+    EXPECT_EQ(1, logger.find_error("elbo_stride must be positive"));
+    EXPECT_EQ(0, parameter.values_.size());
+  }
+}
+
+TEST_F(ServicesPathfinderGLM, multi_elbo_stride_invalid) {
+  constexpr unsigned int seed = 0;
+  constexpr unsigned int chain = 1;
+  constexpr double init_radius = 1;
+  constexpr double num_multi_draws = 100;
+  constexpr int num_paths = 4;
+  constexpr double num_elbo_draws = 1000;
+  constexpr double num_draws = 2000;
+  constexpr int history_size = 15;
+  constexpr double init_alpha = 1;
+  constexpr double tol_obj = 0;
+  constexpr double tol_rel_obj = 0;
+  constexpr double tol_grad = 0;
+  constexpr double tol_rel_grad = 0;
+  constexpr double tol_param = 0;
+  constexpr int num_iterations = 220;
+  constexpr bool save_iterations = false;
+  constexpr int refresh = 0;
+  constexpr bool calculate_lp = true;
+  constexpr bool resample = true;
+  constexpr int elbo_stride = 0;
+
+  stan::test::unit::instrumented_logger logger;
+  std::vector<stan::callbacks::writer> single_path_parameter_writer(num_paths);
+  std::vector<stan::callbacks::json_writer<std::stringstream>>
+      single_path_diagnostic_writer(num_paths);
+  std::vector<std::unique_ptr<decltype(init_init_context())>> single_path_inits;
+  for (int i = 0; i < num_paths; ++i) {
+    single_path_inits.emplace_back(
+        std::make_unique<decltype(init_init_context())>(init_init_context()));
+  }
+  stan::test::mock_callback callback;
+  int rc = stan::services::pathfinder::pathfinder_lbfgs_multi(
+      model, single_path_inits, seed, chain, init_radius, history_size,
+      init_alpha, tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param,
+      num_iterations, num_elbo_draws, num_draws, num_multi_draws, num_paths,
+      save_iterations, refresh, callback, logger,
+      std::vector<stan::callbacks::stream_writer>(num_paths, init),
+      single_path_parameter_writer, single_path_diagnostic_writer, parameter,
+      diagnostics, calculate_lp, resample, elbo_stride);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, rc);
+  EXPECT_EQ(1, logger.call_count_error());
+  EXPECT_EQ(1, logger.find_error("elbo_stride must be positive"));
+  EXPECT_EQ(0, parameter.eigen_states_.size());
+}
+
 TEST_F(ServicesPathfinderGLM, multi) {
   constexpr unsigned int seed = 0;
   constexpr unsigned int chain = 1;
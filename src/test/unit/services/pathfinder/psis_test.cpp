@@ -1,6 +1,11 @@
 #include <stan/services/pathfinder/psis.hpp>
 #include <test/unit/services/pathfinder/util.hpp>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
 
 // Locally tests can use threads but for jenkins we should just use 1 thread
 #ifdef LOCAL_THREADS_TEST
@@ -182,3 +187,72 @@ TEST(ServicesPSIS, max_n_elements) {
     EXPECT_EQ(sorted_idx(i), sorted_result_pos(i));
   }
 }
+
+TEST(ServicesPSIS, max_n_elements_unsorted) {
+  Eigen::Array<double, -1, 1> unsorted(200);
+  for (Eigen::Index i = 0; i < unsorted.size(); ++i) {
+    // includes ties
+    unsorted(i) = std::round(10 * std::sin(1.7 * i));
+  }
+  unsorted(3) = std::numeric_limits<double>::quiet_NaN();
+  std::vector<Eigen::Index> idx(unsorted.size());
+  std::iota(idx.begin(), idx.end(), 0);
+  const double neg_inf = -std::numeric_limits<double>::infinity();
+  std::sort(idx.begin(), idx.end(), [&](auto i, auto j) {
+    double x_i = std::isnan(unsorted(i)) ? neg_inf : unsorted(i);
+    double x_j = std::isnan(unsorted(j)) ? neg_inf : unsorted(j);
+    return x_i < x_j || (x_i == x_j && i < j);
+  });
+  for (Eigen::Index top_size : {1, 15, 200, 300}) {
+    auto sorted_tuple
+        = stan::services::psis::internal::largest_n_elements(unsorted,
+                                                             top_size);
+    const Eigen::Index size = std::min(top_size, unsorted.size());
+    ASSERT_EQ(size, sorted_tuple.first.size());
+    ASSERT_EQ(size, sorted_tuple.second.size());
+    for (Eigen::Index i = 0; i < size; ++i) {
+      Eigen::Index expected_idx = idx[unsorted.size() - size + i];
+      EXPECT_EQ(expected_idx, sorted_tuple.second(i));
+      if (expected_idx != 3) {
+        EXPECT_EQ(unsorted(expected_idx), sorted_tuple.first(i));
+      }
+    }
+  }
+}
+
+TEST(ServicesPSIS, tail_length) {
+  EXPECT_EQ(20, stan::services::psis::tail_length(100));
+  EXPECT_EQ(3000, stan::services::psis::tail_length(1000000));
+  EXPECT_EQ(0, stan::services::psis::tail_length(1));
+}
+
+TEST(ServicesPSIS, analyze) {
+  Eigen::Array<double, -1, 1> log_ratios(1000);
+  for (Eigen::Index i = 0; i < log_ratios.size(); ++i) {
+    log_ratios(i) = 2 * std::sin(0.37 * i) + std::cos(2.3 * i);
+  }
+  stan::test::test_logger logger;
+  auto result = stan::services::psis::analyze(log_ratios, logger);
+  EXPECT_EQ(stan::services::psis::tail_length(1000), result.tail_len);
+  EXPECT_TRUE(std::isfinite(result.pareto_k));
+  EXPECT_FLOAT_EQ(0, result.log_weights.maxCoeff());
+  Eigen::Array<double, -1, 1> weights = stan::services::psis::psis_weights(
+      log_ratios, result.tail_len, logger);
+  for (Eigen::Index i = 0; i < weights.size(); ++i) {
+    EXPECT_FLOAT_EQ(weights(i), std::exp(result.log_weights(i)));
+  }
+
+  auto short_tail = stan::services::psis::analyze(log_ratios, 4, logger);
+  EXPECT_EQ(0, short_tail.tail_len);
+  EXPECT_TRUE(std::isnan(short_tail.pareto_k));
+  for (Eigen::Index i = 0; i < log_ratios.size(); ++i) {
+    EXPECT_FLOAT_EQ(log_ratios(i) - log_ratios.maxCoeff(),
+                    short_tail.log_weights(i));
+  }
+
+  Eigen::Array<double, -1, 1> flat = Eigen::Array<double, -1, 1>::Ones(100);
+  auto flat_tail = stan::services::psis::analyze(flat, 20, logger);
+  EXPECT_EQ(0, flat_tail.tail_len);
+  EXPECT_TRUE(std::isnan(flat_tail.pareto_k));
+  EXPECT_TRUE((flat_tail.log_weights == 0).all());
+}
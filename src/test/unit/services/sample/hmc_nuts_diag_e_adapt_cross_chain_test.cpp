@@ -0,0 +1,195 @@
+#include <stan/services/sample/hmc_nuts_diag_e_adapt.hpp>
+#include <gtest/gtest.h>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <iostream>
+
+auto&& blah = stan::math::init_threadpool_tbb();
+
+static constexpr size_t num_chains = 4;
+
+class ServicesSampleHmcNutsDiagEAdaptCrossChain : public testing::Test {
+ public:
+  ServicesSampleHmcNutsDiagEAdaptCrossChain()
+      : model(data_context, 0, &model_log), metric_writer(num_chains) {
+    for (int i = 0; i < num_chains; ++i) {
+      init.push_back(stan::test::unit::instrumented_writer{});
+      parameter.push_back(stan::test::unit::instrumented_writer{});
+      diagnostic.push_back(stan::test::unit::instrumented_writer{});
+      context.push_back(std::make_shared<stan::io::empty_var_context>());
+      inv_metric.push_back(std::make_shared<stan::io::array_var_context>(
+          stan::services::util::create_unit_e_diag_inv_metric(
+              model.num_params_r())));
+    }
+  }
+  stan::io::empty_var_context data_context;
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  std::vector<stan::test::unit::instrumented_writer> init;
+  std::vector<stan::test::unit::instrumented_writer> parameter;
+  std::vector<stan::test::unit::instrumented_writer> diagnostic;
+  std::vector<stan::callbacks::structured_writer> metric_writer;
+  std::vector<std::shared_ptr<stan::io::empty_var_context>> context;
+  std::vector<std::shared_ptr<stan::io::array_var_context>> inv_metric;
+  stan_model model;
+};
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptCrossChain, shared_adaptation) {
+  unsigned int random_seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int num_warmup = 200;
+  int num_samples = 400;
+  int num_thin = 1;
+  bool save_warmup = true;
+  int refresh = 0;
+  double stepsize = 0.1;
+  double stepsize_jitter = 0;
+  int max_depth = 8;
+  double delta = .8;
+  double gamma = .05;
+  double kappa = .75;
+  double t0 = 10;
+  unsigned int init_buffer = 50;
+  unsigned int term_buffer = 50;
+  unsigned int window = 25;
+  stan::test::unit::instrumented_interrupt interrupt;
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      model, num_chains, context, inv_metric, random_seed, chain, init_radius,
+      num_warmup, num_samples, num_thin, save_warmup, refresh, stepsize,
+      stepsize_jitter, max_depth, delta, gamma, kappa, t0, init_buffer,
+      term_buffer, window, true, 0, 1, 1, interrupt, logger, init, parameter,
+      diagnostic, metric_writer);
+
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ((num_warmup + num_samples) * num_chains, interrupt.call_count());
+  EXPECT_EQ(0, logger.find_info("Effective sample size"));
+  EXPECT_EQ(0, logger.call_count_error());
+
+  // Every chain ends warmup with the same step size and metric
+  std::vector<std::string> adaptation_info = parameter[0].string_values();
+  EXPECT_LT(0, adaptation_info.size());
+  for (size_t i = 0; i < num_chains; ++i) {
+    EXPECT_EQ(1, parameter[i].call_count("vector_string"));
+    EXPECT_EQ(num_warmup + num_samples,
+              parameter[i].call_count("vector_double"));
+    EXPECT_EQ(adaptation_info, parameter[i].string_values());
+  }
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptCrossChain, ess_early_termination) {
+  unsigned int random_seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int num_warmup = 1000;
+  int num_samples = 100;
+  int num_thin = 1;
+  bool save_warmup = false;
+  int refresh = 0;
+  double stepsize = 0.1;
+  double stepsize_jitter = 0;
+  int max_depth = 8;
+  double delta = .8;
+  double gamma = .05;
+  double kappa = .75;
+  double t0 = 10;
+  unsigned int init_buffer = 75;
+  unsigned int term_buffer = 50;
+  unsigned int window = 25;
+  double ess_target = 10;
+  stan::test::unit::instrumented_interrupt interrupt;
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      model, num_chains, context, inv_metric, random_seed, chain, init_radius,
+      num_warmup, num_samples, num_thin, save_warmup, refresh, stepsize,
+      stepsize_jitter, max_depth, delta, gamma, kappa, t0, init_buffer,
+      term_buffer, window, true, ess_target, 1, 1, interrupt, logger, init,
+      parameter, diagnostic, metric_writer);
+
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(1, logger.find_info("Effective sample size"));
+  EXPECT_GT((num_warmup + num_samples) * num_chains, interrupt.call_count());
+  for (size_t i = 0; i < num_chains; ++i)
+    EXPECT_EQ(num_samples, parameter[i].call_count("vector_double"));
+  EXPECT_EQ(0, logger.call_count_error());
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptCrossChain, warmup_thinning) {
+  unsigned int random_seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int num_warmup = 200;
+  int num_samples = 100;
+  int num_thin = 3;
+  bool save_warmup = true;
+  int refresh = 0;
+  double stepsize = 0.1;
+  double stepsize_jitter = 0;
+  int max_depth = 8;
+  double delta = .8;
+  double gamma = .05;
+  double kappa = .75;
+  double t0 = 10;
+  unsigned int init_buffer = 75;
+  unsigned int term_buffer = 50;
+  unsigned int window = 25;
+  stan::test::unit::instrumented_interrupt interrupt;
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      model, num_chains, context, inv_metric, random_seed, chain, init_radius,
+      num_warmup, num_samples, num_thin, save_warmup, refresh, stepsize,
+      stepsize_jitter, max_depth, delta, gamma, kappa, t0, init_buffer,
+      term_buffer, window, true, 0, 1, 1, interrupt, logger, init, parameter,
+      diagnostic, metric_writer);
+
+  EXPECT_EQ(0, return_code);
+  // Thinned as if warmup were run in one piece rather than window by
+  // window
+  int num_warmup_draws = (num_warmup + num_thin - 1) / num_thin;
+  int num_sample_draws = (num_samples + num_thin - 1) / num_thin;
+  for (size_t i = 0; i < num_chains; ++i)
+    EXPECT_EQ(num_warmup_draws + num_sample_draws,
+              parameter[i].call_count("vector_double"));
+  EXPECT_EQ(0, logger.call_count_error());
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptCrossChain, batched_initialization) {
+  unsigned int random_seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 2;
+  int num_warmup = 100;
+  int num_samples = 100;
+  int num_thin = 1;
+  bool save_warmup = false;
+  int refresh = 0;
+  double stepsize = 0.1;
+  double stepsize_jitter = 0;
+  int max_depth = 8;
+  double delta = .8;
+  double gamma = .05;
+  double kappa = .75;
+  double t0 = 10;
+  unsigned int init_buffer = 15;
+  unsigned int term_buffer = 10;
+  unsigned int window = 25;
+  stan::test::unit::instrumented_interrupt interrupt;
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      model, num_chains, context, inv_metric, random_seed, chain, init_radius,
+      num_warmup, num_samples, num_thin, save_warmup, refresh, stepsize,
+      stepsize_jitter, max_depth, delta, gamma, kappa, t0, init_buffer,
+      term_buffer, window, false, 0, 4, 3, interrupt, logger, init, parameter,
+      diagnostic, metric_writer);
+
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ((num_warmup + num_samples) * num_chains, interrupt.call_count());
+  for (size_t i = 0; i < num_chains; ++i) {
+    EXPECT_EQ(1, init[i].call_count("vector_double"));
+    EXPECT_EQ(num_samples, parameter[i].call_count("vector_double"));
+  }
+  // one timing banner per chain, for its first valid candidate
+  EXPECT_EQ(num_chains, logger.find_info("Gradient evaluation took"));
+  EXPECT_EQ(0, logger.call_count_error());
+}
@@ -1,8 +1,10 @@
 #include <stan/services/sample/hmc_nuts_diag_e_adapt.hpp>
 #include <gtest/gtest.h>
 #include <stan/io/empty_var_context.hpp>
+#include <stan/callbacks/json_writer.hpp>
 #include <test/test-models/good/optimization/rosenbrock.hpp>
 #include <test/unit/services/instrumented_callbacks.hpp>
+#include <test/unit/services/util.hpp>
 #include <iostream>
 
 class ServicesSampleHmcNutsDiagEAdapt : public testing::Test {
@@ -194,3 +196,156 @@ TEST_F(ServicesSampleHmcNutsDiagEAdapt, output_regression) {
   EXPECT_EQ(1, logger.find_info("seconds (Total)"));
   EXPECT_EQ(0, logger.call_count_error());
 }
+
+TEST_F(ServicesSampleHmcNutsDiagEAdapt, early_stopping_warmup) {
+  unsigned int random_seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int num_warmup = 1000;
+  int num_samples = 100;
+  int num_thin = 1;
+  bool save_warmup = true;
+  int refresh = 0;
+  double stepsize = 0.1;
+  double stepsize_jitter = 0;
+  int max_depth = 8;
+  double delta = .8;
+  double gamma = .05;
+  double kappa = .75;
+  double t0 = 10;
+  unsigned int init_buffer = 75;
+  unsigned int term_buffer = 50;
+  unsigned int window = 25;
+  // Loose enough to converge at the end of the second window
+  double warmup_stepsize_tol = 1e3;
+  double warmup_metric_tol = 1e3;
+  stan::test::unit::instrumented_interrupt interrupt;
+  auto inv_metric = stan::services::util::create_unit_e_diag_inv_metric(
+      model.num_params_r());
+  stan::callbacks::structured_writer metric;
+  std::stringstream warmup_ss;
+  std::unique_ptr<std::stringstream, stan::test::deleter_noop> warmup_output(
+      &warmup_ss);
+  stan::callbacks::json_writer<std::stringstream, stan::test::deleter_noop>
+      warmup(std::move(warmup_output));
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      model, context, inv_metric, random_seed, chain, init_radius, num_warmup,
+      num_samples, num_thin, save_warmup, refresh, stepsize, stepsize_jitter,
+      max_depth, delta, gamma, kappa, t0, init_buffer, term_buffer, window,
+      warmup_stepsize_tol, warmup_metric_tol, interrupt, logger, init,
+      parameter, diagnostic, metric, warmup);
+
+  EXPECT_EQ(0, return_code);
+  // Windows end after iterations 100 and 150, then the terminal buffer
+  int num_warmup_run = 150 + term_buffer;
+  EXPECT_EQ(num_warmup_run + num_samples, interrupt.call_count());
+  EXPECT_EQ(num_warmup_run + num_samples,
+            parameter.call_count("vector_double"));
+  EXPECT_EQ(1, logger.find_info("Adaptation converged"));
+
+  std::string record = warmup_ss.str();
+  EXPECT_NE(std::string::npos,
+            record.find("\"warmup_end_reason\" : \"converged\""));
+  EXPECT_NE(std::string::npos, record.find("\"num_warmup\" : 200"));
+  EXPECT_NE(std::string::npos, record.find("\"num_windows\" : 2"));
+  EXPECT_EQ(0, logger.call_count_error());
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdapt, early_stopping_warmup_last_window) {
+  unsigned int random_seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int num_warmup = 200;
+  int num_samples = 100;
+  int num_thin = 1;
+  bool save_warmup = true;
+  int refresh = 0;
+  double stepsize = 0.1;
+  double stepsize_jitter = 0;
+  int max_depth = 8;
+  double delta = .8;
+  double gamma = .05;
+  double kappa = .75;
+  double t0 = 10;
+  unsigned int init_buffer = 75;
+  unsigned int term_buffer = 50;
+  unsigned int window = 25;
+  // Converges at the end of the second window, which is also the last
+  double warmup_stepsize_tol = 1e3;
+  double warmup_metric_tol = 1e3;
+  stan::test::unit::instrumented_interrupt interrupt;
+  auto inv_metric = stan::services::util::create_unit_e_diag_inv_metric(
+      model.num_params_r());
+  stan::callbacks::structured_writer metric;
+  std::stringstream warmup_ss;
+  std::unique_ptr<std::stringstream, stan::test::deleter_noop> warmup_output(
+      &warmup_ss);
+  stan::callbacks::json_writer<std::stringstream, stan::test::deleter_noop>
+      warmup(std::move(warmup_output));
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      model, context, inv_metric, random_seed, chain, init_radius, num_warmup,
+      num_samples, num_thin, save_warmup, refresh, stepsize, stepsize_jitter,
+      max_depth, delta, gamma, kappa, t0, init_buffer, term_buffer, window,
+      warmup_stepsize_tol, warmup_metric_tol, interrupt, logger, init,
+      parameter, diagnostic, metric, warmup);
+
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(num_warmup + num_samples, interrupt.call_count());
+  EXPECT_EQ(num_warmup + num_samples, parameter.call_count("vector_double"));
+
+  std::string record = warmup_ss.str();
+  EXPECT_NE(std::string::npos,
+            record.find("\"warmup_end_reason\" : \"num_warmup_reached\""));
+  EXPECT_NE(std::string::npos, record.find("\"num_warmup\" : 200"));
+  EXPECT_NE(std::string::npos, record.find("\"num_windows\" : 2"));
+  EXPECT_EQ(0, logger.call_count_error());
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdapt, windowed_warmup_thinning) {
+  unsigned int random_seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int num_warmup = 200;
+  int num_samples = 100;
+  int num_thin = 3;
+  bool save_warmup = true;
+  int refresh = 10;
+  double stepsize = 0.1;
+  double stepsize_jitter = 0;
+  int max_depth = 8;
+  double delta = .8;
+  double gamma = .05;
+  double kappa = .75;
+  double t0 = 10;
+  unsigned int init_buffer = 75;
+  unsigned int term_buffer = 50;
+  unsigned int window = 25;
+  // Never converges, so warmup runs window by window to the end
+  double warmup_stepsize_tol = 1e-12;
+  double warmup_metric_tol = 1e-12;
+  stan::test::unit::instrumented_interrupt interrupt;
+  auto inv_metric = stan::services::util::create_unit_e_diag_inv_metric(
+      model.num_params_r());
+  stan::callbacks::structured_writer metric, warmup;
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      model, context, inv_metric, random_seed, chain, init_radius, num_warmup,
+      num_samples, num_thin, save_warmup, refresh, stepsize, stepsize_jitter,
+      max_depth, delta, gamma, kappa, t0, init_buffer, term_buffer, window,
+      warmup_stepsize_tol, warmup_metric_tol, interrupt, logger, init,
+      parameter, diagnostic, metric, warmup);
+
+  EXPECT_EQ(0, return_code);
+  // Thinned as if warmup were run in one piece
+  int num_warmup_draws = (num_warmup + num_thin - 1) / num_thin;
+  int num_sample_draws = (num_samples + num_thin - 1) / num_thin;
+  EXPECT_EQ(num_warmup_draws + num_sample_draws,
+            parameter.call_count("vector_double"));
+  // Progress is reported every refresh iterations plus the first and
+  // last iteration of each phase, not at every window
+  EXPECT_EQ(num_warmup / refresh + 1 + num_samples / refresh + 1,
+            logger.find_info("Iteration:"));
+  EXPECT_EQ(0, logger.call_count_error());
+}
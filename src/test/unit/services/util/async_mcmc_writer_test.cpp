@@ -0,0 +1,243 @@
+#include <stan/services/util/async_mcmc_writer.hpp>
+#include <stan/services/util/generate_transitions.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <gtest/gtest.h>
+#include <test/test-models/good/services/test_lp.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace test {
+// Moves every coordinate by one on each transition and reports the
+// iteration as a sampler parameter and diagnostic
+class counting_sampler : public stan::mcmc::base_mcmc {
+ public:
+  counting_sampler() : n_transition(0) {}
+
+  stan::mcmc::sample transition(stan::mcmc::sample& init_sample,
+                                stan::callbacks::logger& logger) {
+    ++n_transition;
+    Eigen::VectorXd q = init_sample.cont_params().array() + 1;
+    return stan::mcmc::sample(q, -n_transition, 0.5);
+  }
+
+  void get_sampler_param_names(std::vector<std::string>& names) {
+    names.push_back("iteration__");
+  }
+
+  void get_sampler_params(std::vector<double>& values) {
+    values.push_back(n_transition);
+  }
+
+  void get_sampler_diagnostic_names(std::vector<std::string>& model_names,
+                                    std::vector<std::string>& names) {
+    names.push_back("iteration_diagnostic");
+  }
+
+  void get_sampler_diagnostics(std::vector<double>& values) {
+    values.push_back(10 * n_transition);
+  }
+
+  int n_transition;
+};
+
+// Logs on every transition
+class logging_sampler : public counting_sampler {
+ public:
+  stan::mcmc::sample transition(stan::mcmc::sample& init_sample,
+                                stan::callbacks::logger& logger) {
+    logger.info("transition");
+    return counting_sampler::transition(init_sample, logger);
+  }
+};
+
+// Prints to the message stream and then fails on every draw
+class failing_gq_model {
+ public:
+  void constrained_param_names(std::vector<std::string>& names,
+                               bool include_tparams = true,
+                               bool include_gqs = true) const {
+    names.push_back("x");
+  }
+
+  template <class RNG>
+  void write_array(RNG& rng, std::vector<double>& params_r,
+                   std::vector<int>& params_i, std::vector<double>& vars,
+                   bool include_tparams = true, bool include_gqs = true,
+                   std::ostream* msgs = 0) const {
+    *msgs << "gq print";
+    throw std::domain_error("gq failed");
+  }
+};
+
+// Records the messages and the threads logging them
+class thread_logger : public stan::callbacks::logger {
+ public:
+  void info(const std::string& message) { record(message); }
+  void info(const std::stringstream& message) { record(message.str()); }
+
+  size_t count(const std::string& message) {
+    size_t n = 0;
+    for (const auto& m : messages)
+      n += m == message;
+    return n;
+  }
+
+  std::vector<std::string> messages;
+  std::vector<std::thread::id> threads;
+
+ private:
+  void record(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    messages.push_back(message);
+    threads.push_back(std::this_thread::get_id());
+  }
+
+  std::mutex mutex_;
+};
+
+// Throws on every draw
+class throwing_writer : public stan::callbacks::writer {
+ public:
+  void operator()(const std::vector<double>& state) {
+    throw std::runtime_error("throwing_writer");
+  }
+};
+}  // namespace test
+
+class ServicesUtilAsyncMcmcWriter : public ::testing::Test {
+ public:
+  ServicesUtilAsyncMcmcWriter() : model(context, 0, &model_log) {}
+
+  stan::test::unit::instrumented_writer sample_writer, diagnostic_writer;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_interrupt interrupt;
+  std::stringstream model_log;
+  stan::io::empty_var_context context;
+  stan_model model;
+};
+
+TEST_F(ServicesUtilAsyncMcmcWriter, matches_mcmc_writer) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  stan::rng_t output_rng = stan::services::util::create_rng(0, 2);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+
+  stan::test::unit::instrumented_writer expected_samples, expected_diagnostics;
+  {
+    test::counting_sampler sampler;
+    stan::mcmc::sample s(x, 0, 0);
+    stan::services::util::mcmc_writer writer(expected_samples,
+                                             expected_diagnostics, logger);
+    writer.write_sample_names(s, sampler, model);
+    writer.write_diagnostic_names(s, sampler, model);
+    stan::services::util::generate_transitions(sampler, 100, 0, 100, 3, 0,
+                                               true, false, writer, s, model,
+                                               rng, interrupt, logger);
+    writer.write_adapt_finish(sampler);
+    writer.write_timing(0, 0);
+  }
+
+  test::counting_sampler sampler;
+  stan::mcmc::sample s(x, 0, 0);
+  stan::services::util::async_mcmc_writer<stan_model, stan::rng_t> writer(
+      sample_writer, diagnostic_writer, logger, model, output_rng, 4);
+  writer.write_sample_names(s, sampler, model);
+  writer.write_diagnostic_names(s, sampler, model);
+  stan::services::util::generate_transitions(sampler, 100, 0, 100, 3, 0, true,
+                                             false, writer, s, model, rng,
+                                             interrupt, logger);
+  writer.write_adapt_finish(sampler);
+  writer.write_timing(0, 0);
+  writer.finish();
+
+  EXPECT_EQ(100, sampler.n_transition);
+  EXPECT_EQ(expected_samples.call_count(), sample_writer.call_count());
+  EXPECT_EQ(expected_samples.call_count("string"),
+            sample_writer.call_count("string"));
+  EXPECT_EQ(expected_samples.vector_string_values(),
+            sample_writer.vector_string_values());
+  EXPECT_EQ(expected_diagnostics.vector_string_values(),
+            diagnostic_writer.vector_string_values());
+
+  std::vector<std::vector<double>> expected
+      = expected_samples.vector_double_values();
+  std::vector<std::vector<double>> values
+      = sample_writer.vector_double_values();
+  ASSERT_EQ(34, expected.size());
+  ASSERT_EQ(expected.size(), values.size());
+  for (size_t n = 0; n < expected.size(); ++n) {
+    ASSERT_EQ(expected[n].size(), values[n].size());
+    for (size_t i = 0; i < expected[n].size(); ++i)
+      EXPECT_FLOAT_EQ(expected[n][i], values[n][i]) << n << ", " << i;
+  }
+  EXPECT_EQ(expected_diagnostics.vector_double_values(),
+            diagnostic_writer.vector_double_values());
+}
+
+TEST_F(ServicesUtilAsyncMcmcWriter, flush) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stan::mcmc::sample s(x, 0, 0);
+  test::counting_sampler sampler;
+  stan::services::util::async_mcmc_writer<stan_model, stan::rng_t> writer(
+      sample_writer, diagnostic_writer, logger, model, rng, 2);
+
+  writer.write_sample_names(s, sampler, model);
+  for (int n = 0; n < 10; ++n) {
+    s = sampler.transition(s, logger);
+    writer.write_sample_params(rng, s, sampler, model);
+    writer.write_diagnostic_params(s, sampler);
+  }
+  writer.flush();
+  EXPECT_EQ(10, sample_writer.call_count("vector_double"));
+  EXPECT_EQ(10, diagnostic_writer.call_count("vector_double"));
+  writer.finish();
+  EXPECT_EQ(10, sample_writer.call_count("vector_double"));
+}
+
+TEST_F(ServicesUtilAsyncMcmcWriter, rethrows_writer_exception) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stan::mcmc::sample s(x, 0, 0);
+  test::counting_sampler sampler;
+  test::throwing_writer throwing;
+  stan::services::util::async_mcmc_writer<stan_model, stan::rng_t> writer(
+      throwing, diagnostic_writer, logger, model, rng);
+
+  writer.write_sample_params(rng, s, sampler, model);
+  EXPECT_THROW(writer.flush(), std::runtime_error);
+  EXPECT_THROW(writer.write_sample_params(rng, s, sampler, model),
+               std::runtime_error);
+  EXPECT_THROW(writer.finish(), std::runtime_error);
+}
+
+TEST_F(ServicesUtilAsyncMcmcWriter, logs_on_sampling_thread) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  stan::rng_t output_rng = stan::services::util::create_rng(0, 2);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(1);
+  stan::mcmc::sample s(x, 0, 0);
+  test::logging_sampler sampler;
+  test::failing_gq_model gq_model;
+  test::thread_logger gq_logger;
+  stan::services::util::async_mcmc_writer<test::failing_gq_model, stan::rng_t>
+      writer(sample_writer, diagnostic_writer, gq_logger, gq_model, output_rng,
+             4);
+
+  writer.write_sample_names(s, sampler, gq_model);
+  stan::services::util::generate_transitions(sampler, 50, 0, 50, 1, 1, true,
+                                             false, writer, s, gq_model, rng,
+                                             interrupt, gq_logger);
+  writer.finish();
+
+  EXPECT_EQ(50, sample_writer.call_count("vector_double"));
+  EXPECT_EQ(50, gq_logger.count("transition"));
+  EXPECT_EQ(50, gq_logger.count("gq print"));
+  EXPECT_EQ(50, gq_logger.count("gq failed"));
+  for (const auto& id : gq_logger.threads)
+    EXPECT_EQ(std::this_thread::get_id(), id);
+}
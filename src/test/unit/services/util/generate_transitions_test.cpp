@@ -128,3 +128,70 @@ TEST_F(ServicesSamplesGenerateTransitions, output_sizes) {
   EXPECT_EQ(parameter_names[0].size(), parameter_values[0].size());
   EXPECT_EQ(diagnostic_names[0].size(), diagnostic_values[0].size());
 }
+
+namespace test {
+// Reports the number of transitions as a sampler parameter
+class counting_sampler : public stan::mcmc::fixed_param_sampler {
+ public:
+  counting_sampler() : n_transition(0) {}
+
+  stan::mcmc::sample transition(stan::mcmc::sample& init_sample,
+                                stan::callbacks::logger& logger) {
+    ++n_transition;
+    return init_sample;
+  }
+
+  void get_sampler_param_names(std::vector<std::string>& names) {
+    names.push_back("iteration__");
+  }
+
+  void get_sampler_params(std::vector<double>& values) {
+    values.push_back(n_transition);
+  }
+
+  int n_transition;
+};
+}  // namespace test
+
+TEST_F(ServicesSamplesGenerateTransitions, phase_segments) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  Eigen::VectorXd cont_params = Eigen::VectorXd::Zero(2);
+  int num_iterations = 20;
+  int num_thin = 3;
+  int refresh = 4;
+
+  stan::test::unit::instrumented_writer expected_parameter;
+  stan::test::unit::instrumented_logger expected_logger;
+  {
+    test::counting_sampler sampler;
+    stan::services::util::mcmc_writer writer(expected_parameter, diagnostic,
+                                             expected_logger);
+    stan::mcmc::sample s(cont_params, 0, 0);
+    stan::services::util::generate_transitions(
+        sampler, num_iterations, 0, num_iterations, num_thin, refresh, true,
+        true, writer, s, model, rng, interrupt, expected_logger);
+  }
+
+  // The same phase generated in segments thins and reports progress
+  // as if it were generated in one call
+  test::counting_sampler sampler;
+  stan::services::util::mcmc_writer writer(parameter, diagnostic, logger);
+  stan::mcmc::sample s(cont_params, 0, 0);
+  int start = 0;
+  for (int segment : {7, 5, 8}) {
+    stan::services::util::generate_transitions(
+        sampler, segment, start, num_iterations, num_thin, refresh, true, true,
+        writer, s, model, rng, interrupt, logger, 1, 1, 0);
+    start += segment;
+  }
+
+  EXPECT_EQ(num_iterations, sampler.n_transition);
+  EXPECT_EQ(7, parameter.call_count("vector_double"));
+  EXPECT_EQ(expected_parameter.vector_double_values(),
+            parameter.vector_double_values());
+  std::stringstream expected_info, info;
+  expected_logger.print_info(expected_info);
+  logger.print_info(info);
+  EXPECT_EQ(expected_info.str(), info.str());
+}
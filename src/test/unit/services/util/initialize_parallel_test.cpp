@@ -0,0 +1,172 @@
+#include <stan/services/util/initialize_parallel.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <test/unit/util.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/model/prob_grad.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace test {
+// Mock model rejecting initial values with a first parameter below -1
+// and with a log density that is highest near the origin.  If fatal,
+// it rejects all values and fails on a first parameter above 1.5.
+// Free of state, so it can be evaluated from multiple threads.
+class mock_rejecting_model : public stan::model::prob_grad {
+ public:
+  explicit mock_rejecting_model(bool fatal = false)
+      : stan::model::prob_grad(2), fatal_(fatal) {}
+
+  template <bool propto__, bool jacobian__, typename T__>
+  T__ log_prob(std::vector<T__>& params_r__, std::vector<int>& params_i__,
+               std::ostream* pstream__ = 0) const {
+    if (fatal_ && params_r__[0] > 1.5)
+      throw std::out_of_range("out_of_range error in log_prob");
+    if (fatal_ || params_r__[0] < -1)
+      throw std::domain_error("theta below -1 in log_prob");
+    return -params_r__[0] * params_r__[0] - params_r__[1] * params_r__[1];
+  }
+
+  void transform_inits(const stan::io::var_context& context__,
+                       std::vector<int>& params_i__,
+                       std::vector<double>& params_r__,
+                       std::ostream* pstream__) const {
+    params_r__ = context__.vals_r("theta");
+  }
+
+  void get_dims(std::vector<std::vector<size_t> >& dimss__,
+                bool include_tparams = true, bool include_gqs = true) const {
+    dimss__.resize(0);
+    dimss__.push_back(std::vector<size_t>{2});
+  }
+
+  void constrained_param_names(std::vector<std::string>& param_names__,
+                               bool include_tparams__ = true,
+                               bool include_gqs__ = true) const {
+    param_names__.push_back("theta.1");
+    param_names__.push_back("theta.2");
+  }
+
+  void get_param_names(std::vector<std::string>& names,
+                       bool include_tparams = true,
+                       bool include_gqs = true) const {
+    names.push_back("theta");
+  }
+
+  void unconstrained_param_names(std::vector<std::string>& param_names__,
+                                 bool include_tparams__ = true,
+                                 bool include_gqs__ = true) const {
+    constrained_param_names(param_names__);
+  }
+
+  template <typename RNG>
+  void write_array(RNG& base_rng__, std::vector<double>& params_r__,
+                   std::vector<int>& params_i__, std::vector<double>& vars__,
+                   bool include_tparams__ = true, bool include_gqs__ = true,
+                   std::ostream* pstream__ = 0) const {
+    vars__ = params_r__;
+  }
+
+ private:
+  bool fatal_;
+};
+}  // namespace test
+
+class ServicesUtilInitializeParallel : public testing::Test {
+ public:
+  ServicesUtilInitializeParallel()
+      : rng(stan::services::util::create_rng(0, 1)),
+        expected_rng(stan::services::util::create_rng(0, 1)) {}
+
+  double log_prob(const std::vector<double>& params) {
+    return -params[0] * params[0] - params[1] * params[1];
+  }
+
+  test::mock_rejecting_model model;
+  stan::io::empty_var_context empty_context;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_logger expected_logger;
+  stan::test::unit::instrumented_writer init;
+  stan::test::unit::instrumented_writer expected_init;
+  stan::rng_t rng;
+  stan::rng_t expected_rng;
+};
+
+TEST_F(ServicesUtilInitializeParallel, matches_initialize) {
+  for (size_t batch_size : {1, 3, 8, 100}) {
+    for (int run = 0; run < 5; ++run) {
+      std::vector<double> expected = stan::services::util::initialize(
+          model, empty_context, expected_rng, 2, true, expected_logger,
+          expected_init);
+      std::vector<double> params = stan::services::util::initialize_parallel(
+          model, empty_context, rng, 2, true, batch_size, 1, logger, init);
+      EXPECT_EQ(expected, params);
+      EXPECT_EQ(expected_rng(), rng()) << "rng in the same state";
+    }
+    EXPECT_EQ(expected_logger.call_count_warn(), logger.call_count_warn());
+    EXPECT_EQ(expected_logger.call_count_info(), logger.call_count_info());
+    EXPECT_EQ(expected_logger.find_warn("theta below -1 in log_prob"),
+              logger.find_warn("theta below -1 in log_prob"));
+    EXPECT_EQ(expected_init.vector_double_values(),
+              init.vector_double_values());
+  }
+}
+
+TEST_F(ServicesUtilInitializeParallel, best_of_k) {
+  size_t num_best = 5;
+  std::vector<double> expected;
+  for (size_t k = 0; k < num_best; ++k) {
+    std::vector<double> params = stan::services::util::initialize(
+        model, empty_context, expected_rng, 2, false, expected_logger,
+        expected_init);
+    if (k == 0 || log_prob(params) > log_prob(expected))
+      expected = params;
+  }
+
+  std::vector<double> params = stan::services::util::initialize_parallel(
+      model, empty_context, rng, 2, true, 4, num_best, logger, init);
+  EXPECT_EQ(expected, params);
+  EXPECT_EQ(expected_rng(), rng());
+  EXPECT_EQ(1, logger.find_info("Gradient evaluation"));
+  EXPECT_EQ(expected_logger.call_count_warn(), logger.call_count_warn());
+  ASSERT_EQ(1, init.vector_double_values().size());
+  EXPECT_EQ(params, init.vector_double_values()[0]);
+}
+
+TEST_F(ServicesUtilInitializeParallel, radius_zero) {
+  std::vector<double> params = stan::services::util::initialize_parallel(
+      model, empty_context, rng, 0, false, 8, 3, logger, init);
+  EXPECT_EQ(std::vector<double>({0, 0}), params);
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST_F(ServicesUtilInitializeParallel, model_errors) {
+  test::mock_rejecting_model error_model(true);
+  EXPECT_THROW_MSG(
+      stan::services::util::initialize(error_model, empty_context,
+                                       expected_rng, 2, false,
+                                       expected_logger, expected_init),
+      std::out_of_range, "out_of_range error in log_prob");
+  EXPECT_THROW_MSG(stan::services::util::initialize_parallel(
+                       error_model, empty_context, rng, 2, false, 16, 1,
+                       logger, init),
+                   std::out_of_range, "out_of_range error in log_prob");
+  EXPECT_EQ(expected_logger.call_count(), logger.call_count());
+  EXPECT_EQ(expected_logger.call_count_warn(), logger.call_count_warn());
+  EXPECT_GT(logger.call_count_warn(), 0);
+  EXPECT_EQ(1, logger.call_count_error());
+  EXPECT_EQ(expected_rng(), rng());
+  EXPECT_EQ(0, init.vector_double_values().size());
+}
+
+TEST_F(ServicesUtilInitializeParallel, invalid_arguments) {
+  EXPECT_THROW(stan::services::util::initialize_parallel(
+                   model, empty_context, rng, 2, false, 0, 1, logger, init),
+               std::invalid_argument);
+  EXPECT_THROW(stan::services::util::initialize_parallel(
+                   model, empty_context, rng, 2, false, 4, 0, logger, init),
+               std::invalid_argument);
+}
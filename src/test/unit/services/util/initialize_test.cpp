@@ -528,32 +528,59 @@ TEST_F(ServicesUtilInitialize, model_throws_in_write_array__radius_zero) {
 
   double init_radius = 0;
   bool print_timing = false;
-  EXPECT_THROW(
-      stan::services::util::initialize(throwing_model, empty_context, rng,
-                                       init_radius, print_timing, logger, init),
-      std::domain_error);
-
-  EXPECT_EQ(3, logger.call_count());
-  EXPECT_EQ(3, logger.call_count_warn());
-  EXPECT_EQ(1, logger.find_warn("throwing within write_array"));
+  std::vector<double> params = stan::services::util::initialize(
+      throwing_model, empty_context, rng, init_radius, print_timing, logger,
+      init);
+
+  // without initial values, the draw is never constrained
+  EXPECT_EQ(std::vector<double>({0}), params);
+  EXPECT_EQ(0, throwing_model.write_array_calls);
+  EXPECT_EQ(0, throwing_model.transform_inits_calls);
+  EXPECT_EQ(0, logger.call_count());
 }
 
 TEST_F(ServicesUtilInitialize, model_throws_in_write_array__radius_two) {
   test::mock_throwing_model_in_write_array throwing_model;
 
+  double init_radius = 2;
+  bool print_timing = false;
+  std::vector<double> params = stan::services::util::initialize(
+      throwing_model, empty_context, rng, init_radius, print_timing, logger,
+      init);
+
+  ASSERT_EQ(1, params.size());
+  EXPECT_LT(-2, params[0]);
+  EXPECT_GT(2, params[0]);
+  EXPECT_EQ(0, throwing_model.write_array_calls);
+  EXPECT_EQ(0, throwing_model.transform_inits_calls);
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST_F(ServicesUtilInitialize, model_throws_in_write_array__full_init) {
+  std::vector<std::string> names_r;
+  std::vector<double> values_r;
+  std::vector<std::vector<size_t> > dim_r;
+  names_r.push_back("theta");
+  values_r.push_back(1.5);
+  dim_r.push_back(std::vector<size_t>());
+  stan::io::array_var_context init_context(names_r, values_r, dim_r);
+
+  test::mock_throwing_model_in_write_array throwing_model;
+
   double init_radius = 2;
   bool print_timing = false;
   EXPECT_THROW(
-      stan::services::util::initialize(throwing_model, empty_context, rng,
+      stan::services::util::initialize(throwing_model, init_context, rng,
                                        init_radius, print_timing, logger, init),
       std::domain_error);
-  EXPECT_EQ(303, logger.call_count());
-  EXPECT_EQ(300, logger.call_count_warn());
+  EXPECT_EQ(1, throwing_model.write_array_calls);
+  EXPECT_EQ(6, logger.call_count());
+  EXPECT_EQ(3, logger.call_count_warn());
   EXPECT_EQ(2, logger.call_count_error());
-  EXPECT_EQ(100, logger.find_warn("throwing within write_array"));
+  EXPECT_EQ(1, logger.find_warn("throwing within write_array"));
 }
 
-TEST_F(ServicesUtilInitialize, model_throws_in_write_array__full_init) {
+TEST_F(ServicesUtilInitialize, model_throws_in_write_array__unused_init) {
   std::vector<std::string> names_r;
   std::vector<double> values_r;
   std::vector<std::vector<size_t> > dim_r;
@@ -569,12 +596,12 @@ TEST_F(ServicesUtilInitialize, model_throws_in_write_array__full_init) {
 
   double init_radius = 2;
   bool print_timing = false;
-  EXPECT_THROW(
-      stan::services::util::initialize(throwing_model, init_context, rng,
-                                       init_radius, print_timing, logger, init),
-      std::domain_error);
-  EXPECT_EQ(303, logger.call_count());
-  EXPECT_EQ(300, logger.call_count_warn());
-  EXPECT_EQ(2, logger.call_count_error());
-  EXPECT_EQ(100, logger.find_warn("throwing within write_array"));
+  std::vector<double> params = stan::services::util::initialize(
+      throwing_model, init_context, rng, init_radius, print_timing, logger,
+      init);
+
+  // values for variables that are not parameters are ignored
+  ASSERT_EQ(1, params.size());
+  EXPECT_EQ(0, throwing_model.write_array_calls);
+  EXPECT_EQ(0, logger.call_count());
 }
@@ -208,3 +208,32 @@ TEST_F(ServicesUtil, num_warmup_num_samples_refresh) {
   EXPECT_EQ(num_samples, diagnostic_writer.call_count("vector_double"))
       << "draws";
 }
+
+TEST_F(ServicesUtil, num_warmup_save_num_samples_async_write) {
+  num_warmup = 500;
+  save_warmup = true;
+  num_samples = 500;
+  stan::services::util::run_adaptive_sampler(
+      sampler, model, cont_vector, num_warmup, num_samples, num_thin, refresh,
+      save_warmup, rng, interrupt, logger, sample_writer, diagnostic_writer,
+      dummy_metric_writer, 1, 1, true);
+  EXPECT_EQ(num_warmup + num_samples, interrupt.call_count());
+
+  EXPECT_EQ(3 + 2, logger.call_count()) << "Writes the elapsed time";
+  EXPECT_EQ(logger.call_count(), logger.call_count_info())
+      << "No other calls to logger";
+
+  EXPECT_EQ(num_warmup + num_samples + 9, sample_writer.call_count());
+  EXPECT_EQ(1, sample_writer.call_count("vector_string")) << "header line";
+  EXPECT_EQ(2 + 3 + 1, sample_writer.call_count("string"))
+      << "adaptation info + elapsed time";
+  EXPECT_EQ(2, sample_writer.call_count("empty")) << "blank lines";
+  EXPECT_EQ(num_warmup + num_samples,
+            sample_writer.call_count("vector_double"))
+      << "warmup and draws";
+
+  EXPECT_EQ(num_warmup + num_samples + 6, diagnostic_writer.call_count());
+  EXPECT_EQ(num_warmup + num_samples,
+            diagnostic_writer.call_count("vector_double"))
+      << "warmup and draws";
+}
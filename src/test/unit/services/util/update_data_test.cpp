@@ -0,0 +1,205 @@
+#include <stan/services/util/update_data.hpp>
+#include <stan/model/model_base_crtp.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <gtest/gtest.h>
+#include <test/unit/util.hpp>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace test {
+// Mock model with data int N and real x[N], and transformed data
+// sum_x.  If incremental, it supports replacing its data.
+struct mock_data_model : public stan::model::model_base_crtp<mock_data_model> {
+  mock_data_model(const stan::io::var_context& context,
+                  unsigned int random_seed, std::ostream* msgs,
+                  bool incremental = false)
+      : model_base_crtp(0), incremental_(incremental) {
+    ++num_constructed;
+    read_N(context);
+    read_x(context);
+    compute_transformed_data();
+  }
+
+  std::unique_ptr<stan::model::model_base> update_data(
+      const stan::io::var_context& delta, unsigned int random_seed,
+      std::ostream* msgs) const override {
+    if (!incremental_)
+      return nullptr;
+    auto model = std::make_unique<mock_data_model>(*this);
+    if (delta.contains_i("N"))
+      model->read_N(delta);
+    if (delta.contains_r("x") || delta.contains_i("N"))
+      model->read_x(delta);
+    model->compute_transformed_data();
+    return model;
+  }
+
+  void read_N(const stan::io::var_context& context) {
+    context.validate_dims("data initialization", "N", "int", {});
+    N = context.vals_i("N")[0];
+  }
+
+  void read_x(const stan::io::var_context& context) {
+    context.validate_dims("data initialization", "x", "double",
+                          {static_cast<size_t>(N)});
+    x = context.vals_r("x");
+  }
+
+  void compute_transformed_data() {
+    sum_x = 0;
+    for (double x_n : x)
+      sum_x += x_n;
+  }
+
+  std::string model_name() const override { return "mock_data_model"; }
+
+  std::vector<std::string> model_compile_info() const {
+    return std::vector<std::string>{"stanc_version = stanc3"};
+  }
+
+  void get_param_names(std::vector<std::string>& names, bool include_tparams,
+                       bool include_gqs) const override {}
+  void get_dims(std::vector<std::vector<size_t> >& dimss, bool include_tparams,
+                bool include_gqs) const override {}
+
+  void constrained_param_names(std::vector<std::string>& param_names,
+                               bool include_tparams,
+                               bool include_gqs) const override {}
+
+  void unconstrained_param_names(std::vector<std::string>& param_names,
+                                 bool include_tparams,
+                                 bool include_gqs) const override {}
+
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(Eigen::Matrix<T, -1, 1>& params_r, std::ostream* msgs) const {
+    return sum_x;
+  }
+
+  void transform_inits(const stan::io::var_context& context,
+                       Eigen::VectorXd& params_r,
+                       std::ostream* msgs) const override {}
+
+  template <typename RNG>
+  void write_array(RNG& base_rng, Eigen::VectorXd& params_r,
+                   Eigen::VectorXd& params_constrained_r, bool include_tparams,
+                   bool include_gqs, std::ostream* msgs) const {}
+
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(std::vector<T>& params_r, std::vector<int>& params_i,
+             std::ostream* msgs) const {
+    return sum_x;
+  }
+
+  void transform_inits(const stan::io::var_context& context,
+                       std::vector<int>& params_i,
+                       std::vector<double>& params_r,
+                       std::ostream* msgs) const override {}
+
+  template <typename RNG>
+  void write_array(RNG& base_rng, std::vector<double>& params_r,
+                   std::vector<int>& params_i,
+                   std::vector<double>& params_r_constrained,
+                   bool include_tparams, bool include_gqs,
+                   std::ostream* msgs) const {}
+
+  void unconstrain_array(const Eigen::VectorXd& params_constrained_r,
+                         Eigen::VectorXd& params_r,
+                         std::ostream* msgs = nullptr) const override {}
+  void unconstrain_array(const std::vector<double>& params_constrained_r,
+                         std::vector<double>& params_r,
+                         std::ostream* msgs = nullptr) const override {}
+
+  int N;
+  std::vector<double> x;
+  double sum_x;
+  static int num_constructed;
+
+ private:
+  bool incremental_;
+};
+
+int mock_data_model::num_constructed = 0;
+}  // namespace test
+
+class ServicesUtilUpdateData : public testing::Test {
+ public:
+  ServicesUtilUpdateData()
+      : data({"x"}, std::vector<double>{1, 2, 3}, {{3}}, {"N"}, {3}, {{}}),
+        new_model([](const stan::io::var_context& context,
+                     unsigned int random_seed, std::ostream* msgs) {
+          return std::make_unique<test::mock_data_model>(context, random_seed,
+                                                         msgs);
+        }) {
+    test::mock_data_model::num_constructed = 0;
+  }
+
+  stan::io::array_var_context data;
+  std::function<std::unique_ptr<stan::model::model_base>(
+      const stan::io::var_context&, unsigned int, std::ostream*)>
+      new_model;
+};
+
+TEST_F(ServicesUtilUpdateData, fallback) {
+  test::mock_data_model model(data, 0, nullptr);
+  stan::io::array_var_context delta({"x"}, std::vector<double>{4, 5, 6},
+                                    {{3}});
+  std::unique_ptr<stan::model::model_base> updated
+      = stan::services::util::update_data(model, data, delta, 0, new_model);
+  EXPECT_EQ(2, test::mock_data_model::num_constructed);
+
+  auto& updated_model = dynamic_cast<test::mock_data_model&>(*updated);
+  EXPECT_EQ(3, updated_model.N);
+  EXPECT_EQ(std::vector<double>({4, 5, 6}), updated_model.x);
+  EXPECT_FLOAT_EQ(15, updated_model.sum_x);
+  EXPECT_FLOAT_EQ(6, model.sum_x) << "model is unchanged";
+}
+
+TEST_F(ServicesUtilUpdateData, incremental) {
+  test::mock_data_model model(data, 0, nullptr, true);
+  stan::io::array_var_context delta({"x"}, std::vector<double>{7, 8}, {{2}},
+                                    {"N"}, std::vector<int>{2}, {{}});
+  std::unique_ptr<stan::model::model_base> updated
+      = stan::services::util::update_data(model, data, delta, 0, new_model);
+  EXPECT_EQ(1, test::mock_data_model::num_constructed) << "not reconstructed";
+
+  auto& updated_model = dynamic_cast<test::mock_data_model&>(*updated);
+  EXPECT_EQ(2, updated_model.N);
+  EXPECT_EQ(std::vector<double>({7, 8}), updated_model.x);
+  EXPECT_FLOAT_EQ(15, updated_model.sum_x);
+  EXPECT_FLOAT_EQ(6, model.sum_x) << "model is unchanged";
+}
+
+TEST_F(ServicesUtilUpdateData, same_result) {
+  stan::io::array_var_context delta({"x"}, std::vector<double>{-1, 0.5, 2.5},
+                                    {{3}});
+  test::mock_data_model model(data, 0, nullptr);
+  test::mock_data_model incremental_model(data, 0, nullptr, true);
+  auto updated
+      = stan::services::util::update_data(model, data, delta, 0, new_model);
+  auto incremental_updated = stan::services::util::update_data(
+      incremental_model, data, delta, 0, new_model);
+  Eigen::VectorXd params_r(0);
+  EXPECT_FLOAT_EQ(updated->log_prob(params_r, nullptr),
+                  incremental_updated->log_prob(params_r, nullptr));
+}
+
+TEST_F(ServicesUtilUpdateData, invalid_delta) {
+  test::mock_data_model model(data, 0, nullptr, true);
+  stan::io::array_var_context unknown({"y"}, std::vector<double>{4}, {{}});
+  EXPECT_THROW_MSG(
+      stan::services::util::update_data(model, data, unknown, 0, new_model),
+      std::invalid_argument, "Variable y to update is not in the model data");
+
+  stan::io::array_var_context wrong_size({"x"}, std::vector<double>{4, 5},
+                                         {{2}});
+  EXPECT_THROW(
+      stan::services::util::update_data(model, data, wrong_size, 0, new_model),
+      std::exception);
+  test::mock_data_model fallback_model(data, 0, nullptr);
+  EXPECT_THROW(stan::services::util::update_data(fallback_model, data,
+                                                 wrong_size, 0, new_model),
+               std::exception);
+}